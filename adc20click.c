@@ -8,6 +8,8 @@
 #include <fcntl.h>
 #include <stdbool.h>
 #include "adc20click.h"
+#include "rp_metrics.h"
+#include "rp_trace.h"
 #include <time.h>
 #include <unistd.h>
 
@@ -33,7 +35,7 @@ void write_register(int spi_fd, uint8_t regAddr, uint8_t regCfg) {
     wr_reg.len = sizeof(wr_reg_buf);
 
     // execute the transfer 
-    if (ioctl(spi_fd, SPI_IOC_MESSAGE(1), &wr_reg) < 0) {
+    if (metrics_spi_message(METRICS_SPI_ADC20, spi_fd, 1, &wr_reg) < 0) {
         printf("Writing to register 0x%02X failed: %s\n", regAddr, strerror(errno));
         exit(EXIT_FAILURE);
     }
@@ -65,7 +67,7 @@ void read_register (int spi_fd, uint8_t regAddr) {
     rd_reg[1].len = sizeof(reg_data);
 
     // execute both transfers one after another
-    if (ioctl(spi_fd, SPI_IOC_MESSAGE(2), &rd_reg) < 0) {
+    if (metrics_spi_message(METRICS_SPI_ADC20, spi_fd, 2, rd_reg) < 0) {
         printf("Reading value from 0x%02X register failed: %s\n", regAddr, strerror(errno));
         exit(EXIT_FAILURE);
     }    
@@ -125,7 +127,7 @@ uint16_t manual_read_adc20_data(int spi_fd, int average) {
     rd_dummy.rx_buf = (unsigned long)data_buf;
     rd_dummy.len = sizeof(data_buf);
 
-    if (ioctl(spi_fd, SPI_IOC_MESSAGE(1), &rd_dummy) < 0) {
+    if (metrics_spi_message(METRICS_SPI_ADC20, spi_fd, 1, &rd_dummy) < 0) {
         printf("Reading/writing dummy data failed. %s\n", strerror(errno));
     }
 
@@ -138,7 +140,7 @@ uint16_t manual_read_adc20_data(int spi_fd, int average) {
     rd_data.len = sizeof(data_buf);
 
     // execute the transfers
-    if (ioctl(spi_fd, SPI_IOC_MESSAGE(1), &rd_data) < 0) {
+    if (metrics_spi_message(METRICS_SPI_ADC20, spi_fd, 1, &rd_data) < 0) {
         printf("Reading data from ADC failed. %s\n", strerror(errno));
         exit(EXIT_FAILURE);
     }
@@ -150,7 +152,7 @@ uint16_t manual_read_adc20_data(int spi_fd, int average) {
        raw_data = ((uint16_t)data_buf[0] << 8) | data_buf[1];
         ch_id = data_buf[2] >> 4;
     }
-    printf("Raw data read from channel %d of ADC 0x%04X\n",ch_id, raw_data);
+    TRACE_HOT("Raw data read from channel %d of ADC 0x%04X", ch_id, raw_data);
 
     return raw_data;
 }
@@ -205,7 +207,7 @@ uint16_t auto_read_adc20_data(int spi_fd, int average) {
     rd_data.len = sizeof(data_buf);
 
     // execute the transfer
-    if (ioctl(spi_fd, SPI_IOC_MESSAGE(1), &rd_data) < 0) {
+    if (metrics_spi_message(METRICS_SPI_ADC20, spi_fd, 1, &rd_data) < 0) {
         printf("Reading data from ADC failed. %s\n", strerror(errno));
         exit(EXIT_FAILURE);
     }
@@ -217,7 +219,7 @@ uint16_t auto_read_adc20_data(int spi_fd, int average) {
        raw_data = ((uint16_t)data_buf[0] << 8) | data_buf[1];
         ch_id = data_buf[2] >> 4;
     }
-    printf("Raw data read from channel %d of ADC 0x%04X\n",ch_id, raw_data);
+    TRACE_HOT("Raw data read from channel %d of ADC 0x%04X", ch_id, raw_data);
 
     return raw_data;
 }
@@ -236,3 +238,157 @@ void sample_sequence_mode_adc20(int spi_fd, int size, int *ptr) {
     write_register(spi_fd, ADC20_REG_SEQUENCE_CFG, ADC20_STOP_SEQUENCE_MODE);
 
 }
+
+/*
+ * Streaming-mode: reads the frames of the auto-sequence with one SPI_IOC_MESSAGE for up to
+ * ADC20_STREAM_MAX_XFERS frames (instead of one ioctl per frame) and decodes raw-value and
+ * appended channel-id of the whole batch at once.
+ *
+ * Each frame is its own spi_ioc_transfer with cs_change set, because the ADC starts the next
+ * conversion on the rising edge of CS. The frames can also be read from a captured frame-file
+ * (replay) instead of spidev, so the stream can be tested without the Click Board.
+ */
+
+static int adc20_stream_transfer(Adc20Stream* stream, int no_frames) {
+    size_t len = (size_t)no_frames * ADC20_FRAME_SIZE;
+
+    if (stream->replay_fd >= 0) {
+        // replay: read frames from capture-file, restart at the end of the file
+        size_t n = 0;
+        bool rewound = false;
+        while (n < len) {
+            ssize_t ret = read(stream->replay_fd, stream->rx_buf + n, len - n);
+            if (ret < 0) {
+                printf("Reading ADC20 replay-file failed: %s\n", strerror(errno));
+                return -1;
+            }
+            if (ret == 0) {
+                if (rewound || lseek(stream->replay_fd, 0, SEEK_SET) < 0) {
+                    printf("ADC20 replay-file is empty\n");
+                    return -1;
+                }
+                rewound = true;
+                continue;
+            }
+            rewound = false;
+            n += (size_t)ret;
+        }
+    } else if (metrics_spi_message(METRICS_SPI_ADC20, stream->spi_fd, no_frames, stream->xfers) < 0) {
+        printf("Reading ADC20 frames failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (stream->capture_fd >= 0 && write(stream->capture_fd, stream->rx_buf, len) != (ssize_t)len) {
+        printf("Writing ADC20 capture-file failed, capture stopped\n");
+        close(stream->capture_fd);
+        stream->capture_fd = -1;
+    }
+    return 0;
+}
+
+int adc20_decode_frames(const uint8_t* frames, int no_frames, int average, uint16_t* raw, uint8_t* ch_id) {
+    // decode frames in output-format with appended channel-id, returns the no. of frames
+    if (!average) {
+        // 12-bit data followed by 4-bit channel-id
+        for (int i = 0; i < no_frames; i++, frames += ADC20_FRAME_SIZE) {
+            raw[i] = ((uint16_t)frames[0] << 4) | (frames[1] >> 4);
+            ch_id[i] = frames[1] & 0x0F;
+        }
+    } else {
+        // 16-bit averaged data, channel-id in upper nibble of third byte
+        for (int i = 0; i < no_frames; i++, frames += ADC20_FRAME_SIZE) {
+            raw[i] = ((uint16_t)frames[0] << 8) | frames[1];
+            ch_id[i] = frames[2] >> 4;
+        }
+    }
+    return no_frames;
+}
+
+int adc20_stream_init(Adc20Stream* stream, int spi_fd, int stop_ch, int average, const char* replay_path, const char* capture_path) {
+    memset(stream, 0, sizeof(Adc20Stream));
+    stream->spi_fd = spi_fd;
+    stream->replay_fd = -1;
+    stream->capture_fd = -1;
+    stream->stop_ch = (uint8_t)stop_ch;
+    stream->average = average;
+
+    if (stop_ch < 0 || stop_ch > 7) {
+        printf("**Invalid channel number: %d**\n", stop_ch);
+        return -1;
+    }
+
+    // one transfer per frame, all transfers of a batch share one rx-buffer
+    for (int i = 0; i < ADC20_STREAM_MAX_XFERS; i++) {
+        stream->xfers[i].rx_buf = (unsigned long)(stream->rx_buf + i * ADC20_FRAME_SIZE);
+        stream->xfers[i].len = ADC20_FRAME_SIZE;
+        stream->xfers[i].cs_change = 1;
+    }
+
+    if (replay_path != NULL) {
+        stream->replay_fd = open(replay_path, O_RDONLY);
+        if (stream->replay_fd < 0) {
+            printf("Opening ADC20 replay-file %s failed: %s\n", replay_path, strerror(errno));
+            return -1;
+        }
+        printf("ADC20-Stream replays frames from %s\n", replay_path);
+    } else {
+        if (spi_fd < 0) {
+            printf("SPI interface is not configured (SPI_CONFIG_ID)\n");
+            return -1;
+        }
+        // auto-sequence over channel 0..stop_ch with appended channel-id
+        write_register(spi_fd, ADC20_REG_DATA_CFG, ADC20_CH_ID_APPEND);
+        write_register(spi_fd, ADC20_REG_OSR_CFG, (uint8_t)average);
+        write_register(spi_fd, ADC20_REG_AUTO_SEQ_CH_SEL, (uint8_t)((1 << (stop_ch + 1)) - 1));
+        write_register(spi_fd, ADC20_REG_SEQUENCE_CFG, ADC20_SEQUENCE_MODE);
+        // first frame holds no valid conversion
+        if (adc20_stream_transfer(stream, 1) < 0) return -1;
+    }
+
+    if (capture_path != NULL) {
+        stream->capture_fd = open(capture_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (stream->capture_fd < 0) {
+            printf("Opening ADC20 capture-file %s failed: %s\n", capture_path, strerror(errno));
+        }
+    }
+    return 0;
+}
+
+int adc20_stream_read(Adc20Stream* stream, uint16_t* raw, uint8_t* ch_id, int no_frames) {
+    // read no_frames frames in batches of ADC20_STREAM_MAX_XFERS, returns -1 on error
+    int no_read = 0;
+
+    while (no_read < no_frames) {
+        int batch = no_frames - no_read;
+        if (batch > ADC20_STREAM_MAX_XFERS) batch = ADC20_STREAM_MAX_XFERS;
+
+        // last transfer of the message releases CS anyway
+        stream->xfers[batch - 1].cs_change = 0;
+        int ret = adc20_stream_transfer(stream, batch);
+        stream->xfers[batch - 1].cs_change = 1;
+        if (ret < 0) return -1;
+
+        adc20_decode_frames(stream->rx_buf, batch, stream->average, raw + no_read, ch_id + no_read);
+
+        // the channel-ids have to follow the sequence 0..stop_ch, a gap means lost/corrupt frames
+        for (int i = no_read; i < no_read + batch; i++) {
+            if (ch_id[i] != stream->next_ch) stream->ch_errors++;
+            stream->next_ch = (ch_id[i] >= stream->stop_ch) ? 0 : ch_id[i] + 1;
+        }
+        no_read += batch;
+    }
+    return no_read;
+}
+
+void adc20_stream_close(Adc20Stream* stream) {
+    if (stream->replay_fd >= 0) {
+        close(stream->replay_fd);
+        stream->replay_fd = -1;
+    } else if (stream->spi_fd >= 0) {
+        write_register(stream->spi_fd, ADC20_REG_SEQUENCE_CFG, ADC20_STOP_SEQUENCE_MODE);
+    }
+    if (stream->capture_fd >= 0) {
+        close(stream->capture_fd);
+        stream->capture_fd = -1;
+    }
+}
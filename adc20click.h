@@ -1,7 +1,9 @@
 #ifndef ADC20CLICK_H
 #define ADC20CLICK_H
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <linux/spi/spidev.h>
 
 // command to write register
 #define ADC20_CMD_REG_WRITE  0x08
@@ -55,6 +57,36 @@
 // config to stop sequence mode
 #define ADC20_STOP_SEQUENCE_MODE            0x00
 
+// size of one data-frame in auto-sequence mode (data + appended channel-id)
+#define ADC20_FRAME_SIZE                    3
+
+// max. no. of frames read with one SPI_IOC_MESSAGE: the ioctl-size field limits the message
+// to 511 transfers and spidev limits the bytes of one message to bufsiz (default 4096)
+#define ADC20_STREAM_MAX_XFERS              256
+
+// frames per tcp-package in streaming-mode
+#define ADC20_STREAM_FRAMES_PER_PKG         4096
+
+// env.-variables to replay a captured frame-file instead of using spidev / to capture frames
+#define ADC20_REPLAY_ENV                    "ADC20_REPLAY_FILE"
+#define ADC20_CAPTURE_ENV                   "ADC20_CAPTURE_FILE"
+
+// state of streaming-mode (auto-sequence with batched SPI-transfers)
+typedef struct {
+    int spi_fd;
+    int replay_fd;       // >= 0: frames are read from captured frame-file instead of spidev
+    int capture_fd;      // >= 0: all frames read are written to this file
+    int average;         // oversampling ratio (0 = 12-bit data, else 16-bit data)
+    uint8_t stop_ch;     // sequence runs from channel 0 to stop_ch
+    uint8_t next_ch;     // expected channel-id of the next frame
+    uint32_t ch_errors;  // frames with unexpected channel-id (lost or corrupt frames)
+    struct spi_ioc_transfer xfers[ADC20_STREAM_MAX_XFERS];
+    uint8_t rx_buf[ADC20_STREAM_MAX_XFERS * ADC20_FRAME_SIZE];
+} Adc20Stream;
+
+// oversampling ratio configured by init_adc20()
+extern int AVERAGE;
+
 void write_register(int spi_fd, uint8_t regAddr, uint8_t regCfg);
 void read_register (int spi_fd, uint8_t regAddr);
 void init_adc20(int spi_fd);
@@ -64,4 +96,9 @@ int get_voltage_adc20(int spi_fd, int ch, int average);
 int *sample_sequence_mode_adc20(int spi_fd, int stop_ch, int average, int size, bool verbose);
 void adc20_debug_communication(int spi_fd);
 
+int adc20_decode_frames(const uint8_t* frames, int no_frames, int average, uint16_t* raw, uint8_t* ch_id);
+int adc20_stream_init(Adc20Stream* stream, int spi_fd, int stop_ch, int average, const char* replay_path, const char* capture_path);
+int adc20_stream_read(Adc20Stream* stream, uint16_t* raw, uint8_t* ch_id, int no_frames);
+void adc20_stream_close(Adc20Stream* stream);
+
 #endif
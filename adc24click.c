@@ -7,6 +7,8 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include "adc24click.h"
+#include "rp_metrics.h"
+#include "rp_trace.h"
 #include <errno.h>
 #include <unistd.h>
 
@@ -24,10 +26,10 @@ void config_adc24_ctrl_reg(int spi_fd, uint16_t regCfg) {
     spi_transfer.rx_buf = (unsigned long)&dummy_read;
     spi_transfer.len = sizeof(data_to_send);
 
-    printf("Control register configuration 0x%04X\n", data_to_send);
+    TRACE_HOT("Control register configuration 0x%04X", data_to_send);
 
     //send SPI message
-    if (ioctl(spi_fd, SPI_IOC_MESSAGE(1), &spi_transfer) < 0) {
+    if (metrics_spi_message(METRICS_SPI_ADC24, spi_fd, 1, &spi_transfer) < 0) {
         printf("**Failed to configure control register on ADC24 Click**. %s\n.", strerror(errno));
         exit(EXIT_FAILURE);
     }
@@ -78,7 +80,7 @@ int get_voltage_adc24(int spi_fd, int ch) {
 
     uint8_t dummy[2] = {0};
 
-
+    uint64_t t_start = metrics_now_ns();
     if (write(spi_fd, tx_buf, sizeof(tx_buf)) < 2) {
         printf("Configuring control register failed. %s\n", strerror(errno));
       }
@@ -92,17 +94,18 @@ int get_voltage_adc24(int spi_fd, int ch) {
     if (read(spi_fd, &raw_data, sizeof(raw_data)) < 2) {
         printf("Reading data from channel failed. %s\n", strerror(errno));
       }
+    metrics_spi_observe(METRICS_SPI_ADC24, t_start, 2);
 
 
     raw_value = ((uint16_t)raw_data[0]) << 8 | raw_data[1];
-    printf("Data read back 0x%04X\n", raw_value);
+    TRACE_HOT("Data read back 0x%04X", raw_value);
 
     ch_id = (raw_value & 0xF000) >> 12; // extract channel identifier bits
     raw_value = raw_value & 0x0FFF;
 
     voltage_mV = convert_adc24raw16_to_mV(raw_value);
 
-    printf("Voltage measured on channel %d is %d mV\n", ch_id, voltage_mV);
+    TRACE_HOT("Voltage measured on channel %d is %d mV", ch_id, voltage_mV);
     return voltage_mV;
 }
 
@@ -0,0 +1,316 @@
+"""
+benchmark.py
+
+Benchmark-Harness around RedPitayaBoard, measures the same as the C-Load-Generator
+(rp_bench_client.c) but through the python-client:
+
+        - cmd:          round-trip latency of commands which answer with one int
+        - config:       sendConfigParams() with AdcConfig (NEW_CONFIG ... CONFIG_DONE)
+        - adc_stream:   start_adc_sampling() in continous- and block-mode,
+                        sustained MB/s and inter-arrival time of the tcp-packages
+        - adc_stream_rx: continous-mode with the background-receiver (stream_adc()),
+                        numpy-ring instead of one bytes-object per package
+        - lut_upload:   upload of the LUT of a DAC-BRAM-Controller-Port, binary over the
+                        command-socket (the codes read back from the BRAM are uploaded again),
+                        as voltages converted on RedPitaya (upload_lut_voltages(), mode 2)
+                        and optional scp + .csv-parsing (send_lut_file() + BramDacConfig),
+                        with a 16384-step BramDacConfig on the port these are the 16k-step numbers
+
+results (p50/p99/mean/max in us, rates) are returned as dict and can be written as JSON,
+one entry per command-id and adc-mode, so runs can be compared between builds:
+
+        python -m rp.benchmark --ip 10.42.0.2 -o results.json
+"""
+
+import argparse
+import json
+import time
+from ctypes import sizeof
+
+import numpy as np
+
+from rp.core import RedPitayaBoard
+from rp.constants import (
+    ADC_CONFIG_ID,
+    DAC_BRAM_CONFIG_ID,
+    LUT_CONFIG_ID,
+    LUT_BIN_VERSION,
+    LUT_BIN_VERSION_VOLTAGE,
+    ADC_CONTINOUS_MODE,
+    ADC_BLOCK_MODE,
+    RAM_INIT_CONFIG_ID,
+    GET_DAC_BRAM_SAMPLE_CNT,
+    GET_DAC_BRAM_SIGNAL_CNT,
+    GET_LATEST_ADC24,
+    START_ADC_SAMPLING,
+)
+from rp.structs import AdcConfig, RamInitConfig, TcpCommand
+
+DEFAULT_ITERATIONS = 1000
+DEFAULT_PACKAGES = 200
+DEFAULT_PKG_SIZE = 16384  # samples per tcp-package
+DEFAULT_RAM_SIZE = 0x100000  # samples in RAM-Writer-buffer
+DEFAULT_STS_WIDTH_MASK = 0xFFFFF
+DEFAULT_SAMPLE_RATE_DIVIDER = 8  # 15.625 MS/s
+DEFAULT_LUT_ITERATIONS = 20
+
+# commands which only read registers and answer with one int
+DEFAULT_CMDS = [
+    (GET_DAC_BRAM_SAMPLE_CNT, 0, 0),
+    (GET_DAC_BRAM_SIGNAL_CNT, 0, 0),
+    (GET_LATEST_ADC24, 0, 0),
+]
+
+
+def _result(bench: str, cmd_id: int, mode: int, samples_us, duration_s: float, nbytes: float, **extra):
+    samples_us = np.asarray(samples_us, dtype=np.float64)
+    n = len(samples_us)
+    result = {
+        "bench": bench,
+        "id": cmd_id,
+        "mode": mode,
+        "n": n,
+        "p50_us": float(np.percentile(samples_us, 50)) if n else 0.0,
+        "p99_us": float(np.percentile(samples_us, 99)) if n else 0.0,
+        "mean_us": float(samples_us.mean()) if n else 0.0,
+        "max_us": float(samples_us.max()) if n else 0.0,
+        "rate_per_s": n / duration_s if duration_s > 0 else 0.0,
+        "mbytes_per_s": nbytes / 1e6 / duration_s if duration_s > 0 else 0.0,
+    }
+    result.update(extra)
+    return result
+
+
+def bench_commands(rp: RedPitayaBoard, cmds=DEFAULT_CMDS, iterations: int = DEFAULT_ITERATIONS):
+    """
+    round-trip latency of commands (cmd_id, channel, value) which answer with one int
+    """
+    results = []
+    for cmd_id, ch, val in cmds:
+        samples = np.empty(iterations)
+        t_start = time.perf_counter()
+        for i in range(iterations):
+            t0 = time.perf_counter()
+            rp.sendCommand(cmd_id, value=val, channel=ch)
+            rp.rp_tcp.receive_int()
+            samples[i] = (time.perf_counter() - t0) * 1e6
+        duration_s = time.perf_counter() - t_start
+        results.append(_result("cmd", cmd_id, -1, samples, duration_s, iterations * (sizeof(TcpCommand) + 4)))
+    return results
+
+
+def _adc_config(adc_mode: int) -> AdcConfig:
+    cfg = AdcConfig()
+    cfg.sample_rate_divider = DEFAULT_SAMPLE_RATE_DIVIDER
+    cfg.adc_mode = adc_mode
+    return cfg
+
+
+def bench_config(rp: RedPitayaBoard, iterations: int = DEFAULT_ITERATIONS):
+    """
+    latency of sendConfigParams() with AdcConfig (receive_struct on RedPitaya)
+    """
+    cfg = _adc_config(ADC_CONTINOUS_MODE)
+    samples = np.empty(iterations)
+    t_start = time.perf_counter()
+    for i in range(iterations):
+        t0 = time.perf_counter()
+        rp.sendConfigParams(cfg, ADC_CONFIG_ID)
+        samples[i] = (time.perf_counter() - t0) * 1e6
+    duration_s = time.perf_counter() - t_start
+    return [_result("config", ADC_CONFIG_ID, -1, samples, duration_s, iterations * sizeof(cfg))]
+
+
+def bench_adc_stream(
+    rp: RedPitayaBoard,
+    adc_mode: int,
+    no_packages: int = DEFAULT_PACKAGES,
+    pkg_size: int = DEFAULT_PKG_SIZE,
+):
+    """
+    sustained rate of the ADC-Stream, samples are the inter-arrival times of the packages
+    (the first one includes the start-latency of the stream)
+    """
+    ram_cfg = RamInitConfig(
+        DEFAULT_STS_WIDTH_MASK, pkg_size, pkg_size * 4, DEFAULT_RAM_SIZE, DEFAULT_RAM_SIZE * 4
+    )
+    rp.sendConfigParams(ram_cfg, RAM_INIT_CONFIG_ID)
+    rp.sendConfigParams(_adc_config(adc_mode), ADC_CONFIG_ID)
+    rp.start_adc_sampling(no_packages)
+
+    pkg_sizes = [pkg_size * 4] * no_packages
+    if adc_mode == ADC_BLOCK_MODE:
+        # one block of the RAM-size (no_packages is ignored by RedPitaya), the last package may be shorter
+        ram_size_bytes = ram_cfg.ram_size_bytes
+        pkg_sizes = [min(pkg_size * 4, ram_size_bytes - i) for i in range(0, ram_size_bytes, pkg_size * 4)]
+
+    samples = np.empty(len(pkg_sizes))
+    nbytes = 0
+    t_start = t_last = time.perf_counter()
+    for i, pkg_size_bytes in enumerate(pkg_sizes):
+        nbytes += len(rp.receive_adc_data_package(pkg_size_bytes))
+        t = time.perf_counter()
+        samples[i] = (t - t_last) * 1e6
+        t_last = t
+    duration_s = t_last - t_start
+
+    extra = {"overruns": rp.adc_stream_overruns} if adc_mode == ADC_CONTINOUS_MODE else {}
+    return [_result("adc_stream", START_ADC_SAMPLING, adc_mode, samples, duration_s, nbytes, **extra)]
+
+
+def bench_adc_stream_rx(rp: RedPitayaBoard, no_packages: int = DEFAULT_PACKAGES, pkg_size: int = DEFAULT_PKG_SIZE):
+    """
+    continous-mode through AdcStreamReceiver, samples are the inter-arrival times of the packages
+    at the consumer (one np.sum per package, so the data is touched once)
+    """
+    ram_cfg = RamInitConfig(
+        DEFAULT_STS_WIDTH_MASK, pkg_size, pkg_size * 4, DEFAULT_RAM_SIZE, DEFAULT_RAM_SIZE * 4
+    )
+    rp.sendConfigParams(ram_cfg, RAM_INIT_CONFIG_ID)
+    rp.sendConfigParams(_adc_config(ADC_CONTINOUS_MODE), ADC_CONFIG_ID)
+
+    receiver = rp.stream_adc(no_packages, pkg_size)
+    samples = []
+    t_start = t_last = time.perf_counter()
+    for _, data in receiver:
+        np.sum(data, dtype=np.uint64)
+        t = time.perf_counter()
+        samples.append((t - t_last) * 1e6)
+        t_last = t
+    duration_s = t_last - t_start
+    return [
+        _result(
+            "adc_stream_rx", START_ADC_SAMPLING, ADC_CONTINOUS_MODE, samples, duration_s,
+            receiver.bytes_received, **receiver.stats()
+        )
+    ]
+
+
+def bench_lut_upload(
+    rp: RedPitayaBoard, bram_port: int, iterations: int = DEFAULT_LUT_ITERATIONS, lut=None, bram_cfg=None, voltages=None
+):
+    """
+    upload-time of the LUT of bram_port: binary (upload_lut_binary() of the codes read back from
+    the BRAM, so the DAC-output doesn't change), as voltages (upload_lut_voltages(), default 0 V
+    at every step, conversion on RedPitaya) and, if lut (rp.tuning.lut.LUT) and the BramDacConfig
+    of the port are given, the old path with scp + .csv-parsing on RedPitaya.
+    The codes read at the start are uploaded again at the end.
+    """
+    header, codes = rp.receive_lut_binary(bram_port)
+    if voltages is None:
+        voltages = np.zeros(len(codes), dtype=np.float32)
+    results = []
+
+    if lut is not None and bram_cfg is not None:
+        samples = np.empty(iterations)
+        t_start = time.perf_counter()
+        for i in range(iterations):
+            t0 = time.perf_counter()
+            rp.send_lut_file(lut)
+            rp.sendConfigParams(bram_cfg, DAC_BRAM_CONFIG_ID)
+            samples[i] = (time.perf_counter() - t0) * 1e6
+        duration_s = time.perf_counter() - t_start
+        results.append(
+            _result("lut_upload", DAC_BRAM_CONFIG_ID, -1, samples, duration_s, 0, no_steps=bram_cfg.no_steps)
+        )
+
+    samples = np.empty(iterations)
+    t_start = time.perf_counter()
+    for i in range(iterations):
+        samples[i] = rp.upload_lut_voltages(bram_port, header.dac_port_id, voltages) * 1e6
+    duration_s = time.perf_counter() - t_start
+    results.append(
+        _result(
+            "lut_upload", LUT_CONFIG_ID, LUT_BIN_VERSION_VOLTAGE, samples, duration_s, iterations * len(voltages) * 4,
+            no_steps=len(voltages),
+        )
+    )
+
+    samples = np.empty(iterations)
+    t_start = time.perf_counter()
+    for i in range(iterations):
+        samples[i] = rp.upload_lut_binary(bram_port, header.dac_port_id, codes) * 1e6
+    duration_s = time.perf_counter() - t_start
+    results.append(
+        _result(
+            "lut_upload", LUT_CONFIG_ID, LUT_BIN_VERSION, samples, duration_s, iterations * len(codes) * 4,
+            no_steps=len(codes),
+        )
+    )
+
+    if bram_cfg is not None:
+        # the last binary upload restored the LUT read at the start, the config makes it active again
+        rp.sendConfigParams(bram_cfg, DAC_BRAM_CONFIG_ID)
+    return results
+
+
+def run_benchmarks(
+    rp: RedPitayaBoard,
+    cmds=DEFAULT_CMDS,
+    iterations: int = DEFAULT_ITERATIONS,
+    no_packages: int = DEFAULT_PACKAGES,
+    pkg_size: int = DEFAULT_PKG_SIZE,
+    adc_modes=(ADC_CONTINOUS_MODE, ADC_BLOCK_MODE),
+    lut_port: int = None,
+) -> dict:
+    """
+    run all benchmarks, returns the same JSON-layout as the C-Load-Generator
+    """
+    results = bench_commands(rp, cmds, iterations)
+    results += bench_config(rp, iterations)
+    for mode in adc_modes:
+        results += bench_adc_stream(rp, mode, no_packages, pkg_size)
+    if ADC_CONTINOUS_MODE in adc_modes:
+        results += bench_adc_stream_rx(rp, no_packages, pkg_size)
+    if lut_port is not None:
+        results += bench_lut_upload(rp, lut_port)
+    return {
+        "host": rp.ip,
+        "port": rp.port,
+        "iterations": iterations,
+        "no_packages": no_packages,
+        "pkg_size": pkg_size,
+        "client": "python",
+        "results": results,
+    }
+
+
+def _parse_cmd(arg: str):
+    # id[:ch[:val]]
+    parts = arg.split(":")
+    return (int(parts[0], 0), int(parts[1], 0) if len(parts) > 1 else 0, float(parts[2]) if len(parts) > 2 else 0)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Benchmark of the RedPitaya App-Server")
+    parser.add_argument("--ip", default="")
+    parser.add_argument("--port", type=int, default=1002)
+    parser.add_argument("-n", "--iterations", type=int, default=DEFAULT_ITERATIONS)
+    parser.add_argument("-c", "--cmd", action="append", type=_parse_cmd, help="id[:ch[:val]]")
+    parser.add_argument("-s", "--packages", type=int, default=DEFAULT_PACKAGES)
+    parser.add_argument("-k", "--pkg-size", type=int, default=DEFAULT_PKG_SIZE)
+    parser.add_argument("-m", "--modes", choices=["cont", "block", "both", "none"], default="both")
+    parser.add_argument("-l", "--lut-port", type=int, default=None, help="benchmark LUT-upload (codes and voltages) of port")
+    parser.add_argument("-o", "--output", default=None)
+    args = parser.parse_args()
+
+    modes = {
+        "cont": (ADC_CONTINOUS_MODE,),
+        "block": (ADC_BLOCK_MODE,),
+        "both": (ADC_CONTINOUS_MODE, ADC_BLOCK_MODE),
+        "none": (),
+    }[args.modes]
+
+    rp = RedPitayaBoard(ip=args.ip, port=args.port)
+    try:
+        report = run_benchmarks(
+            rp, args.cmd or DEFAULT_CMDS, args.iterations, args.packages, args.pkg_size, modes, args.lut_port
+        )
+    finally:
+        rp.close()
+
+    if args.output is None:
+        print(json.dumps(report, indent=4))
+    else:
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=4)
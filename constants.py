@@ -30,6 +30,86 @@ HOSTNAME_RPID = {
 ADC_CONTINOUS_MODE = 0
 ADC_BLOCK_MODE = 1
 ADC_LIA_MODE = 2
+ADC_MULTI_BLOCK_MODE = 3  # back-to-back blocks, RAM-Writer runs through N regions of the buffer
+
+# magic-value of AdcStreamHeader in front of each tcp-package in continous-mode ("RPAD")
+ADC_STREAM_MAGIC = 0x44415052
+# continous-mode with lossless compression (start_adc_sampling(compressed=True)),
+# every tcp-package starts with an AdcStreamZHeader ("RPSZ")
+ADC_STREAM_RAW = 0
+ADC_STREAM_COMPRESSED = 1
+ADC_STREAM_Z_MAGIC = 0x5A535052
+ADC_CODEC_DELTA_BITPLANE = 1  # delta + zigzag + bit-planes per 16 samples
+ADC_CODEC_BLOCK = 16
+# software-LIA in ADC_LIA_MODE, every tcp-package starts with a LiaStreamHeader ("RPLI")
+LIA_STREAM_MAGIC = 0x494C5052
+LIA_OUT_IQ = 0  # int32 I, Q per point
+LIA_OUT_MAG_PHASE = 1  # float32 magnitude, phase (rad) per point
+LIA_SW_MAX_SOS = 6
+LIA_SW_COEFF_FRAC_BITS = 30  # IIR-coefficients as signed Q2.30
+LIA_CHECK_MAGIC = 0x4B4C5052  # "RPLK", LiaCheckHeader of LIA_SW_CHECK
+# magic-value of AdcStreamHeader in front of each tcp-package of the ADC20-Stream ("RD20")
+ADC20_STREAM_MAGIC = 0x30324452
+# magic-value of AdcBlockHeader in front of each block in multi-block-mode ("RPBK")
+ADC_BLOCK_MAGIC = 0x4B425052
+# status-word after each block (and each package in continous-mode), it belongs to the package
+# sent ADC_STREAM_STATUS_LAG packages before, ADC_STREAM_STATUS_LAG more words follow the last package
+ADC_BLOCK_OK = 0
+ADC_BLOCK_TORN = 1  # RAM-Writer reached the region again while it was sent (or package lost)
+ADC_STREAM_STATUS_LAG = 4
+
+# batched command-frames: many commands in one tcp-message, one response-frame back ("RPBF")
+BATCH_FRAME_MAGIC = 0x46425052
+BATCH_PROTOCOL_VERSION = 1
+MAX_BATCH_CMDS = 256  # max. no. of commands in one frame (larger batches are split)
+
+# status of each command in the response-frame
+BATCH_STATUS_OK = 0
+BATCH_STATUS_NOT_ALLOWED = -1  # command needs more data/answers than one value (configs, sampling..)
+BATCH_STATUS_BAD_VERSION = -2
+BATCH_STATUS_SKIPPED = -3  # earlier command of the frame closed the connection
+
+# command-sequences: program with commands, waits and loops executed on RedPitaya ("RPSQ"/"RPSR")
+START_SEQUENCE = 59
+SEQ_PROGRAM_MAGIC = 0x51535052
+SEQ_RESULT_MAGIC = 0x52535052
+SEQ_PROTOCOL_VERSION = 1
+SEQ_MAX_OPS = 1024
+SEQ_MAX_RESULTS = 65536
+SEQ_MAX_LOOP_DEPTH = 8
+SEQ_OP_CMD = 0  # execute command like inside a batch
+SEQ_OP_WAIT_UNTIL = 1  # wait till val us after the start of the program
+SEQ_OP_DELAY = 2  # wait till val us after the previous deadline
+SEQ_OP_LOOP = 3
+SEQ_OP_END_LOOP = 4
+SEQ_FLAG_CAPTURE = 0x1  # reply of the command is returned in the result
+SEQ_STATUS_OK = 0
+SEQ_STATUS_RESULTS_FULL = 1
+SEQ_STATUS_STOPPED = 2  # a command closed the connection
+SEQ_STATUS_STEP_LIMIT = 3
+
+# Local recording of the continous ADC-stream into an indexed chunk-file on RedPitaya
+START_RECORD = 94  # RecConfig follows, reply: no. of chunks written or SERVER_ERROR_ID
+GET_RECORD_INFO = 95  # ch: rec_id, reply: ACK + RecFileHeader + RecChunkInfo[no_chunks]
+GET_RECORD_RANGE = 96  # RecRangeRequest follows, reply: RecRangeHeader + samples
+REC_STORAGE_SD = 0  # rec/ on the SD-card
+REC_STORAGE_TMPFS = 1  # /dev/shm/ (RAM, lost on reboot)
+REC_FILE_MAGIC = 0x43455250
+REC_RANGE_MAGIC = 0x47525052
+REC_CHUNK_SAMPLES = (1024 * 1024 - 64) // 4  # samples per chunk
+REC_MAX_RANGE_SAMPLES = 16 * 1024 * 1024  # max. samples of one GET_RECORD_RANGE
+
+# Runtime-metrics of the server (GET_STATS, Prometheus-Exporter on METRICS_PORT)
+GET_STATS = 97  # ch: STATS_RESET, reply: ACK + StatsSnapshotHeader + StatsCmdEntry[no_cmds]
+STATS_RESET = 1  # clear the metrics after the snapshot
+STATS_MAGIC = 0x54535052
+STATS_VERSION = 1
+METRICS_PORT = 9102
+METRICS_HIST_BUCKETS = 24  # bucket i: durations < 2^(i + METRICS_HIST_SHIFT) ns, last bucket: rest
+METRICS_HIST_SHIFT = 10
+METRICS_CMD_OTHER = -1  # command-IDs >= 256
+METRICS_STREAMS = ("cont", "block", "multi_block", "lia", "record")
+METRICS_SPI_BOARDS = ("adc20", "adc24")
 
 # Config for DAC-Modules (Stream: LUT-operation, Single: static output of voltages via TCP)
 DAC_MODE_SINGLE = 0  # (ASYNC update for AD-DAC)
@@ -111,8 +191,20 @@ GET_VOLTAGE_ADC24 = 45
 START_SEQ_SAMPLING_ADC24 = 46
 # command to close the SPI interface
 CLOSE_SPI = 47
+# start streaming raw frames of ADC20 Click in sequence mode
+START_STREAM_ADC20 = 48
 # get adc cnt (ditial value) from rf adc
 GET_RF_ADC_CNT = 50
+# coherent averaging of DAC-BRAM-sweeps on RedPitaya (channel: no. of LUT-steps, value: no. of sweeps)
+START_SWEEP_AVG = 55
+# magic-value of SweepAvgHeader ("RPSA")
+SWEEP_AVG_MAGIC = 0x41535052
+
+# background-scanner for ADC24 Click
+START_ADC24_SCAN = 51  # sweep channel 0..ch with val sweeps/s
+STOP_ADC24_SCAN = 52
+GET_LATEST_ADC24 = 53  # latest voltage [mV] of one channel
+GET_WINDOW_ADC24 = 54  # all samples of the last val ms
 # 4 user leds (right side, closest to ethernet port)
 SET_LED = 60
 
@@ -128,17 +220,52 @@ ADJ_LUT_VALUE = 74  # adjust LUT-Value inside BRAM on RedPitaya
 REARM_TRIGGER = 75  # rearm current trigger
 HOLD_TRIGGER = 81  # hold current trigger high
 RELEASE_TRIGGER = 82
+# latency trigger-armed -> REQ_WLENGTH sent on RedPitaya (channel: TRIGGER_STAT_*)
+GET_TRIGGER_LATENCY = 57
+TRIGGER_STAT_LAST_US = 0
+TRIGGER_STAT_MEAN_US = 1
+TRIGGER_STAT_MAX_US = 2
+TRIGGER_STAT_EVENTS = 3  # no. of REQ_WLENGTH sent
+TRIGGER_STAT_TIMEOUTS = 4  # no. of waits without trigger-armed event
+TRIGGER_STAT_RESET = 5
+# on-board LUT-calibration (LutCalibConfig + LutCalibPoint[no_triggers]), result with magic "RPLC"
+START_LUT_CALIB = 58
+LUT_CALIB_MAGIC = 0x434C5052
+LUT_CALIB_INPUT_ERROR = 0  # host sends the error (target - measured) per REQ_WLENGTH
+LUT_CALIB_INPUT_READING = 1  # host sends the measured value, error = target - reading
+LUT_CALIB_OK = 0
+LUT_CALIB_TIMEOUT = 1  # trigger not armed on RedPitaya
+LUT_CALIB_ABORTED = 2  # host sent NaN instead of a measurement
 
 # Command to send and apply a new config
 NEW_CONFIG = 76
 CONFIG_DONE = 78
-
-# store Current LUT from BRAM to .csv-file
+# NEW_CONFIG with channel CONFIG_REPORT_APPLIED: reply is CONFIG_DONE | applied << 8 | writes << 16
+# (applied: CONFIG_APPLIED_* for ADC/DAC/DAC-BRAM/Trigger-Configs, writes: cached register-writes)
+CONFIG_REPORT_APPLIED = 1
+CONFIG_APPLIED_NONE = 0x0  # same as the active config, nothing written
+CONFIG_APPLIED_REGS = 0x1  # module was configured
+CONFIG_APPLIED_LUT = 0x2  # LUT was loaded into the BRAM
+CONFIG_APPLIED_RAM_MODE = 0x4  # RAM-Writer-mode was set
+
+# store Current LUT from BRAM to .csv-file (value: LUT_STORE_CSV) or .bin-file (value: LUT_STORE_BIN)
 STORE_LUT = 77
+LUT_STORE_CSV = 0
+LUT_STORE_BIN = 1
+# send LUT of DAC-BRAM-Controller-Port (channel) in binary format (LutBinHeader + uint32 DAC-codes)
+GET_LUT_BIN = 56
+# binary LUT (upload with LUT_CONFIG_ID, GET_LUT_BIN, .bin-files), magic "RPLT"
+LUT_BIN_MAGIC = 0x544C5052
+LUT_BIN_VERSION = 1
+# upload only: float32 voltages instead of DAC-codes, converted on RedPitaya
+LUT_BIN_VERSION_VOLTAGE = 2
+LUT_BIN_MAX_STEPS = 16384
 
 # start sampling data with ADC
 START_ADC_SAMPLING = 80
 
+# header of BRAM-uploads (DUMMY_DATA_GEN_BRAM_ID/LIA_MIXER_BRAM_ID), magic "RPBU"
+BRAM_UPLOAD_MAGIC = 0x55425052
 # Command to receive BRAM values
 RECV_BRAM_DATA = 83
 RECV_BRAM_DATA_DONE = 84
@@ -152,6 +279,15 @@ EXIT_APP = 90
 # test SPI interface
 SPI_TEST = 91
 
+# switch verbose-mode (debug-traces) of the C-Application at runtime
+SET_VERBOSE = 93
+
+# benchmark of the conversion-kernels on RedPitaya
+CONVERT_BENCH = 92
+
+# check of the software-LIA (NEON- against scalar-version) on RedPitaya
+LIA_SW_CHECK = 98
+
 # run debug routine:
 DEBUG = 99
 
@@ -175,6 +311,8 @@ GET_DAC_BRAM_SIGNAL_CNT = 131
 
 # Acknowledge signal (used for all Comands where we need an ACK-Feedback (both ways))
 ACK = 1
+# reply of RedPitaya if a command failed
+SERVER_ERROR_ID = -1
 
 # Dummy-Data-Generator Modes
 DUMMY_COUNTER_MODE = 0
@@ -210,6 +348,7 @@ LIA_MIXER_CONFIG_ID = 8
 LIA_MIXER_BRAM_ID = 9
 LIA_IIR_CONFIG_ID = 10
 CLK_DIVIDER_CONFIG_ID = 11
+LIA_STREAM_CONFIG_ID = 12
 SPI_CONFIG_ID = 20
 READ_REG_ADC20 = 1000
 ADC20_DEBUG_CMD = 1001
@@ -12,17 +12,58 @@ getting called inside init before connection as tcp-client)
 
 """
 
-from ctypes import Structure
+from contextlib import contextmanager
+import socket
+from ctypes import Structure, c_float, c_uint32, sizeof
 import numpy as np
 import matplotlib.pyplot as plt
 import time
+import zlib
 from rp.calib_parameters import RP_GO_VALUES
 from rp.misc.helpers import print_rp_tag
 
 from rp.constants import (
+    ADC_CONFIG_ID,
+    ADC_CONTINOUS_MODE,
+    ADC_STREAM_MAGIC,
+    ADC20_STREAM_MAGIC,
+    ADC_STREAM_COMPRESSED,
+    ADC_STREAM_Z_MAGIC,
+    ADC_CODEC_DELTA_BITPLANE,
+    ADC_CODEC_BLOCK,
+    ADC_LIA_MODE,
+    LIA_STREAM_MAGIC,
+    LIA_STREAM_CONFIG_ID,
+    LIA_OUT_IQ,
+    LIA_OUT_MAG_PHASE,
+    LIA_SW_MAX_SOS,
+    LIA_SW_COEFF_FRAC_BITS,
+    LIA_CHECK_MAGIC,
+    ADC_BLOCK_MAGIC,
+    SWEEP_AVG_MAGIC,
+    START_SWEEP_AVG,
+    BATCH_FRAME_MAGIC,
+    BATCH_PROTOCOL_VERSION,
+    BATCH_STATUS_OK,
+    MAX_BATCH_CMDS,
+    START_SEQUENCE,
+    SEQ_PROGRAM_MAGIC,
+    SEQ_RESULT_MAGIC,
+    SEQ_PROTOCOL_VERSION,
+    SEQ_MAX_OPS,
+    SEQ_MAX_RESULTS,
+    SEQ_MAX_LOOP_DEPTH,
+    SEQ_OP_CMD,
+    SEQ_OP_WAIT_UNTIL,
+    SEQ_OP_DELAY,
+    SEQ_OP_LOOP,
+    SEQ_OP_END_LOOP,
+    SEQ_FLAG_CAPTURE,
     ADJ_LUT_VALUE,
     ALL_BRAM_DAC_PORTS,
     CONFIG_DONE,
+    CONFIG_REPORT_APPLIED,
+    CONFIG_APPLIED_NONE,
     EN_PDM,
     GET_DAC_BRAM_SAMPLE_CNT,
     GET_DAC_BRAM_SIGNAL_CNT,
@@ -36,6 +77,16 @@ from rp.constants import (
     RELEASE_TRIGGER,
     REARM_TRIGGER,
     REQ_WLENGTH,
+    GET_TRIGGER_LATENCY,
+    TRIGGER_STAT_LAST_US,
+    TRIGGER_STAT_MEAN_US,
+    TRIGGER_STAT_MAX_US,
+    TRIGGER_STAT_EVENTS,
+    TRIGGER_STAT_TIMEOUTS,
+    TRIGGER_STAT_RESET,
+    START_LUT_CALIB,
+    LUT_CALIB_MAGIC,
+    LUT_CALIB_OK,
     RP_SYS_CLK,
     SHIFT_ID,
     ACK,
@@ -50,6 +101,16 @@ from rp.constants import (
     START_DAC_SWEEP,
     STOP_DAC_SWEEP,
     STORE_LUT,
+    LUT_STORE_CSV,
+    LUT_STORE_BIN,
+    GET_LUT_BIN,
+    LUT_CONFIG_ID,
+    LUT_BIN_MAGIC,
+    LUT_BIN_VERSION,
+    LUT_BIN_VERSION_VOLTAGE,
+    LUT_BIN_MAX_STEPS,
+    BRAM_UPLOAD_MAGIC,
+    SERVER_ERROR_ID,
     START_TRIGGER_SWEEP,
     TERMINATE_CLIENT,
     DEBUG,
@@ -65,13 +126,34 @@ from rp.constants import (
     CLOSE_SPI,
     GET_VOLTAGE_ADC24,
     START_SEQ_SAMPLING_ADC24,
+    START_ADC24_SCAN,
+    STOP_ADC24_SCAN,
+    GET_LATEST_ADC24,
+    GET_WINDOW_ADC24,
     INIT_ADC24,
     INIT_ADC20,
     GET_VOLTAGE_ADC20,
     START_SEQ_SAMPLING_ADC20,
+    START_STREAM_ADC20,
     SPI_TEST,
+    CONVERT_BENCH,
+    LIA_SW_CHECK,
+    SET_VERBOSE,
     READ_REG_ADC20,
     ADC20_DEBUG_CMD,
+    START_RECORD,
+    GET_RECORD_INFO,
+    GET_RECORD_RANGE,
+    GET_STATS,
+    STATS_RESET,
+    STATS_MAGIC,
+    METRICS_HIST_SHIFT,
+    METRICS_STREAMS,
+    METRICS_SPI_BOARDS,
+    REC_STORAGE_SD,
+    REC_FILE_MAGIC,
+    REC_RANGE_MAGIC,
+    REC_MAX_RANGE_SAMPLES,
 )
 
 from rp.misc.helpers import scanPortForDevice
@@ -79,9 +161,314 @@ from rp.structs import LutValue
 from rp.misc import tcp_client as tcp
 from rp.misc import scp_server as scp
 from rp.adc.helpers import unpackADCData, fix_sign
+from rp.receiver import AdcStreamReceiver, PackageStatusQueue, recv_into_exactly, DEFAULT_RING_SLOTS
 from rp.devices import howland_bridge as hw
 from rp.tuning.lut import LUT
-from rp.structs import TcpCommand
+from rp.structs import (
+    TcpCommand,
+    AdcStreamHeader,
+    AdcStreamZHeader,
+    AdcBlockHeader,
+    SweepAvgHeader,
+    LutBinHeader,
+    BramUploadHeader,
+    LutCalibConfig,
+    LutCalibPoint,
+    LutCalibResultHeader,
+    LutCalibResult,
+    Adc24Sample,
+    Adc24WindowHeader,
+    BatchFrameHeader,
+    BatchCmd,
+    BatchResp,
+    SeqProgramHeader,
+    SeqOp,
+    SeqResultHeader,
+    SeqResult,
+    RecConfig,
+    RecFileHeader,
+    RecChunkInfo,
+    RecRangeRequest,
+    RecRangeHeader,
+    StatsSnapshotHeader,
+    StatsCmdEntry,
+    LiaIIRConfig,
+    LiaStreamConfig,
+    LiaStreamHeader,
+    LiaCheckHeader,
+)
+
+
+def decode_adc_stream_z(payload, no_samples: int) -> np.ndarray:
+    """
+    decode the payload of a compressed ADC-package (ADC_CODEC_DELTA_BITPLANE), returns the
+    uint32-words as sent in the uncompressed continous-mode (channel A in the lower, channel B
+    in the upper half-word, 14-bit values sign-extended to 16 bit).
+
+    payload: uint8 width[2 * nb] (channel A, then B) + uint16 bit-planes, nb blocks of
+    ADC_CODEC_BLOCK samples. Vectorized over all blocks, one numpy-step per bit-plane (max. 15).
+    """
+    nb = -(-no_samples // ADC_CODEC_BLOCK)
+    payload = np.frombuffer(payload, dtype=np.uint8)
+    widths = payload[: 2 * nb].astype(np.int64)
+    planes = payload[2 * nb :].view("<u2")
+    if len(widths) != 2 * nb or len(planes) != widths.sum():
+        raise ValueError(f"invalid compressed ADC-package ({len(payload)} Bytes for {no_samples} samples)")
+
+    # index of the first bit-plane of each block
+    first_plane = np.cumsum(widths) - widths
+    bit = np.arange(ADC_CODEC_BLOCK, dtype=np.uint16)
+    zz = np.zeros((2 * nb, ADC_CODEC_BLOCK), dtype=np.uint16)
+    for k in range(int(widths.max(initial=0))):
+        blocks = np.nonzero(widths > k)[0]
+        plane = planes[first_plane[blocks] + k]
+        zz[blocks] |= ((plane[:, None] >> bit) & 1) << k
+
+    # zigzag -> deltas -> samples (the first sample of a package is a delta to 0)
+    zz = zz.reshape(2, nb * ADC_CODEC_BLOCK)[:, :no_samples].astype(np.int32)
+    deltas = (zz >> 1) ^ -(zz & 1)
+    ch = np.cumsum(deltas, axis=1).astype(np.int16).view(np.uint16).astype(np.uint32)
+    return ch[0] | (ch[1] << 16)
+
+
+def lia_reference_table(ref_len: int, periods: int = 1, amplitude: int = 32767) -> np.ndarray:
+    """
+    reference-table for the LIA-Mixer (upload_bram() with LIA_MIXER_BRAM_ID), periods sine-periods
+    in ref_len ADC-samples: sin (Q1.15) in the lower, cos in the upper half-word
+    """
+    phase = 2 * np.pi * periods * np.arange(ref_len) / ref_len
+    sin = np.round(amplitude * np.sin(phase)).astype(np.int16).view(np.uint16).astype(np.uint32)
+    cos = np.round(amplitude * np.cos(phase)).astype(np.int16).view(np.uint16).astype(np.uint32)
+    return sin | (cos << 16)
+
+
+def lia_iir_config(sos) -> LiaIIRConfig:
+    """
+    LiaIIRConfig from second-order-sections (scipy.signal-layout: b0, b1, b2, a0, a1, a2 per row),
+    the coefficients are normalized to a0 = 1 and rounded to Q2.30
+    """
+    sos = np.atleast_2d(np.asarray(sos, dtype=np.float64))
+    if len(sos) > LIA_SW_MAX_SOS or sos.shape[1] != 6:
+        raise ValueError(f"max. {LIA_SW_MAX_SOS} sections with 6 coefficients")
+    coeffs = (sos[:, [0, 1, 2, 4, 5]] / sos[:, 3:4]) * (1 << LIA_SW_COEFF_FRAC_BITS)
+    if np.any(np.abs(coeffs) >= (1 << 31)):
+        raise ValueError("IIR-coefficients out of range of Q2.30 (|c| < 2)")
+    cfg = LiaIIRConfig()
+    cfg.num_sos = len(sos)
+    for i, c in enumerate(np.round(coeffs).astype(np.int64).ravel()):
+        cfg.coeffs[i] = int(c) & 0xFFFFFFFF
+    return cfg
+
+
+def lia_sw_reference(words, ref_words, iir_cfg: LiaIIRConfig, channel: int, decimation: int, first_sample: int = 0):
+    """
+    bit-exact model of the software-LIA on RedPitaya (rp_lia_sw.h) for raw ADC-words
+    (e.g. a capture of the continous-mode), returns the I/Q-points as np.int32-array (n, 2)
+    """
+    words = np.asarray(words, dtype=np.uint32)
+    ref_words = np.asarray(ref_words, dtype=np.uint32)
+    idx = first_sample + np.arange(len(words))
+
+    raw = ((words >> (16 * channel)) & 0xFFFF).astype(np.uint16).astype(np.int16)
+    x = (raw << 2).astype(np.int16) >> 2  # sign-extended 14 bit
+    ref = ref_words[idx % len(ref_words)]
+    sin = (ref & 0xFFFF).astype(np.uint16).astype(np.int16).astype(np.int64)
+    cos = (ref >> 16).astype(np.uint16).astype(np.int16).astype(np.int64)
+    iq = np.stack([x * cos, x * sin], axis=1)
+
+    coeffs = np.array(iir_cfg.coeffs[: 5 * iir_cfg.num_sos], dtype=np.uint32).view(np.int32).reshape(-1, 5)
+    for b0, b1, b2, a1, a2 in coeffs.tolist():
+        for lane in range(2):
+            x1 = x2 = y1 = y2 = 0
+            col = iq[:, lane].tolist()
+            for n, xn in enumerate(col):
+                acc = b0 * xn + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2
+                acc = (acc + (1 << 63)) % (1 << 64) - (1 << 63)  # 64-bit accumulator wraps
+                y = (acc >> LIA_SW_COEFF_FRAC_BITS) + ((acc >> (LIA_SW_COEFF_FRAC_BITS - 1)) & 1)
+                y = min(max(y, -(1 << 31)), (1 << 31) - 1)
+                x2, x1, y2, y1 = x1, xn, y1, y
+                col[n] = y
+            iq[:, lane] = col
+    return iq[idx % decimation == decimation - 1].astype(np.int32)
+
+
+def metrics_hist(hist) -> dict:
+    """
+    summary of a MetricsHist: count, mean and percentiles in us (percentiles are the upper
+    bound of the log2-bucket, inf for the last bucket), raw bucket-counts
+    """
+    buckets = np.array(hist.buckets[:], dtype=np.uint64)
+    count = int(buckets.sum())
+    upper_us = np.ldexp(1.0, np.arange(len(buckets)) + METRICS_HIST_SHIFT) / 1e3
+    upper_us[-1] = np.inf
+    cum = np.cumsum(buckets)
+
+    def percentile(q):
+        return float(upper_us[np.searchsorted(cum, q * count)]) if count > 0 else 0.0
+
+    return {
+        "count": count,
+        "mean_us": hist.sum_ns / count / 1e3 if count > 0 else 0.0,
+        "p50_us": percentile(0.5),
+        "p99_us": percentile(0.99),
+        "buckets": buckets,
+    }
+
+
+class BatchResult:
+    """
+    result of one command inside a CommandBatch, valid after the batch was flushed
+    """
+
+    def __init__(self, seq: int, cmd_id: int):
+        self.seq = seq
+        self.cmd_id = cmd_id
+        self.status = None  # BATCH_STATUS_*, None if not sent yet
+        self.value = None  # reply of the command (e.g. voltage in mV for getters)
+
+    @property
+    def ok(self) -> bool:
+        return self.status == BATCH_STATUS_OK
+
+
+class CommandBatch:
+    """
+    collects commands and sends them to RedPitaya as batch-frames:
+
+        - all commands are sent in one tcp-message (max. MAX_BATCH_CMDS per frame,
+          larger batches are split into several frames)
+        - RedPitaya executes them in order and sends back one response-frame with the
+          status and reply-value of each command
+
+    commands which send/receive more than one value (configs, LUT, ADC-sampling..) or
+    wait for the trigger (START_TRIGGER_SWEEP, NEXT_TRIGGER, REARM_TRIGGER) are rejected
+    by RedPitaya with BATCH_STATUS_NOT_ALLOWED
+    """
+
+    def __init__(self, rp_tcp, verbose: bool = False):
+        self.rp_tcp = rp_tcp
+        self.verbose = verbose
+        self.cmds = []
+        self.results = []
+        self.next_seq = 0
+
+    def add(self, cmd_id: int, value: float | int = 0, channel: int = 0) -> BatchResult:
+        """
+        add command to batch, returns BatchResult which holds the reply after flush()
+        """
+        result = BatchResult(self.next_seq, cmd_id)
+        self.cmds.append(BatchCmd(self.next_seq, cmd_id, channel, 0, value))
+        self.results.append(result)
+        self.next_seq += 1
+        return result
+
+    def flush(self):
+        """
+        send all collected commands and receive their responses
+        """
+        for start in range(0, len(self.cmds), MAX_BATCH_CMDS):
+            cmds = self.cmds[start : start + MAX_BATCH_CMDS]
+            results = self.results[start : start + MAX_BATCH_CMDS]
+            self._send_frame(cmds, results)
+
+        if self.verbose:
+            print(f"SEND: Batch with {len(self.cmds)} commands")
+        self.cmds = []
+        self.results = []
+
+    def _send_frame(self, cmds: list, results: list):
+        no_cmds = len(cmds)
+
+        # frame = header + array of commands as one struct -> one send
+        class BatchFrame(Structure):
+            _pack_ = 1
+            _fields_ = [("header", BatchFrameHeader), ("cmds", BatchCmd * no_cmds)]
+
+        frame = BatchFrame()
+        frame.header = BatchFrameHeader(BATCH_FRAME_MAGIC, BATCH_PROTOCOL_VERSION, no_cmds)
+        for i, cmd in enumerate(cmds):
+            frame.cmds[i] = cmd
+        self.rp_tcp.send_struct(frame)
+
+        header = BatchFrameHeader.from_buffer_copy(
+            self.rp_tcp.receive_data(sizeof(BatchFrameHeader))
+        )
+        if header.magic != BATCH_FRAME_MAGIC or header.no_cmds != no_cmds:
+            raise ValueError(
+                f"invalid batch-response (magic: {header.magic:#x}, no_cmds: {header.no_cmds})"
+            )
+        resp = (BatchResp * no_cmds).from_buffer_copy(
+            self.rp_tcp.receive_data(no_cmds * sizeof(BatchResp))
+        )
+
+        # map responses to results by sequence-number
+        results_by_seq = {result.seq: result for result in results}
+        for r in resp:
+            result = results_by_seq[r.seq]
+            result.status = r.status
+            result.value = r.value
+            if r.status != BATCH_STATUS_OK:
+                print(f"Batch: command {result.cmd_id} (seq {r.seq}) failed with status {r.status}")
+
+
+class CommandSequence:
+    """
+    program which is uploaded and executed on RedPitaya (RedPitayaBoard.run_sequence()):
+
+        seq = CommandSequence()
+        with seq.loop(100):
+            seq.add(SET_AD_DAC, value=0.5, channel=0)
+            seq.add(GET_XADC, channel=1, capture=True)
+            seq.delay(1000)  # period of 1 ms, deadlines don't drift with the runtime of the commands
+        header, results = rp.run_sequence(seq)
+
+    the timing is done on RedPitaya, there is no round-trip between the commands.
+    Same restrictions as for batches: commands which send/receive more than one value
+    or wait for the trigger are not allowed (result-status BATCH_STATUS_NOT_ALLOWED), neither
+    are EXIT_APP/TERMINATE_CLIENT. The program runs on the worker-thread of the server: other
+    clients are served meanwhile, a sequence is rejected while another job is running
+    """
+
+    def __init__(self):
+        self.ops = []
+        self.no_captures = 0  # no. of captured replies incl. loop-iterations
+        self._loops = []  # count of each open loop
+
+    def add(self, cmd_id: int, value: float | int = 0, channel: int = 0, capture: bool = False) -> int:
+        """
+        add command, returns its op-index (SeqResult.op_index of its captured replies)
+        """
+        self.ops.append(SeqOp(SEQ_OP_CMD, SEQ_FLAG_CAPTURE if capture else 0, cmd_id, channel, 0, value))
+        if capture:
+            self.no_captures += int(np.prod(self._loops, dtype=np.int64))
+        return len(self.ops) - 1
+
+    def wait_until(self, t_us: float):
+        """
+        wait till t_us after the start of the program
+        """
+        self.ops.append(SeqOp(SEQ_OP_WAIT_UNTIL, 0, 0, 0, 0, t_us))
+
+    def delay(self, t_us: float):
+        """
+        wait till t_us after the previous deadline (periodic timing inside loops)
+        """
+        self.ops.append(SeqOp(SEQ_OP_DELAY, 0, 0, 0, 0, t_us))
+
+    @contextmanager
+    def loop(self, count: int):
+        """
+        repeat the ops added inside the block count times
+        """
+        if count <= 0 or len(self._loops) >= SEQ_MAX_LOOP_DEPTH:
+            raise ValueError(f"invalid loop (count {count}, max. depth {SEQ_MAX_LOOP_DEPTH})")
+        self.ops.append(SeqOp(SEQ_OP_LOOP, 0, 0, 0, count, 0))
+        self._loops.append(count)
+        try:
+            yield
+        finally:
+            self._loops.pop()
+            self.ops.append(SeqOp(SEQ_OP_END_LOOP, 0, 0, 0, 0, 0))
 
 
 class RedPitayaBoard:
@@ -129,6 +516,16 @@ class RedPitayaBoard:
         self.verbose = verbose
         self.ip = ip
         self.port = port
+        # adc-mode of the last sent AdcConfig, in continous-mode each tcp-package has a AdcStreamHeader
+        self.adc_mode = None
+        self.adc_stream_framed = False
+        self.adc_stream_compressed = False  # packages with AdcStreamZHeader + compressed payload
+        self.adc_stream_bytes = 0  # bytes received in the current stream (headers + payload)
+        self.adc_stream_seq = -1  # sequence-number of last received package
+        self.adc_stream_overruns = 0  # packages lost on RedPitaya (RAM-Writer overwrote unsent data)
+        self.adc_stream_packages = 0  # packages requested with start_adc_sampling()
+        self.adc_stream_status = PackageStatusQueue()  # packages read ahead till their status-word arrives
+        self.active_batch = None  # CommandBatch of the current batch()-block
         print_rp_tag()
         self.printImageInfo()
 
@@ -254,6 +651,11 @@ class RedPitayaBoard:
             - value, float
             - channel, int
         """
+        # inside a batch()-block commands are collected and sent together
+        if self.active_batch is not None:
+            self.active_batch.add(cmd_id, value, channel)
+            return
+
         # create tcp command struct
         rp_command = TcpCommand(cmd_id, value, channel)
 
@@ -264,6 +666,34 @@ class RedPitayaBoard:
                 f"SEND: ID: {rp_command.id} | VAL: {rp_command.val} | CH: {rp_command.ch}"
             )
 
+    @contextmanager
+    def batch(self):
+        """
+        context-manager which collects all commands sent inside the block and sends them
+        as batch-frame(s) when the block is left:
+
+            with rp.batch() as b:
+                for ch in range(4):
+                    rp.set_voltage_pdm(ch, 0.5)
+                voltage = b.add(GET_XADC, channel=1)
+            print(voltage.value)
+
+        setters can be called as usual. Getters which wait for an answer can't be used
+        inside the block, add them with b.add() and read BatchResult.value after the block.
+        """
+        if self.active_batch is not None:
+            raise RuntimeError("batch()-blocks can not be nested")
+
+        self.active_batch = CommandBatch(
+            None if self.hw_debug else self.rp_tcp, verbose=self.verbose
+        )
+        try:
+            yield self.active_batch
+            if not (self.hw_debug):
+                self.active_batch.flush()
+        finally:
+            self.active_batch = None
+
     def waitForAnswer(self, answerID: int = ACK):
         """
         used in other methods that need some kind of sync inbetween host and RP
@@ -455,17 +885,23 @@ class RedPitayaBoard:
     # Methods for configuring and controlling the RedPitaya-Board
     ############################################################################
 
-    def sendConfigParams(self, configParams: Structure, configID: int):
+    def sendConfigParams(self, configParams: Structure, configID: int, report: bool = False):
         """
         method to send config-params packaged in c-struct via TCP
+
+        RedPitaya applies only the fields which changed against the active config
+        (ADC-, DAC-, DAC-BRAM- and Trigger-Config, a LUT is only reloaded if it changed).
+        report=True: returns (applied, writes), applied: CONFIG_APPLIED_* flags,
+        writes: no. of register-writes on the FPGA (cached devices only)
         """
+        applied, writes = CONFIG_APPLIED_NONE, 0
         if not (self.hw_debug):
 
             if self.verbose:
                 print(f"Send new configParams for ID: {configID} to RedPitaya...")
 
             # send command to RP to send a new Config
-            self.sendCommand(NEW_CONFIG, value=configID)
+            self.sendCommand(NEW_CONFIG, value=configID, channel=CONFIG_REPORT_APPLIED if report else 0)
 
             if self.verbose:
                 print("wait for response from RedPitaya....")
@@ -480,33 +916,272 @@ class RedPitayaBoard:
             self.rp_tcp.send_struct(configParams)
 
             # wait for response from Config-Command:
-            self.waitForAnswer(answerID=CONFIG_DONE)
+            if report:
+                reply = self.rp_tcp.receive_int()
+                if reply & 0xFF != CONFIG_DONE:
+                    raise RuntimeError(f"Config {configID} was rejected by RedPitaya (reply {reply})")
+                applied, writes = (reply >> 8) & 0xFF, reply >> 16
+            else:
+                self.waitForAnswer(answerID=CONFIG_DONE)
+
+        if configID == ADC_CONFIG_ID:
+            self.adc_mode = configParams.adc_mode
 
         if self.verbose:
             print("Done sending Config Params...")
+        if report:
+            return applied, writes
+
+    def upload_bram(self, bramID: int, words, offset: int = 0):
+        """
+        sends words (uint32) to the BRAM of the Dummy-Data-Generator (DUMMY_DATA_GEN_BRAM_ID)
+        or the LIA-Mixer (LIA_MIXER_BRAM_ID), only len(words) are transferred.
+        With offset > 0 only BRAM[offset:offset + len(words)] is updated, the rest of the table is kept.
+        """
+        words = np.ascontiguousarray(words, dtype="<u4")
+        no_words = len(words)
+        if self.hw_debug:
+            return
 
-    def start_adc_sampling(self, noTcpPackages: int):
+        # header + words as one struct -> one send
+        class BramUpload(Structure):
+            _pack_ = 1
+            _fields_ = [("header", BramUploadHeader), ("words", c_uint32 * no_words)]
+
+        upload = BramUpload()
+        upload.header = BramUploadHeader(BRAM_UPLOAD_MAGIC, offset, no_words)
+        np.frombuffer(upload.words, dtype="<u4")[:] = words
+
+        self.sendCommand(NEW_CONFIG, value=bramID)
+        self.waitForAnswer(ACK)
+        self.rp_tcp.send_struct(upload)
+        if self.rp_tcp.receive_int() != CONFIG_DONE:
+            raise RuntimeError(f"BRAM-upload of {no_words} words at offset {offset} was rejected by RedPitaya")
+
+    def start_adc_sampling(self, noTcpPackages: int, compressed: bool = False):
         """
         send start-adc-sampling command to RedPitaya to C-Application
         containing the no. of tcp packages we expect from the RedPitaya
+
+        compressed: continous-mode only, the packages are compressed losslessly on RedPitaya
+        (for links slower than the ADC-data-rate), receive_adc_data_package() returns the
+        decoded raw data
         """
         if self.verbose:
             print("send start sampling command")
 
-        self.sendCommand(START_ADC_SAMPLING, value=noTcpPackages)
+        # packages in continous-mode start with a AdcStreamHeader (AdcStreamZHeader if compressed)
+        self.adc_stream_framed = self.adc_mode == ADC_CONTINOUS_MODE
+        self.adc_stream_compressed = self.adc_stream_framed and compressed
+        self.adc_stream_bytes = 0
+        self.adc_stream_seq = -1
+        self.adc_stream_overruns = 0
+        self.adc_stream_packages = noTcpPackages
+        self.adc_stream_status = PackageStatusQueue()
+
+        self.sendCommand(
+            START_ADC_SAMPLING,
+            value=noTcpPackages,
+            channel=ADC_STREAM_COMPRESSED if self.adc_stream_compressed else 0,
+        )
+
+    def stream_adc(
+        self,
+        noTcpPackages: int,
+        pkg_samples: int,
+        ring_slots: int = DEFAULT_RING_SLOTS,
+        drop: bool = False,
+        callback=None,
+    ) -> AdcStreamReceiver:
+        """
+        starts the continous-mode (raw packages) and returns an AdcStreamReceiver which reads
+        the packages on a background-thread into a numpy-ring (no copy per package):
+
+            for seq, data in rp.stream_adc(no_packages, pkg_samples):
+                ...  # data: np.uint32-view into the ring, valid till the next package
+
+        pkg_samples: tcp_pkg_size of the RamInitConfig
+        drop: if the consumer is too slow, drop packages on the host instead of stalling the socket
+        callback: fn(seq, data) on the receiver-thread instead of the iterator
+        """
+        if self.adc_mode != ADC_CONTINOUS_MODE:
+            raise ValueError("stream_adc() needs ADC_CONTINOUS_MODE")
+        self.start_adc_sampling(noTcpPackages)
+        return AdcStreamReceiver(self._socket(), pkg_samples, noTcpPackages, ring_slots, drop, callback)
+
+    def _socket(self) -> socket.socket:
+        """
+        socket of the tcp-client, for reading directly into numpy-buffers (recv_into)
+        """
+        for value in vars(self.rp_tcp).values():
+            if isinstance(value, socket.socket):
+                return value
+        raise RuntimeError("tcp-client has no socket")
 
     def receive_adc_data_package(self, tcp_pkg_size_bytes: int, time_out: bool = False):
         """
         Receive a ADC-TCP-Package comtaining TCP_PACKAGE_SIZE amount of ADC-Samples
         burstPackageSize: amount of tcp-packages we want to receive in a burst
+
+        In continous-mode the AdcStreamHeader in front of the package and the status-word after it
+        are removed, lost packages (also packages overwritten while they were sent) return b""
+        and are counted in self.adc_stream_overruns. The status-word of a package arrives
+        ADC_STREAM_STATUS_LAG packages later, so up to that many packages are read ahead.
         """
         if self.verbose:
             print("receiving ADC package from RedPitaya")
             print(f"receiving {tcp_pkg_size_bytes} Bytes")
 
-        resp = self.rp_tcp.receive_data(tcp_pkg_size_bytes, time_out)
+        if self.adc_stream_compressed:
+            return self._receive_adc_stream_z(time_out)
+
+        if not self.adc_stream_framed:
+            resp = self.rp_tcp.receive_data(tcp_pkg_size_bytes, time_out)
+            self.adc_stream_bytes += len(resp)
+            return resp
+
+        done = None
+        while done is None:
+            if self.adc_stream_seq + 1 < self.adc_stream_packages:
+                header = self._receive_adc_stream_header(time_out)
+                data = self.rp_tcp.receive_data(header.no_samples * 4, time_out) if header.no_samples else b""
+                self.adc_stream_bytes += len(data)
+                self.adc_stream_status.push((header, data))
+            elif not self.adc_stream_status.pending:
+                raise RuntimeError("all packages of the ADC-Stream were received already")
+            done = self.adc_stream_status.status(self.rp_tcp.receive_int())
+            self.adc_stream_bytes += 4
+        (header, resp), ok = done
+        if header.no_samples and not ok:
+            # counted as overrun on RedPitaya as well (in the header of the next package)
+            print(f"RedPitaya RP{self.id}: ADC-package {header.seq} was overwritten while it was sent")
+            self.adc_stream_overruns += 1
+            return b""
         return resp
 
+    def _receive_adc_stream_z(self, time_out: bool = False):
+        """
+        receive compressed package (AdcStreamZHeader + payload), returns the decoded raw data
+        """
+        header = AdcStreamZHeader.from_buffer_copy(
+            self.rp_tcp.receive_data(sizeof(AdcStreamZHeader), time_out)
+        )
+        if header.magic != ADC_STREAM_Z_MAGIC or header.codec != ADC_CODEC_DELTA_BITPLANE:
+            raise ValueError(f"invalid compressed ADC-Stream-Header (magic: {header.magic:#x}, codec: {header.codec})")
+        self._check_adc_stream_seq(header)
+        if header.no_samples == 0:
+            # lost package, sent without payload
+            self.adc_stream_bytes += sizeof(AdcStreamZHeader)
+            return b""
+
+        payload = self.rp_tcp.receive_data(header.no_bytes, time_out)
+        self.adc_stream_bytes += sizeof(AdcStreamZHeader) + header.no_bytes
+        return decode_adc_stream_z(payload, header.no_samples).tobytes()
+
+    def _receive_adc_stream_header(self, time_out: bool = False):
+        """
+        receive AdcStreamHeader of next package and check sequence-number and overrun-counter
+        """
+        header = AdcStreamHeader.from_buffer_copy(
+            self.rp_tcp.receive_data(sizeof(AdcStreamHeader), time_out)
+        )
+        if header.magic != ADC_STREAM_MAGIC:
+            raise ValueError(f"invalid ADC-Stream-Header (magic: {header.magic:#x})")
+        self.adc_stream_bytes += sizeof(AdcStreamHeader)
+        self._check_adc_stream_seq(header)
+        return header
+
+    def _check_adc_stream_seq(self, header):
+        if header.overruns != self.adc_stream_overruns:
+            print(
+                f"RedPitaya RP{self.id}: {header.overruns - self.adc_stream_overruns} "
+                f"ADC-package(s) lost up to package {header.seq}"
+            )
+        self.adc_stream_seq = header.seq
+        self.adc_stream_overruns = header.overruns
+
+    def start_lia_sampling(self, noTcpPackages: int, decimation: int, output: int = LIA_OUT_IQ, ref_len: int = 0):
+        """
+        ADC_LIA_MODE (AdcConfig.adc_mode): software-LIA on RedPitaya, every ADC-package is mixed with
+        the reference-table (LIA_MIXER_BRAM_ID, see lia_reference_table()), filtered with the
+        LiaIIRConfig (see lia_iir_config()) and decimated, only the points are sent.
+        LiaMixerConfig.channel selects the ADC-channel.
+
+        decimation: one point every decimation ADC-samples
+        output: LIA_OUT_IQ (int32 I, Q) or LIA_OUT_MAG_PHASE (float32 magnitude, phase)
+        ref_len: words of the reference-table (one period), 0: all uploaded words
+        packages are received with receive_lia_package()
+        """
+        if self.adc_mode != ADC_LIA_MODE:
+            raise ValueError("start_lia_sampling() needs ADC_LIA_MODE")
+        self.sendConfigParams(LiaStreamConfig(decimation, output, ref_len), LIA_STREAM_CONFIG_ID)
+        self.adc_stream_seq = -1
+        self.adc_stream_overruns = 0
+        self.sendCommand(START_ADC_SAMPLING, value=noTcpPackages)
+
+    def receive_lia_package(self, time_out: bool = False):
+        """
+        receive one package of the software-LIA,
+        returns (LiaStreamHeader, np-array (no_points, 2): int32 I/Q or float32 magnitude/phase)
+        """
+        magic = self.rp_tcp.receive_int()
+        if magic == SERVER_ERROR_ID:
+            raise RuntimeError("LIA-Mode was not started (reference-table, IIR- or LIA-Stream-Config invalid)")
+        if magic != LIA_STREAM_MAGIC:
+            raise ValueError(f"invalid LIA-Stream-Header (magic: {magic:#x})")
+        # magic was already received as int
+        header = LiaStreamHeader.from_buffer_copy(
+            LIA_STREAM_MAGIC.to_bytes(4, "little") + self.rp_tcp.receive_data(sizeof(LiaStreamHeader) - 4, time_out)
+        )
+        self._check_adc_stream_seq(header)
+        dtype = "<f4" if header.output == LIA_OUT_MAG_PHASE else "<i4"
+        if header.no_points == 0:
+            return header, np.zeros((0, 2), dtype=dtype)
+        data = self.rp_tcp.receive_data(header.no_points * 8, time_out)
+        return header, np.frombuffer(data, dtype=dtype).reshape(-1, 2)
+
+    def acquire_blocks(self, no_blocks: int, no_regions: int = 0):
+        """
+        Back-to-back block acquisition (AdcConfig.adc_mode = ADC_MULTI_BLOCK_MODE):
+        the RAM-Buffer is split into no_regions regions (0: ping-pong), the RAM-Writer keeps
+        running while finished regions are sent, so there is no re-arm gap between blocks.
+
+        returns iterator over (header, data, ok) for each block:
+            - header.seq: gaps are blocks which were dropped (overwritten before sending),
+              header.first_sample gives the exact dead time in samples. A dropped last block
+              is sent anyway with no_samples = 0 (ok = False), it ends the acquisition
+            - header.t_ns: time of the first sample (CLOCK_MONOTONIC on RedPitaya)
+            - data: raw ADC-samples (same format as receive_adc_data_package)
+            - ok: False if the RAM-Writer reached the region again while it was sent
+        """
+        self.adc_stream_framed = False
+        self.sendCommand(START_ADC_SAMPLING, value=no_blocks, channel=no_regions)
+        if self.hw_debug:
+            return iter(())
+        return self._receive_blocks(no_blocks)
+
+    def _receive_blocks(self, no_blocks: int):
+        # the last block ends the acquisition (seq counts dropped blocks as well), the status-word
+        # of a block arrives ADC_STREAM_STATUS_LAG blocks later
+        status_queue = PackageStatusQueue()
+        last = False
+        while not last or status_queue.pending:
+            if not last:
+                header = AdcBlockHeader.from_buffer_copy(
+                    self.rp_tcp.receive_data(sizeof(AdcBlockHeader))
+                )
+                if header.magic != ADC_BLOCK_MAGIC:
+                    raise ValueError(f"invalid ADC-Block-Header (magic: {header.magic:#x})")
+                data = self.rp_tcp.receive_data(header.no_samples * 4) if header.no_samples else b""
+                if self.verbose and header.dropped:
+                    print(f"RedPitaya RP{self.id}: {header.dropped} block(s) dropped before block {header.seq}")
+                status_queue.push((header, data))
+                last = header.seq + 1 >= no_blocks
+            done = status_queue.status(self.rp_tcp.receive_int())
+            if done is not None:
+                (header, data), ok = done
+                yield header, data, ok
+
     def sample_lut_sweep(
         self, noSteps: int, noSweeps: int, ch: int, idx: int, plotPreview: bool = False
     ):
@@ -525,9 +1200,10 @@ class RedPitayaBoard:
         # send command to start sampling
         self.sendCommand(START_ADC_SAMPLING)
 
-        # now we receive data from RedPitaya
-        newData_raw = self.rp_tcp.receive_data(packageSizeBytes)
-        newData = unpackADCData(np.frombuffer(newData_raw, dtype=np.int32), self.id)
+        # now we receive data from RedPitaya, directly into the array
+        newData_raw = np.empty(noSteps * noSweeps, dtype=np.int32)
+        recv_into_exactly(self._socket(), newData_raw)
+        newData = unpackADCData(newData_raw, self.id)
         print(f"Received data for channel {ch} with {len(newData[ch])} samples")
 
         if noSweeps > 1:
@@ -545,6 +1221,50 @@ class RedPitayaBoard:
 
         return newData
 
+    def sample_lut_sweep_averaged(
+        self, noSteps: int, noSweeps: int, ch: int, idx: int, plotPreview: bool = False
+    ):
+        """
+        Same as sample_lut_sweep(), but the sweeps are averaged on RedPitaya:
+        the ADC-samples are accumulated per LUT-step while the sweeps run and only
+        the sums of one sweep are sent (noSteps * 8 Bytes instead of noSteps * noSweeps * 4).
+
+        The ADC has to be started by the first sample of the DAC-BRAM-Controller
+        (external trigger-mode) and sample once per LUT-step, like for sample_lut_sweep().
+        """
+        self.sendCommand(START_SWEEP_AVG, value=noSweeps, channel=noSteps)
+        if self.hw_debug:
+            return np.zeros(noSteps)
+
+        header = SweepAvgHeader.from_buffer_copy(
+            self.rp_tcp.receive_data(sizeof(SweepAvgHeader))
+        )
+        if header.magic != SWEEP_AVG_MAGIC:
+            raise ValueError(f"invalid Sweep-Averaging-Header (magic: {header.magic:#x})")
+        if header.status != 0:
+            raise RuntimeError("Sweep-Averaging failed on RedPitaya (overrun, timeout or invalid parameters)")
+
+        sums = np.frombuffer(
+            self.rp_tcp.receive_data(header.no_steps * 2 * 4), dtype=np.int32
+        ).reshape(2, header.no_steps)
+        newData = self._raw_to_voltage(sums[ch] / header.no_sweeps, ch)
+
+        if plotPreview:
+            plt.plot(newData, marker=".")
+            plt.vlines(idx, -1, 1, color="red")
+            plt.show()
+
+        return newData
+
+    def _raw_to_voltage(self, raw, ch: int):
+        """
+        convert (averaged, non-integer) raw ADC-values with the calibration of unpackADCData(),
+        which is linear: evaluated for raw = 0 and raw = 1000 on both channels
+        """
+        ref = np.array([0, 1000 | (1000 << 16)], dtype=np.int32)
+        v = unpackADCData(ref, self.id)[ch]
+        return v[0] + raw * (v[1] - v[0]) / 1000
+
     def start_dac_sweep(self, port: int = ALL_BRAM_DAC_PORTS):
         """
         send start DAC-BRAM-Controller-sweep command to RedPitaya for
@@ -569,8 +1289,233 @@ class RedPitayaBoard:
     def wait_for_wavelength_request(self):
         """
         stalls programm and waits till wavelength-measurement is requested by RedPitaya Board
+        (raises TimeoutError if the trigger was not armed within the timeout on RedPitaya)
+        """
+        if self.hw_debug:
+            return
+        while True:
+            response = self.rp_tcp.receive_int()
+            if response == REQ_WLENGTH:
+                return
+            if response == SERVER_ERROR_ID:
+                raise TimeoutError("trigger was not armed on RedPitaya (no trigger-armed event)")
+            print("received wrong response...")
+
+    def get_trigger_latency(self, reset: bool = False) -> dict:
+        """
+        latency from trigger-armed (interrupt) to REQ_WLENGTH sent, measured on RedPitaya:
+        last/mean/max in us, no. of events and timeouts
+        """
+        with self.batch() as b:
+            stats = {
+                "last_us": b.add(GET_TRIGGER_LATENCY, channel=TRIGGER_STAT_LAST_US),
+                "mean_us": b.add(GET_TRIGGER_LATENCY, channel=TRIGGER_STAT_MEAN_US),
+                "max_us": b.add(GET_TRIGGER_LATENCY, channel=TRIGGER_STAT_MAX_US),
+                "events": b.add(GET_TRIGGER_LATENCY, channel=TRIGGER_STAT_EVENTS),
+                "timeouts": b.add(GET_TRIGGER_LATENCY, channel=TRIGGER_STAT_TIMEOUTS),
+            }
+            if reset:
+                b.add(GET_TRIGGER_LATENCY, channel=TRIGGER_STAT_RESET)
+        return {name: result.value for name, result in stats.items()}
+
+    def calibrate_lut(self, cfg: LutCalibConfig, points, measure):
+        """
+        closed-loop LUT-calibration on RedPitaya: the trigger-sweep runs on the board and
+        only measure(trigger, iteration) -> float is called on the host for each REQ_WLENGTH
+        (error or reading, see cfg.input_mode; return NaN to abort).
+        points: LutCalibPoint (index, starting voltage, target) for each trigger, the starting
+        voltages are written to the LUT before the sweep.
+        returns (status, list of LutCalibResult)
+        """
+        cfg.no_triggers = len(points)
+        if self.hw_debug:
+            return LUT_CALIB_OK, []
+
+        # config + trigger-points as one struct -> one send
+        class LutCalibRequest(Structure):
+            _pack_ = 1
+            _fields_ = [("cfg", LutCalibConfig), ("points", LutCalibPoint * len(points))]
+
+        request = LutCalibRequest()
+        request.cfg = cfg
+        for i, point in enumerate(points):
+            request.points[i] = point
+
+        self.sendCommand(START_LUT_CALIB)
+        self.waitForAnswer(ACK)
+        self.rp_tcp.send_struct(request)
+
+        trigger, iteration = -1, 0
+        while True:
+            response = self.rp_tcp.receive_int()
+            if response == REQ_WLENGTH:
+                # no. of the trigger-point follows, the same trigger is measured again till it converged
+                t = self.rp_tcp.receive_int()
+                iteration = iteration + 1 if t == trigger else 0
+                trigger = t
+                self.rp_tcp.send_struct(c_float(float(measure(trigger, iteration))))
+            elif response == SERVER_ERROR_ID:
+                raise RuntimeError("LUT-calibration was rejected by RedPitaya (invalid config or trigger-points)")
+            elif response == LUT_CALIB_MAGIC:
+                break
+            else:
+                print("received wrong response...")
+
+        # magic was already received as int
+        header = LutCalibResultHeader.from_buffer_copy(
+            LUT_CALIB_MAGIC.to_bytes(4, "little")
+            + self.rp_tcp.receive_data(sizeof(LutCalibResultHeader) - 4)
+        )
+        results = (LutCalibResult * header.no_triggers).from_buffer_copy(
+            self.rp_tcp.receive_data(header.no_triggers * sizeof(LutCalibResult))
+        )
+        return header.status, list(results)
+
+    def run_sequence(self, seq: CommandSequence):
+        """
+        upload and execute a CommandSequence on RedPitaya,
+        returns (SeqResultHeader, list of SeqResult for the captured commands)
+        """
+        no_ops = len(seq.ops)
+        if no_ops == 0 or no_ops > SEQ_MAX_OPS or seq._loops:
+            raise ValueError(f"invalid sequence ({no_ops} ops, max. {SEQ_MAX_OPS}, loops have to be closed)")
+        max_results = min(seq.no_captures, SEQ_MAX_RESULTS)
+        if self.hw_debug:
+            return SeqResultHeader(SEQ_RESULT_MAGIC), []
+
+        # header + ops as one struct -> one send
+        class SeqProgram(Structure):
+            _pack_ = 1
+            _fields_ = [("header", SeqProgramHeader), ("ops", SeqOp * no_ops)]
+
+        program = SeqProgram()
+        program.header = SeqProgramHeader(SEQ_PROGRAM_MAGIC, SEQ_PROTOCOL_VERSION, no_ops, max_results, 0)
+        for i, op in enumerate(seq.ops):
+            program.ops[i] = op
+
+        self.sendCommand(START_SEQUENCE)
+        self.waitForAnswer(ACK)
+        self.rp_tcp.send_struct(program)
+
+        magic = self.rp_tcp.receive_int()
+        if magic == SERVER_ERROR_ID:
+            raise RuntimeError("sequence was rejected by RedPitaya (invalid program or worker busy)")
+        if magic != SEQ_RESULT_MAGIC:
+            raise ValueError(f"invalid sequence-result (magic: {magic:#x})")
+        # magic was already received as int
+        header = SeqResultHeader.from_buffer_copy(
+            SEQ_RESULT_MAGIC.to_bytes(4, "little")
+            + self.rp_tcp.receive_data(sizeof(SeqResultHeader) - 4)
+        )
+        results = []
+        if header.no_results > 0:
+            results = (SeqResult * header.no_results).from_buffer_copy(
+                self.rp_tcp.receive_data(header.no_results * sizeof(SeqResult))
+            )
+        if header.no_late > 0:
+            print(f"Sequence: {header.no_late} deadlines missed (max. {header.max_late_ns / 1000:.1f} us late)")
+        return header, list(results)
+
+    def start_recording(self, rec_id: int, no_chunks: int, storage: int = REC_STORAGE_SD):
+        """
+        records no_chunks chunks (REC_CHUNK_SAMPLES each) of the continous ADC-stream into
+        a file on RedPitaya (REC_STORAGE_SD or REC_STORAGE_TMPFS), uses the current ADC-Config.
+        The recording runs without the host, wait_for_recording() returns when it is done.
+        """
+        self.sendCommand(START_RECORD)
+        self.waitForAnswer(ACK)
+        self.rp_tcp.send_struct(RecConfig(rec_id, storage, no_chunks))
+
+    def wait_for_recording(self) -> int:
+        """
+        waits till the recording started with start_recording() is done,
+        returns the no. of chunks written (lost chunks are missing)
         """
-        self.waitForAnswer(REQ_WLENGTH)
+        no_chunks = self.rp_tcp.receive_int()
+        if no_chunks == SERVER_ERROR_ID:
+            raise RuntimeError("recording failed on RedPitaya")
+        return no_chunks
+
+    def get_recording_info(self, rec_id: int):
+        """
+        returns (RecFileHeader, list of RecChunkInfo) of a recording,
+        can also be used while the recording is running
+        """
+        self.sendCommand(GET_RECORD_INFO, channel=rec_id)
+        if self.rp_tcp.receive_int() == SERVER_ERROR_ID:
+            raise RuntimeError(f"recording {rec_id} not found on RedPitaya")
+
+        header = RecFileHeader.from_buffer_copy(self.rp_tcp.receive_data(sizeof(RecFileHeader)))
+        if header.magic != REC_FILE_MAGIC:
+            raise ValueError(f"invalid recording-header (magic: {header.magic:#x})")
+        index = []
+        if header.no_chunks > 0:
+            index = (RecChunkInfo * header.no_chunks).from_buffer_copy(
+                self.rp_tcp.receive_data(header.no_chunks * sizeof(RecChunkInfo))
+            )
+        return header, list(index)
+
+    def fetch_recording_range(self, rec_id: int, first_sample: int, no_samples: int):
+        """
+        reads samples [first_sample, first_sample + no_samples) of a recording (raw 32-bit words,
+        max. REC_MAX_RANGE_SAMPLES), the range is clipped to the end of the recording.
+        Samples of lost chunks are 0 (counted in header.no_missing).
+        returns: (RecRangeHeader, np.uint32-array)
+        """
+        if no_samples <= 0 or no_samples > REC_MAX_RANGE_SAMPLES:
+            raise ValueError(f"invalid no. of samples {no_samples} (max. {REC_MAX_RANGE_SAMPLES})")
+        self.sendCommand(GET_RECORD_RANGE)
+        self.waitForAnswer(ACK)
+        self.rp_tcp.send_struct(RecRangeRequest(rec_id, no_samples, first_sample))
+
+        magic = self.rp_tcp.receive_int()
+        if magic == SERVER_ERROR_ID:
+            raise RuntimeError("reading recording was rejected by RedPitaya (worker busy)")
+        if magic != REC_RANGE_MAGIC:
+            raise ValueError(f"invalid recording-range (magic: {magic:#x})")
+        # magic was already received as int
+        header = RecRangeHeader.from_buffer_copy(
+            REC_RANGE_MAGIC.to_bytes(4, "little") + self.rp_tcp.receive_data(sizeof(RecRangeHeader) - 4)
+        )
+        if header.status == SERVER_ERROR_ID:
+            raise RuntimeError(f"recording {rec_id} not found on RedPitaya")
+        if header.no_samples == 0:
+            return header, np.zeros(0, dtype=np.uint32)
+        data = self.rp_tcp.receive_data(header.no_samples * 4)
+        return header, np.frombuffer(data, dtype="<u4").copy()
+
+    def get_stats(self, reset: bool = False) -> dict:
+        """
+        runtime-metrics of the server (since start or last reset): service-time per command-ID
+        (key METRICS_CMD_OTHER for IDs >= 256), bytes/packages per stream-mode, RAM-overruns,
+        SPI-transactions per Click Board and trigger-waits. Histograms see metrics_hist().
+        The same values are served for Prometheus on METRICS_PORT (loopback of RedPitaya, see RP_METRICS_BIND).
+        """
+        self.sendCommand(GET_STATS, channel=STATS_RESET if reset else 0)
+        self.waitForAnswer(ACK)
+        header = StatsSnapshotHeader.from_buffer_copy(self.rp_tcp.receive_data(sizeof(StatsSnapshotHeader)))
+        if header.magic != STATS_MAGIC:
+            raise ValueError(f"invalid stats-snapshot (magic: {header.magic:#x})")
+        cmds = []
+        if header.no_cmds > 0:
+            cmds = (StatsCmdEntry * header.no_cmds).from_buffer_copy(
+                self.rp_tcp.receive_data(header.no_cmds * sizeof(StatsCmdEntry))
+            )
+        return {
+            "duration_s": (header.t_ns - header.t_start_ns) / 1e9,
+            "commands": {entry.cmd_id: metrics_hist(entry.service) for entry in cmds},
+            "streams": {
+                name: {"bytes": stream.bytes, "packages": stream.packages}
+                for name, stream in zip(METRICS_STREAMS, header.streams)
+            },
+            "ram_overruns": header.ram_overruns,
+            "spi": {
+                name: dict(metrics_hist(spi.latency), transfers=spi.transfers)
+                for name, spi in zip(METRICS_SPI_BOARDS, header.spi)
+            },
+            "trigger_wait": metrics_hist(header.trigger_wait),
+            "trigger_timeouts": header.trigger_timeouts,
+        }
 
     def adjust_lut_value(
         self,
@@ -624,11 +1569,114 @@ class RedPitayaBoard:
 
         time.sleep(cooldown_time_ms / 1000)
 
-    def store_adjusted_lut_to_file(self, bramPort: int):
+    def store_adjusted_lut_to_file(self, bramPort: int, binary: bool = False):
         """
         stores current LUT stored in BRAM @ selected Dac-Bram-Ctrl-Port to .csv-file on RedPitaya
+        (binary: to lut/lut_portX_adj.bin with LutBinHeader + DAC-codes)
+        """
+        self.sendCommand(STORE_LUT, value=LUT_STORE_BIN if binary else LUT_STORE_CSV, channel=bramPort)
+
+    def upload_lut_binary(self, bramPort: int, dacPort: int, codes) -> float:
+        """
+        sends a binary LUT (DAC-codes as they are stored in the BRAM) over the command-socket,
+        RedPitaya writes it directly into the BRAM of the Dac-Bram-Ctrl-Port (replaces
+        send_lut_file() + .csv-parsing on RedPitaya).
+
+        Send it before the BramDacConfig (DAC_BRAM_CONFIG_ID) of the port, the next config
+        then uses the uploaded LUT instead of the .csv-file.
+        The codes can be read back with receive_lut_binary() (e.g. after loading a .csv-LUT once).
+
+        returns the upload-time in s
+        """
+        codes = np.ascontiguousarray(codes, dtype="<u4")
+        return self._upload_lut_bin(bramPort, dacPort, codes, LUT_BIN_VERSION)
+
+    def upload_lut_voltages(self, bramPort: int, dacPort: int, voltages) -> float:
+        """
+        like upload_lut_binary(), but sends the voltages of the LUT (float32), RedPitaya converts
+        them into DAC-codes with the conversion of the .csv-LUTs and the DAC of the last DacConfig.
+        No DAC-specific scaling is needed on the host.
+
+        returns the upload-time in s
         """
-        self.sendCommand(STORE_LUT, channel=bramPort)
+        voltages = np.ascontiguousarray(voltages, dtype="<f4")
+        if not np.isfinite(voltages).all():
+            raise ValueError("LUT-voltages have to be finite")
+        return self._upload_lut_bin(bramPort, dacPort, voltages, LUT_BIN_VERSION_VOLTAGE)
+
+    def _upload_lut_bin(self, bramPort: int, dacPort: int, words, version: int) -> float:
+        # LutBinHeader + 32-bit words (DAC-codes or float32 voltages) with NEW_CONFIG/LUT_CONFIG_ID
+        if not 0 < len(words) <= LUT_BIN_MAX_STEPS:
+            raise ValueError(f"binary LUT needs 1..{LUT_BIN_MAX_STEPS} steps (got {len(words)})")
+        if self.hw_debug:
+            return 0.0
+
+        no_steps = len(words)
+
+        # header + words as one struct -> one send
+        class LutBin(Structure):
+            _pack_ = 1
+            _fields_ = [("header", LutBinHeader), ("words", c_uint32 * no_steps)]
+
+        lut_bin = LutBin()
+        lut_bin.header = LutBinHeader(
+            LUT_BIN_MAGIC, version, bramPort, dacPort, no_steps, zlib.crc32(words.tobytes())
+        )
+        np.frombuffer(lut_bin.words, dtype="<u4")[:] = words.view("<u4")
+
+        t0 = time.perf_counter()
+        self.sendCommand(NEW_CONFIG, value=LUT_CONFIG_ID)
+        self.waitForAnswer(ACK)
+        self.rp_tcp.send_struct(lut_bin)
+        if self.rp_tcp.receive_int() != CONFIG_DONE:
+            raise RuntimeError(f"binary LUT for port {bramPort} was rejected by RedPitaya (header, checksum or voltages)")
+        t_upload = time.perf_counter() - t0
+
+        if self.verbose:
+            kind = "voltages" if version == LUT_BIN_VERSION_VOLTAGE else "codes"
+            print(f"binary LUT with {no_steps} {kind} uploaded in {t_upload * 1e3:.2f} ms")
+        return t_upload
+
+    def receive_lut_binary(self, bramPort: int):
+        """
+        reads the LUT from the BRAM of the Dac-Bram-Ctrl-Port (DAC-codes, size of the last BramDacConfig)
+        returns: (LutBinHeader, np.uint32-array of DAC-codes)
+        """
+        self.sendCommand(GET_LUT_BIN, channel=bramPort)
+        if self.rp_tcp.receive_int() == SERVER_ERROR_ID:
+            raise RuntimeError(f"no valid BRAM-DAC-config for port {bramPort} on RedPitaya")
+
+        header = LutBinHeader.from_buffer_copy(self.rp_tcp.receive_data(sizeof(LutBinHeader)))
+        if header.magic != LUT_BIN_MAGIC:
+            raise ValueError(f"invalid LUT-Header (magic: {header.magic:#x})")
+        data = self.rp_tcp.receive_data(header.no_steps * 4)
+        if zlib.crc32(data) != header.checksum:
+            raise ValueError("checksum-error in received binary LUT")
+        return header, np.frombuffer(data, dtype="<u4").copy()
+
+    @staticmethod
+    def save_lut_binary(path: str, header: LutBinHeader, codes):
+        """
+        stores a binary LUT in the same format as STORE_LUT with LUT_STORE_BIN
+        """
+        with open(path, "wb") as f:
+            f.write(bytes(header))
+            f.write(np.ascontiguousarray(codes, dtype="<u4").tobytes())
+
+    @staticmethod
+    def load_lut_binary(path: str):
+        """
+        loads a binary LUT (.bin-file of save_lut_binary() or STORE_LUT with LUT_STORE_BIN)
+        returns: (LutBinHeader, np.uint32-array of DAC-codes)
+        """
+        with open(path, "rb") as f:
+            header = LutBinHeader.from_buffer_copy(f.read(sizeof(LutBinHeader)))
+            if header.magic != LUT_BIN_MAGIC or header.version != LUT_BIN_VERSION:
+                raise ValueError(f"{path} is no binary LUT (magic: {header.magic:#x}, version: {header.version})")
+            data = f.read(header.no_steps * 4)
+        if len(data) != header.no_steps * 4 or zlib.crc32(data) != header.checksum:
+            raise ValueError(f"{path}: binary LUT is truncated or corrupted")
+        return header, np.frombuffer(data, dtype="<u4").copy()
 
     def send_lut_file(self, lut: LUT):
         """
@@ -733,6 +1781,54 @@ class RedPitayaBoard:
         """
         self.sendCommand(SPI_TEST)
 
+    def set_verbose(self, verbose: bool):
+        """
+        Switch debug-traces of the C-Application on/off at runtime
+        """
+        self.sendCommand(SET_VERBOSE, value=int(verbose))
+        if not (self.hw_debug):
+            self.waitForAnswer(ACK)
+
+    def run_convert_benchmark(self, no_samples: int = 0):
+        """
+        Run benchmark of the conversion-kernels (NEON/scalar) on RedPitaya,
+        results are printed on the console of the C-Application.
+        """
+        self.sendCommand(CONVERT_BENCH, value=no_samples)
+        if not (self.hw_debug):
+            self.waitForAnswer(ACK)
+
+    def run_lia_sw_check(self, no_samples: int = 0) -> dict:
+        """
+        Run the check of the software-LIA on RedPitaya: NEON- against scalar-version on a fixed
+        capture (rp_lia_check.c), the scalar output is compared with lia_sw_reference().
+        Both have to be identical bit by bit.
+        """
+        self.sendCommand(LIA_SW_CHECK, value=no_samples)
+        if self.hw_debug:
+            return {}
+        if self.rp_tcp.receive_int() == SERVER_ERROR_ID:
+            raise RuntimeError("LIA-check failed on RedPitaya")
+
+        header = LiaCheckHeader.from_buffer_copy(self.rp_tcp.receive_data(sizeof(LiaCheckHeader)))
+        if header.magic != LIA_CHECK_MAGIC:
+            raise ValueError(f"invalid LIA-check-header (magic: {header.magic:#x})")
+        words = np.frombuffer(self.rp_tcp.receive_data(4 * header.no_samples), dtype=np.uint32)
+        ref_words = np.frombuffer(self.rp_tcp.receive_data(4 * header.ref_len), dtype=np.uint32)
+        points = np.zeros((0, 2), dtype=np.int32)
+        if header.no_points > 0:
+            points = np.frombuffer(self.rp_tcp.receive_data(8 * header.no_points), dtype=np.int32).reshape(-1, 2)
+
+        reference = lia_sw_reference(words, ref_words, header.iir, header.channel, header.decimation)
+        mismatch = np.flatnonzero((reference != points).any(axis=1)) if reference.shape == points.shape else [0]
+        return {
+            "no_samples": header.no_samples,
+            "no_points": header.no_points,
+            "neon_scalar_identical": header.status == 0,
+            "reference_identical": len(mismatch) == 0,
+            "first_reference_difference": int(mismatch[0]) if len(mismatch) else -1,
+        }
+
     def init_adc24(self):
         """
         Initialise ADC24 at the very beginning by sending dummy data. This ensures that the other configurations (command) sent will be correctly set.
@@ -770,6 +1866,66 @@ class RedPitayaBoard:
 
         return voltage_V
 
+    def start_adc24_scan(self, ch: int, rate_hz: int):
+        """
+        Start background-scanner on RedPitaya which sweeps ADC24Click channel 0..ch
+        with rate_hz sweeps per second and stores timestamped samples in a ring.
+
+        While the scanner runs get_voltage_adc24()/start_seq_sampling_adc24() return the latest
+        samples of the scanner, other SPI-commands are rejected.
+        """
+        self.sendCommand(START_ADC24_SCAN, value=rate_hz, channel=ch)
+        if not (self.hw_debug):
+            if self.rp_tcp.receive_int() != ACK:
+                print("Starting ADC24-Scanner failed")
+                return False
+        return True
+
+    def stop_adc24_scan(self):
+        self.sendCommand(STOP_ADC24_SCAN)
+
+    def get_latest_adc24(self, ch: int):
+        """
+        Latest voltage of channel ch from the ADC24-Scanner (does not wait on the SPI-bus)
+        """
+        self.sendCommand(GET_LATEST_ADC24, channel=ch)
+        if self.hw_debug:
+            return 0
+        return round(fix_sign(self.rp_tcp.receive_int(), MSG_SIZE) * 1e-3, 6)
+
+    def get_window_adc24(self, window_s: float):
+        """
+        All samples of the ADC24-Scanner of the last window_s seconds (oldest first).
+
+        returns numpy structured array with fields:
+            - age_s: age of the sample relative to the request
+            - ch: channel
+            - voltage_V
+            - sweep: no. of the sweep on RedPitaya
+        """
+        dtype = [("age_s", np.float64), ("ch", np.uint8), ("voltage_V", np.float64), ("sweep", np.uint32)]
+        self.sendCommand(GET_WINDOW_ADC24, value=window_s * 1e3)
+        if self.hw_debug:
+            return np.zeros(0, dtype=dtype)
+
+        header = Adc24WindowHeader.from_buffer_copy(
+            self.rp_tcp.receive_data(sizeof(Adc24WindowHeader))
+        )
+        raw = self.rp_tcp.receive_data(header.no_samples * sizeof(Adc24Sample))
+        samples = np.frombuffer(
+            raw,
+            dtype=[("t_ns", "<u8"), ("sweep", "<u4"), ("raw", "<u2"), ("ch", "u1"), ("reserved", "u1")],
+        )
+        if header.truncated:
+            print(f"ADC24-Window truncated to the newest {header.no_samples} samples")
+
+        window = np.zeros(header.no_samples, dtype=dtype)
+        window["age_s"] = (header.now_ns - samples["t_ns"]) * 1e-9
+        window["ch"] = samples["ch"]
+        window["voltage_V"] = samples["raw"] / 4095 * 4.096  # 12-bit, 0..REF_IN (4.096 V)
+        window["sweep"] = samples["sweep"]
+        return window
+
     def init_adc20(self):
         """
         Initialise ADC20 to select all the channels as analog Input, set sampling rate and output format.
@@ -809,6 +1965,44 @@ class RedPitayaBoard:
 
         return voltage_V
     
+    def stream_adc20(self, ch: int, no_packages: int):
+        """
+        Stream raw frames of ADC20Click in sequence mode from channel 0 to ch.
+
+        RedPitaya reads the frames in batches of SPI-transfers and sends no_packages
+        tcp-packages, each with AdcStreamHeader, raw-values (uint16) and channel-ids (uint8).
+        Use init_adc20() before to set the averaging (12-bit raw-values without, 16-bit with averaging).
+
+        returns iterator over (raw, ch_id) as numpy-arrays for each package, header.overruns counts the frames
+        with unexpected channel-id (lost or corrupt frames) on RedPitaya.
+        Raises RuntimeError if RedPitaya could not start the stream or stopped it early.
+        """
+        self.sendCommand(START_STREAM_ADC20, value=no_packages, channel=ch)
+        if self.hw_debug:
+            return iter(())
+        return self._receive_adc20_stream(no_packages)
+
+    def _receive_adc20_stream(self, no_packages: int):
+        for _ in range(no_packages):
+            header = AdcStreamHeader.from_buffer_copy(
+                self.rp_tcp.receive_data(sizeof(AdcStreamHeader))
+            )
+            if header.magic != ADC20_STREAM_MAGIC:
+                raise ValueError(f"invalid ADC20-Stream-Header (magic: {header.magic:#x})")
+            if header.no_samples == 0:
+                # header without frames ends the stream (init or SPI-read failed on RedPitaya)
+                raise RuntimeError(f"ADC20-Stream stopped on RedPitaya after {header.seq} of {no_packages} packages")
+            if header.overruns and self.verbose:
+                print(f"ADC20-Stream: {header.overruns} frames with unexpected channel-id")
+
+            raw = np.frombuffer(
+                self.rp_tcp.receive_data(header.no_samples * 2), dtype=np.uint16
+            )
+            ch_id = np.frombuffer(
+                self.rp_tcp.receive_data(header.no_samples), dtype=np.uint8
+            )
+            yield raw, ch_id
+
     def read_register_adc20(self, reg_addr: int):
         self.sendCommand(READ_REG_ADC20, channel=reg_addr)
         
@@ -0,0 +1,303 @@
+"""
+multiboard.py
+
+Concurrent client for several RedPitayas (asyncio), the sockets of all boards are driven
+by one event-loop, so a group-operation costs the latency of the slowest board instead of
+the sum of all boards:
+
+        - AsyncRedPitaya: one board, same protocol as RedPitayaBoard (commands, configs,
+          continous ADC-stream read with sock_recv_into() into a numpy-array)
+        - BoardGroup: configure_all(), start_dac_sweep(), stop_dac_sweep(), stream_adc_all()
+          on all boards at once
+
+Coordinated start: calibrate() measures the round-trip time of every board, start-commands
+are then sent at t_start - rtt/2 per board (one task per board sleeps till its send-time,
+the event-loop keeps serving the other sockets), so they arrive at about the same time.
+The accuracy is the jitter of the network and the timer of the event-loop (without a
+common clock on the boards).
+
+        async def main():
+            group = await BoardGroup.discover(["10.42.0.1", "10.43.0.1"])
+            await group.configure_all(adc_cfg, ADC_CONFIG_ID)
+            await group.calibrate()
+            data = await group.stream_adc_all(no_packages, pkg_samples, delay_s=0.05)
+            await group.close()
+
+        asyncio.run(main())
+
+Local test with simulated boards: RP_SERVER_PORT=1003 ./sim_server, RP_SERVER_PORT=1004 ...
+and BoardGroup.from_addresses([("127.0.0.1", 1003), ("127.0.0.1", 1004)])
+(multiboard_test.py starts the simulators and runs the group-operations against them)
+"""
+
+import asyncio
+import socket
+import time
+from ctypes import Structure, sizeof
+
+import numpy as np
+
+from rp.constants import (
+    ACK,
+    ADC_STREAM_MAGIC,
+    ALL_BRAM_DAC_PORTS,
+    CONFIG_APPLIED_NONE,
+    CONFIG_DONE,
+    CONFIG_REPORT_APPLIED,
+    GET_DAC_BRAM_SAMPLE_CNT,
+    NEW_CONFIG,
+    START_ADC_SAMPLING,
+    START_DAC_SWEEP,
+    STOP_DAC_SWEEP,
+    TERMINATE_CLIENT,
+)
+from rp.receiver import PackageStatusQueue
+from rp.structs import AdcStreamHeader, TcpCommand
+from rp.misc.helpers import scanPortForDevice
+
+DEFAULT_PORT = 1002
+DEFAULT_CONNECT_TIMEOUT_S = 5.0
+DEFAULT_CALIB_ROUNDS = 20
+
+# command which answers with one int without side-effects, used to measure the round-trip time
+PING_CMD = GET_DAC_BRAM_SAMPLE_CNT
+
+
+class AsyncRedPitaya:
+    """
+    one board, all methods are coroutines
+    """
+
+    def __init__(self, ip: str, port: int = DEFAULT_PORT, name: str = ""):
+        self.ip = ip
+        self.port = port
+        self.name = name or f"{ip}:{port}"
+        self.sock = None
+        self.rtt_s = 0.0  # median round-trip time of the last calibrate()
+        self.adc_stream_overruns = 0
+
+    async def connect(self, timeout: float = DEFAULT_CONNECT_TIMEOUT_S):
+        loop = asyncio.get_running_loop()
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        sock.setblocking(False)
+        try:
+            await asyncio.wait_for(loop.sock_connect(sock, (self.ip, self.port)), timeout)
+        except BaseException:
+            sock.close()
+            raise
+        self.sock = sock
+
+    async def close(self):
+        """
+        closes the client-socket on RedPitaya (TERMINATE_CLIENT) and on the host
+        """
+        if self.sock is None:
+            return
+        try:
+            await self.send_command(TERMINATE_CLIENT)
+        finally:
+            self.sock.close()
+            self.sock = None
+
+    async def send_command(self, cmd_id: int, value: float | int = 0, channel: int = 0):
+        await self.send_struct(TcpCommand(cmd_id, value, channel))
+
+    async def send_struct(self, data: Structure):
+        await asyncio.get_running_loop().sock_sendall(self.sock, bytes(data))
+
+    async def receive_into(self, buf):
+        """
+        fills the writable buffer buf (numpy-array or memoryview) completely
+        """
+        loop = asyncio.get_running_loop()
+        view = memoryview(buf).cast("B")
+        received = 0
+        while received < len(view):
+            n = await loop.sock_recv_into(self.sock, view[received:])
+            if n == 0:
+                raise ConnectionError(f"{self.name}: connection closed by RedPitaya")
+            received += n
+
+    async def receive_int(self) -> int:
+        buf = bytearray(4)
+        await self.receive_into(buf)
+        return int.from_bytes(buf, "little", signed=True)
+
+    async def query(self, cmd_id: int, value: float | int = 0, channel: int = 0) -> int:
+        """
+        command which answers with one int
+        """
+        await self.send_command(cmd_id, value, channel)
+        return await self.receive_int()
+
+    async def wait_for_answer(self, answer_id: int = ACK):
+        response = await self.receive_int()
+        if response != answer_id:
+            raise RuntimeError(f"{self.name}: expected answer {answer_id}, received {response}")
+
+    async def send_config(self, cfg: Structure, config_id: int, report: bool = False):
+        """
+        NEW_CONFIG like RedPitayaBoard.sendConfigParams(), report=True returns (applied, writes)
+        """
+        await self.send_command(NEW_CONFIG, config_id, CONFIG_REPORT_APPLIED if report else 0)
+        await self.wait_for_answer(ACK)
+        await self.send_struct(cfg)
+        reply = await self.receive_int()
+        if reply & 0xFF != CONFIG_DONE:
+            raise RuntimeError(f"{self.name}: config {config_id} was rejected by RedPitaya (reply {reply})")
+        if report:
+            return (reply >> 8) & 0xFF, reply >> 16
+        return CONFIG_APPLIED_NONE, 0
+
+    async def calibrate(self, rounds: int = DEFAULT_CALIB_ROUNDS) -> float:
+        """
+        median round-trip time of PING_CMD in s
+        """
+        samples = np.empty(rounds)
+        for i in range(rounds):
+            t0 = time.perf_counter()
+            await self.query(PING_CMD)
+            samples[i] = time.perf_counter() - t0
+        self.rtt_s = float(np.median(samples))
+        return self.rtt_s
+
+    async def receive_adc_stream(self, no_packages: int, pkg_samples: int):
+        """
+        receives the continous-mode (START_ADC_SAMPLING has to be sent already), returns
+        (np.uint32-array (no_packages, pkg_samples), np.bool-array: package received),
+        lost packages (also packages overwritten while they were sent) stay 0
+        """
+        data = np.zeros((no_packages, pkg_samples), dtype=np.uint32)
+        received = np.zeros(no_packages, dtype=bool)
+        header = np.zeros(sizeof(AdcStreamHeader) // 4, dtype=np.uint32)
+        status = np.zeros(1, dtype=np.uint32)
+        scratch = np.empty(pkg_samples, dtype=np.uint32)
+        status_queue = PackageStatusQueue()
+        seq = -1
+        # the last package ends the stream (lost packages are sent without samples),
+        # the status-word of a package arrives ADC_STREAM_STATUS_LAG packages later
+        while seq + 1 < no_packages or status_queue.pending:
+            if seq + 1 < no_packages:
+                await self.receive_into(header)
+                magic, seq, overruns, no_samples = (int(x) for x in header)
+                if magic != ADC_STREAM_MAGIC or no_samples not in (0, pkg_samples):
+                    raise ValueError(f"{self.name}: invalid ADC-Stream-Header (magic: {magic:#x}, {no_samples} samples)")
+                if no_samples:
+                    await self.receive_into(data[seq] if seq < no_packages else scratch)
+                if seq < no_packages:
+                    received[seq] = no_samples != 0
+                status_queue.push(seq)
+                self.adc_stream_overruns = overruns
+            await self.receive_into(status)
+            done = status_queue.status(int(status[0]))
+            if done is not None and not done[1] and done[0] < no_packages:
+                received[done[0]] = False
+                data[done[0]] = 0
+        return data, received
+
+
+class BoardGroup:
+    """
+    group-operations on several boards, every operation runs on all boards concurrently
+    """
+
+    def __init__(self, boards: list[AsyncRedPitaya]):
+        self.boards = boards
+
+    @classmethod
+    async def from_addresses(cls, addresses, timeout: float = DEFAULT_CONNECT_TIMEOUT_S) -> "BoardGroup":
+        """
+        connects to all (ip, port)-tuples
+        """
+        group = cls([AsyncRedPitaya(ip, port) for ip, port in addresses])
+        await group.connect(timeout)
+        return group
+
+    @classmethod
+    async def discover(cls, host_ips, port: int = DEFAULT_PORT, timeout: float = DEFAULT_CONNECT_TIMEOUT_S):
+        """
+        one board per host-interface (like RedPitayaBoard.scanPortForRedpitaya()),
+        the scans run in parallel threads
+        """
+        ips = await asyncio.gather(
+            *(asyncio.to_thread(scanPortForDevice, host_ip, "RedpitayaBoard") for host_ip in host_ips)
+        )
+        missing = [host_ip for host_ip, ip in zip(host_ips, ips) if not ip]
+        if missing:
+            raise ConnectionError(f"no RedPitaya found at {missing}")
+        return await cls.from_addresses([(ip, port) for ip in ips], timeout)
+
+    async def _all(self, fn):
+        # results in the order of the boards, the first error is raised after all boards are done
+        results = await asyncio.gather(*(fn(board) for board in self.boards), return_exceptions=True)
+        for result in results:
+            if isinstance(result, BaseException):
+                raise result
+        return results
+
+    async def connect(self, timeout: float = DEFAULT_CONNECT_TIMEOUT_S):
+        await self._all(lambda board: board.connect(timeout))
+
+    async def close(self):
+        await self._all(lambda board: board.close())
+
+    async def query_all(self, cmd_id: int, value: float | int = 0, channel: int = 0) -> list:
+        return await self._all(lambda board: board.query(cmd_id, value, channel))
+
+    async def configure_all(self, cfg, config_id: int, report: bool = False) -> list:
+        """
+        sends cfg to all boards (or cfg[i] to board i if cfg is a list),
+        returns (applied, writes) per board (see RedPitayaBoard.sendConfigParams())
+        """
+        cfgs = cfg if isinstance(cfg, (list, tuple)) else [cfg] * len(self.boards)
+        if len(cfgs) != len(self.boards):
+            raise ValueError(f"{len(cfgs)} configs for {len(self.boards)} boards")
+        return await asyncio.gather(
+            *(board.send_config(c, config_id, report) for board, c in zip(self.boards, cfgs))
+        )
+
+    async def calibrate(self, rounds: int = DEFAULT_CALIB_ROUNDS) -> list:
+        """
+        round-trip times (s) of all boards for coordinated starts
+        """
+        return await self._all(lambda board: board.calibrate(rounds))
+
+    async def send_at(self, t_start: float, cmd_id: int, value: float | int = 0, channel: int = 0) -> list:
+        """
+        sends the command to every board at t_start - rtt/2 (time.perf_counter()),
+        returns the send-times relative to t_start
+        """
+
+        async def send(board):
+            delay = t_start - board.rtt_s / 2 - time.perf_counter()
+            if delay > 0:
+                await asyncio.sleep(delay)
+            t_sent = time.perf_counter() - t_start
+            await board.send_command(cmd_id, value, channel)
+            return t_sent
+
+        return await self._all(send)
+
+    async def start_dac_sweep(self, port: int = ALL_BRAM_DAC_PORTS, delay_s: float = 0.0) -> list:
+        """
+        starts the DAC-BRAM-output on all boards, delay_s > 0: coordinated start in delay_s
+        """
+        if delay_s <= 0:
+            await self._all(lambda board: board.send_command(START_DAC_SWEEP, channel=port))
+            return [0.0] * len(self.boards)
+        return await self.send_at(time.perf_counter() + delay_s, START_DAC_SWEEP, channel=port)
+
+    async def stop_dac_sweep(self, port: int = ALL_BRAM_DAC_PORTS):
+        await self._all(lambda board: board.send_command(STOP_DAC_SWEEP, channel=port))
+
+    async def stream_adc_all(self, no_packages: int, pkg_samples: int, delay_s: float = 0.0) -> list:
+        """
+        continous-mode on all boards (AdcConfig with ADC_CONTINOUS_MODE has to be sent),
+        delay_s > 0: coordinated start, returns (data, received) per board
+        """
+        if delay_s > 0:
+            await self.send_at(time.perf_counter() + delay_s, START_ADC_SAMPLING, value=no_packages)
+        else:
+            await self._all(lambda board: board.send_command(START_ADC_SAMPLING, no_packages))
+        return await self._all(lambda board: board.receive_adc_stream(no_packages, pkg_samples))
@@ -0,0 +1,166 @@
+"""
+multiboard_test.py
+
+Test of the multi-board client (multiboard.py) against several simulated boards on one host:
+starts NO_BOARDS instances of the sim_server (rp_sim_server.c) on consecutive ports and runs
+the group-operations of BoardGroup against them:
+
+        - query_all() and calibrate(): every board answers, round-trip times are measured
+        - send_at(): the commands are sent at t_start - rtt/2 per board and the event-loop
+          keeps running meanwhile (no busy-waiting inside the loop)
+        - configure_all() + stream_adc_all(): coordinated continous-mode on all boards,
+          every package of every board is received
+        - close(): TERMINATE_CLIENT on all boards
+
+        python -m rp.multiboard_test --sim-server ./sim_server
+
+exit-code != 0 if a check failed
+"""
+
+import argparse
+import asyncio
+import os
+import socket
+import subprocess
+import sys
+import time
+
+from rp.constants import ADC_CONTINOUS_MODE, ADC_CONFIG_ID, RAM_INIT_CONFIG_ID
+from rp.multiboard import PING_CMD, BoardGroup
+from rp.structs import AdcConfig, RamInitConfig
+
+NO_BOARDS = 3
+BASE_PORT = 1103
+BASE_METRICS_PORT = 9203
+START_TIMEOUT_S = 5.0
+SEND_DELAY_S = 0.05
+SEND_TOLERANCE_S = 0.005  # send-time vs. t_start - rtt/2 (timer of the event-loop)
+TICK_S = 0.001
+MAX_TICK_GAP_S = 0.02  # event-loop blocked longer than this during send_at()
+STREAM_PACKAGES = 50
+STREAM_PKG_SAMPLES = 4096
+RAM_SIZE = 0x100000
+STS_WIDTH_MASK = 0xFFFFF
+SAMPLE_RATE_DIVIDER = 64
+
+no_failed = 0
+
+
+def check(ok: bool, name: str):
+    global no_failed
+    print(f"    {name:<58} {'ok' if ok else 'FAILED'}")
+    if not ok:
+        no_failed += 1
+
+
+def start_simulators(sim_server: str) -> list:
+    """
+    one sim_server per board (own server- and metrics-port), waits till all of them accept connections
+    """
+    procs = []
+    for i in range(NO_BOARDS):
+        env = dict(os.environ, RP_SERVER_PORT=str(BASE_PORT + i), RP_METRICS_PORT=str(BASE_METRICS_PORT + i))
+        procs.append(subprocess.Popen([sim_server], env=env, stdout=subprocess.DEVNULL, stderr=subprocess.STDOUT))
+
+    deadline = time.monotonic() + START_TIMEOUT_S
+    for i in range(NO_BOARDS):
+        while True:
+            try:
+                socket.create_connection(("127.0.0.1", BASE_PORT + i), timeout=0.1).close()
+                break
+            except OSError:
+                if time.monotonic() > deadline or procs[i].poll() is not None:
+                    stop_simulators(procs)
+                    raise RuntimeError(f"simulator on port {BASE_PORT + i} did not start")
+                time.sleep(0.05)
+    return procs
+
+
+def stop_simulators(procs: list):
+    for proc in procs:
+        proc.terminate()
+    for proc in procs:
+        try:
+            proc.wait(timeout=START_TIMEOUT_S)
+        except subprocess.TimeoutExpired:
+            proc.kill()
+
+
+async def test_queries(group: BoardGroup):
+    print("--- query_all / calibrate ---")
+    replies = await group.query_all(PING_CMD)
+    check(len(replies) == NO_BOARDS, f"{NO_BOARDS} boards answered")
+    rtts = await group.calibrate()
+    check(all(rtt > 0 for rtt in rtts), f"round-trip times measured ({max(rtts) * 1e6:.0f} us max.)")
+
+
+async def test_send_at(group: BoardGroup):
+    print("--- send_at ---")
+    # a ticker measures the largest gap of the event-loop while the sends are scheduled
+    gaps = []
+
+    async def ticker():
+        t_last = time.perf_counter()
+        while True:
+            await asyncio.sleep(TICK_S)
+            t = time.perf_counter()
+            gaps.append(t - t_last)
+            t_last = t
+
+    tick_task = asyncio.create_task(ticker())
+    sent = await group.send_at(time.perf_counter() + SEND_DELAY_S, PING_CMD)
+    tick_task.cancel()
+    await group._all(lambda board: board.receive_int())
+
+    errors = [abs(t_sent + board.rtt_s / 2) for t_sent, board in zip(sent, group.boards)]
+    check(max(errors) < SEND_TOLERANCE_S, f"send-times at t_start - rtt/2 ({max(errors) * 1e3:.2f} ms max. error)")
+    check(len(gaps) > 0 and max(gaps) < MAX_TICK_GAP_S, f"event-loop not blocked ({max(gaps, default=0) * 1e3:.1f} ms max. gap)")
+
+
+async def test_stream(group: BoardGroup):
+    print("--- configure_all / stream_adc_all ---")
+    ram_cfg = RamInitConfig(
+        STS_WIDTH_MASK, STREAM_PKG_SAMPLES, STREAM_PKG_SAMPLES * 4, RAM_SIZE, RAM_SIZE * 4
+    )
+    adc_cfg = AdcConfig()
+    adc_cfg.sample_rate_divider = SAMPLE_RATE_DIVIDER
+    adc_cfg.adc_mode = ADC_CONTINOUS_MODE
+    await group.configure_all(ram_cfg, RAM_INIT_CONFIG_ID)
+    await group.configure_all(adc_cfg, ADC_CONFIG_ID)
+
+    results = await group.stream_adc_all(STREAM_PACKAGES, STREAM_PKG_SAMPLES, delay_s=SEND_DELAY_S)
+    check(len(results) == NO_BOARDS, f"stream of {NO_BOARDS} boards")
+    for board, (data, received) in zip(group.boards, results):
+        check(received.all() and data.any(), f"{board.name}: {int(received.sum())}/{STREAM_PACKAGES} packages")
+    # the command-socket of every board is usable after the stream
+    replies = await group.query_all(PING_CMD)
+    check(len(replies) == NO_BOARDS, "boards answer after the stream")
+
+
+async def run_tests():
+    group = await BoardGroup.from_addresses([("127.0.0.1", BASE_PORT + i) for i in range(NO_BOARDS)])
+    try:
+        await test_queries(group)
+        await test_send_at(group)
+        await test_stream(group)
+    finally:
+        await group.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="BoardGroup against several simulated RedPitayas")
+    parser.add_argument("--sim-server", default="./sim_server", help="path of the sim_server binary")
+    args = parser.parse_args()
+
+    print(f"##### Multiboard-Test with {NO_BOARDS} simulators #####")
+    procs = start_simulators(args.sim_server)
+    try:
+        asyncio.run(run_tests())
+    finally:
+        stop_simulators(procs)
+    print(f"{'PASSED' if no_failed == 0 else 'FAILED'}: {no_failed} check(s) failed")
+    sys.exit(0 if no_failed == 0 else 1)
+
+
+if __name__ == "__main__":
+    main()
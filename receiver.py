@@ -0,0 +1,246 @@
+"""
+receiver.py
+
+Background-Receiver for the continous ADC-Stream (ADC_CONTINOUS_MODE, raw packages):
+
+        - a thread reads the packages with socket.recv_into() directly into a preallocated
+          numpy-ring (one row per package), no bytes-objects and no copy per package
+        - recv_into() releases the GIL while it waits, so the main-thread can process
+          the previous packages meanwhile
+        - the packages are handed out as views into the ring (iterator or callback),
+          a slot is reused only after it was released by the consumer
+
+If the consumer is slower than the stream:
+        - drop=False (default): the receiver waits for a free slot and stops reading the socket,
+          TCP-backpressure reaches RedPitaya which counts lost packages as overruns
+        - drop=True: the package is read into a scratch-slot and dropped on the host,
+          so the socket never stalls
+
+Packages lost on RedPitaya (sent without samples) or overwritten while they were sent
+(status-word ADC_BLOCK_TORN) are not handed out, they are gaps in seq. The status-word of a
+package arrives ADC_STREAM_STATUS_LAG packages later (PackageStatusQueue), till then it
+occupies its slot.
+
+Counters: host_dropped, backpressure_waits (times the ring was full), board_overruns (from
+the AdcStreamHeader), bytes_received
+"""
+
+import socket
+import threading
+from collections import deque
+from ctypes import sizeof
+
+import numpy as np
+
+from rp.constants import ADC_BLOCK_OK, ADC_STREAM_MAGIC, ADC_STREAM_STATUS_LAG
+from rp.structs import AdcStreamHeader
+
+DEFAULT_RING_SLOTS = 32
+
+# AdcStreamHeader as uint32-words (magic, seq, overruns, no_samples)
+HEADER_WORDS = sizeof(AdcStreamHeader) // 4
+
+
+def recv_into_exactly(sock: socket.socket, buf) -> None:
+    """
+    fills the writable buffer buf (numpy-array or memoryview) completely from sock
+    """
+    view = memoryview(buf).cast("B")
+    received = 0
+    while received < len(view):
+        n = sock.recv_into(view[received:])
+        if n == 0:
+            raise ConnectionError("connection closed by RedPitaya")
+        received += n
+
+
+class PackageStatusQueue:
+    """
+    packages of the continous- and multi-block-mode waiting for their status-word: the word after
+    the i-th package sent belongs to package i - ADC_STREAM_STATUS_LAG (filler before),
+    ADC_STREAM_STATUS_LAG more words follow the last package
+
+        queue.push(package)
+        done = queue.status(word)  # (package, ok) or None
+    """
+
+    def __init__(self):
+        self.pending = deque()
+        self.words = 0
+
+    def push(self, package):
+        self.pending.append(package)
+
+    def status(self, word: int):
+        """
+        returns (package, ok) for the package the word belongs to, None for a filler
+        """
+        idx = self.words - ADC_STREAM_STATUS_LAG
+        self.words += 1
+        if idx < 0:
+            return None
+        return self.pending.popleft(), word == ADC_BLOCK_OK
+
+
+class AdcStreamReceiver:
+    """
+    receives no_packages raw packages with pkg_samples 32-bit samples each from sock
+    (START_ADC_SAMPLING has to be sent already)
+
+    iterator:
+        for seq, data in receiver:      # data: np.uint32-view, valid till the next iteration
+            ...                         # (all packages have to be consumed, they are in the socket)
+
+    callback (called on the receiver-thread, data is only valid inside the callback):
+        receiver = AdcStreamReceiver(sock, pkg_samples, no_packages, callback=fn)
+        receiver.join()
+    """
+
+    def __init__(
+        self,
+        sock: socket.socket,
+        pkg_samples: int,
+        no_packages: int,
+        ring_slots: int = DEFAULT_RING_SLOTS,
+        drop: bool = False,
+        callback=None,
+    ):
+        if pkg_samples <= 0 or no_packages <= 0 or ring_slots <= ADC_STREAM_STATUS_LAG:
+            raise ValueError(f"invalid receiver-config ({pkg_samples} samples, {no_packages} packages, {ring_slots} slots)")
+        self.sock = sock
+        self.pkg_samples = pkg_samples
+        self.no_packages = no_packages
+        self.drop = drop
+        self.callback = callback
+
+        # one extra row as scratch-slot for dropped packages
+        self._ring = np.empty((ring_slots + 1, pkg_samples), dtype=np.uint32)
+        self._headers = np.zeros((ring_slots + 1, HEADER_WORDS), dtype=np.uint32)
+        self._status = np.zeros(1, dtype=np.uint32)
+        self._valid = np.zeros(ring_slots + 1, dtype=bool)  # False: torn package, released unseen
+        self._slots = ring_slots
+        self._head = 0  # packages written by the receiver
+        self._tail = 0  # packages released by the consumer
+        self._done = False
+        self._error = None
+        self._cond = threading.Condition()
+
+        self.host_dropped = 0
+        self.backpressure_waits = 0
+        self.board_overruns = 0
+        self.bytes_received = 0
+        self.last_seq = -1
+
+        self._thread = threading.Thread(target=self._run, name="rp-adc-receiver", daemon=True)
+        self._thread.start()
+
+    def _run(self):
+        status_queue = PackageStatusQueue()  # (slot or None, no_samples) per package
+        pending_slots = 0  # slots of packages waiting for their status-word
+        try:
+            # the last package ends the stream (seq counts lost packages as well),
+            # the status-words of the last packages follow it
+            while self.last_seq + 1 < self.no_packages or status_queue.pending:
+                if self.last_seq + 1 < self.no_packages:
+                    with self._cond:
+                        full = self._head + pending_slots - self._tail >= self._slots
+                        if full:
+                            self.backpressure_waits += 1
+                            if not self.drop:
+                                self._cond.wait_for(lambda: self._head + pending_slots - self._tail < self._slots)
+                                full = False
+                    slot = self._slots if full else (self._head + pending_slots) % self._slots
+
+                    recv_into_exactly(self.sock, self._headers[slot])
+                    magic, seq, overruns, no_samples = (int(x) for x in self._headers[slot])
+                    if magic != ADC_STREAM_MAGIC or no_samples not in (0, self.pkg_samples):
+                        raise ValueError(f"invalid ADC-Stream-Header (magic: {magic:#x}, {no_samples} samples)")
+                    if no_samples:
+                        recv_into_exactly(self.sock, self._ring[slot])
+                    self.bytes_received += sizeof(AdcStreamHeader) + self._ring.itemsize * no_samples
+                    self.board_overruns = overruns
+                    self.last_seq = seq
+
+                    # lost packages (and dropped ones) don't keep a slot
+                    if full or no_samples == 0:
+                        slot = None
+                    else:
+                        pending_slots += 1
+                    status_queue.push((slot, no_samples))
+
+                recv_into_exactly(self.sock, self._status)
+                self.bytes_received += self._status.nbytes
+                done = status_queue.status(int(self._status[0]))
+                if done is None:
+                    continue
+                (slot, no_samples), ok = done
+                if no_samples and not ok:
+                    # overwritten while it was sent, in the overruns of the next header as well
+                    self.board_overruns += 1
+                if slot is None:
+                    if no_samples and ok:
+                        self.host_dropped += 1
+                    continue
+
+                pending_slots -= 1
+                self._valid[slot] = ok
+                if self.callback is not None:
+                    if ok:
+                        self.callback(int(self._headers[slot][1]), self._ring[slot])
+                    with self._cond:
+                        self._head += 1
+                        self._tail += 1
+                else:
+                    with self._cond:
+                        self._head += 1
+                        self._cond.notify_all()
+        except Exception as e:  # handed to the consumer
+            self._error = e
+        finally:
+            with self._cond:
+                self._done = True
+                self._cond.notify_all()
+
+    def __iter__(self):
+        if self.callback is not None:
+            raise RuntimeError("receiver was started with a callback")
+        while True:
+            with self._cond:
+                self._cond.wait_for(lambda: self._head > self._tail or self._done)
+                if self._head == self._tail:
+                    break
+                slot = self._tail % self._slots
+            try:
+                if self._valid[slot]:
+                    yield int(self._headers[slot][1]), self._ring[slot]
+            finally:
+                # consumer is done with the view -> slot can be reused
+                with self._cond:
+                    self._tail += 1
+                    self._cond.notify_all()
+        if self._error is not None:
+            raise self._error
+
+    def join(self, timeout: float | None = None):
+        """
+        waits for the end of the stream, raises the error of the receiver-thread
+        """
+        self._thread.join(timeout)
+        if self._error is not None:
+            raise self._error
+
+    @property
+    def backlog(self) -> int:
+        """
+        packages received but not released by the consumer yet
+        """
+        return self._head - self._tail
+
+    def stats(self) -> dict:
+        return {
+            "bytes_received": self.bytes_received,
+            "last_seq": self.last_seq,
+            "board_overruns": self.board_overruns,
+            "host_dropped": self.host_dropped,
+            "backpressure_waits": self.backpressure_waits,
+        }
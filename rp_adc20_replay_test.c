@@ -0,0 +1,167 @@
+/*
+ * rp_adc20_replay_test.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Test of the ADC20-Stream (adc20click.c) with a replayed frame-file (ADC20_REPLAY_FILE),
+ *    no Click Board or spidev is needed:
+ *
+ *     -- 12-bit and averaged 16-bit frames are decoded to the raw-values and channel-ids
+ *        they were generated from, also across the restart at the end of the file
+ *     -- a lost frame is counted once in ch_errors
+ *     -- the capture-file (ADC20_CAPTURE_FILE) holds exactly the frames which were read
+ *     -- empty or missing replay-files end the stream with an error
+ *
+ *    usage: ./adc20_replay_test   (exit-code != 0 if a check failed)
+ */
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "adc20click.h"
+
+#define REPLAY_STOP_CH 3
+#define REPLAY_NO_FRAMES 1000  // no multiple of ADC20_STREAM_MAX_XFERS, multiple of the sequence-length
+#define REPLAY_LOST_FRAME 5
+
+static int no_failed = 0;
+
+static void check(bool ok, const char* name) {
+    printf("    %-58s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) no_failed++;
+}
+
+static uint16_t frame_raw(int i, int average) {
+    return (uint16_t)((i * 37 + 11) & (average ? 0xFFFF : 0x0FFF));
+}
+
+static uint8_t frame_ch(int i) {
+    return (uint8_t)(i % (REPLAY_STOP_CH + 1));
+}
+
+static void encode_frame(uint8_t* frame, uint16_t raw, uint8_t ch, int average) {
+    // output-format of the ADC with appended channel-id (see adc20_decode_frames)
+    if (!average) {
+        frame[0] = (uint8_t)(raw >> 4);
+        frame[1] = (uint8_t)((raw & 0x0F) << 4) | ch;
+        frame[2] = 0;
+    } else {
+        frame[0] = (uint8_t)(raw >> 8);
+        frame[1] = (uint8_t)raw;
+        frame[2] = (uint8_t)(ch << 4);
+    }
+}
+
+static int write_frames(const char* path, int no_frames, int average, int lost_frame) {
+    // frames 0..no_frames-1 without lost_frame (-1: none), returns the no. of frames written
+    uint8_t frame[ADC20_FRAME_SIZE];
+    int no_written = 0;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    for (int i = 0; i < no_frames; i++) {
+        if (i == lost_frame) continue;
+        encode_frame(frame, frame_raw(i, average), frame_ch(i), average);
+        if (write(fd, frame, sizeof(frame)) != (ssize_t)sizeof(frame)) break;
+        no_written++;
+    }
+    close(fd);
+    return no_written;
+}
+
+static void test_decode(const char* replay_path, const char* capture_path, int average) {
+    // two packages: the second one starts inside the file and wraps around its end
+    static uint16_t raw[ADC20_STREAM_FRAMES_PER_PKG];
+    static uint8_t ch_id[ADC20_STREAM_FRAMES_PER_PKG];
+    Adc20Stream stream;
+    bool values_ok = true;
+    int no_frames = 0;
+
+    printf("--- %s frames ---\n", average ? "averaged 16-bit" : "12-bit");
+    write_frames(replay_path, REPLAY_NO_FRAMES, average, -1);
+    check(adc20_stream_init(&stream, -1, REPLAY_STOP_CH, average, replay_path, capture_path) == 0, "stream started with replay-file");
+
+    for (int pkg = 0; pkg < 2; pkg++) {
+        if (adc20_stream_read(&stream, raw, ch_id, ADC20_STREAM_FRAMES_PER_PKG) != ADC20_STREAM_FRAMES_PER_PKG) {
+            values_ok = false;
+            break;
+        }
+        for (int i = 0; i < ADC20_STREAM_FRAMES_PER_PKG; i++, no_frames++) {
+            int k = no_frames % REPLAY_NO_FRAMES;
+            if (raw[i] != frame_raw(k, average) || ch_id[i] != frame_ch(k)) values_ok = false;
+        }
+    }
+    check(values_ok, "raw-values and channel-ids of 2 packages");
+    check(stream.ch_errors == 0, "no channel-id errors across the end of the file");
+    adc20_stream_close(&stream);
+
+    // capture holds the frames in the order they were read (the replay-file repeated)
+    FILE* f = fopen(capture_path, "rb");
+    bool capture_ok = f != NULL;
+    uint8_t frame[ADC20_FRAME_SIZE], expected[ADC20_FRAME_SIZE];
+    for (int i = 0; capture_ok && i < no_frames; i++) {
+        encode_frame(expected, frame_raw(i % REPLAY_NO_FRAMES, average), frame_ch(i % REPLAY_NO_FRAMES), average);
+        capture_ok = fread(frame, 1, sizeof(frame), f) == sizeof(frame) && memcmp(frame, expected, sizeof(frame)) == 0;
+    }
+    capture_ok = capture_ok && fread(frame, 1, 1, f) == 0;  // nothing more
+    if (f != NULL) fclose(f);
+    check(capture_ok, "capture-file equals the frames read");
+}
+
+static void test_lost_frame(const char* replay_path) {
+    static uint16_t raw[REPLAY_NO_FRAMES];
+    static uint8_t ch_id[REPLAY_NO_FRAMES];
+    Adc20Stream stream;
+
+    printf("--- lost frame ---\n");
+    int no_frames = write_frames(replay_path, REPLAY_NO_FRAMES, 0, REPLAY_LOST_FRAME);
+    adc20_stream_init(&stream, -1, REPLAY_STOP_CH, 0, replay_path, NULL);
+    check(adc20_stream_read(&stream, raw, ch_id, no_frames) == no_frames, "all frames of the file read");
+    check(stream.ch_errors == 1, "lost frame counted once");
+    check(raw[REPLAY_LOST_FRAME] == frame_raw(REPLAY_LOST_FRAME + 1, 0), "stream continues with the next frame");
+    adc20_stream_close(&stream);
+}
+
+static void test_invalid_files(const char* replay_path) {
+    uint16_t raw[4];
+    uint8_t ch_id[4];
+    Adc20Stream stream;
+
+    printf("--- invalid replay-files ---\n");
+    write_frames(replay_path, 0, 0, -1);
+    check(adc20_stream_init(&stream, -1, REPLAY_STOP_CH, 0, replay_path, NULL) == 0 &&
+              adc20_stream_read(&stream, raw, ch_id, 4) < 0,
+          "empty replay-file ends the stream");
+    adc20_stream_close(&stream);
+
+    unlink(replay_path);
+    check(adc20_stream_init(&stream, -1, REPLAY_STOP_CH, 0, replay_path, NULL) < 0, "missing replay-file is rejected");
+}
+
+int main(void) {
+    char replay_path[] = "/tmp/adc20_replay_XXXXXX";
+    char capture_path[] = "/tmp/adc20_capture_XXXXXX";
+    int fd_replay = mkstemp(replay_path);
+    int fd_capture = mkstemp(capture_path);
+    if (fd_replay < 0 || fd_capture < 0) {
+        printf("Creating temporary files failed\n");
+        return EXIT_FAILURE;
+    }
+    close(fd_replay);
+    close(fd_capture);
+
+    printf("##### ADC20-Replay-Test #####\n");
+    test_decode(replay_path, capture_path, 0);
+    test_decode(replay_path, capture_path, 1);
+    test_lost_frame(replay_path);
+    test_invalid_files(replay_path);
+
+    unlink(replay_path);
+    unlink(capture_path);
+    printf("%s: %d check(s) failed\n", (no_failed == 0) ? "PASSED" : "FAILED", no_failed);
+    return (no_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
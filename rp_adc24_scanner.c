@@ -0,0 +1,233 @@
+/*
+ * rp_adc24_scanner.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Background-scanner for the ADC24 Click, see rp_adc24_scanner.h
+ */
+
+#include "rp_adc24_scanner.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+
+#include "rp_metrics.h"
+
+#define ADC24_VOLTAGE_RANGE_MV 4096
+#define ADC24_RAW_MAX 4095
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+static int adc24_write_ctrl(int spi_fd, uint16_t ctrl) {
+    // one frame with the control-word, MSB first
+    uint8_t tx[2] = {(uint8_t)(ctrl >> 8), (uint8_t)ctrl};
+    uint8_t rx[2];
+    struct spi_ioc_transfer xfer;
+
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.tx_buf = (unsigned long)tx;
+    xfer.rx_buf = (unsigned long)rx;
+    xfer.len = sizeof(tx);
+    if (metrics_spi_message(METRICS_SPI_ADC24, spi_fd, 1, &xfer) < 0) {
+        printf("Writing ADC24 control-register failed: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int adc24_scan_sweep(Adc24Scanner* scanner, uint32_t sweep) {
+    // read one sweep (channel 0..stop_ch) with one SPI-message and store it in the ring
+    int no_ch = scanner->stop_ch + 1;
+    Adc24Sample samples[ADC24_SCAN_NO_CHANNELS];
+
+    if (metrics_spi_message(METRICS_SPI_ADC24, scanner->spi_fd, no_ch, scanner->xfers) < 0) {
+        printf("Reading ADC24 sweep failed: %s\n", strerror(errno));
+        return -1;
+    }
+    uint64_t t_ns = now_ns();
+
+    for (int i = 0; i < no_ch; i++) {
+        uint16_t frame = ((uint16_t)scanner->rx_buf[i][0] << 8) | scanner->rx_buf[i][1];
+        samples[i].t_ns = t_ns;
+        samples[i].sweep = sweep;
+        samples[i].raw = frame & ADC24_RAW_MASK;
+        samples[i].ch = (uint8_t)(frame >> 12);  // channel-address in front of the data
+        samples[i].reserved = 0;
+    }
+
+    pthread_mutex_lock(&scanner->lock);
+    for (int i = 0; i < no_ch; i++) {
+        scanner->ring[scanner->ring_head & (ADC24_SCAN_RING_SIZE - 1)] = samples[i];
+        scanner->ring_head++;
+        scanner->latest[samples[i].ch] = samples[i];
+    }
+    scanner->no_sweeps = sweep + 1;
+    pthread_mutex_unlock(&scanner->lock);
+    return 0;
+}
+
+static void* adc24_scan_thread(void* arg) {
+    Adc24Scanner* scanner = (Adc24Scanner*)arg;
+    struct timespec next;
+    long period_ns = 1000000000L / scanner->rate_hz;
+    uint32_t sweep = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!scanner->stop) {
+        if (adc24_scan_sweep(scanner, sweep++) < 0) break;
+
+        // fixed rate: sleep till the start of the next period
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000L) {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        struct timespec t;
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        if (t.tv_sec > next.tv_sec || (t.tv_sec == next.tv_sec && t.tv_nsec > next.tv_nsec)) {
+            // sweep took longer than one period, restart timing instead of catching up
+            pthread_mutex_lock(&scanner->lock);
+            scanner->no_late++;
+            pthread_mutex_unlock(&scanner->lock);
+            next = t;
+            continue;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+    return NULL;
+}
+
+int adc24_scanner_start(Adc24Scanner* scanner, int spi_fd, int stop_ch, int rate_hz) {
+    if (scanner->running) {
+        printf("ADC24-Scanner is already running\n");
+        return -1;
+    }
+    if (spi_fd < 0) {
+        printf("SPI interface is not configured (SPI_CONFIG_ID)\n");
+        return -1;
+    }
+    if (stop_ch < 0 || stop_ch >= ADC24_SCAN_NO_CHANNELS) {
+        printf("**Invalid stop channel: %d**\n", stop_ch);
+        return -1;
+    }
+    if (rate_hz < 1 || rate_hz > ADC24_SCAN_MAX_RATE_HZ) {
+        printf("**Invalid scan-rate: %d Hz (1..%d Hz)**\n", rate_hz, ADC24_SCAN_MAX_RATE_HZ);
+        return -1;
+    }
+
+    memset(scanner, 0, sizeof(Adc24Scanner));
+    scanner->spi_fd = spi_fd;
+    scanner->stop_ch = stop_ch;
+    scanner->rate_hz = rate_hz;
+    scanner->ring = calloc(ADC24_SCAN_RING_SIZE, sizeof(Adc24Sample));
+    if (scanner->ring == NULL) {
+        printf("Allocating ADC24-Scanner ring failed\n");
+        return -1;
+    }
+
+    // one transfer per channel, DIN low keeps the sequence running
+    for (int i = 0; i <= stop_ch; i++) {
+        scanner->xfers[i].tx_buf = (unsigned long)scanner->tx_buf[i];
+        scanner->xfers[i].rx_buf = (unsigned long)scanner->rx_buf[i];
+        scanner->xfers[i].len = 2;
+        scanner->xfers[i].cs_change = (i < stop_ch);
+    }
+
+    // sequence-mode over channel 0..stop_ch
+    uint16_t ctrl = ADC24_CTRL_WRITE | ADC24_CTRL_SEQ | ((uint16_t)stop_ch << ADC24_CTRL_ADD_SHIFT) |
+                    ADC24_CTRL_PM_NORMAL | ADC24_CTRL_RANGE_REF | ADC24_CTRL_CODING_BIN;
+    if (adc24_write_ctrl(spi_fd, ctrl) < 0) {
+        free(scanner->ring);
+        scanner->ring = NULL;
+        return -1;
+    }
+
+    pthread_mutex_init(&scanner->lock, NULL);
+    if (pthread_create(&scanner->thread, NULL, adc24_scan_thread, scanner) != 0) {
+        printf("Starting ADC24-Scanner thread failed\n");
+        pthread_mutex_destroy(&scanner->lock);
+        free(scanner->ring);
+        scanner->ring = NULL;
+        return -1;
+    }
+    scanner->running = true;
+    printf("ADC24-Scanner started: channel 0..%d with %d sweeps/s\n", stop_ch, rate_hz);
+    return 0;
+}
+
+void adc24_scanner_stop(Adc24Scanner* scanner) {
+    if (!scanner->running) return;
+
+    scanner->stop = true;
+    pthread_join(scanner->thread, NULL);
+    scanner->running = false;
+
+    // leave sequence-mode, next frames convert channel 0 again
+    adc24_write_ctrl(scanner->spi_fd, ADC24_CTRL_WRITE | ADC24_CTRL_PM_NORMAL | ADC24_CTRL_RANGE_REF | ADC24_CTRL_CODING_BIN);
+    printf("ADC24-Scanner stopped after %u sweeps (%u late)\n", scanner->no_sweeps, scanner->no_late);
+
+    pthread_mutex_destroy(&scanner->lock);
+    free(scanner->ring);
+    scanner->ring = NULL;
+}
+
+bool adc24_scanner_is_running(Adc24Scanner* scanner) {
+    return scanner->running;
+}
+
+int adc24_scanner_latest(Adc24Scanner* scanner, int ch, Adc24Sample* sample) {
+    // latest sample of channel ch, -1 if scanner is not running or channel not sampled yet
+    if (!scanner->running || ch < 0 || ch > scanner->stop_ch) return -1;
+
+    pthread_mutex_lock(&scanner->lock);
+    *sample = scanner->latest[ch];
+    pthread_mutex_unlock(&scanner->lock);
+    return (sample->t_ns != 0) ? 0 : -1;
+}
+
+uint32_t adc24_scanner_window(Adc24Scanner* scanner, uint64_t window_ns, Adc24Sample* samples, uint32_t max_samples,
+                              Adc24WindowHeader* header) {
+    // copies all samples of the last window_ns (oldest first), returns the no. of samples
+    memset(header, 0, sizeof(Adc24WindowHeader));
+    header->now_ns = now_ns();
+    if (!scanner->running) return 0;
+
+    uint64_t t_min = (header->now_ns > window_ns) ? header->now_ns - window_ns : 0;
+
+    pthread_mutex_lock(&scanner->lock);
+    uint64_t head = scanner->ring_head;
+    uint64_t available = (head < ADC24_SCAN_RING_SIZE) ? head : ADC24_SCAN_RING_SIZE;
+    uint32_t n = 0;
+
+    // search the start of the window from the newest sample backwards
+    while (n < available && scanner->ring[(head - n - 1) & (ADC24_SCAN_RING_SIZE - 1)].t_ns >= t_min) {
+        n++;
+    }
+    // window is older than the ring or bigger than the response -> newest samples are returned
+    if (n == available && head > available) header->truncated = 1;
+    if (n > max_samples) {
+        n = max_samples;
+        header->truncated = 1;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        samples[i] = scanner->ring[(head - n + i) & (ADC24_SCAN_RING_SIZE - 1)];
+    }
+    header->no_late = scanner->no_late;
+    pthread_mutex_unlock(&scanner->lock);
+
+    header->no_samples = n;
+    return n;
+}
+
+int adc24_raw_to_mV(uint16_t raw) {
+    return (int)((raw * ADC24_VOLTAGE_RANGE_MV) / ADC24_RAW_MAX);
+}
@@ -0,0 +1,74 @@
+/*
+ * rp_adc24_scanner.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Background-scanner for the ADC24 Click (AD7490, 16 channels, 12-bit):
+ *
+ *     -- a thread sweeps channel 0..stop_ch in sequence-mode with a fixed rate,
+ *        one SPI_IOC_MESSAGE per sweep
+ *
+ *     -- every sample is stored with CLOCK_MONOTONIC-timestamp in a ring which overwrites
+ *        the oldest samples, the latest sample of each channel is kept separately
+ *
+ *     -- readers (command-handler) only copy from the ring under a short lock,
+ *        so a request from the host never waits on the SPI-bus
+ *
+ *    While the scanner is running it owns the SPI-bus, other SPI-commands are rejected.
+ */
+
+#ifndef SRC_RP_ADC24_SCANNER_H
+#define SRC_RP_ADC24_SCANNER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <linux/spi/spidev.h>
+
+#include "rp_structs.h"
+
+#define ADC24_SCAN_NO_CHANNELS 16
+#define ADC24_SCAN_RING_SIZE 65536      // samples, power of two
+#define ADC24_SCAN_MAX_RATE_HZ 20000    // max. sweeps per second
+#define ADC24_SCAN_MAX_WINDOW_SAMPLES 16384  // max. samples returned by one window-request
+
+// AD7490 control-register (upper 12 bits of the 16-bit frame)
+#define ADC24_CTRL_WRITE (1 << 15)
+#define ADC24_CTRL_SEQ (1 << 14)
+#define ADC24_CTRL_ADD_SHIFT 10
+#define ADC24_CTRL_PM_NORMAL (3 << 8)
+#define ADC24_CTRL_RANGE_REF (1 << 5)   // input range 0..REF_IN
+#define ADC24_CTRL_CODING_BIN (1 << 4)  // straight binary output
+#define ADC24_RAW_MASK 0x0FFF
+
+typedef struct {
+    int spi_fd;
+    int stop_ch;
+    int rate_hz;  // sweeps per second
+
+    pthread_t thread;
+    bool running;
+    volatile bool stop;
+
+    // ring with all samples, written only by the scanner-thread
+    pthread_mutex_t lock;
+    Adc24Sample* ring;
+    uint64_t ring_head;  // total no. of samples written (slot = head & (size-1))
+    Adc24Sample latest[ADC24_SCAN_NO_CHANNELS];
+    uint32_t no_sweeps;
+    uint32_t no_late;    // sweeps which missed their period (SPI slower than rate)
+
+    struct spi_ioc_transfer xfers[ADC24_SCAN_NO_CHANNELS];
+    uint8_t rx_buf[ADC24_SCAN_NO_CHANNELS][2];
+    uint8_t tx_buf[ADC24_SCAN_NO_CHANNELS][2];
+} Adc24Scanner;
+
+int adc24_scanner_start(Adc24Scanner* scanner, int spi_fd, int stop_ch, int rate_hz);
+void adc24_scanner_stop(Adc24Scanner* scanner);
+bool adc24_scanner_is_running(Adc24Scanner* scanner);
+int adc24_scanner_latest(Adc24Scanner* scanner, int ch, Adc24Sample* sample);
+uint32_t adc24_scanner_window(Adc24Scanner* scanner, uint64_t window_ns, Adc24Sample* samples, uint32_t max_samples,
+                              Adc24WindowHeader* header);
+int adc24_raw_to_mV(uint16_t raw);
+
+#endif
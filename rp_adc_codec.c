@@ -0,0 +1,210 @@
+/*
+ * rp_adc_codec.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Delta/zigzag + bit-plane packing of RF-ADC-packages, see rp_adc_codec.h
+ *
+ *    NEON: one block (16 values) is held in two q-registers, the deltas are built with
+ *    vext (previous sample in lane 7 of the last register), a bit-plane is extracted with
+ *    and/narrow/shift and summed to two bytes with vpadd.
+ */
+
+#include "rp_adc_codec.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#include "rp_convert.h"
+
+static inline int16_t sign_extend_14bit(uint16_t raw) {
+    return (int16_t)(uint16_t)(raw << (16 - RF_ADC_BITS)) >> (16 - RF_ADC_BITS);
+}
+
+static inline int bit_width(uint16_t max) {
+    return (max == 0) ? 0 : 32 - __builtin_clz(max);
+}
+
+static inline void store_plane(uint8_t* out, uint16_t plane) {
+    // little-endian, out is not aligned
+    out[0] = (uint8_t)plane;
+    out[1] = (uint8_t)(plane >> 8);
+}
+
+static int no_blocks(int n) {
+    return (n + ADC_CODEC_BLOCK - 1) / ADC_CODEC_BLOCK;
+}
+
+static void pad_block(int16_t* x, int n) {
+    // repeat the last value till the end of the block (delta 0, no extra bits)
+    for (int i = n; i < no_blocks(n) * ADC_CODEC_BLOCK; i++) x[i] = (n > 0) ? x[n - 1] : 0;
+}
+
+size_t adc_codec_max_bytes(int n) {
+    // 2 widths + max. 15 planes per channel and block
+    return (size_t)no_blocks(n) * 2 * (1 + 2 * 15);
+}
+
+/**************************************************************/
+/* scalar versions                                            */
+/**************************************************************/
+
+void adc_codec_split_scalar(const uint32_t* words, int n, int16_t* a, int16_t* b) {
+    for (int i = 0; i < n; i++) {
+        a[i] = sign_extend_14bit((uint16_t)words[i]);
+        b[i] = sign_extend_14bit((uint16_t)(words[i] >> 16));
+    }
+}
+
+static size_t encode_channel_scalar(const int16_t* x, int nb, uint8_t* widths, uint8_t* planes) {
+    uint8_t* p = planes;
+    int16_t prev = 0;
+
+    for (int blk = 0; blk < nb; blk++) {
+        uint16_t zz[ADC_CODEC_BLOCK];
+        uint16_t bits = 0;
+
+        for (int j = 0; j < ADC_CODEC_BLOCK; j++) {
+            int16_t d = (int16_t)(x[blk * ADC_CODEC_BLOCK + j] - prev);
+            prev = x[blk * ADC_CODEC_BLOCK + j];
+            zz[j] = (uint16_t)((uint16_t)d << 1) ^ (uint16_t)(d >> 15);
+            bits |= zz[j];
+        }
+        int w = bit_width(bits);
+        widths[blk] = (uint8_t)w;
+
+        for (int k = 0; k < w; k++) {
+            uint16_t plane = 0;
+            for (int j = 0; j < ADC_CODEC_BLOCK; j++) plane |= (uint16_t)(((zz[j] >> k) & 1) << j);
+            store_plane(p, plane);
+            p += 2;
+        }
+    }
+    return (size_t)(p - planes);
+}
+
+size_t adc_codec_encode_scalar(int16_t* a, int16_t* b, int n, uint8_t* out) {
+    // a and b have to hold n rounded up to ADC_CODEC_BLOCK values (padding)
+    int nb = no_blocks(n);
+    uint8_t* planes = out + 2 * nb;
+
+    pad_block(a, n);
+    pad_block(b, n);
+    planes += encode_channel_scalar(a, nb, out, planes);
+    planes += encode_channel_scalar(b, nb, out + nb, planes);
+    return (size_t)(planes - out);
+}
+
+int adc_codec_decode(const uint8_t* in, size_t len, int n, int16_t* a, int16_t* b) {
+    // returns 0 if the payload is complete, a and b have to hold n rounded up to ADC_CODEC_BLOCK
+    int nb = no_blocks(n);
+    const uint8_t* p = in + 2 * nb;
+    const uint8_t* end = in + len;
+
+    if (len < (size_t)(2 * nb)) return -1;
+    for (int ch = 0; ch < 2; ch++) {
+        int16_t* x = (ch == 0) ? a : b;
+        int16_t prev = 0;
+
+        for (int blk = 0; blk < nb; blk++) {
+            int w = in[ch * nb + blk];
+            uint16_t zz[ADC_CODEC_BLOCK] = {0};
+
+            if (w > 15 || p + 2 * w > end) return -1;
+            for (int k = 0; k < w; k++, p += 2) {
+                uint16_t plane = (uint16_t)(p[0] | (p[1] << 8));
+                for (int j = 0; j < ADC_CODEC_BLOCK; j++) zz[j] |= (uint16_t)(((plane >> j) & 1) << k);
+            }
+            for (int j = 0; j < ADC_CODEC_BLOCK; j++) {
+                prev = (int16_t)(prev + (int16_t)((zz[j] >> 1) ^ (uint16_t)-(zz[j] & 1)));
+                x[blk * ADC_CODEC_BLOCK + j] = prev;
+            }
+        }
+    }
+    return (p == end) ? 0 : -1;
+}
+
+/**************************************************************/
+/* NEON versions                                              */
+/**************************************************************/
+
+#ifdef __ARM_NEON
+
+void adc_codec_split(const uint32_t* words, int n, int16_t* a, int16_t* b) {
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        int16x8x2_t w = vld2q_s16((const int16_t*)(words + i));
+        vst1q_s16(a + i, vshrq_n_s16(vshlq_n_s16(w.val[0], 16 - RF_ADC_BITS), 16 - RF_ADC_BITS));
+        vst1q_s16(b + i, vshrq_n_s16(vshlq_n_s16(w.val[1], 16 - RF_ADC_BITS), 16 - RF_ADC_BITS));
+    }
+    adc_codec_split_scalar(words + i, n - i, a + i, b + i);
+}
+
+static inline uint16x8_t zigzag_s16(int16x8_t d) {
+    return veorq_u16(vreinterpretq_u16_s16(vshlq_n_s16(d, 1)), vreinterpretq_u16_s16(vshrq_n_s16(d, 15)));
+}
+
+static size_t encode_channel(const int16_t* x, int nb, uint8_t* widths, uint8_t* planes) {
+    static const int8_t lane_shift[16] = {0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7};
+    const int8x16_t shift = vld1q_s8(lane_shift);
+    const uint16x8_t one = vdupq_n_u16(1);
+    uint8_t* p = planes;
+    int16x8_t prev = vdupq_n_s16(0);  // lane 7: last sample of the previous block
+
+    for (int blk = 0; blk < nb; blk++) {
+        int16x8_t x0 = vld1q_s16(x + blk * ADC_CODEC_BLOCK);
+        int16x8_t x1 = vld1q_s16(x + blk * ADC_CODEC_BLOCK + 8);
+        uint16x8_t z0 = zigzag_s16(vsubq_s16(x0, vextq_s16(prev, x0, 7)));
+        uint16x8_t z1 = zigzag_s16(vsubq_s16(x1, vextq_s16(x0, x1, 7)));
+        prev = x1;
+
+        // width of the block: or of all values (same highest bit as the max.)
+        uint16x8_t m = vorrq_u16(z0, z1);
+        uint16x4_t m4 = vorr_u16(vget_low_u16(m), vget_high_u16(m));
+        m4 = vpmax_u16(m4, m4);
+        m4 = vpmax_u16(m4, m4);
+        int w = bit_width((uint16_t)(vget_lane_u16(m4, 0) | vget_lane_u16(m4, 1)));
+        widths[blk] = (uint8_t)w;
+
+        for (int k = 0; k < w; k++) {
+            // bit k of the 16 values -> lane j shifted to bit j % 8 -> sum of each half
+            uint8x16_t bits = vcombine_u8(vmovn_u16(vandq_u16(z0, one)), vmovn_u16(vandq_u16(z1, one)));
+            bits = vshlq_u8(bits, shift);
+            uint8x8_t s = vpadd_u8(vget_low_u8(bits), vget_high_u8(bits));
+            s = vpadd_u8(s, s);
+            s = vpadd_u8(s, s);
+            p[0] = vget_lane_u8(s, 0);
+            p[1] = vget_lane_u8(s, 1);
+            p += 2;
+            z0 = vshrq_n_u16(z0, 1);
+            z1 = vshrq_n_u16(z1, 1);
+        }
+    }
+    return (size_t)(p - planes);
+}
+
+size_t adc_codec_encode(int16_t* a, int16_t* b, int n, uint8_t* out) {
+    // a and b have to hold n rounded up to ADC_CODEC_BLOCK values (padding)
+    int nb = no_blocks(n);
+    uint8_t* planes = out + 2 * nb;
+
+    pad_block(a, n);
+    pad_block(b, n);
+    planes += encode_channel(a, nb, out, planes);
+    planes += encode_channel(b, nb, out + nb, planes);
+    return (size_t)(planes - out);
+}
+
+#else
+
+void adc_codec_split(const uint32_t* words, int n, int16_t* a, int16_t* b) {
+    adc_codec_split_scalar(words, n, a, b);
+}
+
+size_t adc_codec_encode(int16_t* a, int16_t* b, int n, uint8_t* out) {
+    return adc_codec_encode_scalar(a, b, n, out);
+}
+
+#endif
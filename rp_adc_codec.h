@@ -0,0 +1,41 @@
+/*
+ * rp_adc_codec.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Lossless compression of RF-ADC-packages for the continous-mode (ADC_STREAM_COMPRESSED):
+ *
+ *     -- the 32-bit words are split into the sign-extended 14-bit values of channel A and B
+ *
+ *     -- per channel: delta to the previous sample (the first sample of a package to 0, so
+ *        every package can be decoded on its own), zigzag-mapping to unsigned 16-bit
+ *
+ *     -- blocks of ADC_CODEC_BLOCK values are bit-packed with the width of their largest
+ *        value (0..15 bits), stored as bit-planes: plane k holds bit k of all 16 values
+ *        as one little-endian uint16 (bit j = value j)
+ *
+ *    Payload of a package with n samples (nb = n / ADC_CODEC_BLOCK rounded up):
+ *        uint8 width_a[nb], uint8 width_b[nb], uint16 planes_a[sum(width_a)], uint16 planes_b[sum(width_b)]
+ *
+ *    A block needs 1 + 2 * width bytes instead of 32, in the worst case (15 bits) the payload is
+ *    still smaller than the raw package. Uses NEON on the Cortex-A9 (__ARM_NEON), the scalar
+ *    version produces the same payload.
+ */
+
+#ifndef SRC_RP_ADC_CODEC_H
+#define SRC_RP_ADC_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ADC_CODEC_BLOCK 16
+
+size_t adc_codec_max_bytes(int n);
+void adc_codec_split(const uint32_t* words, int n, int16_t* a, int16_t* b);
+size_t adc_codec_encode(int16_t* a, int16_t* b, int n, uint8_t* out);
+int adc_codec_decode(const uint8_t* in, size_t len, int n, int16_t* a, int16_t* b);
+
+void adc_codec_split_scalar(const uint32_t* words, int n, int16_t* a, int16_t* b);
+size_t adc_codec_encode_scalar(int16_t* a, int16_t* b, int n, uint8_t* out);
+
+#endif
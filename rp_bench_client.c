@@ -0,0 +1,423 @@
+/*
+ * rp_bench_client.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Load-generator for the App-Server, speaks the TcpCmd-protocol like the python-client
+ *    and runs against the RedPitaya or the simulator (rp_sim_server):
+ *
+ *     -- cmd:        round-trip latency of commands which answer with one int
+ *     -- config:     NEW_CONFIG + AdcConfig (receive_struct) till CONFIG_DONE
+ *     -- adc_stream: START_ADC_SAMPLING in continous- and block-mode, sustained MB/s and
+ *                    inter-arrival time of the TCP-packages
+ *
+ *    Results (p50/p99/mean/max in us, rates) are printed as JSON, one entry per
+ *    command-id and ADC-mode, so they can be compared between builds. Errors go to stderr.
+ *
+ *    usage: ./bench_client [-h host] [-p port] [-n iterations] [-c id[:ch[:val]]]...
+ *                          [-s no_packages] [-k pkg_size] [-m cont|block|both|none] [-o file]
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rp_constants.h"
+#include "rp_structs.h"
+
+#define BENCH_DEFAULT_ITERATIONS 1000
+#define BENCH_DEFAULT_PACKAGES 200
+#define BENCH_DEFAULT_PKG_SIZE 16384           // samples per TCP-package
+#define BENCH_DEFAULT_RAM_SIZE 0x100000        // samples in RAM-Writer-buffer
+#define BENCH_DEFAULT_STS_WIDTH_MASK 0xFFFFF
+#define BENCH_DEFAULT_SAMPLE_RATE_DIVIDER 8    // 15.625 MS/s
+#define BENCH_MAX_CMDS 32
+
+typedef struct {
+    int id;
+    int ch;
+    double val;
+} BenchCmd;
+
+typedef struct {
+    const char* host;
+    int port;
+    int iterations;
+    int no_packages;
+    uint32_t pkg_size;
+    bool modes[2];  // ADC_CONTINOUS_MODE, ADC_BLOCK_MODE
+    BenchCmd cmds[BENCH_MAX_CMDS];
+    int no_cmds;
+    FILE* out;
+} BenchOptions;
+
+static bool first_result = true;
+
+static double now_us(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec * 1e-3;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double d = *(const double*)a - *(const double*)b;
+    return (d > 0) - (d < 0);
+}
+
+static double percentile(const double* sorted, int n, double p) {
+    // nearest-rank percentile of sorted samples
+    if (n == 0) return 0;
+    int idx = (int)(p / 100.0 * n + 0.5) - 1;
+    if (idx < 0) idx = 0;
+    if (idx >= n) idx = n - 1;
+    return sorted[idx];
+}
+
+static void print_latency_result(BenchOptions* opt, const char* bench, int id, int mode, double* samples_us, int n,
+                                 double duration_s, double bytes, long overruns) {
+    // one JSON-object per result, latencies in us
+    double sum = 0;
+    qsort(samples_us, n, sizeof(double), compare_double);
+    for (int i = 0; i < n; i++) sum += samples_us[i];
+
+    fprintf(opt->out, "%s\n    {\"bench\": \"%s\", \"id\": %d, \"mode\": %d, \"n\": %d, ", first_result ? "" : ",", bench, id, mode, n);
+    fprintf(opt->out, "\"p50_us\": %.2f, \"p99_us\": %.2f, \"mean_us\": %.2f, \"max_us\": %.2f, ", percentile(samples_us, n, 50),
+            percentile(samples_us, n, 99), n > 0 ? sum / n : 0, n > 0 ? samples_us[n - 1] : 0);
+    fprintf(opt->out, "\"rate_per_s\": %.1f, \"mbytes_per_s\": %.3f", duration_s > 0 ? n / duration_s : 0,
+            duration_s > 0 ? bytes / 1e6 / duration_s : 0);
+    if (overruns >= 0) fprintf(opt->out, ", \"overruns\": %ld", overruns);
+    fprintf(opt->out, "}");
+    first_result = false;
+}
+
+/**************************************************************/
+/* TCP                                                        */
+/**************************************************************/
+
+static int connect_server(const char* host, int port) {
+    struct addrinfo hints, *res;
+    char port_str[16];
+    int one = 1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(port_str, sizeof(port_str), "%d", port);
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) {
+        fprintf(stderr, "Resolving %s failed\n", host);
+        return -1;
+    }
+
+    int sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (sock < 0 || connect(sock, res->ai_addr, res->ai_addrlen) < 0) {
+        fprintf(stderr, "Connecting to %s:%d failed: %s\n", host, port, strerror(errno));
+        if (sock >= 0) close(sock);
+        freeaddrinfo(res);
+        return -1;
+    }
+    freeaddrinfo(res);
+    // commands are small, don't wait for more data (like the python-client)
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return sock;
+}
+
+static int send_all(int sock, const void* data, size_t size) {
+    const char* p = data;
+    while (size > 0) {
+        ssize_t n = send(sock, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static int recv_all(int sock, void* data, size_t size) {
+    char* p = data;
+    while (size > 0) {
+        ssize_t n = recv(sock, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+static int send_command(int sock, int id, int ch, double val) {
+    TcpCmd cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.id = id;
+    cmd.ch = ch;
+    cmd.val = val;
+    return send_all(sock, &cmd, sizeof(cmd));
+}
+
+static int recv_int(int sock, int32_t* value) {
+    return recv_all(sock, value, sizeof(int32_t));
+}
+
+static int wait_for_answer(int sock, int32_t answer_id) {
+    int32_t value;
+    do {
+        if (recv_int(sock, &value) < 0) {
+            fprintf(stderr, "Connection closed while waiting for answer %d\n", answer_id);
+            return -1;
+        }
+    } while (value != answer_id);
+    return 0;
+}
+
+static int send_config(int sock, int config_id, const void* cfg, size_t size) {
+    // same handshake as sendConfigParams() of the python-client
+    if (send_command(sock, NEW_CONFIG, 0, config_id) < 0) return -1;
+    if (wait_for_answer(sock, ACK) < 0) return -1;
+    if (send_all(sock, cfg, size) < 0) return -1;
+    return wait_for_answer(sock, CONFIG_DONE);
+}
+
+/**************************************************************/
+/* benchmarks                                                 */
+/**************************************************************/
+
+static int bench_commands(int sock, BenchOptions* opt, double* samples) {
+    for (int c = 0; c < opt->no_cmds; c++) {
+        BenchCmd* cmd = &opt->cmds[c];
+        int32_t value;
+        double t_start = now_us();
+
+        for (int i = 0; i < opt->iterations; i++) {
+            double t0 = now_us();
+            if (send_command(sock, cmd->id, cmd->ch, cmd->val) < 0 || recv_int(sock, &value) < 0) {
+                fprintf(stderr, "Command %d failed after %d iterations\n", cmd->id, i);
+                return -1;
+            }
+            samples[i] = now_us() - t0;
+        }
+        double duration_s = (now_us() - t_start) * 1e-6;
+        print_latency_result(opt, "cmd", cmd->id, -1, samples, opt->iterations, duration_s,
+                             (double)opt->iterations * (sizeof(TcpCmd) + sizeof(int32_t)), -1);
+    }
+    return 0;
+}
+
+static AdcConfig bench_adc_config(int adc_mode) {
+    AdcConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.sample_rate_divider = BENCH_DEFAULT_SAMPLE_RATE_DIVIDER;
+    cfg.adc_mode = adc_mode;
+    return cfg;
+}
+
+static int bench_config(int sock, BenchOptions* opt, double* samples) {
+    AdcConfig cfg = bench_adc_config(ADC_CONTINOUS_MODE);
+    double t_start = now_us();
+
+    for (int i = 0; i < opt->iterations; i++) {
+        double t0 = now_us();
+        if (send_config(sock, ADC_CONFIG_ID, &cfg, sizeof(cfg)) < 0) {
+            fprintf(stderr, "ADC-Config failed after %d iterations\n", i);
+            return -1;
+        }
+        samples[i] = now_us() - t0;
+    }
+    double duration_s = (now_us() - t_start) * 1e-6;
+    print_latency_result(opt, "config", ADC_CONFIG_ID, -1, samples, opt->iterations, duration_s, (double)opt->iterations * sizeof(cfg), -1);
+    return 0;
+}
+
+static int bench_stream_packages(BenchOptions* opt, int adc_mode) {
+    // block-mode sends one block of the RAM-size (no_packages is ignored by the server),
+    // it is received in packages of pkg_size (the last one may be shorter)
+    if (adc_mode == ADC_BLOCK_MODE) return (int)((BENCH_DEFAULT_RAM_SIZE + opt->pkg_size - 1) / opt->pkg_size);
+    return opt->no_packages;
+}
+
+static int bench_adc_stream(int sock, BenchOptions* opt, int adc_mode, double* samples) {
+    // continous-mode: AdcStreamHeader + package + status-word (ADC_STREAM_STATUS_LAG more words
+    // after the last package), block-mode: plain packages
+    RamInitConfig ramCfg = {BENCH_DEFAULT_STS_WIDTH_MASK, opt->pkg_size, opt->pkg_size * sizeof(int32_t), BENCH_DEFAULT_RAM_SIZE,
+                            BENCH_DEFAULT_RAM_SIZE * sizeof(int32_t)};
+    AdcConfig adcCfg = bench_adc_config(adc_mode);
+    size_t pkg_size_bytes = (size_t)opt->pkg_size * sizeof(int32_t);
+    int no_packages = bench_stream_packages(opt, adc_mode);
+    uint32_t overruns = 0;
+    double bytes = 0;
+
+    char* buf = malloc(pkg_size_bytes);
+    if (buf == NULL) return -1;
+
+    if (send_config(sock, RAM_INIT_CONFIG_ID, &ramCfg, sizeof(ramCfg)) < 0 || send_config(sock, ADC_CONFIG_ID, &adcCfg, sizeof(adcCfg)) < 0 ||
+        send_command(sock, START_ADC_SAMPLING, 0, opt->no_packages) < 0) {
+        free(buf);
+        return -1;
+    }
+
+    double t_start = now_us();
+    double t_last = t_start;
+    for (int i = 0; i < no_packages; i++) {
+        if (adc_mode == ADC_CONTINOUS_MODE) {
+            AdcStreamHeader hdr;
+            uint32_t status;
+            if (recv_all(sock, &hdr, sizeof(hdr)) < 0 || hdr.magic != ADC_STREAM_MAGIC || hdr.no_samples > (uint32_t)opt->pkg_size) {
+                fprintf(stderr, "Invalid ADC-Stream-Header in package %d\n", i);
+                free(buf);
+                return -1;
+            }
+            // lost packages are sent without samples
+            size_t no_bytes = (size_t)hdr.no_samples * sizeof(int32_t);
+            if ((no_bytes > 0 && recv_all(sock, buf, no_bytes) < 0) || recv_all(sock, &status, sizeof(status)) < 0) {
+                fprintf(stderr, "Connection closed after %d ADC-packages\n", i);
+                free(buf);
+                return -1;
+            }
+            overruns = hdr.overruns;
+            bytes += sizeof(hdr) + no_bytes + sizeof(status);
+        } else {
+            size_t no_bytes = ramCfg.ram_size_bytes - (size_t)i * pkg_size_bytes;
+            if (no_bytes > pkg_size_bytes) no_bytes = pkg_size_bytes;
+            if (recv_all(sock, buf, no_bytes) < 0) {
+                fprintf(stderr, "Connection closed after %d ADC-packages\n", i);
+                free(buf);
+                return -1;
+            }
+            bytes += no_bytes;
+        }
+
+        double t = now_us();
+        samples[i] = t - t_last;  // first sample includes the start-latency of the stream
+        t_last = t;
+    }
+    double duration_s = (t_last - t_start) * 1e-6;
+    free(buf);
+    if (adc_mode == ADC_CONTINOUS_MODE) {
+        uint32_t status[ADC_STREAM_STATUS_LAG];
+        if (recv_all(sock, status, sizeof(status)) < 0) {
+            fprintf(stderr, "Connection closed before the last status-words\n");
+            return -1;
+        }
+        bytes += sizeof(status);
+    }
+
+    print_latency_result(opt, "adc_stream", START_ADC_SAMPLING, adc_mode, samples, no_packages, duration_s, bytes,
+                         (adc_mode == ADC_CONTINOUS_MODE) ? (long)overruns : -1);
+    return 0;
+}
+
+/**************************************************************/
+/* main                                                       */
+/**************************************************************/
+
+static int parse_cmd(const char* arg, BenchCmd* cmd) {
+    // id[:ch[:val]]
+    char* end;
+    memset(cmd, 0, sizeof(BenchCmd));
+    cmd->id = (int)strtol(arg, &end, 0);
+    if (end == arg) return -1;
+    if (*end == ':') cmd->ch = (int)strtol(end + 1, &end, 0);
+    if (*end == ':') cmd->val = strtod(end + 1, &end);
+    return (*end == '\0') ? 0 : -1;
+}
+
+static void print_usage(const char* name) {
+    fprintf(stderr, "usage: %s [-h host] [-p port] [-n iterations] [-c id[:ch[:val]]]... [-s no_packages]\n"
+           "          [-k pkg_size] [-m cont|block|both|none] [-o file]\n", name);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    const char* out_path = NULL;
+    int opt_c;
+    int ret = 0;
+
+    memset(&opt, 0, sizeof(opt));
+    opt.host = "127.0.0.1";
+    opt.port = TCP_PORT;
+    opt.iterations = BENCH_DEFAULT_ITERATIONS;
+    opt.no_packages = BENCH_DEFAULT_PACKAGES;
+    opt.pkg_size = BENCH_DEFAULT_PKG_SIZE;
+    opt.modes[ADC_CONTINOUS_MODE] = true;
+    opt.modes[ADC_BLOCK_MODE] = true;
+    opt.out = stdout;
+
+    while ((opt_c = getopt(argc, argv, "h:p:n:c:s:k:m:o:")) != -1) {
+        switch (opt_c) {
+            case 'h': opt.host = optarg; break;
+            case 'p': opt.port = atoi(optarg); break;
+            case 'n': opt.iterations = atoi(optarg); break;
+            case 's': opt.no_packages = atoi(optarg); break;
+            case 'k': opt.pkg_size = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'o': out_path = optarg; break;
+            case 'c':
+                if (opt.no_cmds >= BENCH_MAX_CMDS || parse_cmd(optarg, &opt.cmds[opt.no_cmds]) < 0) {
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                opt.no_cmds++;
+                break;
+            case 'm':
+                opt.modes[ADC_CONTINOUS_MODE] = (strcmp(optarg, "cont") == 0 || strcmp(optarg, "both") == 0);
+                opt.modes[ADC_BLOCK_MODE] = (strcmp(optarg, "block") == 0 || strcmp(optarg, "both") == 0);
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (opt.iterations <= 0 || opt.no_packages <= 0 || opt.pkg_size == 0 || opt.pkg_size > BENCH_DEFAULT_RAM_SIZE / 2) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // default: commands which only read registers and answer with one int
+    if (opt.no_cmds == 0) {
+        opt.cmds[opt.no_cmds++] = (BenchCmd){GET_DAC_BRAM_SAMPLE_CNT, 0, 0};
+        opt.cmds[opt.no_cmds++] = (BenchCmd){GET_DAC_BRAM_SIGNAL_CNT, 0, 0};
+        opt.cmds[opt.no_cmds++] = (BenchCmd){GET_LATEST_ADC24, 0, 0};
+    }
+
+    int max_samples = opt.iterations;
+    for (int mode = ADC_CONTINOUS_MODE; mode <= ADC_BLOCK_MODE; mode++) {
+        if (opt.modes[mode] && bench_stream_packages(&opt, mode) > max_samples) max_samples = bench_stream_packages(&opt, mode);
+    }
+    double* samples = malloc(sizeof(double) * (size_t)max_samples);
+    if (samples == NULL) return EXIT_FAILURE;
+
+    if (out_path != NULL && (opt.out = fopen(out_path, "w")) == NULL) {
+        fprintf(stderr, "Opening %s failed: %s\n", out_path, strerror(errno));
+        free(samples);
+        return EXIT_FAILURE;
+    }
+
+    int sock = connect_server(opt.host, opt.port);
+    if (sock < 0) {
+        free(samples);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(opt.out, "{\"host\": \"%s\", \"port\": %d, \"iterations\": %d, \"no_packages\": %d, \"pkg_size\": %u, \"results\": [",
+            opt.host, opt.port, opt.iterations, opt.no_packages, opt.pkg_size);
+
+    if (bench_commands(sock, &opt, samples) < 0 || bench_config(sock, &opt, samples) < 0) ret = -1;
+    for (int mode = ADC_CONTINOUS_MODE; ret == 0 && mode <= ADC_BLOCK_MODE; mode++) {
+        if (opt.modes[mode]) ret = bench_adc_stream(sock, &opt, mode, samples);
+    }
+    fprintf(opt.out, "\n]}\n");
+
+    send_command(sock, TERMINATE_CLIENT, 0, 0);
+    close(sock);
+    if (opt.out != stdout) fclose(opt.out);
+    free(samples);
+    return (ret < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,64 @@
+/*
+ * rp_bram_upload.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Variable-length BRAM-uploads, see rp_bram_upload.h
+ */
+
+#include "rp_bram_upload.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "rp_constants.h"
+#include "rp_convert.h"
+#include "rp_trace.h"
+
+int recv_all(int sock, void* buf, size_t len) {
+    uint8_t* p = buf;
+    while (len > 0) {
+        ssize_t n = recv(sock, p, len, MSG_WAITALL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int send_all(int sock, const void* buf, size_t len) {
+    const uint8_t* p = buf;
+    while (len > 0) {
+        ssize_t n = send(sock, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int bram_upload_check(const BramUploadHeader* header, uint32_t bram_words) {
+    // the words have to fit into the target (bram_words, at most BRAM_UPLOAD_WINDOW_WORDS)
+    if (bram_words > BRAM_UPLOAD_WINDOW_WORDS) bram_words = BRAM_UPLOAD_WINDOW_WORDS;
+
+    if (header->magic != BRAM_UPLOAD_MAGIC) {
+        printf("BRAM-Upload: invalid header (magic: 0x%08X)\n", header->magic);
+        return BRAM_UPLOAD_ERR_HEADER;
+    }
+    if (header->no_words == 0 || header->offset >= bram_words || header->no_words > bram_words - header->offset) {
+        printf("BRAM-Upload: %u words at offset %u don't fit into the BRAM (%u words)\n", header->no_words,
+               header->offset, bram_words);
+        return BRAM_UPLOAD_ERR_HEADER;
+    }
+    return BRAM_UPLOAD_OK;
+}
+
+void bram_upload_write(void* bram, const BramUploadHeader* header, const uint32_t* words) {
+    // header has to be checked by bram_upload_check()
+    copy_words((volatile uint32_t*)bram + header->offset, words, (int)header->no_words);
+    TRACE_DEBUG("BRAM-Upload: %u words written at offset %u", header->no_words, header->offset);
+}
@@ -0,0 +1,41 @@
+/*
+ * rp_bram_upload.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Variable-length uploads into the BRAMs of the Dummy-Data-Generator and the LIA-Mixer:
+ *
+ *     -- BramUploadHeader (offset + no. of words) followed by the words, only the used
+ *        part of the table is sent instead of a full BramConfig (64 KiB)
+ *
+ *     -- the upload is received by the reactor (reactor_payload()), bram_upload_check()
+ *        validates the header against the size of the target before the words are requested, bram_upload_write() copies
+ *        them into the mapped BRAM (no copy of the whole table in the server-state)
+ *
+ *     -- offset > 0 updates only a range of the table (e.g. retune the LIA-Mixer-reference)
+ *
+ *    Also holds the blocking socket-helpers used by the BRAM-transfers (rp_lut_bin.c) and the jobs.
+ */
+
+#ifndef SRC_RP_BRAM_UPLOAD_H
+#define SRC_RP_BRAM_UPLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+#define BRAM_UPLOAD_OK 0
+#define BRAM_UPLOAD_PENDING 1      // rest of the upload is still on the way (reactor_payload())
+#define BRAM_UPLOAD_ERR_HEADER -1  // invalid header/range, the words were not read (client is out of sync)
+
+// words of the mapped BRAM-window, limit of every upload
+#define BRAM_UPLOAD_WINDOW_WORDS ((uint32_t)(AXI_BRAM_RANGE / sizeof(uint32_t)))
+
+int recv_all(int sock, void* buf, size_t len);
+int send_all(int sock, const void* buf, size_t len);
+
+int bram_upload_check(const BramUploadHeader* header, uint32_t bram_words);
+void bram_upload_write(void* bram, const BramUploadHeader* header, const uint32_t* words);
+
+#endif
@@ -0,0 +1,119 @@
+/*
+ * rp_config_diff.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Field-level diff of config-structs, see rp_config_diff.h
+ */
+
+#include "rp_config_diff.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "rp_constants.h"
+
+#define CONFIG_FIELD(type, field) {#field, offsetof(type, field), sizeof(((type*)0)->field)}
+
+const ConfigField adc_config_fields[ADC_CONFIG_NO_FIELDS] = {
+    CONFIG_FIELD(AdcConfig, sample_rate_divider),
+    CONFIG_FIELD(AdcConfig, burst_size),
+    CONFIG_FIELD(AdcConfig, adc_mode),
+    CONFIG_FIELD(AdcConfig, start_delay),
+    CONFIG_FIELD(AdcConfig, trigger_mode),
+    CONFIG_FIELD(AdcConfig, under_sampling),
+    CONFIG_FIELD(AdcConfig, offset_val_port_1),
+    CONFIG_FIELD(AdcConfig, offset_val_port_2),
+    CONFIG_FIELD(AdcConfig, gain_val_port_1),
+    CONFIG_FIELD(AdcConfig, gain_val_port_2),
+    CONFIG_FIELD(AdcConfig, debug_port_en),
+    CONFIG_FIELD(AdcConfig, gain_offset_calib_en),
+};
+
+const ConfigField dac_config_fields[DAC_CONFIG_NO_FIELDS] = {
+    CONFIG_FIELD(DacConfig, dev_id),
+    CONFIG_FIELD(DacConfig, mode),
+    CONFIG_FIELD(DacConfig, reset_voltage),
+    CONFIG_FIELD(DacConfig, used_ports),
+    CONFIG_FIELD(DacConfig, mirror),
+};
+
+const ConfigField bram_dac_config_fields[BRAM_DAC_CONFIG_NO_FIELDS] = {
+    CONFIG_FIELD(BramDacConfig, port_id),
+    CONFIG_FIELD(BramDacConfig, dacConfig),
+    CONFIG_FIELD(BramDacConfig, dac_port_id),
+    CONFIG_FIELD(BramDacConfig, no_steps),
+    CONFIG_FIELD(BramDacConfig, dwell_time_delay),
+    CONFIG_FIELD(BramDacConfig, no_sweeps),
+    CONFIG_FIELD(BramDacConfig, rep_delay),
+    CONFIG_FIELD(BramDacConfig, enable_handshake),
+};
+
+const ConfigField trigger_config_fields[TRIGGER_CONFIG_NO_FIELDS] = {
+    CONFIG_FIELD(TriggerConfig, trigger_inc),
+    CONFIG_FIELD(TriggerConfig, trigger_ref_max_value),
+    CONFIG_FIELD(TriggerConfig, trigger_ref_min_value),
+    CONFIG_FIELD(TriggerConfig, length),
+    CONFIG_FIELD(TriggerConfig, start_delay),
+};
+
+uint32_t config_diff(bool valid, const void* active, const void* next, const ConfigField* fields, int no_fields) {
+    // bitmask of the changed fields (bytewise, so -0.0f/0.0f differ), all fields without active config
+    if (!valid) return CONFIG_ALL_FIELDS;
+
+    uint32_t changed = 0;
+    for (int i = 0; i < no_fields; i++) {
+        if (memcmp((const char*)active + fields[i].offset, (const char*)next + fields[i].offset, fields[i].size) != 0) {
+            changed |= CONFIG_FIELD_BIT(i);
+        }
+    }
+    return changed;
+}
+
+void config_diff_print(const char* name, uint32_t changed, const ConfigField* fields, int no_fields) {
+    if (changed == CONFIG_ALL_FIELDS) {
+        printf("%s: no active config, all fields are applied\n", name);
+        return;
+    }
+    if (changed == 0) {
+        printf("%s: same as active config, nothing to apply\n", name);
+        return;
+    }
+    printf("%s: changed fields:", name);
+    for (int i = 0; i < no_fields; i++) {
+        if (changed & CONFIG_FIELD_BIT(i)) printf(" %s", fields[i].name);
+    }
+    printf("\n");
+}
+
+void lut_source_get(LutSource* src, int port_id, bool binary) {
+    // .csv-file which can't be read: a new source every time (the LUT is always reloaded)
+    char path[64];
+    struct stat st;
+
+    memset(src, 0, sizeof(LutSource));
+    src->binary = binary;
+    if (binary) return;
+
+    snprintf(path, sizeof(path), LUT_CSV_FILE, port_id);
+    if (stat(path, &st) != 0) {
+        src->size = -1;
+        return;
+    }
+    src->mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    src->size = (int64_t)st.st_size;
+}
+
+bool lut_source_equal(const LutSource* a, const LutSource* b) {
+    if (a->binary || b->binary) return false;  // a binary upload is always a new LUT
+    if (a->size < 0 || b->size < 0) return false;
+    return a->mtime_ns == b->mtime_ns && a->size == b->size;
+}
+
+int config_done_reply(int report, uint32_t applied, uint32_t writes) {
+    // CONFIG_DONE, with CONFIG_REPORT_APPLIED (NEW_CONFIG-channel) the applied parts in the upper bits
+    if (report != CONFIG_REPORT_APPLIED) return CONFIG_DONE;
+    if (writes > CONFIG_REPLY_MAX_WRITES) writes = CONFIG_REPLY_MAX_WRITES;
+    return (int)(CONFIG_DONE | (applied & 0xFF) << 8 | writes << 16);
+}
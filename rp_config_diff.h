@@ -0,0 +1,123 @@
+/*
+ * rp_config_diff.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Incremental reconfiguration: the server keeps the active config of every module (and of
+ *    every DAC-BRAM-Port), an incoming config is compared field by field and only the parts
+ *    which changed are applied:
+ *
+ *     -- no changed field: the config-function is not called at all
+ *     -- AdcConfig: RAM-Writer-mode is only set if adc_mode changed (or a job changed the mode)
+ *     -- BramDacConfig: the LUT is only reloaded if no_steps, dacConfig, dac_port_id or the
+ *        source of the LUT changed (.csv-file: mtime and size, or a binary upload), or the
+ *        LUT in the BRAM was modified (ADJ_LUT_VALUE, LUT-Calibration)
+ *
+ *    The changed fields are printed in verbose-mode, the applied parts are reported in the
+ *    CONFIG_DONE-reply (CONFIG_REPORT_APPLIED).
+ */
+
+#ifndef SRC_RP_CONFIG_DIFF_H
+#define SRC_RP_CONFIG_DIFF_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+#define LUT_CSV_FILE "lut/lut_port%d.csv"  // read by write_dac_lut_from_config()
+#define CONFIG_ALL_FIELDS 0xFFFFFFFFu
+
+typedef struct {
+    const char* name;
+    size_t offset;
+    size_t size;
+} ConfigField;
+
+// fields of the configs (bit-index in the diff)
+enum {
+    ADC_FIELD_SAMPLE_RATE_DIVIDER,
+    ADC_FIELD_BURST_SIZE,
+    ADC_FIELD_ADC_MODE,
+    ADC_FIELD_START_DELAY,
+    ADC_FIELD_TRIGGER_MODE,
+    ADC_FIELD_UNDER_SAMPLING,
+    ADC_FIELD_OFFSET_VAL_PORT_1,
+    ADC_FIELD_OFFSET_VAL_PORT_2,
+    ADC_FIELD_GAIN_VAL_PORT_1,
+    ADC_FIELD_GAIN_VAL_PORT_2,
+    ADC_FIELD_DEBUG_PORT_EN,
+    ADC_FIELD_GAIN_OFFSET_CALIB_EN,
+    ADC_CONFIG_NO_FIELDS
+};
+
+enum {
+    DAC_FIELD_DEV_ID,
+    DAC_FIELD_MODE,
+    DAC_FIELD_RESET_VOLTAGE,
+    DAC_FIELD_USED_PORTS,
+    DAC_FIELD_MIRROR,
+    DAC_CONFIG_NO_FIELDS
+};
+
+enum {
+    BRAM_FIELD_PORT_ID,
+    BRAM_FIELD_DAC_CONFIG,
+    BRAM_FIELD_DAC_PORT_ID,
+    BRAM_FIELD_NO_STEPS,
+    BRAM_FIELD_DWELL_TIME_DELAY,
+    BRAM_FIELD_NO_SWEEPS,
+    BRAM_FIELD_REP_DELAY,
+    BRAM_FIELD_ENABLE_HANDSHAKE,
+    BRAM_DAC_CONFIG_NO_FIELDS
+};
+
+enum {
+    TRIGGER_FIELD_TRIGGER_INC,
+    TRIGGER_FIELD_TRIGGER_REF_MAX_VALUE,
+    TRIGGER_FIELD_TRIGGER_REF_MIN_VALUE,
+    TRIGGER_FIELD_LENGTH,
+    TRIGGER_FIELD_START_DELAY,
+    TRIGGER_CONFIG_NO_FIELDS
+};
+
+#define CONFIG_FIELD_BIT(index) (1u << (index))
+// fields of a BramDacConfig which change the content of the LUT
+#define BRAM_LUT_FIELDS \
+    (CONFIG_FIELD_BIT(BRAM_FIELD_DAC_CONFIG) | CONFIG_FIELD_BIT(BRAM_FIELD_DAC_PORT_ID) | CONFIG_FIELD_BIT(BRAM_FIELD_NO_STEPS))
+
+extern const ConfigField adc_config_fields[ADC_CONFIG_NO_FIELDS];
+extern const ConfigField dac_config_fields[DAC_CONFIG_NO_FIELDS];
+extern const ConfigField bram_dac_config_fields[BRAM_DAC_CONFIG_NO_FIELDS];
+extern const ConfigField trigger_config_fields[TRIGGER_CONFIG_NO_FIELDS];
+
+// where the LUT in the BRAM of a port came from
+typedef struct {
+    bool binary;          // binary upload (LUT_CONFIG_ID), else .csv-file
+    int64_t mtime_ns;     // .csv-file: modification-time and size
+    int64_t size;
+} LutSource;
+
+// configs which are active on the FPGA
+typedef struct {
+    bool adc_valid;
+    AdcConfig adc;
+    bool ram_mode_valid;  // RAM-Writer-mode of adc.adc_mode is set (jobs change the mode)
+    bool dac_valid;
+    DacConfig dac;
+    bool trigger_valid;
+    TriggerConfig trigger;
+    bool bram_valid[NO_DAC_BRAM_INTERFACES_USED];
+    BramDacConfig bram[NO_DAC_BRAM_INTERFACES_USED];
+    bool lut_valid[NO_DAC_BRAM_INTERFACES_USED];  // LUT in the BRAM matches bram[] and lut_source[]
+    LutSource lut_source[NO_DAC_BRAM_INTERFACES_USED];
+} ActiveConfig;
+
+uint32_t config_diff(bool valid, const void* active, const void* next, const ConfigField* fields, int no_fields);
+void config_diff_print(const char* name, uint32_t changed, const ConfigField* fields, int no_fields);
+void lut_source_get(LutSource* src, int port_id, bool binary);
+bool lut_source_equal(const LutSource* a, const LutSource* b);
+int config_done_reply(int report, uint32_t applied, uint32_t writes);
+
+#endif
@@ -38,11 +38,13 @@
 #define ADC_RESOLUTION 14
 #define ADC_VOLTAGE_RANGE 20
 #define ADC_MAX_VALUE 8191
+#define ADC_SYS_CLK_HZ 125000000  // sample-clock of RF-ADC (before sample_rate_divider)
 
 // defines for selecting between BLOCK-MODE and CONTINOUS-MODE
 #define ADC_CONTINOUS_MODE 0
 #define ADC_BLOCK_MODE 1
 #define ADC_LIA_MODE 2
+#define ADC_MULTI_BLOCK_MODE 3  // back-to-back blocks, RAM-Writer runs through N regions of the buffer
 
 ///////////////////////////////////////////////////////////////////////////////////////
 // AXI-Devices:
@@ -57,6 +59,34 @@
 // config for CMA-Alloc-Command
 #define CMA_ALLOC _IOWR('Z', 0, uint32_t)
 
+// magic-value of AdcStreamHeader in front of each TCP-Package in continous-mode ("RPAD")
+#define ADC_STREAM_MAGIC 0x44415052
+// continous-mode with lossless compression (START_ADC_SAMPLING with ch = ADC_STREAM_COMPRESSED),
+// every TCP-Package starts with an AdcStreamZHeader ("RPSZ")
+#define ADC_STREAM_RAW 0
+#define ADC_STREAM_COMPRESSED 1
+#define ADC_STREAM_Z_MAGIC 0x5A535052
+#define ADC_CODEC_DELTA_BITPLANE 1  // delta + zigzag + bit-planes per 16 samples (rp_adc_codec.h)
+// magic-value of AdcStreamHeader in front of each TCP-Package of the ADC20-Stream ("RD20")
+#define ADC20_STREAM_MAGIC 0x30324452
+
+// magic-value of AdcBlockHeader in front of each block in multi-block-mode ("RPBK")
+#define ADC_BLOCK_MAGIC 0x4B425052
+// status-word after each block (and each package in continous-mode): it belongs to the package
+// sent ADC_STREAM_STATUS_LAG packages before (the pages have to be released by the kernel first),
+// the words after the first ADC_STREAM_STATUS_LAG packages are ADC_BLOCK_OK (filler) and
+// ADC_STREAM_STATUS_LAG more words follow the last package
+#define ADC_BLOCK_OK 0
+#define ADC_BLOCK_TORN 1  // RAM-Writer reached the region again while it was sent (or package lost)
+#define ADC_STREAM_STATUS_LAG 4  // = max. no. of packages in flight with zero-copy
+#define ADC_BLOCK_DEFAULT_REGIONS 2  // ping-pong
+
+// software-LIA in ADC_LIA_MODE (rp_lia_sw.h), every TCP-Package starts with a LiaStreamHeader ("RPLI")
+#define LIA_STREAM_MAGIC 0x494C5052
+#define LIA_OUT_IQ 0         // int32 I, Q per point
+#define LIA_OUT_MAG_PHASE 1  // float magnitude, phase (rad) per point
+#define LIA_CHECK_MAGIC 0x4B4C5052  // "RPLK", LiaCheckHeader of LIA_SW_CHECK
+
 // mode for RAM-Writer
 #define RAM_WRITER_CONTI_MODE 0
 #define RAM_WRITER_BLOCK_MODE 1
@@ -64,6 +94,7 @@
 ///////////////////////////////////////////////////////////////////////////////////////
 // TCP-Config
 #define TCP_PORT 1002
+#define SERVER_PORT_ENV "RP_SERVER_PORT"  // env.: listen on another port (several simulators on one host)
 
 ///////////////////////////////////////////////////////////////////////////////////////
 // Command IDs from TCP-App-Server-Comunication..
@@ -98,8 +129,20 @@
 #define START_SEQ_SAMPLING_ADC24 46
 // Command to close the SPI interface
 #define CLOSE_SPI 47
+// Start streaming raw frames of ADC20 Click in sequence mode (batched SPI-transfers)
+#define START_STREAM_ADC20 48
 // Get ADC count (digital value) from RF ADC
 #define GET_RF_ADC_CNT 50
+// Coherent averaging of DAC-BRAM-sweeps on RedPitaya (ch: no. of LUT-steps, val: no. of sweeps)
+#define START_SWEEP_AVG 55
+// magic-value of SweepAvgHeader ("RPSA")
+#define SWEEP_AVG_MAGIC 0x41535052
+
+// Background-scanner for ADC24 Click (sweeps channel 0..ch with val sweeps/s)
+#define START_ADC24_SCAN 51
+#define STOP_ADC24_SCAN 52
+#define GET_LATEST_ADC24 53  // latest voltage [mV] of channel ch from the scanner
+#define GET_WINDOW_ADC24 54  // all samples of the last val ms (Adc24WindowHeader + Adc24Sample[])
 // Set LED on the RedPitaya board
 #define SET_LED 60
 // Start and Stop DAC-Sweep (DAC-BRAM-Controller output)
@@ -113,13 +156,46 @@
 #define REARM_TRIGGER       75  // Rearm current trigger
 #define HOLD_TRIGGER		81  // hold current trigger high
 #define RELEASE_TRIGGER     82  // release current trigger
+#define START_LUT_CALIB     58  // on-board LUT-calibration (LutCalibConfig + LutCalibPoint[])
+#define LUT_CALIB_MAGIC 0x434C5052
+#define LUT_CALIB_INPUT_ERROR 0    // host sends the error (target - measured) per REQ_WLENGTH as float
+#define LUT_CALIB_INPUT_READING 1  // host sends the measured value, error = LutCalibPoint.target - reading
+#define LUT_CALIB_OK 0
+#define LUT_CALIB_TIMEOUT 1        // trigger not armed within TRIGGER_IRQ_TIMEOUT_MS
+#define LUT_CALIB_ABORTED 2        // host sent NaN instead of a measurement
+#define GET_TRIGGER_LATENCY 57  // latency trigger-armed -> REQ_WLENGTH sent (ch: TRIGGER_STAT_*)
+#define TRIGGER_STAT_LAST_US 0
+#define TRIGGER_STAT_MEAN_US 1
+#define TRIGGER_STAT_MAX_US 2
+#define TRIGGER_STAT_EVENTS 3    // no. of REQ_WLENGTH sent
+#define TRIGGER_STAT_TIMEOUTS 4  // no. of waits without trigger-armed event (SERVER_ERROR_ID sent)
+#define TRIGGER_STAT_RESET 5
 // Command to send and apply a new config-struct
 #define NEW_CONFIG 76
 #define CONFIG_DONE 78
-// Store Current LUT from BRAM to .csv-file with _adj-suffix
+// NEW_CONFIG with ch = CONFIG_REPORT_APPLIED: the reply is CONFIG_DONE | applied << 8 | writes << 16
+// (applied: CONFIG_APPLIED_* of ADC/DAC/DAC-BRAM/Trigger-Configs, writes: cached register-writes)
+#define CONFIG_REPORT_APPLIED 1
+#define CONFIG_APPLIED_NONE 0x0      // same as the active config, nothing written
+#define CONFIG_APPLIED_REGS 0x1      // module was configured
+#define CONFIG_APPLIED_LUT 0x2       // LUT was loaded into the BRAM
+#define CONFIG_APPLIED_RAM_MODE 0x4  // RAM-Writer-mode was set
+#define CONFIG_REPLY_MAX_WRITES 0x7FFF
+// Store Current LUT from BRAM to .csv-file with _adj-suffix (val: LUT_STORE_CSV/LUT_STORE_BIN)
 #define STORE_LUT 77
+#define LUT_STORE_CSV 0
+#define LUT_STORE_BIN 1  // lut/lut_portX_adj.bin (LutBinHeader + DAC-codes)
+// Send LUT of DAC-BRAM-Controller-Port ch in binary format (LutBinHeader + uint32 DAC-codes[no_steps])
+#define GET_LUT_BIN 56
+// binary LUT (NEW_CONFIG with LUT_CONFIG_ID, GET_LUT_BIN, .bin-files)
+#define LUT_BIN_MAGIC 0x544C5052
+#define LUT_BIN_VERSION 1
+// upload only: float32 voltages instead of DAC-codes, converted on RedPitaya (rp_lut.c)
+#define LUT_BIN_VERSION_VOLTAGE 2
 // Start sampling data with ADC
 #define START_ADC_SAMPLING 80
+// header of BRAM-uploads (DUMMY_DATA_GEN_BRAM_ID/LIA_MIXER_BRAM_ID)
+#define BRAM_UPLOAD_MAGIC 0x55425052
 // Command to receive new BRAM data
 #define RECV_BRAM_DATA 83
 #define RECV_BRAM_DATA_DONE 84
@@ -129,6 +205,16 @@
 #define EXIT_APP 90
 // Test SPI Interface
 #define SPI_TEST 91
+// Switch verbose-mode (debug-traces) at runtime (val: 0 = off, 1 = on)
+#define SET_VERBOSE 93
+// Benchmark of the conversion-kernels (val: no. of samples, 0 = default)
+#define CONVERT_BENCH 92
+#define CONVERT_BENCH_DEFAULT_SAMPLES 65536
+#define CONVERT_BENCH_RUNS 100
+// Check of the software-LIA, NEON- against scalar-version (val: no. of samples, 0 = default)
+#define LIA_SW_CHECK 98
+#define LIA_SW_CHECK_DEFAULT_SAMPLES 10000
+#define LIA_SW_CHECK_MAX_SAMPLES 1048576
 // Debug command (for testing)
 #define DEBUG 99
 // debug adc20 read and write
@@ -155,6 +241,54 @@
 #define GET_DAC_BRAM_SAMPLE_CNT 130
 #define GET_DAC_BRAM_SIGNAL_CNT 131
 
+// Batched command protocol: frames start with BATCH_FRAME_MAGIC instead of a TcpCmd-id ("RPBF")
+#define BATCH_FRAME_MAGIC 0x46425052
+#define BATCH_PROTOCOL_VERSION 1
+#define MAX_BATCH_CMDS 256
+// status for each command in the response-frame
+#define BATCH_STATUS_OK 0
+#define BATCH_STATUS_NOT_ALLOWED -1     // command needs more data or streams data (not possible in batch)
+#define BATCH_STATUS_BAD_VERSION -2     // frame with unknown protocol-version
+#define BATCH_STATUS_SKIPPED -3         // not executed, an earlier command closed the connection
+
+// Command-sequences: program (SeqProgramHeader + SeqOp[]) is executed on RedPitaya ("RPSQ"/"RPSR")
+#define START_SEQUENCE 59
+#define SEQ_PROGRAM_MAGIC 0x51535052
+#define SEQ_RESULT_MAGIC 0x52535052
+#define SEQ_PROTOCOL_VERSION 1
+// operations of a sequence-program
+#define SEQ_OP_CMD 0         // execute command (id, ch, val) like inside a batch
+#define SEQ_OP_WAIT_UNTIL 1  // wait till val us after the start of the program
+#define SEQ_OP_DELAY 2       // wait till val us after the previous deadline (no drift inside loops)
+#define SEQ_OP_LOOP 3        // repeat the ops till the matching SEQ_OP_END_LOOP count times
+#define SEQ_OP_END_LOOP 4
+#define SEQ_FLAG_CAPTURE 0x1  // store reply-value of SEQ_OP_CMD in the result-buffer
+// status of the result
+#define SEQ_STATUS_OK 0
+#define SEQ_STATUS_RESULTS_FULL 1  // more captures than max_results, the rest was dropped
+#define SEQ_STATUS_STOPPED 2       // a command closed the connection, the program was stopped
+#define SEQ_STATUS_STEP_LIMIT 3    // more than SEQ_MAX_STEPS ops executed
+
+// Local recording of the continous ADC-stream into an indexed chunk-file (rp_recorder.h)
+#define START_RECORD 94      // RecConfig follows, reply: no. of chunks written or SERVER_ERROR_ID
+#define GET_RECORD_INFO 95   // ch: rec_id, reply: ACK + RecFileHeader + RecChunkInfo[no_chunks]
+#define GET_RECORD_RANGE 96  // RecRangeRequest follows, reply: RecRangeHeader + samples
+#define REC_STORAGE_SD 0     // rec/ on the SD-card
+#define REC_STORAGE_TMPFS 1  // /dev/shm/ (RAM, lost on reboot)
+#define REC_FILE_MAGIC 0x43455250   // "PREC"
+#define REC_CHUNK_MAGIC 0x4B484352  // "RCHK"
+#define REC_RANGE_MAGIC 0x47525052  // "RPRG"
+#define REC_FILE_VERSION 1
+
+// Runtime-metrics of the server (rp_metrics.h)
+#define GET_STATS 97        // ch: STATS_RESET clears the metrics after the snapshot, reply: ACK + StatsSnapshotHeader + StatsCmdEntry[no_cmds]
+#define STATS_RESET 1
+#define STATS_MAGIC 0x54535052  // "RPST"
+#define STATS_VERSION 1
+#define METRICS_PORT 9102                  // Prometheus-Exporter
+#define METRICS_PORT_ENV "RP_METRICS_PORT"  // env.: other port for the exporter, 0 = disabled
+#define METRICS_BIND_ENV "RP_METRICS_BIND"  // env.: IPv4-address of the exporter (default: loopback)
+
 // Acknowledge signal (used for all commands where we need an ACK-Feedback (both ways))
 #define ACK 1
 // for handling a client which closes the connection
@@ -173,6 +307,7 @@
 #define LIA_MIXER_BRAM_ID 9
 #define LIA_IIR_CONFIG_ID 10
 #define CLK_DIVIDER_CONFIG_ID 11
+#define LIA_STREAM_CONFIG_ID 12
 #define SPI_CONFIG_ID 20
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,212 @@
+/*
+ * rp_convert.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Array-conversion of raw ADC-data, see rp_convert.h
+ *
+ *    The NEON-kernels convert 16 frames (ADC-Clicks) or 8 words (RF-ADC) per iteration,
+ *    the rest of the array is converted with the scalar version.
+ */
+
+#include "rp_convert.h"
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#define ADC20_SCALE_12BIT (ADC20_FULL_SCALE_MV / 4095.0f)
+#define ADC20_SCALE_16BIT (ADC20_FULL_SCALE_MV / 65535.0f)
+#define ADC24_SCALE (ADC24_FULL_SCALE_MV / 4095.0f)
+
+static inline int16_t sign_extend_14bit(uint16_t x) {
+    return (int16_t)(x << (16 - RF_ADC_BITS)) >> (16 - RF_ADC_BITS);
+}
+
+/**************************************************************/
+/* scalar versions                                            */
+/**************************************************************/
+
+void convert_adc20_frames_scalar(const uint8_t* frames, int n, int average, float* mV, uint8_t* ch_id) {
+    for (int i = 0; i < n; i++, frames += 3) {
+        if (!average) {
+            // 12-bit data followed by 4-bit channel-id
+            mV[i] = (float)(((uint16_t)frames[0] << 4) | (frames[1] >> 4)) * ADC20_SCALE_12BIT;
+            ch_id[i] = frames[1] & 0x0F;
+        } else {
+            // 16-bit averaged data, channel-id in upper nibble of third byte
+            mV[i] = (float)(((uint16_t)frames[0] << 8) | frames[1]) * ADC20_SCALE_16BIT;
+            ch_id[i] = frames[2] >> 4;
+        }
+    }
+}
+
+void convert_adc24_frames_scalar(const uint8_t* frames, int n, bool twos_complement, float* mV, uint8_t* ch_id) {
+    for (int i = 0; i < n; i++, frames += 2) {
+        uint16_t frame = ((uint16_t)frames[0] << 8) | frames[1];
+        ch_id[i] = frame >> 12;
+        if (twos_complement) {
+            mV[i] = (float)((int16_t)(frame << 4) >> 4) * ADC24_SCALE;
+        } else {
+            mV[i] = (float)(frame & 0x0FFF) * ADC24_SCALE;
+        }
+    }
+}
+
+void convert_rf_adc_words_scalar(const uint32_t* words, int n, const RfAdcCalib* calib, float* ch_a, float* ch_b) {
+    for (int i = 0; i < n; i++) {
+        ch_a[i] = (float)sign_extend_14bit((uint16_t)words[i]) * calib->gain[0] + calib->offset[0];
+        ch_b[i] = (float)sign_extend_14bit((uint16_t)(words[i] >> 16)) * calib->gain[1] + calib->offset[1];
+    }
+}
+
+void accumulate_rf_adc_words_scalar(const uint32_t* words, int n, int32_t* sum_a, int32_t* sum_b) {
+    for (int i = 0; i < n; i++) {
+        sum_a[i] += sign_extend_14bit((uint16_t)words[i]);
+        sum_b[i] += sign_extend_14bit((uint16_t)(words[i] >> 16));
+    }
+}
+
+void copy_words_scalar(volatile uint32_t* dst, const volatile uint32_t* src, int n) {
+    // one 32-bit access per word (volatile: no byte-wise or merged accesses by the compiler)
+    for (int i = 0; i < n; i++) dst[i] = src[i];
+}
+
+/**************************************************************/
+/* NEON versions                                              */
+/**************************************************************/
+
+#ifdef __ARM_NEON
+
+static inline void store_u16_as_f32(uint16x8_t x, float scale, float* out) {
+    vst1q_f32(out, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(x))), scale));
+    vst1q_f32(out + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(x))), scale));
+}
+
+static inline void store_s16_as_f32(int16x8_t x, float scale, float* out) {
+    vst1q_f32(out, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+    vst1q_f32(out + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+}
+
+void convert_adc20_frames(const uint8_t* frames, int n, int average, float* mV, uint8_t* ch_id) {
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        // de-interleave 16 frames into byte 0, 1 and 2 of each frame
+        uint8x16x3_t f = vld3q_u8(frames + 3 * i);
+        uint16x8_t raw_lo, raw_hi;
+
+        if (!average) {
+            uint8x16_t low_nibble = vshrq_n_u8(f.val[1], 4);
+            raw_lo = vorrq_u16(vshll_n_u8(vget_low_u8(f.val[0]), 4), vmovl_u8(vget_low_u8(low_nibble)));
+            raw_hi = vorrq_u16(vshll_n_u8(vget_high_u8(f.val[0]), 4), vmovl_u8(vget_high_u8(low_nibble)));
+            vst1q_u8(ch_id + i, vandq_u8(f.val[1], vdupq_n_u8(0x0F)));
+            store_u16_as_f32(raw_lo, ADC20_SCALE_12BIT, mV + i);
+            store_u16_as_f32(raw_hi, ADC20_SCALE_12BIT, mV + i + 8);
+        } else {
+            raw_lo = vorrq_u16(vshll_n_u8(vget_low_u8(f.val[0]), 8), vmovl_u8(vget_low_u8(f.val[1])));
+            raw_hi = vorrq_u16(vshll_n_u8(vget_high_u8(f.val[0]), 8), vmovl_u8(vget_high_u8(f.val[1])));
+            vst1q_u8(ch_id + i, vshrq_n_u8(f.val[2], 4));
+            store_u16_as_f32(raw_lo, ADC20_SCALE_16BIT, mV + i);
+            store_u16_as_f32(raw_hi, ADC20_SCALE_16BIT, mV + i + 8);
+        }
+    }
+    convert_adc20_frames_scalar(frames + 3 * i, n - i, average, mV + i, ch_id + i);
+}
+
+void convert_adc24_frames(const uint8_t* frames, int n, bool twos_complement, float* mV, uint8_t* ch_id) {
+    int i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        // de-interleave 16 frames into MSB and LSB
+        uint8x16x2_t f = vld2q_u8(frames + 2 * i);
+        uint16x8_t frame_lo = vorrq_u16(vshll_n_u8(vget_low_u8(f.val[0]), 8), vmovl_u8(vget_low_u8(f.val[1])));
+        uint16x8_t frame_hi = vorrq_u16(vshll_n_u8(vget_high_u8(f.val[0]), 8), vmovl_u8(vget_high_u8(f.val[1])));
+
+        vst1q_u8(ch_id + i, vshrq_n_u8(f.val[0], 4));
+        if (twos_complement) {
+            // shift channel-address out and sign-extend bit 11
+            store_s16_as_f32(vshrq_n_s16(vshlq_n_s16(vreinterpretq_s16_u16(frame_lo), 4), 4), ADC24_SCALE, mV + i);
+            store_s16_as_f32(vshrq_n_s16(vshlq_n_s16(vreinterpretq_s16_u16(frame_hi), 4), 4), ADC24_SCALE, mV + i + 8);
+        } else {
+            store_u16_as_f32(vandq_u16(frame_lo, vdupq_n_u16(0x0FFF)), ADC24_SCALE, mV + i);
+            store_u16_as_f32(vandq_u16(frame_hi, vdupq_n_u16(0x0FFF)), ADC24_SCALE, mV + i + 8);
+        }
+    }
+    convert_adc24_frames_scalar(frames + 2 * i, n - i, twos_complement, mV + i, ch_id + i);
+}
+
+void convert_rf_adc_words(const uint32_t* words, int n, const RfAdcCalib* calib, float* ch_a, float* ch_b) {
+    int i = 0;
+    float32x4_t offset_a = vdupq_n_f32(calib->offset[0]);
+    float32x4_t offset_b = vdupq_n_f32(calib->offset[1]);
+
+    for (; i + 8 <= n; i += 8) {
+        // de-interleave lower (A) and upper (B) half-words, sign-extend the 14-bit values
+        int16x8x2_t w = vld2q_s16((const int16_t*)(words + i));
+        int16x8_t a = vshrq_n_s16(vshlq_n_s16(w.val[0], 16 - RF_ADC_BITS), 16 - RF_ADC_BITS);
+        int16x8_t b = vshrq_n_s16(vshlq_n_s16(w.val[1], 16 - RF_ADC_BITS), 16 - RF_ADC_BITS);
+
+        // offset + raw * gain (Cortex-A9 has no fused multiply-add)
+        vst1q_f32(ch_a + i, vmlaq_n_f32(offset_a, vcvtq_f32_s32(vmovl_s16(vget_low_s16(a))), calib->gain[0]));
+        vst1q_f32(ch_a + i + 4, vmlaq_n_f32(offset_a, vcvtq_f32_s32(vmovl_s16(vget_high_s16(a))), calib->gain[0]));
+        vst1q_f32(ch_b + i, vmlaq_n_f32(offset_b, vcvtq_f32_s32(vmovl_s16(vget_low_s16(b))), calib->gain[1]));
+        vst1q_f32(ch_b + i + 4, vmlaq_n_f32(offset_b, vcvtq_f32_s32(vmovl_s16(vget_high_s16(b))), calib->gain[1]));
+    }
+    convert_rf_adc_words_scalar(words + i, n - i, calib, ch_a + i, ch_b + i);
+}
+
+void accumulate_rf_adc_words(const uint32_t* words, int n, int32_t* sum_a, int32_t* sum_b) {
+    int i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        int16x8x2_t w = vld2q_s16((const int16_t*)(words + i));
+        int16x8_t a = vshrq_n_s16(vshlq_n_s16(w.val[0], 16 - RF_ADC_BITS), 16 - RF_ADC_BITS);
+        int16x8_t b = vshrq_n_s16(vshlq_n_s16(w.val[1], 16 - RF_ADC_BITS), 16 - RF_ADC_BITS);
+
+        // widening add of the 16-bit values to the 32-bit accumulators
+        vst1q_s32(sum_a + i, vaddw_s16(vld1q_s32(sum_a + i), vget_low_s16(a)));
+        vst1q_s32(sum_a + i + 4, vaddw_s16(vld1q_s32(sum_a + i + 4), vget_high_s16(a)));
+        vst1q_s32(sum_b + i, vaddw_s16(vld1q_s32(sum_b + i), vget_low_s16(b)));
+        vst1q_s32(sum_b + i + 4, vaddw_s16(vld1q_s32(sum_b + i + 4), vget_high_s16(b)));
+    }
+    accumulate_rf_adc_words_scalar(words + i, n - i, sum_a + i, sum_b + i);
+}
+
+void copy_words(volatile uint32_t* dst, const volatile uint32_t* src, int n) {
+    int i = 0;
+
+    // single words till dst is 16-byte aligned, src has to reach the same alignment
+    while (i < n && ((uintptr_t)(dst + i) & 15) != 0) {
+        dst[i] = src[i];
+        i++;
+    }
+    if (((uintptr_t)(src + i) & 15) == 0) {
+        for (; i + 4 <= n; i += 4) vst1q_u32((uint32_t*)(dst + i), vld1q_u32((const uint32_t*)(src + i)));
+    }
+    copy_words_scalar(dst + i, src + i, n - i);
+}
+
+#else
+
+void convert_adc20_frames(const uint8_t* frames, int n, int average, float* mV, uint8_t* ch_id) {
+    convert_adc20_frames_scalar(frames, n, average, mV, ch_id);
+}
+
+void convert_adc24_frames(const uint8_t* frames, int n, bool twos_complement, float* mV, uint8_t* ch_id) {
+    convert_adc24_frames_scalar(frames, n, twos_complement, mV, ch_id);
+}
+
+void convert_rf_adc_words(const uint32_t* words, int n, const RfAdcCalib* calib, float* ch_a, float* ch_b) {
+    convert_rf_adc_words_scalar(words, n, calib, ch_a, ch_b);
+}
+
+void accumulate_rf_adc_words(const uint32_t* words, int n, int32_t* sum_a, int32_t* sum_b) {
+    accumulate_rf_adc_words_scalar(words, n, sum_a, sum_b);
+}
+
+void copy_words(volatile uint32_t* dst, const volatile uint32_t* src, int n) {
+    copy_words_scalar(dst, src, n);
+}
+
+#endif
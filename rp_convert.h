@@ -0,0 +1,59 @@
+/*
+ * rp_convert.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Array-conversion of raw ADC-data to physical values:
+ *
+ *     -- ADC20 Click: 3-byte frames with appended channel-id, 12-bit (no averaging)
+ *        or 16-bit (averaging) data -> mV + channel-id
+ *
+ *     -- ADC24 Click: 16-bit frames (MSB first) with 4-bit channel-address and 12-bit data,
+ *        straight binary or two's complement (sign-extended) -> mV + channel-id
+ *
+ *     -- RF-ADC: 32-bit words with two 14-bit channels (two's complement, channel A in the
+ *        lower, channel B in the upper half-word) -> V with gain/offset-calibration
+ *
+ *     -- RF-ADC accumulation: adds the sign-extended raw values of both channels to
+ *        int32-accumulators (coherent averaging of sweeps, no conversion)
+ *
+ *     -- word-copy into/out of the BRAM-windows: 128-bit loads/stores on aligned
+ *        addresses instead of the byte-wise memcpy() on uncached device-memory
+ *
+ *    Uses NEON on the Cortex-A9 of the Zynq (__ARM_NEON), the scalar versions are used as
+ *    portable fallback and are also compiled on ARM to compare both in the benchmark.
+ */
+
+#ifndef SRC_RP_CONVERT_H
+#define SRC_RP_CONVERT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ADC20_FULL_SCALE_MV 3300.0f
+#define ADC24_FULL_SCALE_MV 4096.0f
+#define RF_ADC_BITS 14
+
+// calibration of the RF-ADC: value_V = raw * gain + offset
+typedef struct {
+    float gain[2];    // V per LSB for channel A/B
+    float offset[2];  // V
+} RfAdcCalib;
+
+void convert_adc20_frames(const uint8_t* frames, int n, int average, float* mV, uint8_t* ch_id);
+void convert_adc24_frames(const uint8_t* frames, int n, bool twos_complement, float* mV, uint8_t* ch_id);
+void convert_rf_adc_words(const uint32_t* words, int n, const RfAdcCalib* calib, float* ch_a, float* ch_b);
+
+void accumulate_rf_adc_words(const uint32_t* words, int n, int32_t* sum_a, int32_t* sum_b);
+void copy_words(volatile uint32_t* dst, const volatile uint32_t* src, int n);
+
+void convert_adc20_frames_scalar(const uint8_t* frames, int n, int average, float* mV, uint8_t* ch_id);
+void convert_adc24_frames_scalar(const uint8_t* frames, int n, bool twos_complement, float* mV, uint8_t* ch_id);
+void convert_rf_adc_words_scalar(const uint32_t* words, int n, const RfAdcCalib* calib, float* ch_a, float* ch_b);
+
+void accumulate_rf_adc_words_scalar(const uint32_t* words, int n, int32_t* sum_a, int32_t* sum_b);
+void copy_words_scalar(volatile uint32_t* dst, const volatile uint32_t* src, int n);
+
+void convert_benchmark(int n, int no_runs);
+
+#endif
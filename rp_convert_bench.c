@@ -0,0 +1,189 @@
+/*
+ * rp_convert_bench.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Benchmark of the conversion-kernels (rp_convert.c): throughput of the NEON-kernels,
+ *    the scalar versions and the per-sample functions of the Click-Board drivers.
+ *    The results of NEON and scalar version are compared as well.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rp_adc_codec.h"
+#include "rp_convert.h"
+#include "rp_click_boards/adc20click.h"
+#include "rp_click_boards/adc24click.h"
+
+static double elapsed_s(struct timespec* t_start, struct timespec* t_end) {
+    return (t_end->tv_sec - t_start->tv_sec) + (t_end->tv_nsec - t_start->tv_nsec) * 1e-9;
+}
+
+static void print_result(const char* name, int n, int no_runs, struct timespec* t_start, struct timespec* t_end) {
+    double duration_s = elapsed_s(t_start, t_end);
+    printf("    %-28s %10.2f MSamples/s\n", name, (double)n * no_runs / duration_s / 1e6);
+}
+
+static float max_diff(const float* a, const float* b, int n) {
+    float diff = 0;
+    for (int i = 0; i < n; i++) {
+        if (fabsf(a[i] - b[i]) > diff) diff = fabsf(a[i] - b[i]);
+    }
+    return diff;
+}
+
+static void bench_adc_codec(uint32_t* words, int n, int no_runs) {
+    // delta/bit-plane-codec of the compressed continous-mode on a noisy sine (random words don't compress)
+    size_t ch_size = ((size_t)n + ADC_CODEC_BLOCK) * sizeof(int16_t);
+    int16_t* a = malloc(ch_size);
+    int16_t* b = malloc(ch_size);
+    uint8_t* out = malloc(adc_codec_max_bytes(n));
+    uint8_t* out_ref = malloc(adc_codec_max_bytes(n));
+    struct timespec t_start, t_end;
+    size_t len = 0, len_ref = 0;
+
+    if (a == NULL || b == NULL || out == NULL || out_ref == NULL) {
+        printf("Allocating codec-buffers failed\n");
+        goto cleanup;
+    }
+    for (int i = 0; i < n; i++) {
+        int v = (int)(6000.0f * sinf(i * 0.001f)) + (rand() % 64) - 32;
+        words[i] = ((uint32_t)v & 0x3FFF) | (((uint32_t)(v / 2) & 0x3FFF) << 16);
+    }
+
+    printf("  RF-ADC-Codec (split + delta/bit-plane-encode):\n");
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    for (int r = 0; r < no_runs; r++) {
+        adc_codec_split_scalar(words, n, a, b);
+        len_ref = adc_codec_encode_scalar(a, b, n, out_ref);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    print_result("scalar", n, no_runs, &t_start, &t_end);
+
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    for (int r = 0; r < no_runs; r++) {
+        adc_codec_split(words, n, a, b);
+        len = adc_codec_encode(a, b, n, out);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    print_result("kernel", n, no_runs, &t_start, &t_end);
+    printf("    compression: %.2f, kernel/scalar %s\n", (double)n * sizeof(uint32_t) / len,
+           (len == len_ref && memcmp(out, out_ref, len) == 0) ? "identical" : "DIFFERENT");
+
+cleanup:
+    free(a);
+    free(b);
+    free(out);
+    free(out_ref);
+}
+
+void convert_benchmark(int n, int no_runs) {
+    uint8_t* frames = malloc((size_t)n * 3);
+    uint32_t* words = malloc((size_t)n * sizeof(uint32_t));
+    float* out = malloc((size_t)n * sizeof(float));
+    float* out_ref = malloc((size_t)n * sizeof(float));
+    float* out_b = malloc((size_t)n * sizeof(float));
+    uint8_t* ch_id = malloc((size_t)n);
+    int* out_mV = malloc((size_t)n * sizeof(int));
+    RfAdcCalib calib = {{0.5e-3f / 8.192f, 0.5e-3f / 8.192f}, {0.001f, -0.002f}};
+    struct timespec t_start, t_end;
+    volatile int sink = 0;
+
+    if (frames == NULL || words == NULL || out == NULL || out_ref == NULL || out_b == NULL || ch_id == NULL || out_mV == NULL) {
+        printf("Allocating benchmark-buffers failed\n");
+        goto cleanup;
+    }
+
+    srand(1);
+    for (int i = 0; i < n * 3; i++) frames[i] = (uint8_t)rand();
+    for (int i = 0; i < n; i++) words[i] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+
+    printf("##### Conversion-Benchmark: %d samples, %d runs #####\n", n, no_runs);
+#ifdef __ARM_NEON
+    printf("    NEON: on\n");
+#else
+    printf("    NEON: off (scalar fallback)\n");
+#endif
+
+    for (int average = 0; average <= 1; average++) {
+        printf("  ADC20 (%s):\n", average ? "16-bit" : "12-bit");
+        clock_gettime(CLOCK_MONOTONIC, &t_start);
+        for (int r = 0; r < no_runs; r++) {
+            for (int i = 0; i < n; i++) {
+                uint16_t raw = average ? (((uint16_t)frames[3 * i] << 8) | frames[3 * i + 1])
+                                       : (((uint16_t)frames[3 * i] << 4) | (frames[3 * i + 1] >> 4));
+                out_mV[i] = convert_adc20raw16_to_mV(raw, average);
+            }
+            sink += out_mV[n - 1];
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t_end);
+        print_result("convert_adc20raw16_to_mV", n, no_runs, &t_start, &t_end);
+
+        clock_gettime(CLOCK_MONOTONIC, &t_start);
+        for (int r = 0; r < no_runs; r++) convert_adc20_frames_scalar(frames, n, average, out_ref, ch_id);
+        clock_gettime(CLOCK_MONOTONIC, &t_end);
+        print_result("scalar", n, no_runs, &t_start, &t_end);
+
+        clock_gettime(CLOCK_MONOTONIC, &t_start);
+        for (int r = 0; r < no_runs; r++) convert_adc20_frames(frames, n, average, out, ch_id);
+        clock_gettime(CLOCK_MONOTONIC, &t_end);
+        print_result("kernel", n, no_runs, &t_start, &t_end);
+        printf("    max. difference kernel/scalar: %g mV\n", max_diff(out, out_ref, n));
+    }
+
+    for (int twos = 0; twos <= 1; twos++) {
+        printf("  ADC24 (%s):\n", twos ? "two's complement" : "straight binary");
+        if (!twos) {
+            clock_gettime(CLOCK_MONOTONIC, &t_start);
+            for (int r = 0; r < no_runs; r++) {
+                for (int i = 0; i < n; i++) {
+                    uint16_t raw = (((uint16_t)frames[2 * i] << 8) | frames[2 * i + 1]) & 0x0FFF;
+                    out_mV[i] = convert_adc24raw16_to_mV(raw);
+                }
+                sink += out_mV[n - 1];
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t_end);
+            print_result("convert_adc24raw16_to_mV", n, no_runs, &t_start, &t_end);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &t_start);
+        for (int r = 0; r < no_runs; r++) convert_adc24_frames_scalar(frames, n, twos, out_ref, ch_id);
+        clock_gettime(CLOCK_MONOTONIC, &t_end);
+        print_result("scalar", n, no_runs, &t_start, &t_end);
+
+        clock_gettime(CLOCK_MONOTONIC, &t_start);
+        for (int r = 0; r < no_runs; r++) convert_adc24_frames(frames, n, twos, out, ch_id);
+        clock_gettime(CLOCK_MONOTONIC, &t_end);
+        print_result("kernel", n, no_runs, &t_start, &t_end);
+        printf("    max. difference kernel/scalar: %g mV\n", max_diff(out, out_ref, n));
+    }
+
+    printf("  RF-ADC (2x14-bit, calibrated):\n");
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    for (int r = 0; r < no_runs; r++) convert_rf_adc_words_scalar(words, n, &calib, out_ref, out_b);
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    print_result("scalar", n, no_runs, &t_start, &t_end);
+
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    for (int r = 0; r < no_runs; r++) convert_rf_adc_words(words, n, &calib, out, out_b);
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    print_result("kernel", n, no_runs, &t_start, &t_end);
+    printf("    max. difference kernel/scalar (ch. A): %g V\n", max_diff(out, out_ref, n));
+
+    bench_adc_codec(words, n, no_runs);
+
+    (void)sink;
+
+cleanup:
+    free(frames);
+    free(words);
+    free(out);
+    free(out_ref);
+    free(out_b);
+    free(ch_id);
+    free(out_mV);
+}
@@ -0,0 +1,444 @@
+/*
+ * rp_hal.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Hardware-abstraction for the AXI-register-windows, see rp_hal.h
+ */
+
+#include "rp_hal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rp_constants.h"
+#include "rp_ram.h"
+#include "rp_reset.h"
+
+// register-window of one AXI-device
+typedef struct {
+    size_t field;      // offset of the pointer inside AxiDevs
+    off_t base;        // physical base-address (AXI_BASE_ADDR_* of the FPGA-image)
+    bool bram;         // BRAM-window (AXI_BRAM_RANGE) or register-window (AXI_SLAVE_REG_RANGE)
+    const char* name;  // NULL terminates hal_windows
+} HalWindow;
+
+#define HAL_WINDOW(dev, base_addr, is_bram) {offsetof(AxiDevs, dev), (off_t)(base_addr), is_bram, #dev}
+
+// windows of the devices, devices without base-address in the current FPGA-image stay NULL
+static const HalWindow hal_windows[] = {
+#ifdef AXI_BASE_ADDR_GPIO_RSTN
+    HAL_WINDOW(reset, AXI_BASE_ADDR_GPIO_RSTN, false),
+#endif
+#ifdef AXI_BASE_ADDR_BRAM_PORT0
+    HAL_WINDOW(bram[0], AXI_BASE_ADDR_BRAM_PORT0, true),
+#endif
+#if defined(AXI_BASE_ADDR_BRAM_PORT1) && NO_DAC_BRAM_INTERFACES_USED > 1
+    HAL_WINDOW(bram[1], AXI_BASE_ADDR_BRAM_PORT1, true),
+#endif
+#ifdef AXI_BASE_ADDR_DAC_BRAM_CTRL_PORT0
+    HAL_WINDOW(dac_bram_ctrl[0], AXI_BASE_ADDR_DAC_BRAM_CTRL_PORT0, false),
+#endif
+#if defined(AXI_BASE_ADDR_DAC_BRAM_CTRL_PORT1) && NO_DAC_BRAM_INTERFACES_USED > 1
+    HAL_WINDOW(dac_bram_ctrl[1], AXI_BASE_ADDR_DAC_BRAM_CTRL_PORT1, false),
+#endif
+#ifdef AXI_BASE_ADDR_BRAM_CTRL_SYNC
+    HAL_WINDOW(bram_sync, AXI_BASE_ADDR_BRAM_CTRL_SYNC, false),
+#endif
+#ifdef AXI_BASE_ADDR_TRIGGER_GEN
+    HAL_WINDOW(trigger_gen, AXI_BASE_ADDR_TRIGGER_GEN, false),
+#endif
+#ifdef AXI_BASE_ADDR_RP_DAC
+    HAL_WINDOW(rp_dac, AXI_BASE_ADDR_RP_DAC, false),
+#endif
+#ifdef AXI_BASE_ADDR_AD_DAC
+    HAL_WINDOW(ad_dac, AXI_BASE_ADDR_AD_DAC, false),
+#endif
+#ifdef AXI_BASE_ADDR_PDM
+    HAL_WINDOW(pdm, AXI_BASE_ADDR_PDM, false),
+#endif
+#ifdef AXI_BASE_ADDR_GPIO_LEDS
+    HAL_WINDOW(leds, AXI_BASE_ADDR_GPIO_LEDS, false),
+#endif
+#ifdef AXI_BASE_ADDR_XADC
+    HAL_WINDOW(xadc, AXI_BASE_ADDR_XADC, false),
+#endif
+#ifdef AXI_BASE_ADDR_RP_ADC
+    HAL_WINDOW(adc, AXI_BASE_ADDR_RP_ADC, false),
+#endif
+#ifdef AXI_BASE_ADDR_ADC_MUX
+    HAL_WINDOW(adc_mux_4x1, AXI_BASE_ADDR_ADC_MUX, false),
+#endif
+#ifdef AXI_BASE_ADDR_DUMMY_DATA_GEN
+    HAL_WINDOW(dummy_data_gen, AXI_BASE_ADDR_DUMMY_DATA_GEN, false),
+#endif
+#ifdef AXI_BASE_ADDR_CLK_DIVIDER
+    HAL_WINDOW(clk_divider, AXI_BASE_ADDR_CLK_DIVIDER, false),
+#endif
+#ifdef AXI_BASE_ADDR_DUMMY_DATA_GEN_BRAM
+    HAL_WINDOW(dummy_data_gen_bram, AXI_BASE_ADDR_DUMMY_DATA_GEN_BRAM, true),
+#endif
+#ifdef AXI_BASE_ADDR_RAM_WRITER
+    HAL_WINDOW(ram, AXI_BASE_ADDR_RAM_WRITER, false),
+#endif
+#ifdef AXI_BASE_ADDR_RAM_MUX
+    HAL_WINDOW(ram_mux_8x1, AXI_BASE_ADDR_RAM_MUX, false),
+#endif
+#ifdef AXI_BASE_ADDR_LIA_MIXER
+    HAL_WINDOW(lia_mixer, AXI_BASE_ADDR_LIA_MIXER, false),
+#endif
+#ifdef AXI_BASE_ADDR_LIA_MIXER_BRAM
+    HAL_WINDOW(lia_mixer_bram, AXI_BASE_ADDR_LIA_MIXER_BRAM, true),
+#endif
+#ifdef AXI_BASE_ADDR_LIA_IIR
+    HAL_WINDOW(lia_iir, AXI_BASE_ADDR_LIA_IIR, false),
+#endif
+    {0, 0, false, NULL},
+};
+
+// devices the server can't run without (reset-GPIO, ADC, RAM-Writer, Trigger-Generator)
+static const size_t hal_required[] = {offsetof(AxiDevs, reset), offsetof(AxiDevs, adc), offsetof(AxiDevs, ram),
+                                      offsetof(AxiDevs, trigger_gen)};
+static const char* const hal_required_names[] = {"reset (AXI_BASE_ADDR_GPIO_RSTN)", "adc (AXI_BASE_ADDR_RP_ADC)",
+                                                 "ram (AXI_BASE_ADDR_RAM_WRITER)", "trigger_gen (AXI_BASE_ADDR_TRIGGER_GEN)"};
+
+#define HAL_NO_REQUIRED (sizeof(hal_required) / sizeof(hal_required[0]))
+#define HAL_NO_DEVICES (sizeof(AxiDevs) / sizeof(void*))
+
+typedef struct {
+    HalBackend backend;
+    bool initialized;
+    int mem_fd;
+    AxiDevs devs;  // mapped windows, for hal_release() and the simulator
+
+    // simulator
+    pthread_t sim_thread;
+    bool sim_running;
+    volatile bool sim_stop;
+    pthread_mutex_t sim_lock;  // protects cfg, RAM-buffer and stats
+    HalSimConfig sim_cfg;
+    int32_t* sim_ram;
+    uint32_t sim_wrap;  // samples after which the RAM-Writer wraps around
+    uint32_t sim_pos;
+    int sim_divider;  // sample_rate_divider of the last AdcConfig
+    HalSimStats sim_stats;
+    int sim_trigger_fd;                // eventfd, written for every simulated trigger
+    volatile uint64_t sim_trigger_ns;  // CLOCK_MONOTONIC-time of the last simulated trigger
+} Hal;
+
+static Hal hal = {.mem_fd = -1, .sim_trigger_fd = -1};
+
+static void** hal_field(AxiDevs* axi_devs, size_t field) {
+    return (void**)((char*)axi_devs + field);
+}
+
+static size_t hal_window_range(const HalWindow* w) {
+    return w->bram ? (size_t)AXI_BRAM_RANGE : (size_t)AXI_SLAVE_REG_RANGE;
+}
+
+/**************************************************************/
+/* /dev/mem-backend                                           */
+/**************************************************************/
+
+static bool hal_devmem_has_window(size_t field) {
+    for (const HalWindow* w = hal_windows; w->name != NULL; w++) {
+        if (w->field == field) return true;
+    }
+    return false;
+}
+
+static int hal_devmem_init(AxiDevs* axi_devs) {
+    // the module-functions don't check their pointers, so a missing base-address is fatal
+    for (size_t i = 0; i < HAL_NO_REQUIRED; i++) {
+        if (!hal_devmem_has_window(hal_required[i])) {
+            printf("AXI-device %s has no base-address in proj_constants.h\n", hal_required_names[i]);
+            return -1;
+        }
+    }
+
+    hal.mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
+    if (hal.mem_fd < 0) {
+        printf("Opening /dev/mem failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    for (const HalWindow* w = hal_windows; w->name != NULL; w++) {
+        void* window = mmap(NULL, hal_window_range(w), PROT_READ | PROT_WRITE, MAP_SHARED, hal.mem_fd, w->base);
+        if (window == MAP_FAILED) {
+            printf("Mapping AXI-device %s at 0x%08lx failed: %s\n", w->name, (unsigned long)w->base, strerror(errno));
+            hal_release(axi_devs);
+            return -1;
+        }
+        *hal_field(axi_devs, w->field) = window;
+    }
+    return 0;
+}
+
+/**************************************************************/
+/* simulator-backend                                          */
+/**************************************************************/
+
+static bool hal_sim_module_enabled(int reset_index) {
+    uint32_t reset = *(volatile uint32_t*)((char*)hal.devs.reset + HAL_RESET_REG_OFFSET);
+    return (reset >> reset_index) & 1;
+}
+
+static double hal_sim_env(const char* name, double default_value) {
+    const char* value = getenv(name);
+    return (value != NULL) ? atof(value) : default_value;
+}
+
+static void hal_sim_ram_writer(double dt, double* acc) {
+    // writes the samples of the last dt seconds into the RAM-buffer and advances pos
+    volatile uint32_t* pos_reg = (volatile uint32_t*)((char*)hal.devs.ram + HAL_RAM_WRITER_POS_OFFSET);
+
+    if (hal.sim_ram == NULL || !hal_sim_module_enabled(RESET_INDEX_RAM_WRITER)) {
+        // module in reset: write-position starts at 0 again
+        hal.sim_pos = 0;
+        *acc = 0;
+        __atomic_store_n(pos_reg, 0, __ATOMIC_RELEASE);
+        return;
+    }
+
+    *acc += hal.sim_cfg.sample_rate_hz / hal.sim_divider * dt;
+    uint64_t n = (uint64_t)*acc;
+    *acc -= (double)n;
+    if (n > hal.sim_wrap) n = hal.sim_wrap;  // more than one lap per tick can't be seen by a reader anyway
+
+    // counter-pattern: sample = total sample-index, so a receiver can check for gaps
+    uint32_t value = (uint32_t)hal.sim_stats.samples_written;
+    for (uint64_t i = 0; i < n; i++) {
+        hal.sim_ram[hal.sim_pos] = (int32_t)value++;
+        if (++hal.sim_pos == hal.sim_wrap) hal.sim_pos = 0;
+    }
+    hal.sim_stats.samples_written += n;
+
+    // data has to be visible before the new position
+    __atomic_store_n(pos_reg, hal.sim_pos, __ATOMIC_RELEASE);
+}
+
+static uint64_t hal_sim_counter(bool enabled, double rate_hz, double dt, double* acc) {
+    // no. of events (DAC-steps, triggers) of the last dt seconds
+    if (!enabled) {
+        *acc = 0;
+        return 0;
+    }
+    *acc += rate_hz * dt;
+    uint64_t n = (uint64_t)*acc;
+    *acc -= (double)n;
+    return n;
+}
+
+static void* hal_sim_thread(void* arg) {
+    (void)arg;
+    struct timespec t_last, t_now;
+    double acc_samples = 0, acc_trigger = 0;
+    double acc_steps[NO_DAC_BRAM_INTERFACES_USED] = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &t_last);
+    while (!hal.sim_stop) {
+        usleep(HAL_SIM_TICK_US);
+        clock_gettime(CLOCK_MONOTONIC, &t_now);
+        double dt = (t_now.tv_sec - t_last.tv_sec) + (t_now.tv_nsec - t_last.tv_nsec) * 1e-9;
+        t_last = t_now;
+
+        pthread_mutex_lock(&hal.sim_lock);
+        hal_sim_ram_writer(dt, &acc_samples);
+        for (int i = 0; i < NO_DAC_BRAM_INTERFACES_USED; i++) {
+            // reset-indices of the DAC-BRAM-Controllers are consecutive
+            hal.sim_stats.dac_steps[i] += hal_sim_counter(hal_sim_module_enabled(RESET_INDEX_DAC_BRAM_CTRL_PORT0 + i),
+                                                          hal.sim_cfg.dac_step_rate_hz, dt, &acc_steps[i]);
+        }
+        uint64_t triggers = hal_sim_counter(hal_sim_module_enabled(RESET_INDEX_TRIGGER_GEN),
+                                            hal.sim_cfg.trigger_rate_hz, dt, &acc_trigger);
+        hal.sim_stats.triggers += triggers;
+        pthread_mutex_unlock(&hal.sim_lock);
+
+        if (triggers > 0) {
+            // time first, the waiting thread reads it after the eventfd
+            __atomic_store_n(&hal.sim_trigger_ns, (uint64_t)t_now.tv_sec * 1000000000ULL + (uint64_t)t_now.tv_nsec,
+                             __ATOMIC_RELEASE);
+            // fails only if the eventfd-counter is full, the waiting thread gets an event anyway
+            ssize_t ret = write(hal.sim_trigger_fd, &triggers, sizeof(triggers));
+            (void)ret;
+        }
+    }
+    return NULL;
+}
+
+static int hal_sim_init(AxiDevs* axi_devs) {
+    void** windows = (void**)axi_devs;
+
+    // every device gets a zeroed window (BRAM-size is enough for all register-windows),
+    // independent of the base-addresses of the current FPGA-image
+    for (size_t i = 0; i < HAL_NO_DEVICES; i++) {
+        windows[i] = aligned_alloc(sysconf(_SC_PAGESIZE), AXI_BRAM_RANGE);
+        if (windows[i] == NULL) {
+            printf("Allocating simulated AXI-window failed\n");
+            hal_release(axi_devs);
+            return -1;
+        }
+        memset(windows[i], 0, AXI_BRAM_RANGE);
+    }
+
+    hal.sim_cfg.sample_rate_hz = hal_sim_env(HAL_SIM_SAMPLE_RATE_ENV, ADC_SYS_CLK_HZ);
+    hal.sim_cfg.dac_step_rate_hz = hal_sim_env(HAL_SIM_DAC_STEP_RATE_ENV, HAL_SIM_DEFAULT_DAC_STEP_RATE_HZ);
+    hal.sim_cfg.trigger_rate_hz = hal_sim_env(HAL_SIM_TRIGGER_RATE_ENV, HAL_SIM_DEFAULT_TRIGGER_RATE_HZ);
+    hal.sim_divider = 1;
+    hal.devs = *axi_devs;
+    hal.sim_stop = false;
+
+    hal.sim_trigger_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (hal.sim_trigger_fd < 0) {
+        printf("Creating eventfd for simulated triggers failed: %s\n", strerror(errno));
+        hal_release(axi_devs);
+        return -1;
+    }
+
+    pthread_mutex_init(&hal.sim_lock, NULL);
+    if (pthread_create(&hal.sim_thread, NULL, hal_sim_thread, NULL) != 0) {
+        printf("Starting simulator-thread failed\n");
+        pthread_mutex_destroy(&hal.sim_lock);
+        hal_release(axi_devs);
+        return -1;
+    }
+    hal.sim_running = true;
+    printf("HAL: simulated FPGA with %.3f MS/s, %.0f DAC-steps/s, %.0f triggers/s\n", hal.sim_cfg.sample_rate_hz / 1e6,
+           hal.sim_cfg.dac_step_rate_hz, hal.sim_cfg.trigger_rate_hz);
+    return 0;
+}
+
+/**************************************************************/
+/* interface                                                  */
+/**************************************************************/
+
+int hal_init(HalBackend backend, AxiDevs* axi_devs) {
+    int ret;
+
+    if (hal.initialized) {
+        printf("HAL is already initialized\n");
+        return -1;
+    }
+    memset(axi_devs, 0, sizeof(AxiDevs));
+    hal.backend = backend;
+    hal.initialized = true;  // so hal_release() cleans up a failed init
+
+    ret = (backend == HAL_BACKEND_SIM) ? hal_sim_init(axi_devs) : hal_devmem_init(axi_devs);
+    if (ret < 0) return -1;
+
+    hal.devs = *axi_devs;
+    return 0;
+}
+
+int hal_init_from_env(AxiDevs* axi_devs) {
+    // simulator if RP_HAL_SIM is set, else the FPGA
+    return hal_init((getenv(HAL_SIM_ENV) != NULL) ? HAL_BACKEND_SIM : HAL_BACKEND_DEVMEM, axi_devs);
+}
+
+void hal_release(AxiDevs* axi_devs) {
+    if (!hal.initialized) return;
+
+    if (hal.backend == HAL_BACKEND_SIM) {
+        if (hal.sim_running) {
+            hal.sim_stop = true;
+            pthread_join(hal.sim_thread, NULL);
+            pthread_mutex_destroy(&hal.sim_lock);
+            hal.sim_running = false;
+        }
+        free(hal.sim_ram);
+        hal.sim_ram = NULL;
+        if (hal.sim_trigger_fd >= 0) close(hal.sim_trigger_fd);
+        hal.sim_trigger_fd = -1;
+
+        void** windows = (void**)axi_devs;
+        for (size_t i = 0; i < HAL_NO_DEVICES; i++) {
+            free(windows[i]);
+            windows[i] = NULL;
+        }
+    } else {
+        for (const HalWindow* w = hal_windows; w->name != NULL; w++) {
+            void** window = hal_field(axi_devs, w->field);
+            if (*window != NULL) munmap(*window, hal_window_range(w));
+            *window = NULL;
+        }
+    }
+
+    if (hal.mem_fd >= 0) {
+        close(hal.mem_fd);
+        hal.mem_fd = -1;
+    }
+    memset(&hal.devs, 0, sizeof(AxiDevs));
+    hal.initialized = false;
+}
+
+bool hal_is_simulated(void) {
+    return hal.initialized && hal.backend == HAL_BACKEND_SIM;
+}
+
+RamConfig hal_init_ram(AxiDevs axi_devs, RamInitConfig cfg) {
+    // FPGA: CMA-region of the RAM-Writer, simulator: heap-buffer written by the sim-thread
+    RamConfig ramCfg;
+
+    if (!hal_is_simulated()) return init_ram(axi_devs, cfg);
+
+    memset(&ramCfg, 0, sizeof(ramCfg));
+    ramCfg.param = cfg;
+    ramCfg.pos = (volatile uint32_t*)((char*)axi_devs.ram + HAL_RAM_WRITER_POS_OFFSET);
+
+    pthread_mutex_lock(&hal.sim_lock);
+    free(hal.sim_ram);
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    hal.sim_ram = aligned_alloc(page_size, ((size_t)cfg.ram_size * sizeof(int32_t) + page_size - 1) & ~(page_size - 1));
+    hal.sim_wrap = (cfg.ram_size < HIGHEST_POS_ADDR_CONT_MODE) ? cfg.ram_size : HIGHEST_POS_ADDR_CONT_MODE;
+    hal.sim_pos = 0;
+    if (hal.sim_ram == NULL || hal.sim_wrap == 0) {
+        printf("Allocating simulated RAM-Writer-buffer with %u samples failed\n", cfg.ram_size);
+        free(hal.sim_ram);
+        hal.sim_ram = NULL;
+    } else {
+        memset(hal.sim_ram, 0, (size_t)cfg.ram_size * sizeof(int32_t));
+    }
+    ramCfg.ram = hal.sim_ram;
+    pthread_mutex_unlock(&hal.sim_lock);
+    return ramCfg;
+}
+
+void hal_sim_configure(HalSimConfig cfg) {
+    if (!hal_is_simulated()) return;
+    pthread_mutex_lock(&hal.sim_lock);
+    hal.sim_cfg = cfg;
+    pthread_mutex_unlock(&hal.sim_lock);
+}
+
+void hal_sim_set_sample_rate_divider(int divider) {
+    // the simulated RAM-Writer runs with sample_rate_hz / divider, like the ADC with this AdcConfig
+    if (!hal_is_simulated()) return;
+    pthread_mutex_lock(&hal.sim_lock);
+    hal.sim_divider = (divider > 0) ? divider : 1;
+    pthread_mutex_unlock(&hal.sim_lock);
+}
+
+int hal_sim_trigger_fd(void) {
+    // readable (eventfd-counter = no. of triggers) after every simulated trigger, -1 on the FPGA
+    return hal_is_simulated() ? hal.sim_trigger_fd : -1;
+}
+
+uint64_t hal_sim_last_trigger_ns(void) {
+    return __atomic_load_n(&hal.sim_trigger_ns, __ATOMIC_ACQUIRE);
+}
+
+void hal_sim_get_stats(HalSimStats* stats) {
+    memset(stats, 0, sizeof(HalSimStats));
+    if (!hal_is_simulated()) return;
+    pthread_mutex_lock(&hal.sim_lock);
+    *stats = hal.sim_stats;
+    pthread_mutex_unlock(&hal.sim_lock);
+}
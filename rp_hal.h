@@ -0,0 +1,79 @@
+/*
+ * rp_hal.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Hardware-abstraction for the AXI-register-windows in AxiDevs:
+ *
+ *     -- HAL_BACKEND_DEVMEM: windows are mmapped from /dev/mem (FPGA on RedPitaya),
+ *        RAM-Writer-buffer is the CMA-region of init_ram()
+ *
+ *     -- HAL_BACKEND_SIM: windows are plain memory, a simulator-thread models the FPGA:
+ *          - RAM-Writer: writes a counter-pattern into the RAM-buffer and advances the
+ *            pos-register with the configured sample-rate divided by the sample_rate_divider
+ *            of the last AdcConfig (continous-mode, wraps like the FPGA)
+ *          - DAC-BRAM-Controllers: step through their LUT with the configured step-rate
+ *          - Trigger-Generator: counts triggers with the configured trigger-rate, every
+ *            trigger is signalled on an eventfd (trigger-armed event, see rp_trigger_irq.h)
+ *        a module runs while its bit in the reset-register is set (enable_module())
+ *
+ *    The module-functions keep accessing the windows through the pointers in AxiDevs,
+ *    so the server (and the streaming-paths) run unchanged on a host without FPGA.
+ *    HAL_BACKEND_DEVMEM fails if the FPGA-image has no base-address for reset, adc, ram or trigger_gen.
+ *    Register-layouts of the DAC-BRAM-Controllers and the Trigger-Generator are not
+ *    modelled, their state is read with hal_sim_get_stats().
+ */
+
+#ifndef SRC_RP_HAL_H
+#define SRC_RP_HAL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+typedef enum {
+    HAL_BACKEND_DEVMEM,
+    HAL_BACKEND_SIM
+} HalBackend;
+
+// register offsets used by the simulator (same as in the FPGA-IPs)
+#define HAL_RESET_REG_OFFSET 0x0          // GPIO-data of axi_gpio_rstn, bit = RESET_INDEX_*
+#define HAL_RAM_WRITER_POS_OFFSET 0x0     // status-register of the RAM-Writer (write-position)
+
+// env.-variables to select and configure the simulator
+#define HAL_SIM_ENV "RP_HAL_SIM"                        // set (to anything) => HAL_BACKEND_SIM
+#define HAL_SIM_SAMPLE_RATE_ENV "RP_SIM_SAMPLE_RATE_HZ"
+#define HAL_SIM_DAC_STEP_RATE_ENV "RP_SIM_DAC_STEP_RATE_HZ"
+#define HAL_SIM_TRIGGER_RATE_ENV "RP_SIM_TRIGGER_RATE_HZ"
+
+#define HAL_SIM_DEFAULT_DAC_STEP_RATE_HZ 100000
+#define HAL_SIM_DEFAULT_TRIGGER_RATE_HZ 1000
+#define HAL_SIM_TICK_US 50  // update-interval of the simulator-thread
+
+typedef struct {
+    double sample_rate_hz;    // ADC-samples written by the RAM-Writer per second with sample_rate_divider = 1
+    double dac_step_rate_hz;  // LUT-steps per second of each DAC-BRAM-Controller
+    double trigger_rate_hz;   // triggers per second of the Trigger-Generator
+} HalSimConfig;
+
+typedef struct {
+    uint64_t samples_written;  // total no. of samples written by the RAM-Writer
+    uint64_t dac_steps[NO_DAC_BRAM_INTERFACES_USED];
+    uint64_t triggers;
+} HalSimStats;
+
+int hal_init(HalBackend backend, AxiDevs* axi_devs);
+int hal_init_from_env(AxiDevs* axi_devs);
+void hal_release(AxiDevs* axi_devs);
+bool hal_is_simulated(void);
+RamConfig hal_init_ram(AxiDevs axi_devs, RamInitConfig cfg);
+
+void hal_sim_configure(HalSimConfig cfg);
+void hal_sim_set_sample_rate_divider(int divider);
+void hal_sim_get_stats(HalSimStats* stats);
+int hal_sim_trigger_fd(void);
+uint64_t hal_sim_last_trigger_ns(void);
+
+#endif
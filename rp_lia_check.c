@@ -0,0 +1,127 @@
+/*
+ * rp_lia_check.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Check of the software-LIA (rp_lia_sw.c) for LIA_SW_CHECK: lia_sw_process() (NEON under
+ *    __ARM_NEON) and lia_sw_process_scalar() run on the same fixed capture and their output is
+ *    compared bit by bit. The capture covers the corner-cases of the block-processing:
+ *
+ *     -- the reference-table has LIA_CHECK_REF_LEN words (no multiple of LIA_SW_BLOCK),
+ *        so the table wraps inside a block
+ *     -- the capture is processed in two calls, the first one ends inside a block and the
+ *        second one starts at an odd sample-index
+ *     -- the last block is partial if no_samples is no multiple of LIA_SW_BLOCK (default)
+ *
+ *    Capture, reference-table, IIR-config and scalar output are sent to the client, which
+ *    compares them with lia_sw_reference() in core.py (run_lia_sw_check()).
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rp_lia_sw.h"
+
+#define LIA_CHECK_REF_LEN 1000   // no multiple of LIA_SW_BLOCK
+#define LIA_CHECK_REF_CYCLES 27  // periods of the reference in the table
+#define LIA_CHECK_DECIMATION 7
+#define LIA_CHECK_CHANNEL 1      // channel B (upper half-word)
+
+static int32_t q2_30(double c) {
+    return (int32_t)lround(c * (double)(1 << LIA_SW_COEFF_FRAC_BITS));
+}
+
+static uint16_t adc14(double v) {
+    // 14-bit two's complement sign-extended to 16 bit (as in the RAM-Writer-words)
+    long x = lround(v);
+    if (x > 8191) x = 8191;
+    if (x < -8192) x = -8192;
+    return (uint16_t)(int16_t)x;
+}
+
+static void lia_check_input(uint32_t* words, int n, uint32_t* ref, LiaIIRConfig* iir) {
+    // noisy sine at the reference-frequency on channel B, noise only on channel A
+    const double w = 2 * M_PI * LIA_CHECK_REF_CYCLES / LIA_CHECK_REF_LEN;
+    srand(1);
+    for (int i = 0; i < n; i++) {
+        double noise_a = (rand() % 2001) - 1000;
+        double noise_b = (rand() % 801) - 400;
+        words[i] = ((uint32_t)adc14(7000 * sin(w * i + 0.3) + noise_b) << 16) | adc14(noise_a);
+    }
+    for (int i = 0; i < LIA_CHECK_REF_LEN; i++) {
+        uint16_t s = (uint16_t)(int16_t)lround(32767 * sin(w * i));
+        uint16_t c = (uint16_t)(int16_t)lround(32767 * cos(w * i));
+        ref[i] = ((uint32_t)c << 16) | s;
+    }
+
+    // two low-pass sections with dc-gain 1 (poles at 0.8 and 0.9)
+    const double sos[2][5] = {{0.01, 0.02, 0.01, -1.6, 0.64}, {0.05, 0.05, 0.0, -0.9, 0.0}};
+    memset(iir, 0, sizeof(LiaIIRConfig));
+    iir->num_sos = 2;
+    for (int k = 0; k < 2; k++) {
+        for (int c = 0; c < 5; c++) iir->coeffs[5 * k + c] = (uint32_t)q2_30(sos[k][c]);
+    }
+}
+
+uint32_t* lia_sw_check(int n, LiaCheckHeader* header) {
+    // returns the payload of the reply (words[n], ref[LIA_CHECK_REF_LEN], scalar I/Q-points)
+    // or NULL, header->status = 0 if the NEON-output is identical to the scalar one
+    LiaSw lia, lia_scalar;
+    int split = (n / 2) | 1;  // first call ends inside a block
+    uint32_t max_points = (uint32_t)n / LIA_CHECK_DECIMATION + 2;
+    uint32_t* payload = malloc(((size_t)n + LIA_CHECK_REF_LEN + 2 * max_points) * sizeof(uint32_t));
+    int32_t* out = malloc(2 * max_points * sizeof(int32_t));
+
+    memset(header, 0, sizeof(LiaCheckHeader));
+    if (n < 2 || n > LIA_SW_CHECK_MAX_SAMPLES || payload == NULL || out == NULL) {
+        printf("LIA-Check: invalid no. of samples (%d) or allocating buffers failed\n", n);
+        free(payload);
+        free(out);
+        return NULL;
+    }
+    uint32_t* words = payload;
+    uint32_t* ref = words + n;
+    int32_t* out_scalar = (int32_t*)(ref + LIA_CHECK_REF_LEN);
+
+    lia_check_input(words, n, ref, &header->iir);
+    if (lia_sw_init(&lia, &header->iir, LIA_CHECK_CHANNEL, ref, LIA_CHECK_REF_LEN, LIA_CHECK_DECIMATION) != 0 ||
+        lia_sw_init(&lia_scalar, &header->iir, LIA_CHECK_CHANNEL, ref, LIA_CHECK_REF_LEN, LIA_CHECK_DECIMATION) != 0) {
+        free(payload);
+        free(out);
+        return NULL;
+    }
+
+    int no_points = lia_sw_process(&lia, words, split, 0, out);
+    no_points += lia_sw_process(&lia, words + split, n - split, (uint64_t)split, out + 2 * no_points);
+    int no_points_scalar = lia_sw_process_scalar(&lia_scalar, words, split, 0, out_scalar);
+    no_points_scalar +=
+        lia_sw_process_scalar(&lia_scalar, words + split, n - split, (uint64_t)split, out_scalar + 2 * no_points_scalar);
+
+    header->magic = LIA_CHECK_MAGIC;
+    header->no_samples = (uint32_t)n;
+    header->ref_len = LIA_CHECK_REF_LEN;
+    header->channel = LIA_CHECK_CHANNEL;
+    header->decimation = LIA_CHECK_DECIMATION;
+    header->no_points = (uint32_t)no_points_scalar;
+    if (no_points != no_points_scalar) {
+        header->status = 1;
+    } else {
+        for (int i = 0; i < 2 * no_points; i++) {
+            if (out[i] != out_scalar[i]) {
+                header->status = i + 1;
+                break;
+            }
+        }
+    }
+
+#ifdef __ARM_NEON
+    printf("##### LIA-Check: %d samples, %d points, NEON: on #####\n", n, no_points_scalar);
+#else
+    printf("##### LIA-Check: %d samples, %d points, NEON: off (scalar fallback) #####\n", n, no_points_scalar);
+#endif
+    printf("    NEON/scalar: %s\n", (header->status == 0) ? "identical" : "DIFFERENT");
+    free(out);
+    return payload;
+}
@@ -0,0 +1,230 @@
+/*
+ * rp_lia_sw.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Software Lock-In-Amplifier, see rp_lia_sw.h
+ *
+ *    Samples are processed in blocks of LIA_SW_BLOCK: the mixer writes I/Q interleaved into
+ *    lia->iq, then every biquad runs over the whole block (same result as sample by sample,
+ *    a section only depends on its own input), at last the decimated points are picked.
+ *
+ *    NEON: vld2 splits 4 ADC-words (and 4 reference-words) into the 16-bit halves, vmull_s16
+ *    gives I and Q, vst2q stores them interleaved. A biquad uses vmull/vmlal/vmlsl_n_s32 on
+ *    the (I, Q)-pair and vqrshrn_n_s64 for the rounding shift with saturation.
+ */
+
+#include "rp_lia_sw.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#include "rp_convert.h"
+
+static inline int16_t sign_extend_14bit(uint16_t raw) {
+    return (int16_t)(uint16_t)(raw << (16 - RF_ADC_BITS)) >> (16 - RF_ADC_BITS);
+}
+
+static inline int32_t round_shift_sat(int64_t acc) {
+    // (acc + 2^29) >> 30 without overflow, saturated to int32 (same as vqrshrn_n_s64(acc, 30))
+    int64_t y = (acc >> LIA_SW_COEFF_FRAC_BITS) + ((acc >> (LIA_SW_COEFF_FRAC_BITS - 1)) & 1);
+    if (y > INT32_MAX) return INT32_MAX;
+    if (y < INT32_MIN) return INT32_MIN;
+    return (int32_t)y;
+}
+
+int lia_sw_init(LiaSw* lia, const LiaIIRConfig* iir, int channel, const uint32_t* ref, uint32_t ref_len,
+                uint32_t decimation) {
+    // returns -1 for an invalid config (no reference-table, too many sections...)
+    if (iir->num_sos > LIA_SW_MAX_SOS || ref == NULL || ref_len == 0 || ref_len > LIA_REF_MAX_WORDS ||
+        decimation == 0 || decimation > LIA_SW_MAX_DECIMATION || (channel != 0 && channel != 1)) {
+        printf("Software-LIA: invalid config (%u SOS, %u reference-words, decimation %u, channel %d)\n", iir->num_sos,
+               ref_len, decimation, channel);
+        return -1;
+    }
+    memset(lia, 0, sizeof(LiaSw));
+    lia->channel = channel;
+    lia->ref = ref;
+    lia->ref_len = ref_len;
+    lia->decimation = decimation;
+    lia->num_sos = (int)iir->num_sos;
+    for (int k = 0; k < lia->num_sos; k++) {
+        for (int c = 0; c < 5; c++) lia->coeffs[k][c] = (int32_t)iir->coeffs[5 * k + c];
+    }
+    return 0;
+}
+
+void lia_sw_reset(LiaSw* lia) {
+    memset(lia->state, 0, sizeof(lia->state));
+}
+
+uint32_t lia_sw_max_points(const LiaSw* lia, int n) {
+    // max. no. of output points for n samples
+    return (uint32_t)n / lia->decimation + 1;
+}
+
+uint64_t lia_sw_first_point(const LiaSw* lia, uint64_t first_sample) {
+    // absolute sample-index of the first output point at or after first_sample
+    return first_sample + (lia->decimation - 1 - first_sample % lia->decimation);
+}
+
+static int decimate(const LiaSw* lia, int n, uint64_t first_sample, int32_t* out) {
+    int no_points = 0;
+    for (int i = (int)(lia_sw_first_point(lia, first_sample) - first_sample); i < n; i += (int)lia->decimation) {
+        out[2 * no_points] = lia->iq[2 * i];
+        out[2 * no_points + 1] = lia->iq[2 * i + 1];
+        no_points++;
+    }
+    return no_points;
+}
+
+/**************************************************************/
+/* scalar versions                                            */
+/**************************************************************/
+
+static void mix_block_scalar(LiaSw* lia, const uint32_t* words, int n, uint64_t first_sample) {
+    uint32_t pos = (uint32_t)(first_sample % lia->ref_len);
+    int shift = 16 * lia->channel;
+
+    for (int i = 0; i < n; i++) {
+        int32_t x = sign_extend_14bit((uint16_t)(words[i] >> shift));
+        uint32_t r = lia->ref[pos];
+        lia->iq[2 * i] = x * (int16_t)(r >> 16);   // cos
+        lia->iq[2 * i + 1] = x * (int16_t)r;       // sin
+        if (++pos == lia->ref_len) pos = 0;
+    }
+}
+
+static void iir_block_scalar(LiaSw* lia, int n) {
+    for (int k = 0; k < lia->num_sos; k++) {
+        const int32_t* c = lia->coeffs[k];
+        for (int lane = 0; lane < 2; lane++) {
+            int32_t x1 = lia->state[k][0][lane], x2 = lia->state[k][1][lane];
+            int32_t y1 = lia->state[k][2][lane], y2 = lia->state[k][3][lane];
+            for (int i = 0; i < n; i++) {
+                int32_t x = lia->iq[2 * i + lane];
+                // wrapping 64-bit accumulator like vmlal_s32
+                uint64_t acc = (uint64_t)((int64_t)c[0] * x) + (uint64_t)((int64_t)c[1] * x1) +
+                               (uint64_t)((int64_t)c[2] * x2) - (uint64_t)((int64_t)c[3] * y1) -
+                               (uint64_t)((int64_t)c[4] * y2);
+                int32_t y = round_shift_sat((int64_t)acc);
+                x2 = x1;
+                x1 = x;
+                y2 = y1;
+                y1 = y;
+                lia->iq[2 * i + lane] = y;
+            }
+            lia->state[k][0][lane] = x1;
+            lia->state[k][1][lane] = x2;
+            lia->state[k][2][lane] = y1;
+            lia->state[k][3][lane] = y2;
+        }
+    }
+}
+
+int lia_sw_process_scalar(LiaSw* lia, const uint32_t* words, int n, uint64_t first_sample, int32_t* out) {
+    // returns the no. of points (I, Q interleaved) written to out (lia_sw_max_points())
+    int no_points = 0;
+    for (int done = 0; done < n; done += LIA_SW_BLOCK) {
+        int len = (n - done < LIA_SW_BLOCK) ? n - done : LIA_SW_BLOCK;
+        mix_block_scalar(lia, words + done, len, first_sample + done);
+        iir_block_scalar(lia, len);
+        no_points += decimate(lia, len, first_sample + done, out + 2 * no_points);
+    }
+    return no_points;
+}
+
+/**************************************************************/
+/* NEON versions                                              */
+/**************************************************************/
+
+#ifdef __ARM_NEON
+
+static void mix_block(LiaSw* lia, const uint32_t* words, int n, uint64_t first_sample) {
+    uint32_t pos = (uint32_t)(first_sample % lia->ref_len);
+    int i = 0;
+
+    while (i < n) {
+        // contiguous part of the reference-table
+        int run = (int)(lia->ref_len - pos);
+        if (run > n - i) run = n - i;
+        int j = 0;
+        for (; j + 4 <= run; j += 4) {
+            int16x4x2_t w = vld2_s16((const int16_t*)(words + i + j));
+            int16x4x2_t r = vld2_s16((const int16_t*)(lia->ref + pos + j));
+            int16x4_t x = vshr_n_s16(vshl_n_s16(w.val[lia->channel], 16 - RF_ADC_BITS), 16 - RF_ADC_BITS);
+            int32x4x2_t iq = {{vmull_s16(x, r.val[1]), vmull_s16(x, r.val[0])}};
+            vst2q_s32(lia->iq + 2 * (i + j), iq);
+        }
+        int shift = 16 * lia->channel;
+        for (; j < run; j++) {
+            int32_t x = sign_extend_14bit((uint16_t)(words[i + j] >> shift));
+            uint32_t r = lia->ref[pos + j];
+            lia->iq[2 * (i + j)] = x * (int16_t)(r >> 16);
+            lia->iq[2 * (i + j) + 1] = x * (int16_t)r;
+        }
+        i += run;
+        pos += (uint32_t)run;
+        if (pos == lia->ref_len) pos = 0;
+    }
+}
+
+static void iir_block(LiaSw* lia, int n) {
+    for (int k = 0; k < lia->num_sos; k++) {
+        const int32_t* c = lia->coeffs[k];
+        int32x2_t x1 = vld1_s32(lia->state[k][0]), x2 = vld1_s32(lia->state[k][1]);
+        int32x2_t y1 = vld1_s32(lia->state[k][2]), y2 = vld1_s32(lia->state[k][3]);
+        for (int i = 0; i < n; i++) {
+            int32x2_t x = vld1_s32(lia->iq + 2 * i);
+            int64x2_t acc = vmull_n_s32(x, c[0]);
+            acc = vmlal_n_s32(acc, x1, c[1]);
+            acc = vmlal_n_s32(acc, x2, c[2]);
+            acc = vmlsl_n_s32(acc, y1, c[3]);
+            acc = vmlsl_n_s32(acc, y2, c[4]);
+            int32x2_t y = vqrshrn_n_s64(acc, LIA_SW_COEFF_FRAC_BITS);
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            vst1_s32(lia->iq + 2 * i, y);
+        }
+        vst1_s32(lia->state[k][0], x1);
+        vst1_s32(lia->state[k][1], x2);
+        vst1_s32(lia->state[k][2], y1);
+        vst1_s32(lia->state[k][3], y2);
+    }
+}
+
+int lia_sw_process(LiaSw* lia, const uint32_t* words, int n, uint64_t first_sample, int32_t* out) {
+    // returns the no. of points (I, Q interleaved) written to out (lia_sw_max_points())
+    int no_points = 0;
+    for (int done = 0; done < n; done += LIA_SW_BLOCK) {
+        int len = (n - done < LIA_SW_BLOCK) ? n - done : LIA_SW_BLOCK;
+        mix_block(lia, words + done, len, first_sample + done);
+        iir_block(lia, len);
+        no_points += decimate(lia, len, first_sample + done, out + 2 * no_points);
+    }
+    return no_points;
+}
+
+#else
+
+int lia_sw_process(LiaSw* lia, const uint32_t* words, int n, uint64_t first_sample, int32_t* out) {
+    return lia_sw_process_scalar(lia, words, n, first_sample, out);
+}
+
+#endif
+
+void lia_sw_mag_phase(const int32_t* iq, int n, float* out) {
+    // I/Q-points -> magnitude and phase (rad)
+    for (int i = 0; i < n; i++) {
+        float re = (float)iq[2 * i], im = (float)iq[2 * i + 1];
+        out[2 * i] = sqrtf(re * re + im * im);
+        out[2 * i + 1] = atan2f(im, re);
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * rp_lia_sw.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Software Lock-In-Amplifier for ADC_LIA_MODE (continous RAM-Writer-stream, works
+ *    without the LIA-Mixer/IIR-Modules in the bitstream):
+ *
+ *     -- mixer: sample x of channel A/B (LiaMixerConfig.channel, sign-extended 14-bit) times the
+ *        reference-table uploaded with LIA_MIXER_BRAM_ID, one table-word per ADC-sample
+ *        (index = absolute sample-index % table-length):
+ *            word bits 15:0 = sin (Q1.15), bits 31:16 = cos (Q1.15)
+ *            I = x * cos, Q = x * sin (int32)
+ *
+ *     -- IIR: cascade of LiaIIRConfig.num_sos biquads (direct form I) on I and Q,
+ *        coeffs[5 * k ... 5 * k + 4] = b0, b1, b2, a1, a2 (a0 = 1) as signed Q2.30:
+ *            acc = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]   (64-bit, wrapping)
+ *            y[n] = acc >> 30, rounded to nearest (half up) and saturated to int32
+ *
+ *     -- decimation: only samples with absolute index % decimation == decimation - 1 are output,
+ *        the filters run at the full rate
+ *
+ *    The NEON-version (__ARM_NEON) mixes 4 samples per instruction and runs I and Q of a biquad
+ *    in the two lanes of a d-register, it produces the same output bit by bit as the scalar version.
+ *    lia_sw_reference() in core.py is the same model in numpy (for comparing with FPGA-captures).
+ *    LIA_SW_CHECK compares all three on a fixed capture (rp_lia_check.c, run_lia_sw_check() in core.py),
+ *    rp_lia_sw_test.c runs the same capture on the board against the known-good output.
+ */
+
+#ifndef SRC_RP_LIA_SW_H
+#define SRC_RP_LIA_SW_H
+
+#include <stdint.h>
+
+#include "rp_constants.h"
+#include "rp_structs.h"
+
+#define LIA_SW_MAX_SOS 6
+#define LIA_SW_COEFF_FRAC_BITS 30
+#define LIA_SW_BLOCK 256                // samples mixed and filtered at once
+#define LIA_SW_MAX_DECIMATION 1048576
+#define LIA_REF_MAX_WORDS MAX_DATA_LENGTH  // size of the LIA-Mixer-BRAM
+
+typedef struct {
+    int channel;                          // LiaMixerConfig.channel: 0 = RF-ADC channel A, 1 = B
+    const uint32_t* ref;                  // reference-table (sin/cos)
+    uint32_t ref_len;
+    uint32_t decimation;
+    int num_sos;
+    int32_t coeffs[LIA_SW_MAX_SOS][5];    // b0, b1, b2, a1, a2
+    int32_t state[LIA_SW_MAX_SOS][4][2];  // x[n-1], x[n-2], y[n-1], y[n-2] of I and Q
+    int32_t iq[2 * LIA_SW_BLOCK] __attribute__((aligned(16)));  // last field: the state is saved without it
+} LiaSw;
+
+int lia_sw_init(LiaSw* lia, const LiaIIRConfig* iir, int channel, const uint32_t* ref, uint32_t ref_len,
+                uint32_t decimation);
+void lia_sw_reset(LiaSw* lia);
+uint32_t lia_sw_max_points(const LiaSw* lia, int n);
+uint64_t lia_sw_first_point(const LiaSw* lia, uint64_t first_sample);
+int lia_sw_process(LiaSw* lia, const uint32_t* words, int n, uint64_t first_sample, int32_t* out);
+int lia_sw_process_scalar(LiaSw* lia, const uint32_t* words, int n, uint64_t first_sample, int32_t* out);
+void lia_sw_mag_phase(const int32_t* iq, int n, float* out);
+
+uint32_t* lia_sw_check(int n, LiaCheckHeader* header);
+
+#endif
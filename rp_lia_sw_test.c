@@ -0,0 +1,94 @@
+/*
+ * rp_lia_sw_test.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Fixed-capture test of the software-LIA (rp_lia_sw.c), runs on RedPitaya without a client:
+ *
+ *     -- lia_sw_check() (rp_lia_check.c) runs lia_sw_process() and lia_sw_process_scalar()
+ *        on the fixed capture, the outputs have to be identical bit by bit
+ *     -- the output is compared with the FNV-1a hash of the known-good output, so a change
+ *        of both versions is detected as well (capture and output are hashed separately,
+ *        a different capture means the test-input changed, not the LIA)
+ *     -- built for ARM the NEON-version has to be used (__ARM_NEON, -mfpu=neon), otherwise
+ *        the test fails instead of comparing the scalar fallback with itself
+ *
+ *    The capture is generated with rand() (glibc) and libm, like LIA_SW_CHECK.
+ *
+ *    usage: ./lia_sw_test   (exit-code != 0 if a check failed)
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "rp_lia_sw.h"
+
+#define LIA_TEST_NO_RUNS 3
+
+typedef struct {
+    int no_samples;          // partial last block / full blocks
+    uint32_t capture_hash;   // words of the capture
+    uint32_t output_hash;    // I/Q-points of the scalar output
+} LiaTestCase;
+
+// known-good hashes of the fixed capture (rp_lia_check.c), the output was verified with lia_sw_reference() in core.py
+static const LiaTestCase lia_test_cases[LIA_TEST_NO_RUNS] = {
+    {LIA_SW_CHECK_DEFAULT_SAMPLES, 0x443E5AB1, 0xB708DC8E},
+    {4 * LIA_SW_BLOCK, 0xB207B3B8, 0x27447931},
+    {4 * LIA_SW_BLOCK + 5, 0x9A418766, 0x76F813BB},
+};
+
+static int no_failed = 0;
+
+static void check(bool ok, const char* name) {
+    printf("    %-58s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) no_failed++;
+}
+
+static uint32_t fnv1a(const void* data, size_t len) {
+    const uint8_t* p = data;
+    uint32_t hash = 0x811C9DC5;
+    for (size_t i = 0; i < len; i++) hash = (hash ^ p[i]) * 0x01000193;
+    return hash;
+}
+
+int main(void) {
+    LiaCheckHeader header;
+    char name[80];
+
+#ifdef __ARM_NEON
+    printf("##### LIA-SW-Test (NEON: on) #####\n");
+#else
+    printf("##### LIA-SW-Test (NEON: off, scalar fallback) #####\n");
+#endif
+#if (defined(__arm__) || defined(__aarch64__)) && !defined(__ARM_NEON)
+    check(false, "NEON-version built (-mfpu=neon)");
+#endif
+
+    for (int t = 0; t < LIA_TEST_NO_RUNS; t++) {
+        const LiaTestCase* tc = &lia_test_cases[t];
+        uint32_t* payload = lia_sw_check(tc->no_samples, &header);
+        if (payload == NULL) {
+            snprintf(name, sizeof(name), "%d samples: check started", tc->no_samples);
+            check(false, name);
+            continue;
+        }
+
+        const int32_t* out = (const int32_t*)(payload + header.no_samples + header.ref_len);
+        uint32_t capture_hash = fnv1a(payload, header.no_samples * sizeof(uint32_t));
+        uint32_t output_hash = fnv1a(out, 2 * header.no_points * sizeof(int32_t));
+
+        snprintf(name, sizeof(name), "%d samples: NEON- and scalar-output identical", tc->no_samples);
+        check(header.status == 0, name);
+        snprintf(name, sizeof(name), "%d samples: capture (0x%08X)", tc->no_samples, capture_hash);
+        check(capture_hash == tc->capture_hash, name);
+        snprintf(name, sizeof(name), "%d samples: output of %u points (0x%08X)", tc->no_samples, header.no_points,
+                 output_hash);
+        check(output_hash == tc->output_hash, name);
+        free(payload);
+    }
+
+    printf("%s: %d check(s) failed\n", (no_failed == 0) ? "PASSED" : "FAILED", no_failed);
+    return (no_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,138 @@
+/*
+ * rp_lut_bin.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Binary LUTs for the DAC-BRAM-Controllers, see rp_lut_bin.h
+ *
+ *    The codes are copied into a staging-buffer and checked with CRC-32 before they are
+ *    written into the BRAM. BRAM-accesses use copy_words() (aligned 128-bit accesses with NEON).
+ */
+
+#include "rp_lut_bin.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "rp_bram_upload.h"
+#include "rp_constants.h"
+#include "rp_convert.h"
+#include "rp_lut.h"
+#include "rp_trace.h"
+
+static uint32_t crc_table[256];
+static pthread_once_t crc_table_once = PTHREAD_ONCE_INIT;
+
+static void init_crc_table(void) {
+    // reflected CRC-32 (polynomial 0xEDB88320), same as zlib.crc32()
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+uint32_t lut_bin_crc32(uint32_t crc, const void* data, size_t len) {
+    // crc = 0 for the first call, continues with the returned value (like zlib.crc32())
+    const uint8_t* p = data;
+
+    pthread_once(&crc_table_once, init_crc_table);
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) crc = crc_table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+int lut_bin_check_header(const LutBinHeader* header) {
+    if (header->magic != LUT_BIN_MAGIC ||
+        (header->version != LUT_BIN_VERSION && header->version != LUT_BIN_VERSION_VOLTAGE)) {
+        printf("Binary LUT: invalid header (magic: 0x%08X, version: %u)\n", header->magic, header->version);
+        return LUT_BIN_ERR_HEADER;
+    }
+    if (header->port_id < 0 || header->port_id >= NO_DAC_BRAM_INTERFACES_USED || header->no_steps == 0 ||
+        header->no_steps > LUT_BIN_MAX_STEPS) {
+        printf("Binary LUT: invalid port %d or no. of steps %u\n", header->port_id, header->no_steps);
+        return LUT_BIN_ERR_HEADER;
+    }
+    return LUT_BIN_OK;
+}
+
+int lut_bin_check_codes(const LutBinHeader* header, const uint32_t* codes) {
+    // CRC-32 of the no_steps codes (header has to be checked by lut_bin_check_header())
+    uint32_t crc = lut_bin_crc32(0, codes, (size_t)header->no_steps * sizeof(uint32_t));
+    if (crc != header->checksum) {
+        printf("Binary LUT: checksum-error (received 0x%08X, calculated 0x%08X)\n", header->checksum, crc);
+        return LUT_BIN_ERR_CHECKSUM;
+    }
+    return LUT_BIN_OK;
+}
+
+int lut_bin_send(int sock, const LutBinHeader* header, const uint32_t* codes) {
+    if (send_all(sock, header, sizeof(LutBinHeader)) != 0 ||
+        send_all(sock, codes, (size_t)header->no_steps * sizeof(uint32_t)) != 0) {
+        printf("Binary LUT: sending to client failed\n");
+        return LUT_BIN_ERR_IO;
+    }
+    return LUT_BIN_OK;
+}
+
+void lut_bin_write_bram(AxiDevs axi_devs, const LutBinHeader* header, const uint32_t* codes) {
+    // header has to be checked by lut_bin_check_header()
+    copy_words((volatile uint32_t*)axi_devs.bram[header->port_id], codes, (int)header->no_steps);
+    TRACE_DEBUG("Binary LUT: %u codes written to BRAM of port %d", header->no_steps, header->port_id);
+}
+
+int lut_bin_write_voltages(AxiDevs axi_devs, const LutBinHeader* header, const uint32_t* words, int dac_dev_id) {
+    // words: no_steps float32 voltages (LUT_BIN_VERSION_VOLTAGE), checked by lut_bin_check_codes()
+    LutValue value = {header->port_id, dac_dev_id, header->dac_port_id, 0.0f, 0};
+
+    for (uint32_t i = 0; i < header->no_steps; i++) {
+        memcpy(&value.voltage, &words[i], sizeof(float));
+        if (!isfinite(value.voltage)) {
+            printf("Binary LUT: invalid voltage at index %u, LUT not changed\n", i);
+            return LUT_BIN_ERR_VOLTAGE;
+        }
+    }
+    for (uint32_t i = 0; i < header->no_steps; i++) {
+        memcpy(&value.voltage, &words[i], sizeof(float));
+        value.index = (int)i;
+        change_value_in_lut_at_index(axi_devs, value, value.index, false);
+    }
+    TRACE_DEBUG("Binary LUT: %u voltages converted into BRAM of port %d", header->no_steps, header->port_id);
+    return LUT_BIN_OK;
+}
+
+int lut_bin_read_bram(AxiDevs axi_devs, BramDacConfig cfg, LutBinHeader* header, uint32_t* codes) {
+    // reads the LUT of cfg.port_id (cfg.no_steps codes) from the BRAM
+    if (cfg.port_id < 0 || cfg.port_id >= NO_DAC_BRAM_INTERFACES_USED || cfg.no_steps <= 0 ||
+        cfg.no_steps > LUT_BIN_MAX_STEPS) {
+        printf("Binary LUT: no valid BRAM-DAC-config for port %d (%d steps)\n", cfg.port_id, cfg.no_steps);
+        return LUT_BIN_ERR_HEADER;
+    }
+
+    copy_words(codes, (const volatile uint32_t*)axi_devs.bram[cfg.port_id], cfg.no_steps);
+    header->magic = LUT_BIN_MAGIC;
+    header->version = LUT_BIN_VERSION;
+    header->port_id = cfg.port_id;
+    header->dac_port_id = cfg.dac_port_id;
+    header->no_steps = (uint32_t)cfg.no_steps;
+    header->checksum = lut_bin_crc32(0, codes, (size_t)cfg.no_steps * sizeof(uint32_t));
+    return LUT_BIN_OK;
+}
+
+int lut_bin_store_file(const char* path, const LutBinHeader* header, const uint32_t* codes) {
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) {
+        printf("Binary LUT: opening %s failed\n", path);
+        return LUT_BIN_ERR_IO;
+    }
+
+    size_t ok = fwrite(header, sizeof(LutBinHeader), 1, f);
+    ok += fwrite(codes, sizeof(uint32_t), header->no_steps, f);
+    if (fclose(f) != 0 || ok != 1 + header->no_steps) {
+        printf("Binary LUT: writing %s failed\n", path);
+        return LUT_BIN_ERR_IO;
+    }
+    return LUT_BIN_OK;
+}
@@ -0,0 +1,56 @@
+/*
+ * rp_lut_bin.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Binary LUTs for the DAC-BRAM-Controllers:
+ *
+ *     -- LutBinHeader + uint32 DAC-codes[no_steps], the codes are the BRAM-words
+ *        (pre-scaled on the host or read back from the BRAM), so no CSV-parsing and
+ *        voltage-conversion is needed on RedPitaya
+ *
+ *     -- uploaded over the command-socket (NEW_CONFIG with LUT_CONFIG_ID) instead of
+ *        scp + write_dac_lut_from_config(), the codes are checked with CRC-32 before
+ *        they are written into the BRAM (a broken upload doesn't change the LUT).
+ *        The upload is received by the reactor, lut_bin_check_header() validates the
+ *        header before the codes are requested.
+ *
+ *     -- uploads with LUT_BIN_VERSION_VOLTAGE carry float32 voltages instead of the codes,
+ *        lut_bin_write_voltages() converts them with the conversion of the .csv-LUTs (rp_lut.c),
+ *        so the host needs no DAC-specific scaling (CSV-parsing and scp are still skipped)
+ *
+ *     -- read back from the BRAM and sent to the host (GET_LUT_BIN) or stored as
+ *        lut/lut_portX_adj.bin (STORE_LUT with LUT_STORE_BIN)
+ */
+
+#ifndef SRC_RP_LUT_BIN_H
+#define SRC_RP_LUT_BIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+// BRAM of one DAC-BRAM-Controller-Port (AXI_BRAM_RANGE) holds 16384 words
+#define LUT_BIN_MAX_STEPS 16384
+#define LUT_BIN_ADJ_FILE "lut/lut_port%d_adj.bin"
+
+#define LUT_BIN_OK 0
+#define LUT_BIN_ERR_HEADER -1    // invalid header, the codes are not requested (client is out of sync)
+#define LUT_BIN_ERR_CHECKSUM -2  // codes received, but CRC-32 doesn't match
+#define LUT_BIN_ERR_IO -3        // socket/file-error
+#define LUT_BIN_ERR_VOLTAGE -4   // voltage-upload holds a NaN/Inf
+
+uint32_t lut_bin_crc32(uint32_t crc, const void* data, size_t len);
+
+int lut_bin_check_header(const LutBinHeader* header);
+int lut_bin_check_codes(const LutBinHeader* header, const uint32_t* codes);
+int lut_bin_send(int sock, const LutBinHeader* header, const uint32_t* codes);
+
+void lut_bin_write_bram(AxiDevs axi_devs, const LutBinHeader* header, const uint32_t* codes);
+int lut_bin_write_voltages(AxiDevs axi_devs, const LutBinHeader* header, const uint32_t* words, int dac_dev_id);
+int lut_bin_read_bram(AxiDevs axi_devs, BramDacConfig cfg, LutBinHeader* header, uint32_t* codes);
+
+int lut_bin_store_file(const char* path, const LutBinHeader* header, const uint32_t* codes);
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * rp_lut_calib.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Closed-loop LUT-calibration, see rp_lut_calib.h
+ *
+ *    Runs on the worker-thread and owns the client-socket. The trigger-sweep is started
+ *    like START_TRIGGER_SWEEP, the next trigger is selected like NEXT_TRIGGER and an
+ *    adjusted trigger is rearmed like ADJ_LUT_VALUE.
+ */
+
+#include "rp_lut_calib.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "rp_bram_upload.h"
+#include "rp_constants.h"
+#include "rp_dac_bram_ctrl.h"
+#include "rp_lut.h"
+#include "rp_reset.h"
+#include "rp_tcp.h"
+#include "rp_trace.h"
+#include "rp_trigger_gen.h"
+
+int lut_calib_check_config(const LutCalibConfig* cfg, int no_steps) {
+    // returns 0 if the config can be used for a LUT with no_steps steps
+    if (cfg->port_id < 0 || cfg->port_id >= NO_DAC_BRAM_INTERFACES_USED || no_steps <= 0) {
+        printf("LUT-Calibration: no LUT configured for port %d\n", cfg->port_id);
+        return -1;
+    }
+    if (cfg->no_triggers <= 0 || cfg->no_triggers > LUT_CALIB_MAX_TRIGGERS || cfg->no_triggers > no_steps) {
+        printf("LUT-Calibration: invalid no. of triggers %d (LUT with %d steps)\n", cfg->no_triggers, no_steps);
+        return -1;
+    }
+    if (cfg->max_iterations <= 0 || !(cfg->max_step > 0) || !(cfg->tolerance >= 0) ||
+        !(cfg->min_voltage <= cfg->max_voltage) || !isfinite(cfg->gain) ||
+        (cfg->input_mode != LUT_CALIB_INPUT_ERROR && cfg->input_mode != LUT_CALIB_INPUT_READING)) {
+        printf("LUT-Calibration: invalid controller-parameters\n");
+        return -1;
+    }
+    return 0;
+}
+
+int lut_calib_check_points(const LutCalibPoint* points, int no_points, int no_steps) {
+    for (int i = 0; i < no_points; i++) {
+        if (points[i].index < 0 || points[i].index >= no_steps || !isfinite(points[i].voltage)) {
+            printf("LUT-Calibration: invalid trigger-point %d (index %d)\n", i, points[i].index);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static float clampf(float x, float lo, float hi) {
+    return (x < lo) ? lo : (x > hi) ? hi : x;
+}
+
+static void write_lut_voltage(AxiDevs axi_devs, const LutCalibConfig* cfg, int index, float voltage, int no_steps,
+                              bool verbose) {
+    LutValue value = {cfg->port_id, cfg->dac_dev_id, cfg->dac_port_id, voltage, index};
+
+    change_value_in_lut(axi_devs, value, verbose);
+    // for first value in LUT we also want to adjust the last value in LUT (same as ADJ_LUT_VALUE)
+    if (index == 0) change_value_in_lut_at_index(axi_devs, value, no_steps - 1, verbose);
+}
+
+static void start_trigger_sweep(AxiDevs axi_devs, TriggerIrq* irq, int port) {
+    disable_module(axi_devs, RESET_INDEX_TRIGGER_GEN);
+    trigger_irq_arm(irq);
+    enable_module(axi_devs, RESET_INDEX_DAC_BRAM_CTRL_PORT0);
+    enable_module(axi_devs, RESET_INDEX_BRAM_CTRL_SYNC);
+    enable_module(axi_devs, RESET_INDEX_TRIGGER_GEN);
+    start_bram_dac_output(axi_devs, port);
+}
+
+int lut_calib_run(AxiDevs axi_devs, int sock, TriggerIrq* irq, const LutCalibConfig* cfg, const LutCalibPoint* points,
+                  int no_steps, LutCalibResult* results, LutCalibResultHeader* header, bool verbose) {
+    // returns 0 if the result can be sent, -1 if the connection to the host is lost
+    header->magic = LUT_CALIB_MAGIC;
+    header->status = LUT_CALIB_OK;
+    header->no_triggers = (uint32_t)cfg->no_triggers;
+    header->no_measurements = 0;
+    for (int t = 0; t < cfg->no_triggers; t++) {
+        results[t].index = points[t].index;
+        results[t].voltage = clampf(points[t].voltage, cfg->min_voltage, cfg->max_voltage);
+        results[t].error = NAN;
+        results[t].iterations = 0;
+        results[t].converged = 0;
+        // the first measurement of every trigger is done with the starting voltage of the host
+        write_lut_voltage(axi_devs, cfg, results[t].index, results[t].voltage, no_steps, verbose);
+    }
+
+    start_trigger_sweep(axi_devs, irq, cfg->port_id);
+    for (int t = 0; t < cfg->no_triggers && header->status == LUT_CALIB_OK; t++) {
+        LutCalibResult* res = &results[t];
+
+        if (t > 0) {
+            trigger_irq_arm(irq);
+            select_next_trigger(axi_devs);
+        }
+        while (res->iterations < cfg->max_iterations) {
+            if (trigger_irq_wait(irq, axi_devs, TRIGGER_IRQ_TIMEOUT_MS) != 0) {
+                header->status = LUT_CALIB_TIMEOUT;
+                break;
+            }
+            if (send_to_client(sock, REQ_WLENGTH) < 0 || send_to_client(sock, t) < 0) return -1;
+            trigger_irq_notified(irq);
+
+            float value;
+            if (recv_all(sock, &value, sizeof(value)) != 0) return -1;
+            if (isnan(value)) {
+                header->status = LUT_CALIB_ABORTED;
+                break;
+            }
+            res->error = (cfg->input_mode == LUT_CALIB_INPUT_READING) ? points[t].target - value : value;
+            res->iterations++;
+            header->no_measurements++;
+
+            if (fabsf(res->error) <= cfg->tolerance) {
+                res->converged = 1;
+                break;
+            }
+            if (res->iterations == cfg->max_iterations) break;
+
+            // proportional step towards the target, then measure the same trigger again
+            float step = clampf(cfg->gain * res->error, -cfg->max_step, cfg->max_step);
+            res->voltage = clampf(res->voltage + step, cfg->min_voltage, cfg->max_voltage);
+            write_lut_voltage(axi_devs, cfg, res->index, res->voltage, no_steps, verbose);
+            trigger_irq_arm(irq);
+            rearm_current_trigger(axi_devs);
+        }
+        TRACE_DEBUG("LUT-Calibration: trigger %d: %.6f V after %d iterations (error %g)", t, (double)res->voltage,
+                    res->iterations, (double)res->error);
+    }
+    return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * rp_lut_calib.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Closed-loop LUT-calibration on RedPitaya for trigger-sweeps:
+ *
+ *     -- the board runs the trigger-sweep and the correction per trigger-point, the host
+ *        only answers every REQ_WLENGTH (followed by the no. of the trigger-point as int)
+ *        with one float (error or measured value)
+ *
+ *     -- the starting voltages of the trigger-points (LutCalibPoint.voltage, clamped to
+ *        min_voltage..max_voltage) are written to the LUT before the sweep is started
+ *
+ *     -- proportional step: voltage += clamp(gain * error, +-max_step), the new voltage is
+ *        written with change_value_in_lut() and the trigger is rearmed, till
+ *        |error| <= tolerance or max_iterations measurements were done
+ *
+ *     -- the final voltages of all trigger-points are sent once at the end
+ *        (LutCalibResultHeader + LutCalibResult[no_triggers])
+ *
+ *    Replaces the host-loop REQ_WLENGTH -> ADJ_LUT_VALUE -> rearm -> REQ_WLENGTH..
+ */
+
+#ifndef SRC_RP_LUT_CALIB_H
+#define SRC_RP_LUT_CALIB_H
+
+#include <stdbool.h>
+
+#include "rp_structs.h"
+#include "rp_trigger_irq.h"
+
+#define LUT_CALIB_MAX_TRIGGERS 16384  // one trigger per LUT-step at most
+
+int lut_calib_check_config(const LutCalibConfig* cfg, int no_steps);
+int lut_calib_check_points(const LutCalibPoint* points, int no_points, int no_steps);
+int lut_calib_run(AxiDevs axi_devs, int sock, TriggerIrq* irq, const LutCalibConfig* cfg, const LutCalibPoint* points,
+                  int no_steps, LutCalibResult* results, LutCalibResultHeader* header, bool verbose);
+
+#endif
@@ -0,0 +1,305 @@
+/*
+ * rp_metrics.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Metrics-registry of the app-server, see rp_metrics.h
+ *
+ *    The exporter answers every connection on METRICS_PORT with the Prometheus text-format
+ *    (HTTP/1.0, the connection is closed after the reply), one client at a time.
+ *    It listens on the loopback-interface unless RP_METRICS_BIND selects another address.
+ */
+
+#include "rp_metrics.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <linux/spi/spidev.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "rp_bram_upload.h"
+#include "rp_constants.h"
+
+#define METRICS_EXPORT_BACKLOG 4
+#define METRICS_EXPORT_RX_TIMEOUT_MS 1000
+
+Metrics metrics;
+
+static const char* stream_names[METRICS_NO_STREAMS] = {"cont", "block", "multi_block", "lia", "record"};
+static const char* spi_board_names[METRICS_NO_SPI_BOARDS] = {"adc20", "adc24"};
+
+static struct {
+    int sock;
+    pthread_t thread;
+    atomic_bool running;
+} exporter = {.sock = -1};
+
+static uint64_t load(const uint64_t* counter) {
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+static void clear(uint64_t* counters, size_t size) {
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++) __atomic_store_n(&counters[i], 0, __ATOMIC_RELAXED);
+}
+
+static void copy_hist(MetricsHist* dst, const MetricsHist* src) {
+    dst->sum_ns = load(&src->sum_ns);
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) dst->buckets[i] = load(&src->buckets[i]);
+}
+
+static uint64_t hist_count(const MetricsHist* hist) {
+    uint64_t count = 0;
+    for (int i = 0; i < METRICS_HIST_BUCKETS; i++) count += hist->buckets[i];
+    return count;
+}
+
+int metrics_spi_message(int board, int spi_fd, unsigned int no_xfers, struct spi_ioc_transfer* xfers) {
+    // ioctl(SPI_IOC_MESSAGE) with latency per Click Board
+    uint64_t t_start = metrics_now_ns();
+    int ret = ioctl(spi_fd, SPI_IOC_MESSAGE(no_xfers), xfers);
+    metrics_spi_observe(board, t_start, no_xfers);
+    return ret;
+}
+
+void metrics_spi_observe(int board, uint64_t t_start_ns, unsigned int no_xfers) {
+    // one transaction which started at t_start_ns (for read()/write() on spidev)
+    metrics_observe(&metrics.spi[board].latency, metrics_now_ns() - t_start_ns);
+    metrics_add(&metrics.spi[board].transfers, no_xfers);
+}
+
+void metrics_init(void) {
+    metrics_reset();
+}
+
+void metrics_reset(void) {
+    // the start-time is set last, so a snapshot never shows old counters with the new start
+    clear((uint64_t*)metrics.cmds, sizeof(metrics.cmds));
+    clear((uint64_t*)metrics.streams, sizeof(metrics.streams));
+    clear(&metrics.ram_overruns, sizeof(metrics.ram_overruns));
+    clear((uint64_t*)metrics.spi, sizeof(metrics.spi));
+    clear((uint64_t*)&metrics.trigger_wait, sizeof(metrics.trigger_wait));
+    clear(&metrics.trigger_timeouts, sizeof(metrics.trigger_timeouts));
+    __atomic_store_n(&metrics.t_start_ns, metrics_now_ns(), __ATOMIC_RELAXED);
+}
+
+uint32_t metrics_snapshot(StatsSnapshotHeader* header, StatsCmdEntry* cmds) {
+    // cmds needs METRICS_CMD_SLOTS entries, returns the no. of commands which were called
+    uint32_t no_cmds = 0;
+
+    memset(header, 0, sizeof(StatsSnapshotHeader));
+    header->magic = STATS_MAGIC;
+    header->version = STATS_VERSION;
+    header->t_ns = metrics_now_ns();
+    header->t_start_ns = load(&metrics.t_start_ns);
+    header->hist_buckets = METRICS_HIST_BUCKETS;
+
+    for (int i = 0; i < METRICS_NO_STREAMS; i++) {
+        header->streams[i].bytes = load(&metrics.streams[i].bytes);
+        header->streams[i].packages = load(&metrics.streams[i].packages);
+    }
+    header->ram_overruns = load(&metrics.ram_overruns);
+    for (int i = 0; i < METRICS_NO_SPI_BOARDS; i++) {
+        header->spi[i].transfers = load(&metrics.spi[i].transfers);
+        copy_hist(&header->spi[i].latency, &metrics.spi[i].latency);
+    }
+    copy_hist(&header->trigger_wait, &metrics.trigger_wait);
+    header->trigger_timeouts = load(&metrics.trigger_timeouts);
+
+    for (int slot = 0; slot < METRICS_CMD_SLOTS; slot++) {
+        StatsCmdEntry* entry = &cmds[no_cmds];
+        copy_hist(&entry->service, &metrics.cmds[slot]);
+        if (hist_count(&entry->service) == 0) continue;
+        entry->cmd_id = (slot < METRICS_MAX_CMD_ID) ? slot : METRICS_CMD_OTHER;
+        entry->reserved = 0;
+        no_cmds++;
+    }
+    header->no_cmds = no_cmds;
+    return no_cmds;
+}
+
+/**************************************************************/
+/* Prometheus-Exporter                                        */
+/**************************************************************/
+
+static void print_hist(FILE* out, const char* name, const char* label, const MetricsHist* hist) {
+    // cumulative buckets, le in seconds
+    uint64_t count = 0;
+    const char* sep = (label[0] != '\0') ? "," : "";
+
+    for (int i = 0; i < METRICS_HIST_BUCKETS - 1; i++) {
+        count += hist->buckets[i];
+        fprintf(out, "%s_bucket{%s%sle=\"%.9g\"} %llu\n", name, label, sep,
+                (double)(1ULL << (i + METRICS_HIST_SHIFT)) * 1e-9, (unsigned long long)count);
+    }
+    count += hist->buckets[METRICS_HIST_BUCKETS - 1];
+    fprintf(out, "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, label, sep, (unsigned long long)count);
+    // no empty braces for histograms without label
+    fprintf(out, "%s_sum%s%s%s %.9f\n", name, sep[0] ? "{" : "", label, sep[0] ? "}" : "", (double)hist->sum_ns * 1e-9);
+    fprintf(out, "%s_count%s%s%s %llu\n", name, sep[0] ? "{" : "", label, sep[0] ? "}" : "", (unsigned long long)count);
+}
+
+static void print_metrics(FILE* out, const StatsSnapshotHeader* hdr, const StatsCmdEntry* cmds) {
+    char label[32];
+
+    fprintf(out, "# HELP rp_metrics_age_seconds Time since start of the server or last STATS_RESET\n");
+    fprintf(out, "# TYPE rp_metrics_age_seconds gauge\n");
+    fprintf(out, "rp_metrics_age_seconds %.3f\n", (double)(hdr->t_ns - hdr->t_start_ns) * 1e-9);
+
+    fprintf(out, "# HELP rp_command_duration_seconds Service-time of the TCP-commands\n");
+    fprintf(out, "# TYPE rp_command_duration_seconds histogram\n");
+    for (uint32_t i = 0; i < hdr->no_cmds; i++) {
+        if (cmds[i].cmd_id == METRICS_CMD_OTHER) {
+            snprintf(label, sizeof(label), "cmd=\"other\"");
+        } else {
+            snprintf(label, sizeof(label), "cmd=\"%d\"", cmds[i].cmd_id);
+        }
+        print_hist(out, "rp_command_duration_seconds", label, &cmds[i].service);
+    }
+
+    fprintf(out, "# HELP rp_stream_bytes_total Bytes sent by the ADC-streams (written for recordings)\n");
+    fprintf(out, "# TYPE rp_stream_bytes_total counter\n");
+    for (int i = 0; i < METRICS_NO_STREAMS; i++) {
+        fprintf(out, "rp_stream_bytes_total{stream=\"%s\"} %llu\n", stream_names[i], (unsigned long long)hdr->streams[i].bytes);
+    }
+    fprintf(out, "# HELP rp_stream_packages_total Packages sent by the ADC-streams\n");
+    fprintf(out, "# TYPE rp_stream_packages_total counter\n");
+    for (int i = 0; i < METRICS_NO_STREAMS; i++) {
+        fprintf(out, "rp_stream_packages_total{stream=\"%s\"} %llu\n", stream_names[i], (unsigned long long)hdr->streams[i].packages);
+    }
+    fprintf(out, "# HELP rp_ram_overruns_total Packages overwritten by the RAM-Writer before they were sent\n");
+    fprintf(out, "# TYPE rp_ram_overruns_total counter\n");
+    fprintf(out, "rp_ram_overruns_total %llu\n", (unsigned long long)hdr->ram_overruns);
+
+    fprintf(out, "# HELP rp_spi_transfers_total SPI-frames per Click Board\n");
+    fprintf(out, "# TYPE rp_spi_transfers_total counter\n");
+    for (int i = 0; i < METRICS_NO_SPI_BOARDS; i++) {
+        fprintf(out, "rp_spi_transfers_total{board=\"%s\"} %llu\n", spi_board_names[i], (unsigned long long)hdr->spi[i].transfers);
+    }
+    fprintf(out, "# HELP rp_spi_transaction_duration_seconds Duration of the SPI-transactions per Click Board\n");
+    fprintf(out, "# TYPE rp_spi_transaction_duration_seconds histogram\n");
+    for (int i = 0; i < METRICS_NO_SPI_BOARDS; i++) {
+        snprintf(label, sizeof(label), "board=\"%s\"", spi_board_names[i]);
+        print_hist(out, "rp_spi_transaction_duration_seconds", label, &hdr->spi[i].latency);
+    }
+
+    fprintf(out, "# HELP rp_trigger_wait_seconds Wait for the trigger-armed event of the trigger-sweep\n");
+    fprintf(out, "# TYPE rp_trigger_wait_seconds histogram\n");
+    print_hist(out, "rp_trigger_wait_seconds", "", &hdr->trigger_wait);
+    fprintf(out, "# HELP rp_trigger_timeouts_total Trigger-waits without trigger-armed event\n");
+    fprintf(out, "# TYPE rp_trigger_timeouts_total counter\n");
+    fprintf(out, "rp_trigger_timeouts_total %llu\n", (unsigned long long)hdr->trigger_timeouts);
+}
+
+static void serve_client(int sock, StatsCmdEntry* cmds) {
+    // the request itself is not parsed, every path returns the metrics
+    StatsSnapshotHeader hdr;
+    struct timeval timeout = {METRICS_EXPORT_RX_TIMEOUT_MS / 1000, (METRICS_EXPORT_RX_TIMEOUT_MS % 1000) * 1000};
+    char request[1024];
+    char* body = NULL;
+    size_t body_len = 0;
+    char head[160];
+
+    // without the timeout a silent client would block the exporter
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+        printf("Metrics-Exporter: setting receive-timeout failed: %s\n", strerror(errno));
+        return;
+    }
+    if (recv(sock, request, sizeof(request), 0) <= 0) return;
+
+    FILE* out = open_memstream(&body, &body_len);
+    if (out == NULL) return;
+    metrics_snapshot(&hdr, cmds);
+    print_metrics(out, &hdr, cmds);
+    fclose(out);
+
+    int n = snprintf(head, sizeof(head),
+                     "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n", body_len);
+    if (send_all(sock, head, (size_t)n) == 0) send_all(sock, body, body_len);
+    free(body);
+}
+
+static void* exporter_thread(void* arg) {
+    StatsCmdEntry* cmds = (StatsCmdEntry*)arg;
+
+    while (atomic_load(&exporter.running)) {
+        int sock = accept(exporter.sock, NULL, NULL);
+        if (sock < 0) {
+            if (errno == EINTR) continue;
+            break;  // socket was shut down by metrics_export_stop()
+        }
+        serve_client(sock, cmds);
+        close(sock);
+    }
+    free(cmds);
+    return NULL;
+}
+
+int metrics_export_start(void) {
+    // exporter on METRICS_PORT (or RP_METRICS_PORT) of the loopback-interface (or RP_METRICS_BIND),
+    // the server runs without it if the port is not free
+    struct sockaddr_in addr;
+    int one = 1;
+    const char* env = getenv(METRICS_PORT_ENV);
+    const char* bind_addr = getenv(METRICS_BIND_ENV);
+    int port = (env != NULL) ? atoi(env) : METRICS_PORT;
+
+    if (port <= 0) {
+        printf("Metrics-Exporter disabled (%s=%s)\n", METRICS_PORT_ENV, env);
+        return 0;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind_addr != NULL && inet_pton(AF_INET, bind_addr, &addr.sin_addr) != 1) {
+        printf("Metrics-Exporter: invalid address %s=%s, running without exporter\n", METRICS_BIND_ENV, bind_addr);
+        return -1;
+    }
+    StatsCmdEntry* cmds = malloc(METRICS_CMD_SLOTS * sizeof(StatsCmdEntry));
+    exporter.sock = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (cmds == NULL || exporter.sock < 0) {
+        printf("Starting Metrics-Exporter failed: %s\n", strerror(errno));
+        free(cmds);
+        if (exporter.sock >= 0) close(exporter.sock);
+        exporter.sock = -1;
+        return -1;
+    }
+    setsockopt(exporter.sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(exporter.sock, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(exporter.sock, METRICS_EXPORT_BACKLOG) < 0) {
+        printf("Metrics-Exporter: port %d not available (%s), running without exporter\n", port, strerror(errno));
+        free(cmds);
+        close(exporter.sock);
+        exporter.sock = -1;
+        return -1;
+    }
+
+    atomic_store(&exporter.running, true);
+    if (pthread_create(&exporter.thread, NULL, exporter_thread, cmds) != 0) {
+        printf("Creating Metrics-Exporter-thread failed\n");
+        atomic_store(&exporter.running, false);
+        free(cmds);
+        close(exporter.sock);
+        exporter.sock = -1;
+        return -1;
+    }
+    printf("Metrics-Exporter (Prometheus) listens on %s:%d\n", (bind_addr != NULL) ? bind_addr : "127.0.0.1", port);
+    return 0;
+}
+
+void metrics_export_stop(void) {
+    if (!atomic_load(&exporter.running)) return;
+    atomic_store(&exporter.running, false);
+    shutdown(exporter.sock, SHUT_RDWR);  // wakes up accept()
+    pthread_join(exporter.thread, NULL);
+    close(exporter.sock);
+    exporter.sock = -1;
+}
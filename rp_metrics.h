@@ -0,0 +1,140 @@
+/*
+ * rp_metrics.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    In-process metrics of the app-server, always on:
+ *
+ *     -- service-time histogram per command-ID (reactor), histograms of the SPI-transactions
+ *        per Click Board and of the trigger-waits, bytes/packages per stream-mode, RAM-overruns
+ *
+ *     -- recording is a few relaxed atomic adds into a static registry (no locks, no
+ *        allocation), histograms have log2-buckets so the bucket is found with one clz
+ *
+ *     -- GET_STATS replies a binary snapshot (StatsSnapshotHeader + StatsCmdEntry[no_cmds],
+ *        only commands which were called), ch = STATS_RESET clears the registry afterwards
+ *
+ *     -- an exporter-thread serves the same values as Prometheus text-format on METRICS_PORT
+ *        (any HTTP-request, e.g. GET /metrics), RP_METRICS_PORT (env.) selects another port,
+ *        0 disables the exporter. It only listens on the loopback-interface, RP_METRICS_BIND
+ *        (env.) selects another address, e.g. 0.0.0.0 for all interfaces (no authentication)
+ *
+ *    Values of one snapshot are read field by field while other threads keep recording,
+ *    so counters of one histogram can be a few events apart.
+ */
+
+#ifndef SRC_RP_METRICS_H
+#define SRC_RP_METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// bucket i counts durations < 2^(i + METRICS_HIST_SHIFT) ns (~1 us .. ~4.3 s), the last bucket the rest
+#define METRICS_HIST_BUCKETS 24
+#define METRICS_HIST_SHIFT 10
+#define METRICS_MAX_CMD_ID 256                      // command-IDs >= METRICS_MAX_CMD_ID share one slot
+#define METRICS_CMD_SLOTS (METRICS_MAX_CMD_ID + 1)
+#define METRICS_CMD_OTHER -1                        // cmd_id of the shared slot in the snapshot
+
+// stream-modes (bytes and packages sent to the client, written to the file for recordings)
+#define METRICS_STREAM_CONT 0         // continous-mode (raw and compressed)
+#define METRICS_STREAM_BLOCK 1        // one package per block (RAM-size)
+#define METRICS_STREAM_MULTI_BLOCK 2
+#define METRICS_STREAM_LIA 3
+#define METRICS_STREAM_RECORD 4
+#define METRICS_NO_STREAMS 5
+
+// Click Boards on the SPI-bus
+#define METRICS_SPI_ADC20 0
+#define METRICS_SPI_ADC24 1
+#define METRICS_NO_SPI_BOARDS 2
+
+typedef struct {
+    uint64_t sum_ns;
+    uint64_t buckets[METRICS_HIST_BUCKETS];  // count = sum of all buckets
+} MetricsHist;
+
+typedef struct {
+    uint64_t bytes;
+    uint64_t packages;
+} MetricsStream;
+
+typedef struct {
+    uint64_t transfers;   // spi_ioc_transfers (one transaction can hold several frames)
+    MetricsHist latency;  // one entry per transaction (SPI_IOC_MESSAGE)
+} MetricsSpi;
+
+// reply of GET_STATS, followed by no_cmds StatsCmdEntry
+typedef struct {
+    uint32_t magic;          // STATS_MAGIC
+    uint32_t version;        // STATS_VERSION
+    uint64_t t_ns;           // CLOCK_MONOTONIC on RedPitaya when the snapshot was taken
+    uint64_t t_start_ns;     // start of the server or last STATS_RESET
+    uint32_t no_cmds;
+    uint32_t hist_buckets;   // METRICS_HIST_BUCKETS
+    MetricsStream streams[METRICS_NO_STREAMS];
+    uint64_t ram_overruns;   // packages overwritten by the RAM-Writer before they were sent
+    MetricsSpi spi[METRICS_NO_SPI_BOARDS];
+    MetricsHist trigger_wait;
+    uint64_t trigger_timeouts;
+} StatsSnapshotHeader;
+
+typedef struct {
+    int32_t cmd_id;          // METRICS_CMD_OTHER for IDs >= METRICS_MAX_CMD_ID
+    uint32_t reserved;
+    MetricsHist service;
+} StatsCmdEntry;
+
+// registry (written by all threads with relaxed atomics)
+typedef struct {
+    uint64_t t_start_ns;
+    MetricsHist cmds[METRICS_CMD_SLOTS];
+    MetricsStream streams[METRICS_NO_STREAMS];
+    uint64_t ram_overruns;
+    MetricsSpi spi[METRICS_NO_SPI_BOARDS];
+    MetricsHist trigger_wait;
+    uint64_t trigger_timeouts;
+} Metrics;
+
+extern Metrics metrics;
+
+static inline uint64_t metrics_now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static inline void metrics_add(uint64_t* counter, uint64_t value) {
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+static inline void metrics_observe(MetricsHist* hist, uint64_t ns) {
+    uint64_t units = ns >> METRICS_HIST_SHIFT;
+    int bucket = (units == 0) ? 0 : 64 - __builtin_clzll(units);
+    if (bucket >= METRICS_HIST_BUCKETS) bucket = METRICS_HIST_BUCKETS - 1;
+    metrics_add(&hist->buckets[bucket], 1);
+    metrics_add(&hist->sum_ns, ns);
+}
+
+static inline void metrics_observe_cmd(int cmd_id, uint64_t ns) {
+    int slot = (cmd_id >= 0 && cmd_id < METRICS_MAX_CMD_ID) ? cmd_id : METRICS_MAX_CMD_ID;
+    metrics_observe(&metrics.cmds[slot], ns);
+}
+
+static inline void metrics_stream_package(int stream, uint64_t bytes) {
+    metrics_add(&metrics.streams[stream].bytes, bytes);
+    metrics_add(&metrics.streams[stream].packages, 1);
+}
+
+struct spi_ioc_transfer;
+int metrics_spi_message(int board, int spi_fd, unsigned int no_xfers, struct spi_ioc_transfer* xfers);
+void metrics_spi_observe(int board, uint64_t t_start_ns, unsigned int no_xfers);
+
+void metrics_init(void);
+void metrics_reset(void);
+uint32_t metrics_snapshot(StatsSnapshotHeader* header, StatsCmdEntry* cmds);
+int metrics_export_start(void);
+void metrics_export_stop(void);
+
+#endif
@@ -0,0 +1,934 @@
+/*
+ * rp_ram_stream.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Streaming of the RAM-Writer-Buffer (CMA-Region) to the TCP-Client.
+ *
+ *    The pos-register of the RAM-Writer holds the current write-index (in 32bit-samples).
+ *    In continous-mode the RAM-Writer wraps around after HIGHEST_POS_ADDR_CONT_MODE,
+ *    so a TCP-Package at the end of the buffer is sent as two parts (iovec).
+ *
+ *    In continous-mode polling of the pos-register and sending are decoupled by a SPSC-ring,
+ *    so a stalled TCP-Connection does not stop the tracking of the write-pointer. Packages which
+ *    get overwritten before they are sent are counted as overruns and reported in the AdcStreamHeader,
+ *    they are still sent as header without samples, so the client gets all requested packages.
+ *    Every raw package ends with a status-word: the RAM-Writer can also reach a package while
+ *    the kernel still sends it (ADC_BLOCK_TORN). With zero-copy this is only known after the
+ *    completion of the send, so up to ADC_STREAM_STATUS_LAG packages are in flight and the
+ *    status-word belongs to the package sent ADC_STREAM_STATUS_LAG packages before.
+ *
+ *    Multi-Block-Mode uses the same pipeline with packages of 1/N of the buffer (regions),
+ *    each block carries sequence-number, absolute sample-index and timestamp of its first sample.
+ *
+ *    Local recordings use it with packages of one chunk, which are written to a file instead of the socket.
+ *    The software-LIA (ADC_LIA_MODE) uses it with the normal TCP-Packages and sends only the filtered points.
+ */
+
+#include "rp_ram_stream.h"
+
+#include <errno.h>
+#include <linux/errqueue.h>
+#include <stddef.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rp_adc_codec.h"
+#include "rp_bram_upload.h"
+#include "rp_constants.h"
+#include "rp_lia_sw.h"
+#include "rp_metrics.h"
+#include "rp_recorder.h"
+#include "rp_reset.h"
+#include "rp_spsc_ring.h"
+#include "rp_trace.h"
+
+// MSG_ZEROCOPY is available since linux 4.14, older libc-headers don't know the flags
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
+// timeout when waiting for send-completions of the kernel
+#define ZC_POLL_TIMEOUT_MS 100
+#define ZC_WAIT_TIMEOUT_MS 5000  // no completion for this long: the client stalls, the stream is stopped
+#define STREAM_WINDOW_SLOTS (ADC_STREAM_STATUS_LAG + 1)
+
+// descriptor of one TCP-Package (or block) inside the RAM-Buffer (producer -> consumer)
+typedef struct {
+    uint32_t rd_idx;       // start-index inside RAM-Buffer
+    uint32_t seq;          // sequence-number of the package
+    uint64_t start_total;  // absolute no. of samples written before this package
+    uint64_t t_ns;         // CLOCK_MONOTONIC-time of the first sample (estimated from the sample-rate)
+    bool lost;             // dropped by the producer or overwritten before it was read (set by ram_pipeline_pop)
+} RamPkgDesc;
+
+// shared state of producer- and consumer-stage
+typedef struct {
+    RamConfig ramCfg;
+    SpscRing ring;
+    uint32_t wrap;
+    uint32_t pkg_size;
+    uint32_t no_tcp_packages;
+    double sample_rate_hz;
+    useconds_t poll_us;
+    uint32_t pos0;  // pos-register when the producer started
+    atomic_bool stop;
+    atomic_bool producer_done;  // all packages are published, the producer keeps tracking wr_total till stop
+    // consumer only
+    uint32_t next_seq;
+    RamPkgDesc pending;
+    bool pending_valid;
+    void (*idle)(void* arg);  // called while the consumer waits for the next package (or NULL)
+    void* idle_arg;
+    _Alignas(RP_CACHE_LINE_SIZE) _Atomic uint64_t wr_total;  // written by producer only
+    _Alignas(RP_CACHE_LINE_SIZE) atomic_uint overruns;       // lost packages (producer and consumer)
+} RamPipeline;
+
+static void ram_pipeline_overrun(RamPipeline* pl) {
+    // package lost (not sent or overwritten while it was read), called by producer and consumer
+    atomic_fetch_add(&pl->overruns, 1);
+    metrics_add(&metrics.ram_overruns, 1);
+}
+
+// package in flight which waits for its status-word (continous- and multi-block-mode)
+typedef struct {
+    RamPkgDesc desc;
+    uint32_t zc_end;  // zc.next_id after the package was sent, completed when completed_id reaches it
+    uint32_t status;  // ADC_BLOCK_OK/ADC_BLOCK_TORN, valid once the package is settled
+    union {
+        AdcStreamHeader adc;
+        AdcBlockHeader block;
+    } hdr;  // pinned by MSG_ZEROCOPY till the completion
+} StreamSlot;
+
+typedef struct {
+    StreamSlot slots[STREAM_WINDOW_SLOTS];
+    RamPipeline* pl;
+    ZcSocket* zc;
+    uint32_t sent;     // packages sent
+    uint32_t settled;  // packages completed by the kernel with known status
+    uint32_t words;    // status-words sent
+    bool count_torn;   // torn packages are counted as overruns (continous-mode)
+} StreamWindow;
+
+static double elapsed_s(struct timespec* start, struct timespec* end) {
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+void zc_socket_init(ZcSocket* zc, int sock) {
+    int one = 1;
+
+    memset(zc, 0, sizeof(ZcSocket));
+    zc->sock = sock;
+    // try to enable zero-copy on socket, if not supported we use normal send()
+    zc->enabled = (setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0);
+    if (!zc->enabled) {
+        printf("Zero-Copy not supported on socket (%s), using copying send()\n", strerror(errno));
+    }
+}
+
+static int zc_reap_completions(ZcSocket* zc) {
+    // read all send-completions from the error-queue of the socket
+    char control[128];
+    struct msghdr msg;
+
+    while (true) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(zc->sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != NULL; cm = CMSG_NXTHDR(&msg, cm)) {
+            struct sock_extended_err* serr = (struct sock_extended_err*)CMSG_DATA(cm);
+            if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+            // completions cover the id-range [ee_info, ee_data] and arrive in order for TCP
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                zc->no_copied += serr->ee_data - serr->ee_info + 1;
+            }
+            if ((int32_t)(serr->ee_data + 1 - zc->completed_id) > 0) {
+                zc->completed_id = serr->ee_data + 1;
+            }
+        }
+    }
+}
+
+int zc_wait_completions(ZcSocket* zc, uint32_t max_inflight) {
+    // blocks till no more than max_inflight zero-copy sends are pending,
+    // fails if no send completes for ZC_WAIT_TIMEOUT_MS (client doesn't read)
+    struct pollfd pfd;
+    struct timespec t_progress, t_now;
+
+    if (!zc->enabled) return 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t_progress);
+    while ((zc->next_id - zc->completed_id) > max_inflight) {
+        uint32_t completed_id = zc->completed_id;
+        pfd.fd = zc->sock;
+        pfd.events = 0;  // POLLERR is always reported
+        if (poll(&pfd, 1, ZC_POLL_TIMEOUT_MS) < 0 && errno != EINTR) {
+            return -1;
+        }
+        if (zc_reap_completions(zc) < 0) {
+            printf("Reading zero-copy completions failed: %s\n", strerror(errno));
+            return -1;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t_now);
+        if (zc->completed_id != completed_id) {
+            t_progress = t_now;
+        } else if (elapsed_s(&t_progress, &t_now) * 1e3 > ZC_WAIT_TIMEOUT_MS) {
+            printf("No zero-copy completion for %d ms, %u sends pending\n", ZC_WAIT_TIMEOUT_MS,
+                   zc->next_id - zc->completed_id);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int zc_send_iov(ZcSocket* zc, struct iovec* iov, int iov_cnt) {
+    // sends all data in iov, with MSG_ZEROCOPY if enabled
+    struct msghdr msg;
+    ssize_t n;
+
+    while (iov_cnt > 0) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iov_cnt;
+
+        n = sendmsg(zc->sock, &msg, MSG_NOSIGNAL | (zc->enabled ? MSG_ZEROCOPY : 0));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (zc->enabled && errno == ENOBUFS && zc->next_id != zc->completed_id) {
+                // too many pinned pages (optmem-limit), wait for pending sends
+                if (zc_wait_completions(zc, 0) < 0) return -1;
+                continue;
+            }
+            if (zc->enabled && (errno == EFAULT || errno == ENOBUFS || errno == EOPNOTSUPP)) {
+                // pages of the CMA-mapping can't be pinned -> copy from now on
+                printf("Zero-Copy send failed (%s), falling back to copying send()\n", strerror(errno));
+                if (zc_wait_completions(zc, 0) < 0) return -1;
+                zc->enabled = false;
+                continue;
+            }
+            printf("Sending data to client failed: %s\n", strerror(errno));
+            return -1;
+        }
+
+        if (zc->enabled) zc->next_id++;
+
+        // skip the sent data (partial sends)
+        while (iov_cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iov_cnt--;
+        }
+        if (iov_cnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+void zc_socket_release(ZcSocket* zc) {
+    int zero = 0;
+    zc_wait_completions(zc, 0);
+    setsockopt(zc->sock, SOL_SOCKET, SO_ZEROCOPY, &zero, sizeof(zero));
+}
+
+uint32_t ram_stream_wrap_samples(RamConfig ramCfg) {
+    // no. of samples after which the RAM-Writer wraps around in continous-mode
+    uint32_t wrap = HIGHEST_POS_ADDR_CONT_MODE;
+    if (ramCfg.param.ram_size < wrap) wrap = ramCfg.param.ram_size;
+    return wrap;
+}
+
+uint32_t ram_stream_get_pos(RamConfig ramCfg) {
+    return *ramCfg.pos & ramCfg.param.sts_width_mask;
+}
+
+static uint32_t ram_stream_available(uint32_t pos, uint32_t rd_idx, uint32_t wrap) {
+    // no. of samples written by RAM-Writer and not yet sent
+    return (pos >= rd_idx) ? (pos - rd_idx) : (wrap - rd_idx + pos);
+}
+
+int ram_stream_pkg_iov(RamConfig ramCfg, uint32_t rd_idx, uint32_t no_samples, struct iovec* iov) {
+    // fills iov with the package at rd_idx, returns no. of used iovecs (2 at the wrap-around)
+    uint32_t wrap = ram_stream_wrap_samples(ramCfg);
+
+    iov[0].iov_base = ramCfg.ram + rd_idx;
+    if (rd_idx + no_samples <= wrap) {
+        iov[0].iov_len = no_samples * sizeof(int32_t);
+        return 1;
+    }
+    iov[0].iov_len = (wrap - rd_idx) * sizeof(int32_t);
+    iov[1].iov_base = ramCfg.ram;
+    iov[1].iov_len = (no_samples - (wrap - rd_idx)) * sizeof(int32_t);
+    return 2;
+}
+
+static uint32_t next_pow2(uint32_t x) {
+    uint32_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+static bool ram_pipeline_overwritten(RamPipeline* pl, RamPkgDesc* desc) {
+    // true if the RAM-Writer already wrote over the first sample of the package. The pos-register is
+    // read again, wr_total of the producer can be up to one poll-interval old.
+    uint64_t wr_total = atomic_load_explicit(&pl->wr_total, memory_order_acquire);
+    uint32_t last_pos = (uint32_t)((pl->pos0 + wr_total) % pl->wrap);
+    wr_total += ram_stream_available(ram_stream_get_pos(pl->ramCfg), last_pos, pl->wrap);
+    return wr_total - desc->start_total > pl->wrap;
+}
+
+static void* ram_pipeline_producer(void* arg) {
+    // producer-stage: tracks the write-pointer of the RAM-Writer and publishes every
+    // completely written package as descriptor in the ring. The RAM-Writer keeps running
+    // after the last package, so wr_total is updated till the consumer is done: packages
+    // still in the socket can be overwritten as well.
+    RamPipeline* pl = (RamPipeline*)arg;
+    uint32_t last_pos = pl->pos0;
+    uint64_t wr_total = 0;        // absolute no. of samples written by the RAM-Writer
+    uint64_t next_pkg_start = 0;  // absolute start of the next package
+    uint32_t seq = 0;
+
+    while (!atomic_load(&pl->stop)) {
+        if (seq == pl->no_tcp_packages) atomic_store(&pl->producer_done, true);
+
+        struct timespec t_now;
+        clock_gettime(CLOCK_MONOTONIC, &t_now);
+        uint32_t pos = ram_stream_get_pos(pl->ramCfg);
+        uint32_t delta = ram_stream_available(pos, last_pos, pl->wrap);
+        last_pos = pos;
+        wr_total += delta;
+        atomic_store_explicit(&pl->wr_total, wr_total, memory_order_release);
+
+        if (seq == pl->no_tcp_packages || wr_total - next_pkg_start < pl->pkg_size) {
+            usleep(pl->poll_us);
+            continue;
+        }
+
+        while (wr_total - next_pkg_start >= pl->pkg_size && seq < pl->no_tcp_packages) {
+            RamPkgDesc desc;
+            desc.rd_idx = (uint32_t)(next_pkg_start % pl->wrap);
+            desc.seq = seq;
+            desc.start_total = next_pkg_start;
+            // first sample was written (wr_total - next_pkg_start) samples before the pos-register was read
+            desc.t_ns = (uint64_t)t_now.tv_sec * 1000000000ULL + (uint64_t)t_now.tv_nsec -
+                        (uint64_t)((double)(wr_total - next_pkg_start) * 1e9 / pl->sample_rate_hz);
+            if (!spsc_ring_push(&pl->ring, &desc)) {
+                // sender is more than a whole buffer behind, this package is lost
+                ram_pipeline_overrun(pl);
+            }
+            seq++;
+            next_pkg_start += pl->pkg_size;
+        }
+    }
+    atomic_store(&pl->producer_done, true);
+    return NULL;
+}
+
+static int ram_pipeline_start(RamPipeline* pl, AxiDevs axi_devs, RamConfig ramCfg, uint32_t pkg_size, int no_packages,
+                              int sample_rate_divider, pthread_t* producer) {
+    // arms RAM-Writer and ADC and starts the producer-stage, packages have pkg_size samples
+    memset(pl, 0, sizeof(RamPipeline));
+    pl->ramCfg = ramCfg;
+    pl->wrap = ram_stream_wrap_samples(ramCfg);
+    pl->pkg_size = pkg_size;
+    pl->no_tcp_packages = (no_packages > 0) ? (uint32_t)no_packages : 0;
+    pl->sample_rate_hz = (double)ADC_SYS_CLK_HZ / (sample_rate_divider > 0 ? sample_rate_divider : 1);
+
+    if (pl->pkg_size == 0 || pl->pkg_size > pl->wrap) {
+        printf("Invalid TCP-Package-Size %u for RAM-Size %u\n", pl->pkg_size, pl->wrap);
+        return -1;
+    }
+
+    // sleep a quarter of the time the RAM-Writer needs for one package when waiting for new data
+    pl->poll_us = (useconds_t)((uint64_t)pl->pkg_size * (sample_rate_divider > 0 ? sample_rate_divider : 1) / (ADC_SYS_CLK_HZ / 1000000) / 4);
+    if (pl->poll_us == 0) pl->poll_us = 1;
+
+    // one descriptor for each package inside the RAM-Buffer
+    if (spsc_ring_init(&pl->ring, next_pow2(pl->wrap / pl->pkg_size + 1), sizeof(RamPkgDesc)) < 0) {
+        return -1;
+    }
+
+    // start RAM-Writer and ADC
+    enable_module(axi_devs, RESET_INDEX_RAM_WRITER);
+    enable_module(axi_devs, RESET_INDEX_RP_ADC);
+    pl->pos0 = ram_stream_get_pos(ramCfg);
+
+    if (pthread_create(producer, NULL, ram_pipeline_producer, pl) != 0) {
+        printf("Creating RAM-Writer producer-thread failed\n");
+        spsc_ring_free(&pl->ring);
+        return -1;
+    }
+    return 0;
+}
+
+static void ram_pipeline_stop(RamPipeline* pl, pthread_t producer) {
+    atomic_store(&pl->stop, true);
+    pthread_join(producer, NULL);
+}
+
+static bool ram_pipeline_pop(RamPipeline* pl, RamPkgDesc* desc) {
+    // consumer: descriptor of the next package in seq-order, false after the last package.
+    // Packages which the producer could not publish (ring full) or which got overwritten by the
+    // RAM-Writer before we could read them come with desc->lost -> don't send stale data
+    if (pl->next_seq >= pl->no_tcp_packages) return false;
+
+    while (!pl->pending_valid) {
+        if (spsc_ring_pop(&pl->ring, &pl->pending)) {
+            pl->pending_valid = true;
+        } else if (atomic_load(&pl->producer_done) && spsc_ring_count(&pl->ring) == 0) {
+            break;  // the remaining packages were dropped by the producer
+        } else {
+            if (pl->idle != NULL) pl->idle(pl->idle_arg);
+            usleep(pl->poll_us);
+        }
+    }
+
+    if (pl->pending_valid && pl->pending.seq == pl->next_seq) {
+        *desc = pl->pending;
+        pl->pending_valid = false;
+        desc->lost = ram_pipeline_overwritten(pl, desc);
+        if (desc->lost) ram_pipeline_overrun(pl);
+    } else {
+        // gap in the ring, the overrun was counted by the producer
+        memset(desc, 0, sizeof(RamPkgDesc));
+        desc->seq = pl->next_seq;
+        desc->start_total = (uint64_t)pl->next_seq * pl->pkg_size;
+        desc->rd_idx = (uint32_t)(desc->start_total % pl->wrap);
+        desc->lost = true;
+    }
+    pl->next_seq++;
+    return true;
+}
+
+static void ram_pipeline_fill_stats(RamPipeline* pl, ZcSocket* zc, struct timespec* t_start, StreamStats* stats) {
+    struct timespec t_end;
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+    stats->duration_s = elapsed_s(t_start, &t_end);
+    stats->mbytes_per_s = (stats->duration_s > 0) ? (stats->bytes_sent / 1e6) / stats->duration_s : 0;
+    stats->zerocopy_used = zc->enabled;
+    stats->zerocopy_sends = zc->next_id;
+    stats->zerocopy_copied = zc->no_copied;
+    stats->overruns = atomic_load(&pl->overruns);
+}
+
+static StreamSlot* stream_window_next(StreamWindow* win) {
+    // slot of the next package, its previous package got its status-word already
+    return &win->slots[win->sent % STREAM_WINDOW_SLOTS];
+}
+
+static void stream_window_settle(void* arg) {
+    // status of the packages the kernel is done with (checked as early as possible, the
+    // RAM-Writer keeps running), also called while the consumer waits for the next package
+    StreamWindow* win = (StreamWindow*)arg;
+
+    if (win->zc->enabled && zc_reap_completions(win->zc) < 0) return;  // reported by zc_wait_completions()
+    while (win->settled < win->sent) {
+        StreamSlot* slot = &win->slots[win->settled % STREAM_WINDOW_SLOTS];
+        if (win->zc->enabled && (int32_t)(win->zc->completed_id - slot->zc_end) < 0) break;
+        slot->status = ADC_BLOCK_OK;
+        if (slot->desc.lost) {
+            slot->status = ADC_BLOCK_TORN;
+        } else if (ram_pipeline_overwritten(win->pl, &slot->desc)) {
+            slot->status = ADC_BLOCK_TORN;
+            if (win->count_torn) ram_pipeline_overrun(win->pl);
+        }
+        TRACE_DEBUG("status of package %u: %u", slot->desc.seq, slot->status);
+        win->settled++;
+    }
+}
+
+static int stream_window_status(StreamWindow* win) {
+    // sends the next status-word: status of package words - ADC_STREAM_STATUS_LAG (filler before),
+    // waits till the kernel released its pages
+    uint32_t status = ADC_BLOCK_OK;
+
+    if (win->words >= ADC_STREAM_STATUS_LAG) {
+        uint32_t idx = win->words - ADC_STREAM_STATUS_LAG;
+        StreamSlot* slot = &win->slots[idx % STREAM_WINDOW_SLOTS];
+        if (zc_wait_completions(win->zc, win->zc->next_id - slot->zc_end) < 0) return -1;
+        stream_window_settle(win);
+        status = slot->status;
+    }
+    if (send_all(win->zc->sock, &status, sizeof(status)) != 0) {
+        printf("Sending package-status failed: %s\n", strerror(errno));
+        return -1;
+    }
+    win->words++;
+    return 0;
+}
+
+int cont_adc_writer_zc(AxiDevs axi_devs, int sock_client, RamConfig ramCfg, int no_tcp_packages,
+                       int sample_rate_divider, StreamStats* stats) {
+    // continous mode for ADC-Sampling till 15.625 MS/s, split in two pipeline-stages:
+    //  -- producer-thread: polls pos-register and pushes package-descriptors into SPSC-ring
+    //  -- consumer (this thread): pops descriptors and hands the CMA-pages to the socket
+    // every package: AdcStreamHeader (sequence-number, overrun-counter) + samples + uint32 status
+    // of the package ADC_STREAM_STATUS_LAG before (ADC_BLOCK_TORN if the RAM-Writer reached it
+    // while it was sent), lost packages are sent with no_samples = 0
+    RamPipeline pl;
+    ZcSocket zc;
+    RamPkgDesc desc;
+    StreamWindow win;
+    struct iovec iov[3];
+    struct timespec t_start;
+    pthread_t producer;
+    int ret = 0;
+
+    memset(stats, 0, sizeof(StreamStats));
+    memset(&win, 0, sizeof(StreamWindow));
+    win.count_torn = true;
+    uint32_t pkg_size = ramCfg.param.tcp_pkg_size;
+
+    zc_socket_init(&zc, sock_client);
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    if (ram_pipeline_start(&pl, axi_devs, ramCfg, pkg_size, no_tcp_packages, sample_rate_divider, &producer) < 0) {
+        zc_socket_release(&zc);
+        return -1;
+    }
+    win.pl = &pl;
+    win.zc = &zc;
+    pl.idle = stream_window_settle;
+    pl.idle_arg = &win;
+
+    while (ram_pipeline_pop(&pl, &desc)) {
+        StreamSlot* slot = stream_window_next(&win);
+        AdcStreamHeader* hdr = &slot->hdr.adc;
+        slot->desc = desc;
+        hdr->magic = ADC_STREAM_MAGIC;
+        hdr->seq = desc.seq;
+        hdr->overruns = atomic_load(&pl.overruns);
+        hdr->no_samples = desc.lost ? 0 : pl.pkg_size;
+
+        iov[0].iov_base = hdr;
+        iov[0].iov_len = sizeof(AdcStreamHeader);
+        int iov_cnt = 1 + (desc.lost ? 0 : ram_stream_pkg_iov(ramCfg, desc.rd_idx, pl.pkg_size, &iov[1]));
+
+        // the status of this package follows ADC_STREAM_STATUS_LAG packages later, when the kernel
+        // released its pages, so up to ADC_STREAM_STATUS_LAG packages are in flight
+        if (zc_send_iov(&zc, iov, iov_cnt) < 0) {
+            printf("Stopped Continous-Mode after %u/%d TCP-Packages\n", desc.seq, no_tcp_packages);
+            ret = -1;
+            break;
+        }
+        slot->zc_end = zc.next_id;
+        win.sent++;
+        if (stream_window_status(&win) < 0) {
+            printf("Stopped Continous-Mode after %u/%d TCP-Packages\n", desc.seq, no_tcp_packages);
+            ret = -1;
+            break;
+        }
+
+        uint64_t pkg_bytes = sizeof(AdcStreamHeader) + (uint64_t)hdr->no_samples * sizeof(int32_t) + sizeof(uint32_t);
+        stats->no_packages++;
+        stats->bytes_sent += pkg_bytes;
+        metrics_stream_package(METRICS_STREAM_CONT, pkg_bytes);
+        TRACE_DEBUG("sent TCP-Package %u/%d (overruns: %u)", desc.seq + 1, no_tcp_packages, hdr->overruns);
+    }
+    // status of the last packages
+    for (int i = 0; ret == 0 && i < ADC_STREAM_STATUS_LAG; i++) {
+        if (stream_window_status(&win) < 0) ret = -1;
+        stats->bytes_sent += sizeof(uint32_t);
+    }
+
+    ram_pipeline_stop(&pl, producer);
+
+    // all pages have to be released by the kernel before the RAM-Writer gets disabled
+    zc_socket_release(&zc);
+    ram_pipeline_fill_stats(&pl, &zc, &t_start, stats);
+
+    spsc_ring_free(&pl.ring);
+    return ret;
+}
+
+static double thread_cpu_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+int cont_adc_writer_compressed(AxiDevs axi_devs, int sock_client, RamConfig ramCfg, int no_tcp_packages,
+                               int sample_rate_divider, StreamStats* stats) {
+    // continous mode with lossless compression (ADC_STREAM_COMPRESSED), same pipeline as
+    // cont_adc_writer_zc(): the consumer splits the package out of the RAM-Buffer into the
+    // channels, checks that it was not overwritten meanwhile and sends the encoded payload
+    RamPipeline pl;
+    ZcSocket zc;
+    RamPkgDesc desc;
+    AdcStreamZHeader hdr;
+    struct iovec seg[2], iov[2];
+    struct timespec t_start;
+    pthread_t producer;
+    int ret = 0;
+
+    memset(stats, 0, sizeof(StreamStats));
+    stats->compressed = true;
+    uint32_t pkg_size = ramCfg.param.tcp_pkg_size;
+    size_t ch_size = ((size_t)pkg_size + ADC_CODEC_BLOCK) * sizeof(int16_t);  // incl. padding of the last block
+    int16_t* ch_a = malloc(ch_size);
+    int16_t* ch_b = malloc(ch_size);
+    uint8_t* payload = malloc(adc_codec_max_bytes((int)pkg_size));
+    if (ch_a == NULL || ch_b == NULL || payload == NULL) {
+        free(ch_a);
+        free(ch_b);
+        free(payload);
+        return -1;
+    }
+
+    // the payload-buffer is reused for the next package -> copying send()
+    memset(&zc, 0, sizeof(ZcSocket));
+    zc.sock = sock_client;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    if (ram_pipeline_start(&pl, axi_devs, ramCfg, pkg_size, no_tcp_packages, sample_rate_divider, &producer) < 0) {
+        free(ch_a);
+        free(ch_b);
+        free(payload);
+        return -1;
+    }
+
+    while (ram_pipeline_pop(&pl, &desc)) {
+        double t_cpu = thread_cpu_s();
+        if (!desc.lost) {
+            int seg_cnt = ram_stream_pkg_iov(ramCfg, desc.rd_idx, pl.pkg_size, seg);
+            uint32_t done = 0;
+            for (int i = 0; i < seg_cnt; i++) {
+                uint32_t n = (uint32_t)(seg[i].iov_len / sizeof(uint32_t));
+                adc_codec_split((const uint32_t*)seg[i].iov_base, (int)n, ch_a + done, ch_b + done);
+                done += n;
+            }
+            // the RAM-Writer could have reached the package while it was read
+            if (ram_pipeline_overwritten(&pl, &desc)) {
+                ram_pipeline_overrun(&pl);
+                desc.lost = true;
+            }
+        }
+        // lost packages are sent as header without payload
+        hdr.no_bytes = desc.lost ? 0 : (uint32_t)adc_codec_encode(ch_a, ch_b, (int)pl.pkg_size, payload);
+        stats->codec_cpu_s += thread_cpu_s() - t_cpu;
+
+        hdr.magic = ADC_STREAM_Z_MAGIC;
+        hdr.seq = desc.seq;
+        hdr.overruns = atomic_load(&pl.overruns);
+        hdr.no_samples = desc.lost ? 0 : pl.pkg_size;
+        hdr.codec = ADC_CODEC_DELTA_BITPLANE;
+        hdr.reserved = 0;
+        iov[0].iov_base = &hdr;
+        iov[0].iov_len = sizeof(AdcStreamZHeader);
+        iov[1].iov_base = payload;
+        iov[1].iov_len = hdr.no_bytes;
+        if (zc_send_iov(&zc, iov, 2) < 0) {
+            printf("Stopped compressed Continous-Mode after %u/%d TCP-Packages\n", desc.seq, no_tcp_packages);
+            ret = -1;
+            break;
+        }
+
+        stats->no_packages++;
+        stats->raw_bytes += sizeof(AdcStreamHeader) + (uint64_t)hdr.no_samples * sizeof(int32_t);
+        stats->bytes_sent += sizeof(AdcStreamZHeader) + hdr.no_bytes;
+        metrics_stream_package(METRICS_STREAM_CONT, sizeof(AdcStreamZHeader) + hdr.no_bytes);
+        TRACE_DEBUG("sent compressed TCP-Package %u/%d (%u Bytes, overruns: %u)", desc.seq + 1, no_tcp_packages,
+                    hdr.no_bytes, hdr.overruns);
+    }
+
+    ram_pipeline_stop(&pl, producer);
+    ram_pipeline_fill_stats(&pl, &zc, &t_start, stats);
+
+    spsc_ring_free(&pl.ring);
+    free(ch_a);
+    free(ch_b);
+    free(payload);
+    return ret;
+}
+
+int lia_adc_writer(AxiDevs axi_devs, int sock_client, RamConfig ramCfg, LiaSw* lia, int output, int no_tcp_packages,
+                   int sample_rate_divider, StreamStats* stats) {
+    // ADC_LIA_MODE in software (rp_lia_sw.h), same pipeline as cont_adc_writer_zc(): the consumer
+    // mixes and filters each package straight out of the RAM-Buffer and sends only the decimated
+    // points (LiaStreamHeader + I/Q or magnitude/phase). The reference-phase and the decimation
+    // follow the absolute sample-index, so they stay coherent over lost packages.
+    RamPipeline pl;
+    ZcSocket zc;
+    RamPkgDesc desc;
+    LiaStreamHeader hdr;
+    LiaSw saved;
+    struct iovec seg[2], iov[2];
+    struct timespec t_start;
+    pthread_t producer;
+    int ret = 0;
+
+    memset(stats, 0, sizeof(StreamStats));
+    uint32_t pkg_size = ramCfg.param.tcp_pkg_size;
+    uint32_t max_points = lia_sw_max_points(lia, (int)pkg_size) + 1;  // +1: package split at the end of the buffer
+    int32_t* iq = malloc((size_t)max_points * 2 * sizeof(int32_t));
+    float* mag_phase = malloc((size_t)max_points * 2 * sizeof(float));
+    if (iq == NULL || mag_phase == NULL) {
+        free(iq);
+        free(mag_phase);
+        return -1;
+    }
+
+    // the point-buffers are reused for the next package -> copying send()
+    memset(&zc, 0, sizeof(ZcSocket));
+    zc.sock = sock_client;
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    if (ram_pipeline_start(&pl, axi_devs, ramCfg, pkg_size, no_tcp_packages, sample_rate_divider, &producer) < 0) {
+        free(iq);
+        free(mag_phase);
+        return -1;
+    }
+
+    while (ram_pipeline_pop(&pl, &desc)) {
+        double t_cpu = thread_cpu_s();
+        int no_points = 0;
+        if (!desc.lost) {
+            int seg_cnt = ram_stream_pkg_iov(ramCfg, desc.rd_idx, pl.pkg_size, seg);
+            uint32_t done = 0;
+            memcpy(&saved, lia, offsetof(LiaSw, iq));
+            for (int i = 0; i < seg_cnt; i++) {
+                uint32_t n = (uint32_t)(seg[i].iov_len / sizeof(uint32_t));
+                no_points += lia_sw_process(lia, (const uint32_t*)seg[i].iov_base, (int)n, desc.start_total + done,
+                                            iq + 2 * no_points);
+                done += n;
+            }
+            // the RAM-Writer could have reached the package while it was read: the filters
+            // continue with the state before this package
+            if (ram_pipeline_overwritten(&pl, &desc)) {
+                memcpy(lia, &saved, offsetof(LiaSw, iq));
+                ram_pipeline_overrun(&pl);
+                no_points = 0;
+            }
+        }
+        // lost packages are sent as header without points
+        stats->codec_cpu_s += thread_cpu_s() - t_cpu;
+
+        hdr.magic = LIA_STREAM_MAGIC;
+        hdr.seq = desc.seq;
+        hdr.overruns = atomic_load(&pl.overruns);
+        hdr.no_points = (uint32_t)no_points;
+        hdr.output = (uint16_t)output;
+        hdr.reserved = 0;
+        hdr.decimation = lia->decimation;
+        hdr.first_sample = lia_sw_first_point(lia, desc.start_total);
+        iov[0].iov_base = &hdr;
+        iov[0].iov_len = sizeof(LiaStreamHeader);
+        iov[1].iov_base = iq;
+        iov[1].iov_len = (size_t)no_points * 2 * sizeof(int32_t);
+        if (output == LIA_OUT_MAG_PHASE) {
+            lia_sw_mag_phase(iq, no_points, mag_phase);
+            iov[1].iov_base = mag_phase;
+        }
+        if (zc_send_iov(&zc, iov, 2) < 0) {
+            printf("Stopped LIA-Mode after %u/%d TCP-Packages\n", desc.seq, no_tcp_packages);
+            ret = -1;
+            break;
+        }
+
+        stats->no_packages++;
+        stats->raw_bytes += sizeof(AdcStreamHeader) + ramCfg.param.tcp_pkg_size_bytes;
+        stats->bytes_sent += sizeof(LiaStreamHeader) + iov[1].iov_len;
+        metrics_stream_package(METRICS_STREAM_LIA, sizeof(LiaStreamHeader) + iov[1].iov_len);
+        TRACE_DEBUG("sent LIA-Package %u/%d (%d points, overruns: %u)", desc.seq + 1, no_tcp_packages, no_points,
+                    hdr.overruns);
+    }
+
+    ram_pipeline_stop(&pl, producer);
+    ram_pipeline_fill_stats(&pl, &zc, &t_start, stats);
+
+    spsc_ring_free(&pl.ring);
+    free(iq);
+    free(mag_phase);
+    return ret;
+}
+
+int record_adc_writer(AxiDevs axi_devs, RamConfig ramCfg, const char* path, AdcConfig adcCfg, int no_chunks,
+                      int sample_rate_divider, StreamStats* stats) {
+    // continous mode into a local recording (rp_recorder.h), same pipeline as cont_adc_writer_zc()
+    // with packages of REC_CHUNK_SAMPLES: the consumer copies a package into the aligned
+    // chunk-buffer, checks that it was not overwritten meanwhile and writes it with O_DIRECT.
+    // Lost packages are gaps in first_sample of the chunks. Returns the no. of chunks written.
+    RamPipeline pl;
+    ZcSocket zc;
+    RamPkgDesc desc;
+    RecFile rec;
+    RecChunkInfo info;
+    struct iovec seg[2];
+    struct timespec t_start;
+    pthread_t producer;
+    int ret = 0;
+
+    memset(stats, 0, sizeof(StreamStats));
+    memset(&zc, 0, sizeof(ZcSocket));
+    double sample_rate_hz = (double)ADC_SYS_CLK_HZ / (sample_rate_divider > 0 ? sample_rate_divider : 1);
+
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    if (rec_open(&rec, path, adcCfg, sample_rate_hz,
+                 (uint64_t)t_start.tv_sec * 1000000000ULL + (uint64_t)t_start.tv_nsec) < 0) {
+        return -1;
+    }
+    if (ram_pipeline_start(&pl, axi_devs, ramCfg, REC_CHUNK_SAMPLES, no_chunks, sample_rate_divider, &producer) < 0) {
+        rec_close(&rec);
+        return -1;
+    }
+
+    while (ram_pipeline_pop(&pl, &desc)) {
+        if (desc.lost) continue;
+        int seg_cnt = ram_stream_pkg_iov(ramCfg, desc.rd_idx, pl.pkg_size, seg);
+        uint8_t* dst = (uint8_t*)rec_chunk_samples(&rec);
+        for (int i = 0; i < seg_cnt; i++) {
+            memcpy(dst, seg[i].iov_base, seg[i].iov_len);
+            dst += seg[i].iov_len;
+        }
+        // the RAM-Writer could have reached the package while it was copied
+        if (ram_pipeline_overwritten(&pl, &desc)) {
+            ram_pipeline_overrun(&pl);
+            continue;
+        }
+
+        info.seq = desc.seq;
+        info.no_samples = pl.pkg_size;
+        info.overruns = atomic_load(&pl.overruns);
+        info.first_sample = desc.start_total;
+        info.t_ns = desc.t_ns;
+        if (rec_write_chunk(&rec, &info) < 0) {
+            printf("Stopped recording after %u/%d chunks\n", desc.seq, no_chunks);
+            ret = -1;
+            break;
+        }
+
+        stats->no_packages++;
+        stats->bytes_sent += REC_CHUNK_BYTES;
+        metrics_stream_package(METRICS_STREAM_RECORD, REC_CHUNK_BYTES);
+        TRACE_DEBUG("recorded chunk %u/%d (overruns: %u)", desc.seq + 1, no_chunks, info.overruns);
+    }
+
+    ram_pipeline_stop(&pl, producer);
+    ram_pipeline_fill_stats(&pl, &zc, &t_start, stats);
+    spsc_ring_free(&pl.ring);
+
+    if (rec_close(&rec) < 0) ret = -1;
+    return (ret < 0) ? -1 : (int)stats->no_packages;
+}
+
+int multi_block_adc_writer_zc(AxiDevs axi_devs, int sock_client, RamConfig ramCfg, int no_blocks, int no_regions,
+                              int sample_rate_divider, StreamStats* stats) {
+    // back-to-back blocks: the RAM-Writer runs without stopping through no_regions regions of
+    // the buffer, while one region is sent the writer already fills the next one (no re-arm gap).
+    // Blocks which are overwritten before they are sent are dropped as a whole, so the dead time
+    // between two received blocks is always (seq-difference - 1) * block-duration. Only the
+    // last block is sent anyway (no_samples = 0, ADC_BLOCK_TORN), it ends the acquisition for the client.
+    // every block: AdcBlockHeader + samples + uint32 status of the block sent ADC_STREAM_STATUS_LAG
+    // blocks before (ADC_BLOCK_TORN if the writer reached the region again while it was sent)
+    RamPipeline pl;
+    ZcSocket zc;
+    RamPkgDesc desc;
+    StreamWindow win;
+    struct iovec iov[3];
+    struct timespec t_start;
+    pthread_t producer;
+    int ret = 0;
+
+    memset(stats, 0, sizeof(StreamStats));
+    memset(&win, 0, sizeof(StreamWindow));
+    uint32_t wrap = ram_stream_wrap_samples(ramCfg);
+    if (no_regions <= 0) no_regions = ADC_BLOCK_DEFAULT_REGIONS;
+    if (no_regions < 2 || (uint32_t)no_regions > wrap) {
+        printf("Invalid no. of regions %d for Multi-Block-Mode\n", no_regions);
+        return -1;
+    }
+    uint32_t block_size = wrap / (uint32_t)no_regions;
+
+    zc_socket_init(&zc, sock_client);
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    if (ram_pipeline_start(&pl, axi_devs, ramCfg, block_size, no_blocks, sample_rate_divider, &producer) < 0) {
+        zc_socket_release(&zc);
+        return -1;
+    }
+    win.pl = &pl;
+    win.zc = &zc;
+    pl.idle = stream_window_settle;
+    pl.idle_arg = &win;
+    printf("Multi-Block-Mode: %d regions with %u samples (%.3f ms per block)\n", no_regions, block_size,
+           block_size / pl.sample_rate_hz * 1e3);
+
+    while (ram_pipeline_pop(&pl, &desc)) {
+        if (desc.lost && desc.seq + 1 < (uint32_t)no_blocks) continue;
+
+        StreamSlot* slot = stream_window_next(&win);
+        AdcBlockHeader* hdr = &slot->hdr.block;
+        slot->desc = desc;
+        hdr->magic = ADC_BLOCK_MAGIC;
+        hdr->seq = desc.seq;
+        hdr->dropped = atomic_load(&pl.overruns);
+        hdr->no_samples = desc.lost ? 0 : block_size;
+        hdr->first_sample = desc.start_total;
+        hdr->t_ns = desc.t_ns;
+
+        iov[0].iov_base = hdr;
+        iov[0].iov_len = sizeof(AdcBlockHeader);
+        int iov_cnt = 1 + (desc.lost ? 0 : ram_stream_pkg_iov(ramCfg, desc.rd_idx, block_size, &iov[1]));
+
+        // the status of this block follows ADC_STREAM_STATUS_LAG blocks later (as in Continous-Mode)
+        if (zc_send_iov(&zc, iov, iov_cnt) < 0) {
+            printf("Stopped Multi-Block-Mode after %u/%d blocks\n", desc.seq, no_blocks);
+            ret = -1;
+            break;
+        }
+        slot->zc_end = zc.next_id;
+        win.sent++;
+        if (stream_window_status(&win) < 0) {
+            printf("Stopped Multi-Block-Mode after %u/%d blocks\n", desc.seq, no_blocks);
+            ret = -1;
+            break;
+        }
+
+        uint64_t block_bytes = sizeof(AdcBlockHeader) + (uint64_t)hdr->no_samples * sizeof(int32_t) + sizeof(uint32_t);
+        stats->no_packages++;
+        stats->bytes_sent += block_bytes;
+        metrics_stream_package(METRICS_STREAM_MULTI_BLOCK, block_bytes);
+        TRACE_DEBUG("sent block %u/%d (dropped: %u)", desc.seq + 1, no_blocks, hdr->dropped);
+    }
+    // status of the last blocks
+    for (int i = 0; ret == 0 && i < ADC_STREAM_STATUS_LAG; i++) {
+        if (stream_window_status(&win) < 0) ret = -1;
+        stats->bytes_sent += sizeof(uint32_t);
+    }
+
+    ram_pipeline_stop(&pl, producer);
+    zc_socket_release(&zc);
+    ram_pipeline_fill_stats(&pl, &zc, &t_start, stats);
+
+    spsc_ring_free(&pl.ring);
+    return ret;
+}
+
+void print_stream_stats(const char* name, StreamStats* stats) {
+    printf("### %s: %u TCP-Packages, %llu Bytes in %.3f s => %.2f MB/s ###\n", name, stats->no_packages,
+           (unsigned long long)stats->bytes_sent, stats->duration_s, stats->mbytes_per_s);
+    printf("    zero-copy: %s, %llu sends, %llu copied by kernel\n", stats->zerocopy_used ? "on" : "off",
+           (unsigned long long)stats->zerocopy_sends, (unsigned long long)stats->zerocopy_copied);
+    if (stats->compressed && stats->bytes_sent > 0) {
+        uint64_t no_samples = (stats->raw_bytes - stats->no_packages * sizeof(AdcStreamHeader)) / sizeof(uint32_t);
+        printf("    compression: %.2f (%llu -> %llu Bytes), codec-cpu %.3f s = %.1f%% of the run, %.1f ns/sample\n",
+               (double)stats->raw_bytes / stats->bytes_sent, (unsigned long long)stats->raw_bytes,
+               (unsigned long long)stats->bytes_sent, stats->codec_cpu_s,
+               (stats->duration_s > 0) ? 100.0 * stats->codec_cpu_s / stats->duration_s : 0.0,
+               (no_samples > 0) ? stats->codec_cpu_s * 1e9 / no_samples : 0.0);
+    }
+}
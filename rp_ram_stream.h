@@ -0,0 +1,91 @@
+/*
+ * rp_ram_stream.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Streaming of the RAM-Writer-Buffer (CMA-Region) to the TCP-Client:
+ *
+ *     -- zero-copy send-path (MSG_ZEROCOPY) which hands the mmapped pages of the
+ *        CMA-Region directly to the socket, with tracking of the send-completions
+ *        so a region is not reused by the next send before the kernel is done with it
+ *
+ *     -- falls back to a normal send() if the kernel does not support zero-copy
+ *        for the CMA-mapping (or for the socket)
+ *
+ *     -- continous-mode runs as two-stage pipeline (pos-poller -> SPSC-ring -> sender),
+ *        every package starts with an AdcStreamHeader carrying seq-no. and overrun-counter
+ *        and ends with a status-word (ADC_BLOCK_TORN: overwritten while it was sent) of the
+ *        package ADC_STREAM_STATUS_LAG before, so that many packages can be in flight
+ *
+ *     -- optional compressed continous-mode (rp_adc_codec.h): packages are encoded by the
+ *        consumer and sent with AdcStreamZHeader (copying send(), the payload is reused)
+ *
+ *     -- multi-block-mode splits the buffer into N regions (ping-pong for N = 2), the
+ *        RAM-Writer keeps running while finished regions are sent as blocks with
+ *        AdcBlockHeader (seq-no., first sample-index, timestamp) and a status-word
+ *
+ *     -- software-LIA (rp_lia_sw.h): packages are mixed, filtered and decimated by the consumer,
+ *        only the points are sent with LiaStreamHeader
+ *
+ *     -- local recording: packages are written as chunks to a file on the board (rp_recorder.h)
+ *
+ *     -- statistics for every run (bytes, packages, sustained MB/s, overruns), bytes/packages
+ *        and overruns are also counted in the metrics of the server (rp_metrics.h)
+ */
+
+#ifndef SRC_RP_RAM_STREAM_H
+#define SRC_RP_RAM_STREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include "rp_lia_sw.h"
+#include "rp_structs.h"
+
+// statistics of one streaming-run
+typedef struct {
+    uint64_t bytes_sent;        // sent to the client (written to the file for recordings)
+    uint32_t no_packages;
+    double duration_s;
+    double mbytes_per_s;       // sustained rate over the whole run
+    uint64_t zerocopy_sends;   // sends which used MSG_ZEROCOPY
+    uint64_t zerocopy_copied;  // completions where the kernel had to copy anyway
+    bool zerocopy_used;        // false if the run fell back to copying send()
+    uint32_t overruns;         // packages lost because the RAM-Writer overwrote them
+    bool compressed;           // packages sent with ADC_STREAM_COMPRESSED
+    uint64_t raw_bytes;        // size of the packages before compression
+    double codec_cpu_s;        // cpu-time of splitting + encoding or of the software-LIA (consumer-thread)
+} StreamStats;
+
+// socket with state for MSG_ZEROCOPY-completion tracking
+typedef struct {
+    int sock;
+    bool enabled;            // SO_ZEROCOPY is active on the socket
+    uint32_t next_id;        // id of the next zero-copy send (counted by the kernel)
+    uint32_t completed_id;   // all sends with id < completed_id are completed
+    uint64_t no_copied;      // completions reported as copied by the kernel
+} ZcSocket;
+
+void zc_socket_init(ZcSocket* zc, int sock);
+int zc_send_iov(ZcSocket* zc, struct iovec* iov, int iov_cnt);
+int zc_wait_completions(ZcSocket* zc, uint32_t max_inflight);
+void zc_socket_release(ZcSocket* zc);
+
+uint32_t ram_stream_wrap_samples(RamConfig ramCfg);
+uint32_t ram_stream_get_pos(RamConfig ramCfg);
+int ram_stream_pkg_iov(RamConfig ramCfg, uint32_t rd_idx, uint32_t no_samples, struct iovec* iov);
+
+int cont_adc_writer_zc(AxiDevs axi_devs, int sock_client, RamConfig ramCfg, int no_tcp_packages,
+                       int sample_rate_divider, StreamStats* stats);
+int cont_adc_writer_compressed(AxiDevs axi_devs, int sock_client, RamConfig ramCfg, int no_tcp_packages,
+                               int sample_rate_divider, StreamStats* stats);
+int multi_block_adc_writer_zc(AxiDevs axi_devs, int sock_client, RamConfig ramCfg, int no_blocks, int no_regions,
+                              int sample_rate_divider, StreamStats* stats);
+int lia_adc_writer(AxiDevs axi_devs, int sock_client, RamConfig ramCfg, LiaSw* lia, int output, int no_tcp_packages,
+                   int sample_rate_divider, StreamStats* stats);
+int record_adc_writer(AxiDevs axi_devs, RamConfig ramCfg, const char* path, AdcConfig adcCfg, int no_chunks,
+                      int sample_rate_divider, StreamStats* stats);
+void print_stream_stats(const char* name, StreamStats* stats);
+
+#endif
@@ -0,0 +1,491 @@
+/*
+ * rp_reactor.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    epoll-based command-loop which replaces the blocking
+ *    wait_for_client_connect()/wait_for_new_command()-loop of the app-server.
+ *
+ *    The reactor-thread never waits for a single client: commands, batch-frames and
+ *    payloads are collected from the readable bytes, events are waited for with epoll.
+ */
+
+#include "rp_reactor.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "rp_bram_upload.h"
+#include "rp_metrics.h"
+#include "rp_tcp.h"
+
+// tags to separate the server-socket, the worker-eventfd and the waited event from the client-slots
+#define REACTOR_TAG_SERVER -1
+#define REACTOR_TAG_WORKER -2
+#define REACTOR_TAG_EVENT -3
+
+static int epoll_add(int epoll_fd, int fd, int tag) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t)tag;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+static void reset_payload(ClientConn* client) {
+    client->payload_len = 0;
+    client->payload_expected = 0;
+    client->payload_ready = false;
+    client->payload_failed = false;
+}
+
+static void close_client(Reactor* reactor, ClientConn* client) {
+    if (!client->busy && !client->waiting) {
+        epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, client->sock, NULL);
+    }
+    close(client->sock);
+    client->sock = -1;
+    client->rx_len = 0;
+    client->busy = false;
+    client->waiting = false;
+    reset_payload(client);
+    free(client->payload);
+    client->payload = NULL;
+    client->payload_cap = 0;
+}
+
+static void accept_client(Reactor* reactor) {
+    int sock_client = accept(reactor->sock_server, NULL, NULL);
+    if (sock_client < 0) {
+        printf("Accepting client failed: %s\n", strerror(errno));
+        return;
+    }
+
+    for (int i = 0; i < REACTOR_MAX_CLIENTS; i++) {
+        ClientConn* client = &reactor->clients[i];
+        if (client->sock >= 0) continue;
+
+        client->sock = sock_client;
+        client->rx_len = 0;
+        client->busy = false;
+        client->waiting = false;
+        reset_payload(client);
+        if (epoll_add(reactor->epoll_fd, sock_client, i) < 0) {
+            printf("Adding client to epoll failed: %s\n", strerror(errno));
+            close(sock_client);
+            client->sock = -1;
+            return;
+        }
+        printf("Client %d connected to Socket...\n", i);
+        return;
+    }
+
+    printf("Max. no. of clients (%d) reached, closing new connection\n", REACTOR_MAX_CLIENTS);
+    close(sock_client);
+}
+
+static CmdResult dispatch(Reactor* reactor, ClientConn* client, TcpCmd command) {
+    // calls the handler, the service-time is recorded per command-ID (also inside batches/sequences)
+    pthread_mutex_lock(&reactor->handler_lock);
+    uint64_t t_start = metrics_now_ns();
+    CmdResult result = reactor->handler(reactor->ctx, client, command);
+    metrics_observe_cmd(command.id, metrics_now_ns() - t_start);
+    pthread_mutex_unlock(&reactor->handler_lock);
+    return result;
+}
+
+static size_t expected_msg_len(ClientConn* client) {
+    // length of the message currently received: TcpCmd or batch-frame
+    // (a frame has at least one command, so it is never shorter than a TcpCmd)
+    uint32_t magic;
+    BatchFrameHeader hdr;
+
+    if (client->rx_len < sizeof(magic)) return sizeof(TcpCmd);
+    memcpy(&magic, client->rx_buf, sizeof(magic));
+    if (magic != BATCH_FRAME_MAGIC) return sizeof(TcpCmd);
+
+    if (client->rx_len < sizeof(BatchFrameHeader)) return sizeof(TcpCmd);
+    memcpy(&hdr, client->rx_buf, sizeof(BatchFrameHeader));
+    if (hdr.no_cmds == 0 || hdr.no_cmds > MAX_BATCH_CMDS) return 0;  // invalid frame
+    return sizeof(BatchFrameHeader) + hdr.no_cmds * sizeof(BatchCmd);
+}
+
+static CmdResult handle_batch_frame(Reactor* reactor, ClientConn* client) {
+    // execute all commands of the frame in order and send one response-frame
+    BatchFrameHeader hdr;
+    BatchCmd batch_cmd;
+    TcpCmd command;
+    CmdResult result = CMD_KEEP_CONNECTION;
+
+    memcpy(&hdr, client->rx_buf, sizeof(BatchFrameHeader));
+    client->in_batch = true;
+
+    for (int i = 0; i < hdr.no_cmds; i++) {
+        BatchResp* resp = &client->tx_resp[i];
+        memcpy(&batch_cmd, client->rx_buf + sizeof(BatchFrameHeader) + i * sizeof(BatchCmd), sizeof(BatchCmd));
+        resp->seq = batch_cmd.seq;
+        resp->status = BATCH_STATUS_OK;
+        resp->value = 0;
+        resp->reserved = 0;
+
+        if (hdr.version != BATCH_PROTOCOL_VERSION) {
+            resp->status = BATCH_STATUS_BAD_VERSION;
+            continue;
+        }
+        if (result != CMD_KEEP_CONNECTION) {
+            // connection gets closed by an earlier command of this frame
+            resp->status = BATCH_STATUS_SKIPPED;
+            continue;
+        }
+
+        command.id = batch_cmd.id;
+        command.val = batch_cmd.val;
+        command.ch = batch_cmd.ch;
+        client->cur_resp = resp;
+        result = dispatch(reactor, client, command);
+    }
+    client->in_batch = false;
+    client->cur_resp = NULL;
+
+    hdr.magic = BATCH_FRAME_MAGIC;
+    hdr.version = BATCH_PROTOCOL_VERSION;
+    if (send_all(client->sock, &hdr, sizeof(hdr)) != 0 ||
+        send_all(client->sock, client->tx_resp, hdr.no_cmds * sizeof(BatchResp)) != 0) {
+        printf("Sending batch-response failed: %s\n", strerror(errno));
+        return (result == CMD_SHUTDOWN_SERVER) ? result : CMD_CLOSE_CONNECTION;
+    }
+    return result;
+}
+
+static CmdResult dispatch_payload(Reactor* reactor, ClientConn* client, TcpCmd command) {
+    // calls the handler, a payload requested with reactor_payload() is received afterwards
+    CmdResult result = dispatch(reactor, client, command);
+
+    if (client->payload_failed) return CMD_CLOSE_CONNECTION;
+    if (client->payload_expected > client->payload_len) {
+        client->payload_cmd = command;
+        client->payload_ready = false;
+    } else {
+        reset_payload(client);
+    }
+    return result;
+}
+
+static CmdResult read_payload(Reactor* reactor, ClientConn* client) {
+    // bytes of the requested payload, the handler is called again when it is complete
+    ssize_t n = recv(client->sock, client->payload + client->payload_len,
+                     client->payload_expected - client->payload_len, 0);
+
+    if (n <= 0) {
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) return CMD_KEEP_CONNECTION;
+        return CMD_CLOSE_CONNECTION;
+    }
+    client->payload_len += (size_t)n;
+    if (client->payload_len < client->payload_expected) return CMD_KEEP_CONNECTION;
+
+    client->payload_ready = true;
+    return dispatch_payload(reactor, client, client->payload_cmd);
+}
+
+static CmdResult read_client(Reactor* reactor, ClientConn* client) {
+    // read only the missing bytes of the current message, data following a command
+    // is requested by the handler (reactor_payload())
+    if (client->payload_expected > 0) return read_payload(reactor, client);
+
+    size_t expected = expected_msg_len(client);
+    if (expected == 0) {
+        printf("Received invalid batch-frame\n");
+        return CMD_CLOSE_CONNECTION;
+    }
+
+    ssize_t n = recv(client->sock, client->rx_buf + client->rx_len, expected - client->rx_len, 0);
+
+    if (n <= 0) {
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) return CMD_KEEP_CONNECTION;
+        // client closed the connection (or invalid data) -> same as CLIENT_DISCONNECT
+        return CMD_CLOSE_CONNECTION;
+    }
+    client->rx_len += (size_t)n;
+
+    // header of a batch-frame completed -> frame is longer than the TcpCmd
+    expected = expected_msg_len(client);
+    if (expected == 0) {
+        printf("Received invalid batch-frame\n");
+        return CMD_CLOSE_CONNECTION;
+    }
+    if (client->rx_len < expected) return CMD_KEEP_CONNECTION;
+    client->rx_len = 0;
+
+    uint32_t magic;
+    memcpy(&magic, client->rx_buf, sizeof(magic));
+    if (magic == BATCH_FRAME_MAGIC) {
+        return handle_batch_frame(reactor, client);
+    }
+
+    // compatibility: single TcpCmd, replies are sent directly
+    TcpCmd command;
+    memcpy(&command, client->rx_buf, sizeof(TcpCmd));
+    return dispatch_payload(reactor, client, command);
+}
+
+int reactor_reply(ClientConn* client, int value) {
+    // reply of a command: stored in response-frame for batches, else sent directly
+    if (client->in_batch) {
+        client->cur_resp->value = value;
+        return 0;
+    }
+    return send_to_client(client->sock, value);
+}
+
+void reactor_set_status(ClientConn* client, int status) {
+    // only used in batch-mode, single commands have no status
+    if (client->in_batch) client->cur_resp->status = status;
+}
+
+const void* reactor_payload(ClientConn* client, size_t offset, size_t len) {
+    // payload[offset, offset + len) of the current command, NULL if it is not received yet:
+    // the first request sends ACK, the handler has to return CMD_KEEP_CONNECTION and is called
+    // again with the same command when the payload is complete (the calls before have to be
+    // repeated, the returned pointers are only valid till the next request)
+    size_t end = offset + len;
+
+    if (client->payload_ready && end <= client->payload_len) return client->payload + offset;
+    if (client->in_batch) {
+        // the commands of a batch-frame (or a sequence) have no payload
+        reactor_set_status(client, BATCH_STATUS_NOT_ALLOWED);
+        return NULL;
+    }
+    if (end > REACTOR_MAX_PAYLOAD) {
+        // lengths are checked by the handler
+        printf("Payload of %zu bytes can't be received\n", end);
+        client->payload_failed = true;
+        return NULL;
+    }
+    if (end > client->payload_cap) {
+        char* payload = realloc(client->payload, end);
+        if (payload == NULL) {
+            printf("Allocating payload-buffer of %zu bytes failed\n", end);
+            client->payload_failed = true;
+            return NULL;
+        }
+        client->payload = payload;
+        client->payload_cap = end;
+    }
+    if (client->payload_expected == 0 && !client->payload_ready) send_to_client(client->sock, ACK);
+    client->payload_expected = end;
+    return NULL;
+}
+
+bool reactor_wait_event(Reactor* reactor, ClientConn* client, TcpCmd command, int fd, int timeout_ms,
+                        EventHandler on_event) {
+    // on_event is called when fd gets readable (has to consume the event) or after timeout_ms,
+    // returns false if another command is waiting already
+    if (reactor->event_client != NULL || client->in_batch) return false;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t)REACTOR_TAG_EVENT;
+    if (epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        printf("Adding event to epoll failed: %s\n", strerror(errno));
+        return false;
+    }
+    // commands of this client are handled after the event (the order is kept)
+    epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, client->sock, NULL);
+    client->waiting = true;
+
+    reactor->event_client = client;
+    reactor->event_cmd = command;
+    reactor->event_fd = fd;
+    reactor->event_deadline_ns = metrics_now_ns() + (uint64_t)timeout_ms * 1000000ULL;
+    reactor->on_event = on_event;
+    return true;
+}
+
+static CmdResult complete_event(Reactor* reactor, bool timeout) {
+    // hands the client back to epoll and completes the waiting command
+    ClientConn* client = reactor->event_client;
+    int tag = (int)(client - reactor->clients);
+
+    epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, reactor->event_fd, NULL);
+    reactor->event_client = NULL;
+    client->waiting = false;
+    if (epoll_add(reactor->epoll_fd, client->sock, tag) < 0) {
+        printf("Re-adding client %d to epoll failed: %s\n", tag, strerror(errno));
+        return CMD_CLOSE_CONNECTION;
+    }
+
+    pthread_mutex_lock(&reactor->handler_lock);
+    uint64_t t_start = metrics_now_ns();
+    CmdResult result = reactor->on_event(reactor->ctx, client, reactor->event_cmd, timeout);
+    metrics_observe_cmd(reactor->event_cmd.id, metrics_now_ns() - t_start);
+    pthread_mutex_unlock(&reactor->handler_lock);
+    return result;
+}
+
+static int event_timeout_ms(Reactor* reactor) {
+    // timeout of epoll_wait(): -1 without waiting command
+    if (reactor->event_client == NULL) return -1;
+    uint64_t now = metrics_now_ns();
+    if (now >= reactor->event_deadline_ns) return 0;
+    return (int)((reactor->event_deadline_ns - now + 999999) / 1000000);
+}
+
+CmdResult reactor_exec_captured(Reactor* reactor, ClientConn* client, TcpCmd command, BatchResp* resp) {
+    // executes command like inside a batch-frame: the reply is stored in resp instead of sent
+    // (used for command-sequences on the worker-thread, the client-socket is owned by the job,
+    // must not be called from inside the handler)
+    bool in_batch = client->in_batch;
+    BatchResp* cur_resp = client->cur_resp;
+
+    resp->status = BATCH_STATUS_OK;
+    resp->value = 0;
+    client->in_batch = true;
+    client->cur_resp = resp;
+    CmdResult result = dispatch(reactor, client, command);
+    client->in_batch = in_batch;
+    client->cur_resp = cur_resp;
+    return result;
+}
+
+static void release_finished_job(Reactor* reactor) {
+    // hand back the client-socket which was owned by the finished job
+    WorkerJob job;
+    if (!worker_collect(&reactor->worker, &job)) return;
+    if (job.done != NULL) job.done(job.arg);
+
+    for (int i = 0; i < REACTOR_MAX_CLIENTS; i++) {
+        ClientConn* client = &reactor->clients[i];
+        if (client->sock != job.owner_fd || !client->busy) continue;
+
+        client->busy = false;
+        if (epoll_add(reactor->epoll_fd, client->sock, i) < 0) {
+            printf("Re-adding client %d to epoll failed: %s\n", i, strerror(errno));
+            close_client(reactor, client);
+        }
+        return;
+    }
+}
+
+int reactor_init(Reactor* reactor, int sock_server, CmdHandler handler, void* ctx) {
+    memset(reactor, 0, sizeof(Reactor));
+    reactor->sock_server = sock_server;
+    reactor->handler = handler;
+    reactor->ctx = ctx;
+    pthread_mutex_init(&reactor->handler_lock, NULL);
+    for (int i = 0; i < REACTOR_MAX_CLIENTS; i++) {
+        reactor->clients[i].sock = -1;
+    }
+
+    reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor->epoll_fd < 0) {
+        printf("Creating epoll instance failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (worker_init(&reactor->worker) < 0) {
+        close(reactor->epoll_fd);
+        return -1;
+    }
+
+    if (epoll_add(reactor->epoll_fd, sock_server, REACTOR_TAG_SERVER) < 0 ||
+        epoll_add(reactor->epoll_fd, worker_event_fd(&reactor->worker), REACTOR_TAG_WORKER) < 0) {
+        printf("Adding server-socket to epoll failed: %s\n", strerror(errno));
+        worker_shutdown(&reactor->worker);
+        close(reactor->epoll_fd);
+        return -1;
+    }
+    return 0;
+}
+
+static bool handle_result(Reactor* reactor, ClientConn* client, CmdResult result) {
+    // returns true if the server has to be shutdown
+    switch (result) {
+        case CMD_KEEP_CONNECTION:
+            break;
+        case CMD_CLOSE_CONNECTION:
+            printf("Client %d disconnected...\n", (int)(client - reactor->clients));
+            close_client(reactor, client);
+            break;
+        case CMD_SHUTDOWN_SERVER:
+            return true;
+    }
+    return false;
+}
+
+int reactor_run(Reactor* reactor, volatile sig_atomic_t* interrupted) {
+    // returns 1 if the server got shutdown by a client (EXIT_APP), 0 on user-interrupt
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+
+    while (!(*interrupted)) {
+        int no_events = epoll_wait(reactor->epoll_fd, events, REACTOR_MAX_EVENTS, event_timeout_ms(reactor));
+        if (no_events < 0) {
+            if (errno == EINTR) continue;
+            printf("epoll_wait failed: %s\n", strerror(errno));
+            return -1;
+        }
+        if (no_events == 0 && reactor->event_client != NULL && metrics_now_ns() >= reactor->event_deadline_ns) {
+            // no event within the timeout of the waiting command
+            ClientConn* client = reactor->event_client;
+            if (handle_result(reactor, client, complete_event(reactor, true))) return 1;
+            continue;
+        }
+
+        for (int i = 0; i < no_events; i++) {
+            int tag = (int)events[i].data.u32;
+            ClientConn* client;
+            CmdResult result;
+
+            if (tag == REACTOR_TAG_SERVER) {
+                accept_client(reactor);
+                continue;
+            }
+            if (tag == REACTOR_TAG_WORKER) {
+                release_finished_job(reactor);
+                continue;
+            }
+            if (tag == REACTOR_TAG_EVENT) {
+                if (reactor->event_client == NULL) continue;
+                client = reactor->event_client;
+                result = complete_event(reactor, false);
+            } else {
+                client = &reactor->clients[tag];
+                // client could be closed, handed to the worker or waiting by an earlier event of this round
+                if (client->sock < 0 || client->busy || client->waiting) continue;
+                result = read_client(reactor, client);
+            }
+            if (handle_result(reactor, client, result)) return 1;
+        }
+    }
+    return 0;
+}
+
+bool reactor_start_job(Reactor* reactor, ClientConn* client, WorkerJobFn job, WorkerDoneFn done, void* arg) {
+    // the socket of the client is removed from epoll while the job is sending data on it
+    WorkerJob worker_job = {job, done, arg, client->sock};
+    if (!worker_submit(&reactor->worker, worker_job)) {
+        return false;
+    }
+    client->busy = true;
+    epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, client->sock, NULL);
+    return true;
+}
+
+void reactor_close(Reactor* reactor) {
+    worker_shutdown(&reactor->worker);
+    for (int i = 0; i < REACTOR_MAX_CLIENTS; i++) {
+        if (reactor->clients[i].sock >= 0) {
+            close(reactor->clients[i].sock);
+            reactor->clients[i].sock = -1;
+        }
+        free(reactor->clients[i].payload);
+        reactor->clients[i].payload = NULL;
+    }
+    close(reactor->epoll_fd);
+    pthread_mutex_destroy(&reactor->handler_lock);
+}
@@ -0,0 +1,121 @@
+/*
+ * rp_reactor.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    epoll-based command-loop for the app-server:
+ *
+ *     -- serves multiple clients at once (e.g. tuning-script + monitoring-dashboard)
+ *
+ *     -- each client has its own receive-buffer for the TcpCmd-struct,
+ *        partial commands are kept until the rest of the struct arrives
+ *
+ *     -- besides single TcpCmds a client can send batch-frames (BATCH_FRAME_MAGIC) with
+ *        up to MAX_BATCH_CMDS commands, the replies of all commands are sent back in one
+ *        response-frame. Handlers reply with reactor_reply(), which works for both.
+ *        Command-sequences execute their commands the same way (reactor_exec_captured),
+ *        on the worker-thread: handler-calls are serialized by handler_lock, so the handler
+ *        never runs on both threads at once
+ *
+ *     -- data following a command (config-structs, uploads, programs) is received by the
+ *        reactor as well: the handler requests it with reactor_payload() (ACK is sent) and is
+ *        called again with the same command when it is complete, so a slow client never
+ *        blocks the others inside recv()
+ *
+ *     -- commands which wait for an event (trigger-armed) are completed by the event:
+ *        reactor_wait_event() adds the fd to the epoll-set with a timeout, the client sends
+ *        no new commands till the EventHandler was called
+ *
+ *     -- long running jobs (ADC-RAM-TCP-Writer..) are executed on the worker-thread,
+ *        the client-socket is owned by the job till it is finished (WorkerDoneFn is called
+ *        on the reactor-thread when the job was collected)
+ *
+ *     -- the service-time of every command is recorded per command-ID (rp_metrics.h)
+ *
+ *    The commands itself are handled by the CmdHandler-callback, so the reactor does not
+ *    depend on the FPGA-Modules and can be used over loopback with a mocked AxiDevs.
+ */
+
+#ifndef SRC_RP_REACTOR_H
+#define SRC_RP_REACTOR_H
+
+#include <pthread.h>
+#include <signal.h>  //sig_atomic_t
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "rp_constants.h"
+#include "rp_structs.h"
+#include "rp_worker.h"
+
+#define REACTOR_MAX_CLIENTS 16
+#define REACTOR_MAX_EVENTS (REACTOR_MAX_CLIENTS + 3)
+// biggest message from client: batch-frame with MAX_BATCH_CMDS commands
+#define REACTOR_RX_BUF_SIZE (sizeof(BatchFrameHeader) + MAX_BATCH_CMDS * sizeof(BatchCmd))
+
+// connection of one client
+typedef struct {
+    int sock;                          // client-socket, -1 if slot is not used
+    char rx_buf[REACTOR_RX_BUF_SIZE];  // receive-buffer for (partial) commands or batch-frames
+    size_t rx_len;                     // no. of bytes currently stored in rx_buf
+    bool busy;                         // socket is owned by a job on the worker-thread
+    bool waiting;                      // command waits for an event (reactor_wait_event)
+
+    // payload of the current command (data after the ACK, see reactor_payload())
+    TcpCmd payload_cmd;
+    char* payload;
+    size_t payload_len;                // received bytes
+    size_t payload_expected;           // bytes requested by the handler, 0: no payload pending
+    size_t payload_cap;
+    bool payload_ready;                // handler is called with the received payload
+    bool payload_failed;               // buffer could not be allocated -> connection is closed
+
+    // while a batch-frame is handled, replies of the commands are stored in the response-frame
+    bool in_batch;
+    BatchResp* cur_resp;               // response-slot of the command currently handled
+    BatchResp tx_resp[MAX_BATCH_CMDS];
+} ClientConn;
+
+// return values of the command-handler
+typedef enum {
+    CMD_KEEP_CONNECTION,   // command handled, wait for next command
+    CMD_CLOSE_CONNECTION,  // close client-socket (TERMINATE_CLIENT...)
+    CMD_SHUTDOWN_SERVER    // close all sockets and leave reactor_run (EXIT_APP)
+} CmdResult;
+
+typedef CmdResult (*CmdHandler)(void* ctx, ClientConn* client, TcpCmd command);
+// completes a command started with reactor_wait_event(): fd got readable or timeout
+typedef CmdResult (*EventHandler)(void* ctx, ClientConn* client, TcpCmd command, bool timeout);
+
+// biggest payload of a command (the handler checks the lengths of its payload)
+#define REACTOR_MAX_PAYLOAD (1 << 20)
+
+typedef struct {
+    int sock_server;
+    int epoll_fd;
+    ClientConn clients[REACTOR_MAX_CLIENTS];
+    Worker worker;
+    CmdHandler handler;
+    void* ctx;  // handed to every call of handler (server-state)
+    pthread_mutex_t handler_lock;  // held during every call of handler/on_event
+
+    // command waiting for an event (only one at a time)
+    ClientConn* event_client;  // NULL: no wait
+    TcpCmd event_cmd;
+    int event_fd;
+    uint64_t event_deadline_ns;
+    EventHandler on_event;
+} Reactor;
+
+int reactor_init(Reactor* reactor, int sock_server, CmdHandler handler, void* ctx);
+int reactor_run(Reactor* reactor, volatile sig_atomic_t* interrupted);
+int reactor_reply(ClientConn* client, int value);
+void reactor_set_status(ClientConn* client, int status);
+const void* reactor_payload(ClientConn* client, size_t offset, size_t len);
+bool reactor_wait_event(Reactor* reactor, ClientConn* client, TcpCmd command, int fd, int timeout_ms,
+                        EventHandler on_event);
+CmdResult reactor_exec_captured(Reactor* reactor, ClientConn* client, TcpCmd command, BatchResp* resp);
+bool reactor_start_job(Reactor* reactor, ClientConn* client, WorkerJobFn job, WorkerDoneFn done, void* arg);
+void reactor_close(Reactor* reactor);
+
+#endif
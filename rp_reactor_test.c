@@ -0,0 +1,318 @@
+/*
+ * rp_reactor_test.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Test of the command-loop (rp_reactor.c) over loopback with a mocked command-handler,
+ *    no FPGA-Modules are needed. Checks that one slow client never blocks the others:
+ *
+ *     -- a payload which arrives in pieces (client waits between the sends)
+ *     -- a command waiting for an event (completed by the event and by the timeout)
+ *     -- two jobs on the worker-thread, the owner of the first job is re-armed before
+ *        the next one is submitted (owner-socket is part of the job)
+ *     -- batch-frame with the replies of all commands
+ *
+ *    usage: ./reactor_test   (exit-code != 0 if a check failed)
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rp_bram_upload.h"
+#include "rp_reactor.h"
+
+// commands of the mocked handler
+#define MOCK_ECHO 1        // reply: ch
+#define MOCK_PAYLOAD 2     // ch bytes follow after the ACK, reply: sum of the bytes
+#define MOCK_WAIT_EVENT 3  // reply after the event (1) or the timeout (0)
+#define MOCK_JOB 4         // job sleeps val ms on the worker, the done-callback replies ch
+#define MOCK_EXIT 5
+
+#define MOCK_EVENT_TIMEOUT_MS 300
+#define MOCK_JOB_MS 100
+#define RECV_TIMEOUT_MS 2000
+
+typedef struct {
+    Reactor reactor;
+    int event_fd;
+    int job_ms;
+    int job_reply;
+    int job_sock;
+} MockServer;
+
+static int no_failed = 0;
+
+static void check(bool ok, const char* name) {
+    printf("    %-58s %s\n", name, ok ? "ok" : "FAILED");
+    if (!ok) no_failed++;
+}
+
+static double now_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e3 + t.tv_nsec * 1e-6;
+}
+
+static void mock_job(void* arg) {
+    MockServer* m = (MockServer*)arg;
+    usleep((useconds_t)m->job_ms * 1000);
+}
+
+static void mock_job_done(void* arg) {
+    MockServer* m = (MockServer*)arg;
+    send_all(m->job_sock, &m->job_reply, sizeof(m->job_reply));
+}
+
+static CmdResult mock_event(void* ctx, ClientConn* client, TcpCmd command, bool timeout) {
+    MockServer* m = (MockServer*)ctx;
+    uint64_t cnt;
+    (void)command;
+    if (!timeout && read(m->event_fd, &cnt, sizeof(cnt)) < 0) printf("Reading mock-event failed\n");
+    reactor_reply(client, timeout ? 0 : 1);
+    return CMD_KEEP_CONNECTION;
+}
+
+static CmdResult mock_handler(void* ctx, ClientConn* client, TcpCmd command) {
+    MockServer* m = (MockServer*)ctx;
+
+    switch (command.id) {
+        case MOCK_ECHO:
+            reactor_reply(client, command.ch);
+            break;
+        case MOCK_PAYLOAD: {
+            const uint8_t* payload = reactor_payload(client, 0, (size_t)command.ch);
+            if (payload == NULL) break;
+            int sum = 0;
+            for (int i = 0; i < command.ch; i++) sum += payload[i];
+            reactor_reply(client, sum);
+            break;
+        }
+        case MOCK_WAIT_EVENT:
+            if (!reactor_wait_event(&m->reactor, client, command, m->event_fd, MOCK_EVENT_TIMEOUT_MS, mock_event)) {
+                reactor_reply(client, -1);
+            }
+            break;
+        case MOCK_JOB:
+            // the arguments of a running job must not be changed (like start_job() of the app-server)
+            if (worker_is_busy(&m->reactor.worker)) {
+                reactor_reply(client, -1);
+                break;
+            }
+            m->job_ms = (int)command.val;
+            m->job_reply = command.ch;
+            m->job_sock = client->sock;
+            if (!reactor_start_job(&m->reactor, client, mock_job, mock_job_done, m)) reactor_reply(client, -1);
+            break;
+        case MOCK_EXIT:
+            return CMD_SHUTDOWN_SERVER;
+        default:
+            reactor_reply(client, -1);
+            break;
+    }
+    return CMD_KEEP_CONNECTION;
+}
+
+static void* reactor_thread(void* arg) {
+    static volatile sig_atomic_t never = 0;
+    MockServer* m = (MockServer*)arg;
+    reactor_run(&m->reactor, &never);
+    return NULL;
+}
+
+static int connect_client(int port) {
+    struct sockaddr_in addr;
+    struct timeval tv = {RECV_TIMEOUT_MS / 1000, (RECV_TIMEOUT_MS % 1000) * 1000};
+    int one = 1;
+
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (sock < 0 || connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        printf("Connecting to mock-server failed: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return sock;
+}
+
+static void send_cmd(int sock, int id, int ch, double val) {
+    TcpCmd cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.id = id;
+    cmd.ch = ch;
+    cmd.val = val;
+    send_all(sock, &cmd, sizeof(cmd));
+}
+
+static int recv_int(int sock) {
+    // -1000 if nothing was received within RECV_TIMEOUT_MS
+    int value;
+    return (recv_all(sock, &value, sizeof(value)) == 0) ? value : -1000;
+}
+
+static void test_payload(int port) {
+    // client a sends its payload in two pieces, client b is served in between
+    uint8_t payload[1000];
+    int sum = 0;
+    for (int i = 0; i < (int)sizeof(payload); i++) sum += payload[i] = (uint8_t)(i * 7);
+
+    int a = connect_client(port);
+    int b = connect_client(port);
+    send_cmd(a, MOCK_PAYLOAD, sizeof(payload), 0);
+    check(recv_int(a) == ACK, "payload: ACK before the payload");
+    send_all(a, payload, 400);
+
+    double t_start = now_ms();
+    send_cmd(b, MOCK_ECHO, 42, 0);
+    check(recv_int(b) == 42 && now_ms() - t_start < 100, "payload: other client served during the payload");
+
+    send_all(a, payload + 400, sizeof(payload) - 400);
+    check(recv_int(a) == sum, "payload: handler called with the complete payload");
+    send_cmd(a, MOCK_ECHO, 7, 0);
+    check(recv_int(a) == 7, "payload: next command after the payload");
+    close(a);
+    close(b);
+}
+
+static void test_event(MockServer* m, int port) {
+    // client a waits for the event, client b is served meanwhile, a sends the next command early
+    uint64_t one = 1;
+    int a = connect_client(port);
+    int b = connect_client(port);
+
+    send_cmd(a, MOCK_WAIT_EVENT, 0, 0);
+    send_cmd(a, MOCK_ECHO, 5, 0);  // handled after the event (order is kept)
+    usleep(20000);
+    double t_start = now_ms();
+    send_cmd(b, MOCK_ECHO, 43, 0);
+    check(recv_int(b) == 43 && now_ms() - t_start < 100, "event: other client served while waiting");
+    send_cmd(b, MOCK_WAIT_EVENT, 0, 0);
+    check(recv_int(b) == -1, "event: second wait is rejected");
+
+    if (write(m->event_fd, &one, sizeof(one)) < 0) printf("Writing mock-event failed\n");
+    check(recv_int(a) == 1, "event: command completed by the event");
+    check(recv_int(a) == 5, "event: next command handled after the event");
+
+    t_start = now_ms();
+    send_cmd(a, MOCK_WAIT_EVENT, 0, 0);
+    int reply = recv_int(a);
+    double t_wait = now_ms() - t_start;
+    check(reply == 0 && t_wait >= MOCK_EVENT_TIMEOUT_MS - 5 && t_wait < MOCK_EVENT_TIMEOUT_MS + 200,
+          "event: command completed by the timeout");
+    close(a);
+    close(b);
+}
+
+static void test_jobs(int port) {
+    // the job of a is finished before b submits its job: both owners get their socket back
+    int a = connect_client(port);
+    int b = connect_client(port);
+
+    send_cmd(a, MOCK_JOB, 11, MOCK_JOB_MS);
+    double t_start = now_ms();
+    send_cmd(b, MOCK_ECHO, 44, 0);
+    check(recv_int(b) == 44 && now_ms() - t_start < MOCK_JOB_MS, "jobs: other client served during the job");
+    send_cmd(b, MOCK_JOB, 22, 0);
+    check(recv_int(b) == -1, "jobs: second job rejected while the first one runs");
+
+    check(recv_int(a) == 11, "jobs: done-callback of job a");
+    send_cmd(b, MOCK_JOB, 22, 0);
+    send_cmd(a, MOCK_ECHO, 12, 0);
+    check(recv_int(a) == 12, "jobs: owner of job a re-armed");
+    check(recv_int(b) == 22, "jobs: done-callback of job b");
+    send_cmd(b, MOCK_ECHO, 23, 0);
+    check(recv_int(b) == 23, "jobs: owner of job b re-armed");
+    close(a);
+    close(b);
+}
+
+static void test_batch(int port) {
+    struct {
+        BatchFrameHeader hdr;
+        BatchCmd cmds[3];
+    } __attribute__((packed)) frame;
+    struct {
+        BatchFrameHeader hdr;
+        BatchResp resp[3];
+    } __attribute__((packed)) reply;
+    int a = connect_client(port);
+
+    memset(&frame, 0, sizeof(frame));
+    frame.hdr.magic = BATCH_FRAME_MAGIC;
+    frame.hdr.version = BATCH_PROTOCOL_VERSION;
+    frame.hdr.no_cmds = 3;
+    for (int i = 0; i < 3; i++) {
+        frame.cmds[i].seq = 100 + i;
+        frame.cmds[i].id = MOCK_ECHO;
+        frame.cmds[i].ch = 10 * i;
+    }
+    frame.cmds[2].id = MOCK_PAYLOAD;  // payloads are not possible inside a batch
+    frame.cmds[2].ch = 4;
+    send_all(a, &frame, sizeof(frame));
+
+    bool ok = recv_all(a, &reply, sizeof(reply)) == 0 && reply.hdr.magic == BATCH_FRAME_MAGIC && reply.hdr.no_cmds == 3;
+    for (int i = 0; ok && i < 2; i++) ok = reply.resp[i].seq == (uint32_t)(100 + i) && reply.resp[i].value == 10 * i;
+    check(ok, "batch: response-frame with the replies of all commands");
+    check(ok && reply.resp[2].status == BATCH_STATUS_NOT_ALLOWED, "batch: command with payload not allowed");
+    send_cmd(a, MOCK_ECHO, 9, 0);
+    check(recv_int(a) == 9, "batch: next command after the frame");
+    close(a);
+}
+
+int main(void) {
+    static MockServer m;
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    pthread_t thread;
+    int one = 1;
+
+    // server-socket on a free loopback-port
+    int sock_server = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    setsockopt(sock_server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (sock_server < 0 || bind(sock_server, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(sock_server, 8) < 0 ||
+        getsockname(sock_server, (struct sockaddr*)&addr, &addr_len) < 0) {
+        printf("Creating mock-server failed: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    int port = ntohs(addr.sin_port);
+
+    m.event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m.event_fd < 0 || reactor_init(&m.reactor, sock_server, mock_handler, &m) < 0) {
+        printf("Initializing reactor failed\n");
+        return EXIT_FAILURE;
+    }
+    pthread_create(&thread, NULL, reactor_thread, &m);
+
+    printf("##### Reactor-Test on loopback-port %d #####\n", port);
+    test_payload(port);
+    test_event(&m, port);
+    test_jobs(port);
+    test_batch(port);
+
+    int a = connect_client(port);
+    send_cmd(a, MOCK_EXIT, 0, 0);
+    pthread_join(thread, NULL);
+    close(a);
+    reactor_close(&m.reactor);
+    close(sock_server);
+    close(m.event_fd);
+
+    printf("%s: %d check(s) failed\n", no_failed == 0 ? "PASSED" : "FAILED", no_failed);
+    return (no_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,287 @@
+/*
+ * rp_recorder.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Indexed chunk-file for local ADC-recordings, see rp_recorder.h
+ *
+ *    The chunks of a recording are sorted by first_sample (written in order), so the chunks
+ *    of a range are found with a binary search in the index.
+ */
+
+#define _GNU_SOURCE  // O_DIRECT
+
+#include "rp_recorder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "rp_constants.h"
+#include "rp_trace.h"
+
+#define REC_INDEX_INIT_SIZE 256
+
+static uint64_t align_up(uint64_t x) {
+    return (x + REC_ALIGN - 1) & ~(uint64_t)(REC_ALIGN - 1);
+}
+
+static int pwrite_all(int fd, const void* buf, size_t len, uint64_t offset) {
+    const uint8_t* p = buf;
+    while (len > 0) {
+        ssize_t n = pwrite(fd, p, len, (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+static int pread_all(int fd, void* buf, size_t len, uint64_t offset) {
+    // returns -1 on error or end of file
+    uint8_t* p = buf;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, (off_t)offset);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+static int write_aligned(RecFile* rec, const void* data, size_t len, uint64_t offset) {
+    // O_DIRECT needs an aligned buffer and size, data is copied and padded with zeros
+    size_t size = (size_t)align_up(len);
+    void* buf;
+    if (posix_memalign(&buf, REC_ALIGN, size) != 0) return -1;
+    memset(buf, 0, size);
+    memcpy(buf, data, len);
+    int ret = pwrite_all(rec->fd, buf, size, offset);
+    free(buf);
+    return ret;
+}
+
+int rec_path(char* path, size_t size, int rec_id, int storage) {
+    const char* dir = (storage == REC_STORAGE_TMPFS) ? REC_DIR_TMPFS : REC_DIR_SD;
+
+    if (storage != REC_STORAGE_SD && storage != REC_STORAGE_TMPFS) return -1;
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        printf("Recording: creating directory %s failed: %s\n", dir, strerror(errno));
+        return -1;
+    }
+    snprintf(path, size, "%s/rec_%d.rprc", dir, rec_id);
+    return 0;
+}
+
+int rec_find(char* path, size_t size, int rec_id) {
+    // recording on tmpfs or SD-card, returns -1 if there is none
+    const char* dirs[2] = {REC_DIR_TMPFS, REC_DIR_SD};
+
+    for (int i = 0; i < 2; i++) {
+        snprintf(path, size, "%s/rec_%d.rprc", dirs[i], rec_id);
+        if (access(path, R_OK) == 0) return 0;
+    }
+    printf("Recording %d not found\n", rec_id);
+    return -1;
+}
+
+int rec_open(RecFile* rec, const char* path, AdcConfig adcCfg, double sample_rate_hz, uint64_t t_start_ns) {
+    memset(rec, 0, sizeof(RecFile));
+    rec->direct = true;
+    rec->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT | O_CLOEXEC, 0644);
+    if (rec->fd < 0 && errno == EINVAL) {
+        // tmpfs (and some other filesystems) don't support O_DIRECT
+        rec->direct = false;
+        rec->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    }
+    if (rec->fd < 0) {
+        printf("Recording: opening %s failed: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    rec->header.magic = REC_FILE_MAGIC;
+    rec->header.version = REC_FILE_VERSION;
+    rec->header.chunk_samples = REC_CHUNK_SAMPLES;
+    rec->header.t_start_ns = t_start_ns;
+    rec->header.sample_rate_hz = sample_rate_hz;
+    rec->header.adcCfg = adcCfg;
+    rec->offset = REC_ALIGN;
+
+    rec->index_size = REC_INDEX_INIT_SIZE;
+    rec->index = malloc(rec->index_size * sizeof(RecChunkInfo));
+    if (rec->index == NULL || posix_memalign((void**)&rec->buf, REC_ALIGN, REC_CHUNK_BYTES) != 0 ||
+        write_aligned(rec, &rec->header, sizeof(RecFileHeader), 0) != 0) {
+        printf("Recording: initializing %s failed\n", path);
+        free(rec->index);
+        close(rec->fd);
+        return -1;
+    }
+    printf("Recording to %s (%s)\n", path, rec->direct ? "O_DIRECT" : "buffered");
+    return 0;
+}
+
+uint32_t* rec_chunk_samples(RecFile* rec) {
+    // samples of the next chunk are copied here before rec_write_chunk()
+    return (uint32_t*)(rec->buf + REC_CHUNK_HDR_SIZE);
+}
+
+int rec_write_chunk(RecFile* rec, RecChunkInfo* info) {
+    // info->no_samples samples have to be in rec_chunk_samples()
+    size_t len = REC_CHUNK_HDR_SIZE + (size_t)info->no_samples * sizeof(uint32_t);
+    size_t size = (size_t)align_up(len);
+
+    info->magic = REC_CHUNK_MAGIC;
+    info->offset = rec->offset + REC_CHUNK_HDR_SIZE;
+    memset(rec->buf, 0, REC_CHUNK_HDR_SIZE);
+    memcpy(rec->buf, info, sizeof(RecChunkInfo));
+    memset(rec->buf + len, 0, size - len);
+
+    if (pwrite_all(rec->fd, rec->buf, size, rec->offset) != 0) {
+        printf("Recording: writing chunk %u failed: %s\n", info->seq, strerror(errno));
+        return -1;
+    }
+    if (rec->header.no_chunks == rec->index_size) {
+        RecChunkInfo* index = realloc(rec->index, 2 * rec->index_size * sizeof(RecChunkInfo));
+        if (index == NULL) return -1;
+        rec->index = index;
+        rec->index_size *= 2;
+    }
+    rec->index[rec->header.no_chunks++] = *info;
+    rec->header.no_samples += info->no_samples;
+    rec->offset += size;
+    return 0;
+}
+
+int rec_close(RecFile* rec) {
+    // writes the index and the final header
+    int ret = 0;
+
+    rec->header.index_offset = rec->offset;
+    if (write_aligned(rec, rec->index, rec->header.no_chunks * sizeof(RecChunkInfo), rec->offset) != 0 ||
+        write_aligned(rec, &rec->header, sizeof(RecFileHeader), 0) != 0 || fsync(rec->fd) != 0) {
+        printf("Recording: writing index failed: %s\n", strerror(errno));
+        ret = -1;
+    }
+    close(rec->fd);
+    free(rec->buf);
+    free(rec->index);
+    return ret;
+}
+
+static int rebuild_index(int fd, RecFileHeader* header, RecChunkInfo** index) {
+    // recording was not finished: collect the chunk-headers
+    uint32_t size = REC_INDEX_INIT_SIZE;
+    uint64_t offset = REC_ALIGN;
+    RecChunkInfo info;
+
+    header->no_chunks = 0;
+    header->no_samples = 0;
+    *index = malloc(size * sizeof(RecChunkInfo));
+    if (*index == NULL) return -1;
+
+    while (pread_all(fd, &info, sizeof(RecChunkInfo), offset) == 0 && info.magic == REC_CHUNK_MAGIC &&
+           info.no_samples <= header->chunk_samples && info.offset == offset + REC_CHUNK_HDR_SIZE) {
+        if (header->no_chunks == size) {
+            RecChunkInfo* larger = realloc(*index, 2 * size * sizeof(RecChunkInfo));
+            if (larger == NULL) break;
+            *index = larger;
+            size *= 2;
+        }
+        (*index)[header->no_chunks++] = info;
+        header->no_samples += info.no_samples;
+        offset += align_up(REC_CHUNK_HDR_SIZE + (uint64_t)info.no_samples * sizeof(uint32_t));
+    }
+    TRACE_DEBUG("Recording: index rebuilt from %u chunk-headers", header->no_chunks);
+    return 0;
+}
+
+int rec_load_index(int fd, RecFileHeader* header, RecChunkInfo** index) {
+    // reads header and index (index has to be freed), returns -1 for invalid files
+    *index = NULL;
+    if (pread_all(fd, header, sizeof(RecFileHeader), 0) != 0 || header->magic != REC_FILE_MAGIC ||
+        header->version != REC_FILE_VERSION) {
+        printf("Recording: invalid file-header\n");
+        return -1;
+    }
+    if (header->index_offset == 0) return rebuild_index(fd, header, index);
+
+    *index = malloc((header->no_chunks > 0 ? header->no_chunks : 1) * sizeof(RecChunkInfo));
+    if (*index == NULL ||
+        pread_all(fd, *index, header->no_chunks * sizeof(RecChunkInfo), header->index_offset) != 0) {
+        printf("Recording: reading index failed\n");
+        free(*index);
+        *index = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static uint32_t first_chunk_of(const RecChunkInfo* index, uint32_t no_chunks, uint64_t sample) {
+    // first chunk which ends after sample
+    uint32_t lo = 0, hi = no_chunks;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index[mid].first_sample + index[mid].no_samples <= sample) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+uint32_t rec_range_missing(const RecChunkInfo* index, uint32_t no_chunks, uint64_t first_sample,
+                           uint32_t no_samples) {
+    // samples of the range which are not in any chunk (lost packages)
+    uint64_t end = first_sample + no_samples;
+    uint64_t covered = 0;
+
+    for (uint32_t c = first_chunk_of(index, no_chunks, first_sample); c < no_chunks; c++) {
+        uint64_t start = (index[c].first_sample > first_sample) ? index[c].first_sample : first_sample;
+        uint64_t stop = index[c].first_sample + index[c].no_samples;
+        if (start >= end) break;
+        covered += ((stop < end) ? stop : end) - start;
+    }
+    return no_samples - (uint32_t)covered;
+}
+
+int rec_read_range(int fd, const RecChunkInfo* index, uint32_t no_chunks, uint64_t first_sample, uint32_t no_samples,
+                   uint32_t* samples, uint32_t* no_missing) {
+    // reads [first_sample, first_sample + no_samples) into samples, samples of lost chunks are 0
+    uint64_t end = first_sample + no_samples;
+    uint64_t pos = first_sample;  // next sample to fill
+
+    *no_missing = 0;
+    for (uint32_t c = first_chunk_of(index, no_chunks, first_sample); c < no_chunks && pos < end; c++) {
+        uint64_t chunk_start = index[c].first_sample;
+        uint64_t chunk_end = chunk_start + index[c].no_samples;
+        if (chunk_start >= end) break;
+
+        if (chunk_start > pos) {
+            // gap of lost packages before this chunk
+            memset(samples + (pos - first_sample), 0, (size_t)(chunk_start - pos) * sizeof(uint32_t));
+            *no_missing += (uint32_t)(chunk_start - pos);
+            pos = chunk_start;
+        }
+        uint64_t n = ((chunk_end < end) ? chunk_end : end) - pos;
+        if (pread_all(fd, samples + (pos - first_sample), (size_t)n * sizeof(uint32_t),
+                      index[c].offset + (pos - chunk_start) * sizeof(uint32_t)) != 0) {
+            printf("Recording: reading chunk %u failed\n", index[c].seq);
+            return -1;
+        }
+        pos += n;
+    }
+    if (pos < end) {
+        memset(samples + (pos - first_sample), 0, (size_t)(end - pos) * sizeof(uint32_t));
+        *no_missing += (uint32_t)(end - pos);
+    }
+    return 0;
+}
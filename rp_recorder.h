@@ -0,0 +1,64 @@
+/*
+ * rp_recorder.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Local recording of the continous ADC-stream (longer than the CMA-Buffer, no host needed):
+ *
+ *     -- file rec_<id>.rprc in rec/ (SD-card) or /dev/shm/ (tmpfs):
+ *        RecFileHeader (padded to REC_ALIGN), chunks, index (RecChunkInfo[no_chunks])
+ *
+ *     -- every chunk is RecChunkInfo (padded to REC_CHUNK_HDR_SIZE) + up to REC_CHUNK_SAMPLES
+ *        samples, padded to REC_ALIGN. Chunks are written with O_DIRECT from an aligned
+ *        buffer (page-cache is bypassed), buffered writes if the filesystem doesn't support
+ *        O_DIRECT (tmpfs)
+ *
+ *     -- the index and the final header are written at the end, if a recording was not
+ *        finished the index is rebuilt from the chunk-headers
+ *
+ *     -- sample-ranges are read back with pread() of the chunks which cover the range only
+ */
+
+#ifndef SRC_RP_RECORDER_H
+#define SRC_RP_RECORDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+#define REC_ALIGN 4096                 // alignment of O_DIRECT-writes (offset, size, buffer)
+#define REC_CHUNK_BYTES (1024 * 1024)  // chunk-header + samples
+#define REC_CHUNK_HDR_SIZE 64
+#define REC_CHUNK_SAMPLES ((REC_CHUNK_BYTES - REC_CHUNK_HDR_SIZE) / 4)
+#define REC_MAX_RANGE_SAMPLES (16 * 1024 * 1024)  // max. samples of one GET_RECORD_RANGE
+#define REC_DIR_SD "rec"
+#define REC_DIR_TMPFS "/dev/shm"
+
+// recording which is written
+typedef struct {
+    int fd;
+    bool direct;            // O_DIRECT is used
+    RecFileHeader header;
+    uint8_t* buf;           // aligned chunk-buffer: RecChunkInfo + samples
+    RecChunkInfo* index;
+    uint32_t index_size;    // allocated entries
+    uint64_t offset;        // file-offset of the next chunk
+} RecFile;
+
+int rec_path(char* path, size_t size, int rec_id, int storage);
+int rec_find(char* path, size_t size, int rec_id);
+
+int rec_open(RecFile* rec, const char* path, AdcConfig adcCfg, double sample_rate_hz, uint64_t t_start_ns);
+uint32_t* rec_chunk_samples(RecFile* rec);
+int rec_write_chunk(RecFile* rec, RecChunkInfo* info);
+int rec_close(RecFile* rec);
+
+int rec_load_index(int fd, RecFileHeader* header, RecChunkInfo** index);
+uint32_t rec_range_missing(const RecChunkInfo* index, uint32_t no_chunks, uint64_t first_sample,
+                           uint32_t no_samples);
+int rec_read_range(int fd, const RecChunkInfo* index, uint32_t no_chunks, uint64_t first_sample, uint32_t no_samples,
+                   uint32_t* samples, uint32_t* no_missing);
+
+#endif
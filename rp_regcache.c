@@ -0,0 +1,162 @@
+/*
+ * rp_regcache.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Shadow-registers for the configuration of the AXI-devices, see rp_regcache.h
+ */
+
+#include "rp_regcache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rp_constants.h"
+#include "rp_convert.h"
+
+static void** regcache_field(AxiDevs* axi_devs, size_t field) {
+    return (void**)((char*)axi_devs + field);
+}
+
+static size_t regcache_window_words(void) {
+    return (size_t)AXI_SLAVE_REG_RANGE / sizeof(uint32_t);
+}
+
+static int regcache_add(RegCache* rc, const char* name, size_t field) {
+    // devices without window in the current FPGA-image are not cached
+    void* window = *regcache_field(&rc->hw, field);
+    if (window == NULL) return 0;
+
+    RegCacheDev* dev = &rc->devs[rc->no_devs];
+    memset(dev, 0, sizeof(RegCacheDev));
+    snprintf(dev->name, sizeof(dev->name), "%s", name);
+    dev->field = field;
+    dev->hw = (volatile uint32_t*)window;
+    dev->shadow = aligned_alloc((size_t)AXI_SLAVE_REG_RANGE, (size_t)AXI_SLAVE_REG_RANGE);
+    if (dev->shadow == NULL) {
+        printf("RegCache: allocating shadow-window of %s failed\n", name);
+        return -1;
+    }
+    memset(dev->shadow, 0, (size_t)AXI_SLAVE_REG_RANGE);
+    rc->no_devs++;
+    return 0;
+}
+
+int regcache_init(RegCache* rc, AxiDevs axi_devs) {
+    memset(rc, 0, sizeof(RegCache));
+    rc->hw = axi_devs;
+    rc->enabled = getenv(REGCACHE_DISABLE_ENV) == NULL;
+    if (!rc->enabled) {
+        printf("RegCache: disabled (%s), configs are written directly\n", REGCACHE_DISABLE_ENV);
+        return 0;
+    }
+
+    int ret = regcache_add(rc, "adc", offsetof(AxiDevs, adc));
+    for (int i = 0; i < NO_DAC_BRAM_INTERFACES_USED && ret == 0; i++) {
+        char name[24];
+        snprintf(name, sizeof(name), "dac_bram_ctrl%d", i);
+        ret = regcache_add(rc, name, offsetof(AxiDevs, dac_bram_ctrl) + i * sizeof(void*));
+    }
+    if (ret == 0) ret = regcache_add(rc, "trigger_gen", offsetof(AxiDevs, trigger_gen));
+    if (ret == 0) ret = regcache_add(rc, "dummy_data_gen", offsetof(AxiDevs, dummy_data_gen));
+    if (ret < 0) {
+        regcache_release(rc);
+        return -1;
+    }
+    return 0;
+}
+
+void regcache_release(RegCache* rc) {
+    for (int i = 0; i < rc->no_devs; i++) free(rc->devs[i].shadow);
+    rc->no_devs = 0;
+    rc->enabled = false;
+}
+
+void regcache_invalidate(RegCache* rc, const void* window) {
+    // window was accessed directly, the shadow is read back before the next config
+    for (int i = 0; i < rc->no_devs; i++) {
+        if ((const void*)rc->devs[i].hw == window) rc->devs[i].valid = false;
+    }
+}
+
+void regcache_invalidate_all(RegCache* rc) {
+    for (int i = 0; i < rc->no_devs; i++) rc->devs[i].valid = false;
+}
+
+AxiDevs regcache_begin(RegCache* rc) {
+    // AxiDevs for one config: cached devices point to their shadow-window
+    AxiDevs staged = rc->hw;
+    if (!rc->enabled) return staged;
+
+    for (int i = 0; i < rc->no_devs; i++) {
+        RegCacheDev* dev = &rc->devs[i];
+        if (dev->write_through) continue;
+        if (!dev->valid) {
+            copy_words_scalar(dev->flushed, dev->hw, REGCACHE_NO_REGS);
+            memcpy(dev->shadow, dev->flushed, sizeof(dev->flushed));
+            dev->stats.bus_reads += REGCACHE_NO_REGS;
+            dev->valid = true;
+        }
+        *regcache_field(&staged, dev->field) = dev->shadow;
+    }
+    return staged;
+}
+
+static uint32_t regcache_flush_dev(RegCacheDev* dev) {
+    uint32_t no_writes = 0;
+
+    for (uint32_t i = 0; i < REGCACHE_NO_REGS; i++) {
+        if (dev->shadow[i] == dev->flushed[i]) continue;
+        dev->hw[i] = dev->shadow[i];
+        dev->flushed[i] = dev->shadow[i];
+        no_writes++;
+    }
+
+    // rest of the window is not cached (zero): forward writes, then switch to write-through
+    bool beyond = false;
+    for (size_t i = REGCACHE_NO_REGS; i < regcache_window_words(); i++) {
+        if (dev->shadow[i] == 0) continue;
+        dev->hw[i] = dev->shadow[i];
+        dev->shadow[i] = 0;
+        no_writes++;
+        beyond = true;
+    }
+    if (beyond) {
+        printf("RegCache: %s uses registers beyond 0x%x, switched to write-through\n", dev->name,
+               (unsigned)(REGCACHE_NO_REGS * sizeof(uint32_t)));
+        dev->write_through = true;
+    }
+    return no_writes;
+}
+
+uint32_t regcache_flush(RegCache* rc, bool verbose) {
+    // writes the changed registers of all devices, returns the no. of bus-writes
+    uint32_t no_writes = 0;
+    if (!rc->enabled) return 0;
+
+    for (int i = 0; i < rc->no_devs; i++) {
+        RegCacheDev* dev = &rc->devs[i];
+        if (!dev->valid || dev->write_through) continue;
+        dev->stats.last_writes = regcache_flush_dev(dev);
+        dev->stats.bus_writes += dev->stats.last_writes;
+        dev->stats.flushes++;
+        no_writes += dev->stats.last_writes;
+        if (verbose && dev->stats.last_writes > 0) {
+            printf("RegCache: %s: %u registers written (total: %llu writes, %llu reads)\n", dev->name,
+                   dev->stats.last_writes, (unsigned long long)dev->stats.bus_writes,
+                   (unsigned long long)dev->stats.bus_reads);
+        }
+    }
+    // one barrier for the whole config (dmb on ARM), the writes are done before the ACK is sent
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return no_writes;
+}
+
+const RegCacheDev* regcache_device(const RegCache* rc, const char* name) {
+    for (int i = 0; i < rc->no_devs; i++) {
+        if (strcmp(rc->devs[i].name, name) == 0) return &rc->devs[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,74 @@
+/*
+ * rp_regcache.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Shadow-registers for the configuration of the AXI-devices:
+ *
+ *     -- every cached device gets a shadow-window (one page in normal, cached memory), a
+ *        config-function (rpa_config(), configDacBramController()...) is called with the
+ *        AxiDevs from regcache_begin(), so all its reads and read-modify-writes of control-bits
+ *        hit the shadow instead of the uncached /dev/mem-window
+ *
+ *     -- regcache_flush() compares the first REGCACHE_NO_REGS registers of each shadow with the
+ *        values last written to the FPGA and writes only the changed ones (ascending offsets),
+ *        followed by one barrier. Modules are started/stopped with the reset-GPIO, which is not
+ *        cached, so the order of the parameter-registers of one config doesn't matter
+ *
+ *     -- the shadow is read back from the FPGA once (REGCACHE_NO_REGS reads) after
+ *        regcache_invalidate(), which has to be called whenever a device was accessed directly
+ *        (start/stop-functions, jobs on the worker-thread, reset)
+ *
+ *     -- a device which writes registers beyond REGCACHE_NO_REGS is switched to write-through
+ *        (the writes are forwarded, message on the console)
+ *
+ *    RP_REGCACHE_OFF (env.) disables the cache: regcache_begin() returns the FPGA-windows.
+ */
+
+#ifndef SRC_RP_REGCACHE_H
+#define SRC_RP_REGCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+#define REGCACHE_NO_REGS 32  // registers per device which are cached (slv_reg0..31 of the user-IPs)
+#define REGCACHE_MAX_DEVICES (3 + NO_DAC_BRAM_INTERFACES_USED)
+#define REGCACHE_DISABLE_ENV "RP_REGCACHE_OFF"
+
+typedef struct {
+    uint64_t bus_reads;     // registers read back from the FPGA
+    uint64_t bus_writes;    // registers written to the FPGA
+    uint64_t flushes;
+    uint32_t last_writes;   // registers written by the last flush
+} RegCacheStats;
+
+typedef struct {
+    char name[24];
+    size_t field;                          // offset of the window-pointer inside AxiDevs
+    volatile uint32_t* hw;                 // FPGA-window
+    uint32_t* shadow;                      // window seen by the config-functions (one page)
+    uint32_t flushed[REGCACHE_NO_REGS];    // values in the FPGA
+    bool valid;                            // shadow and flushed match the FPGA
+    bool write_through;                    // device uses registers beyond REGCACHE_NO_REGS
+    RegCacheStats stats;
+} RegCacheDev;
+
+typedef struct {
+    bool enabled;
+    AxiDevs hw;
+    RegCacheDev devs[REGCACHE_MAX_DEVICES];
+    int no_devs;
+} RegCache;
+
+int regcache_init(RegCache* rc, AxiDevs axi_devs);
+void regcache_release(RegCache* rc);
+void regcache_invalidate(RegCache* rc, const void* window);
+void regcache_invalidate_all(RegCache* rc);
+AxiDevs regcache_begin(RegCache* rc);
+uint32_t regcache_flush(RegCache* rc, bool verbose);
+const RegCacheDev* regcache_device(const RegCache* rc, const char* name);
+
+#endif
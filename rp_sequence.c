@@ -0,0 +1,156 @@
+/*
+ * rp_sequence.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Interpreter for command-sequences, see rp_sequence.h
+ *
+ *    Loops are handled with a stack of (index of SEQ_OP_LOOP, iteration), the nesting is
+ *    checked by seq_check_program() before the program is started.
+ */
+
+#include "rp_sequence.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "rp_constants.h"
+#include "rp_trace.h"
+
+typedef struct {
+    int index;       // index of SEQ_OP_LOOP
+    uint32_t iter;   // current iteration
+} SeqLoop;
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static void wait_until(uint64_t deadline) {
+    // sleep till shortly before the deadline, then spin (wake-up latency of the scheduler)
+    if (deadline > now_ns() + SEQ_SPIN_NS) {
+        uint64_t t_wake = deadline - SEQ_SPIN_NS;
+        struct timespec ts = {(time_t)(t_wake / 1000000000ULL), (long)(t_wake % 1000000000ULL)};
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+    }
+    while (now_ns() < deadline) {
+    }
+}
+
+int seq_check_program(const SeqProgramHeader* header, const SeqOp* ops) {
+    // returns 0 if the program can be executed (loops nested correctly, valid waits)
+    int depth = 0;
+
+    for (int i = 0; i < header->no_ops; i++) {
+        switch (ops[i].op) {
+            case SEQ_OP_CMD:
+                break;
+            case SEQ_OP_WAIT_UNTIL:
+            case SEQ_OP_DELAY:
+                if (!(ops[i].val >= 0 && ops[i].val <= SEQ_MAX_WAIT_US)) {
+                    printf("Sequence: invalid wait of %f us at op %d\n", ops[i].val, i);
+                    return -1;
+                }
+                break;
+            case SEQ_OP_LOOP:
+                if (ops[i].count == 0 || ++depth > SEQ_MAX_LOOP_DEPTH) {
+                    printf("Sequence: invalid loop at op %d (count %u, max. depth %d)\n", i, ops[i].count,
+                           SEQ_MAX_LOOP_DEPTH);
+                    return -1;
+                }
+                break;
+            case SEQ_OP_END_LOOP:
+                if (--depth < 0) {
+                    printf("Sequence: SEQ_OP_END_LOOP without loop at op %d\n", i);
+                    return -1;
+                }
+                break;
+            default:
+                printf("Sequence: unknown op %u at op %d\n", ops[i].op, i);
+                return -1;
+        }
+    }
+    if (depth != 0) {
+        printf("Sequence: %d loop(s) without SEQ_OP_END_LOOP\n", depth);
+        return -1;
+    }
+    return 0;
+}
+
+void seq_run(const SeqProgramHeader* header, const SeqOp* ops, SeqExecFn exec, void* ctx, SeqResult* results,
+             SeqResultHeader* result_header) {
+    // program has to be checked by seq_check_program(), results has to hold header->max_results
+    SeqLoop loops[SEQ_MAX_LOOP_DEPTH];
+    int depth = 0;
+    uint64_t steps = 0;
+
+    result_header->magic = SEQ_RESULT_MAGIC;
+    result_header->status = SEQ_STATUS_OK;
+    result_header->no_results = 0;
+    result_header->no_late = 0;
+    result_header->max_late_ns = 0;
+
+    uint64_t t_start = now_ns();
+    uint64_t deadline = t_start;
+    for (int i = 0; i < header->no_ops; i++) {
+        const SeqOp* op = &ops[i];
+
+        if (++steps > SEQ_MAX_STEPS) {
+            result_header->status = SEQ_STATUS_STEP_LIMIT;
+            break;
+        }
+
+        if (op->op == SEQ_OP_CMD) {
+            TcpCmd command = {.id = op->id, .val = op->val, .ch = op->ch};
+            int32_t status = BATCH_STATUS_OK, value = 0;
+
+            bool keep_running = exec(ctx, command, &status, &value);
+            if (op->flags & SEQ_FLAG_CAPTURE) {
+                if (result_header->no_results < header->max_results) {
+                    SeqResult* res = &results[result_header->no_results++];
+                    res->op_index = (uint32_t)i;
+                    res->status = status;
+                    res->value = value;
+                    res->loop_iter = (depth > 0) ? loops[depth - 1].iter : 0;
+                    res->t_ns = now_ns() - t_start;
+                } else {
+                    result_header->status = SEQ_STATUS_RESULTS_FULL;
+                }
+            }
+            if (!keep_running) {
+                result_header->status = SEQ_STATUS_STOPPED;
+                break;
+            }
+        } else if (op->op == SEQ_OP_WAIT_UNTIL || op->op == SEQ_OP_DELAY) {
+            uint64_t wait_ns = (uint64_t)(op->val * 1000.0);
+            deadline = (op->op == SEQ_OP_WAIT_UNTIL) ? t_start + wait_ns : deadline + wait_ns;
+
+            uint64_t now = now_ns();
+            if (now > deadline) {
+                result_header->no_late++;
+                if (now - deadline > result_header->max_late_ns) result_header->max_late_ns = now - deadline;
+            } else {
+                wait_until(deadline);
+            }
+        } else if (op->op == SEQ_OP_LOOP) {
+            loops[depth].index = i;
+            loops[depth].iter = 0;
+            depth++;
+        } else if (op->op == SEQ_OP_END_LOOP) {
+            SeqLoop* loop = &loops[depth - 1];
+            if (++loop->iter < ops[loop->index].count) {
+                i = loop->index;  // continue after SEQ_OP_LOOP
+            } else {
+                depth--;
+            }
+        }
+    }
+    result_header->t_total_ns = now_ns() - t_start;
+    TRACE_DEBUG("Sequence: %llu ops in %llu us, %u late deadlines (max. %llu us)", (unsigned long long)steps,
+                (unsigned long long)(result_header->t_total_ns / 1000), result_header->no_late,
+                (unsigned long long)(result_header->max_late_ns / 1000));
+}
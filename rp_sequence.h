@@ -0,0 +1,47 @@
+/*
+ * rp_sequence.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Command-sequences executed on RedPitaya:
+ *
+ *     -- the host uploads a program (SeqProgramHeader + SeqOp[no_ops]) with commands,
+ *        waits and loops, RedPitaya runs it without a round-trip per command
+ *
+ *     -- waits are absolute deadlines on CLOCK_MONOTONIC (counter of the ARM-generic-timer):
+ *        clock_nanosleep(TIMER_ABSTIME) till SEQ_SPIN_NS before the deadline, the rest is
+ *        busy-waiting. SEQ_OP_DELAY continues from the previous deadline, so periodic loops
+ *        don't drift by the runtime of the commands
+ *
+ *     -- replies of commands with SEQ_FLAG_CAPTURE are stored with a timestamp and sent
+ *        in one transfer at the end (SeqResultHeader + SeqResult[no_results])
+ *
+ *    The commands are executed by the SeqExecFn-callback (the command-handler of the
+ *    server, same restrictions as for batch-frames). The server runs the program as a job
+ *    on the worker-thread, so long waits don't block the other clients.
+ */
+
+#ifndef SRC_RP_SEQUENCE_H
+#define SRC_RP_SEQUENCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+#define SEQ_MAX_OPS 1024
+#define SEQ_MAX_RESULTS 65536
+#define SEQ_MAX_LOOP_DEPTH 8
+#define SEQ_MAX_STEPS 10000000     // executed ops, limits the runtime of endless programs
+#define SEQ_MAX_WAIT_US 60000000.0  // max. time of one SEQ_OP_WAIT_UNTIL/SEQ_OP_DELAY
+#define SEQ_SPIN_NS 100000         // busy-waiting for the last 100 us before a deadline
+
+// executes one command, stores its status (BATCH_STATUS_*) and reply-value,
+// returns false if the program has to be stopped (connection gets closed)
+typedef bool (*SeqExecFn)(void* ctx, TcpCmd command, int32_t* status, int32_t* value);
+
+int seq_check_program(const SeqProgramHeader* header, const SeqOp* ops);
+void seq_run(const SeqProgramHeader* header, const SeqOp* ops, SeqExecFn exec, void* ctx, SeqResult* results,
+             SeqResultHeader* result_header);
+
+#endif
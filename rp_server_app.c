@@ -7,9 +7,15 @@
  #include <stdlib.h>
 #include <signal.h>  //sig_atomic_t
 #include <stdio.h>   //printf
+#include <string.h>
+#include <fcntl.h>   //open
+#include <unistd.h>  //close
 #include <stdnoreturn.h>
 #include <sys/socket.h>  //listen
+#include <netinet/in.h>  //sockaddr_in
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
 #include "rp_server_app.h"
 #include "dac/dac_constants.h"
 #include "rp_adc.h"
@@ -27,599 +33,1750 @@
 #include "rp_dummy_data_gen.h"
 #include "rp_clock_divider.h"
 #include "rp_lia.h"
+#include "rp_lia_sw.h"
 #include "rp_axis_mux.h"
 #include "rp_click_boards/adc24click.h"
 #include "rp_click_boards/adc20click.h"
 #include "rp_spi.h"
+#include "rp_reactor.h"
+#include "rp_ram_stream.h"
+#include "rp_adc24_scanner.h"
+#include "rp_convert.h"
+#include "rp_trace.h"
+#include "rp_hal.h"
+#include "rp_sweep_avg.h"
+#include "rp_lut_bin.h"
+#include "rp_bram_upload.h"
+#include "rp_trigger_irq.h"
+#include "rp_lut_calib.h"
+#include "rp_sequence.h"
+#include "rp_recorder.h"
+#include "rp_regcache.h"
+#include "rp_config_diff.h"
+#include "rp_metrics.h"
 
 volatile sig_atomic_t interrupted = 0;  // global flag to track if application got interrupted by user
 
-void signal_handler(int sig) {
-    // handles user interrupt (ctrl+c), gets connected to
-    printf("interrupted!\n");
-    interrupted = 1;
-}
-
-int app_server(AxiDevs axi_devs, bool verbose) {
-    // after all devices are initialized this should be the main application loop,
-    // where all requests from the application connected via tcp are handled
-
-    int sock_client;  // client which is connected to server
-    int sock_server;
-    uint16_t cmd;
+// arguments for a long running job on the worker-thread
+typedef struct {
+    AxiDevs axi_devs;
+    int sock_client;      // socket of the client which started the job
     RamConfig ramCfg;
+    AdcConfig adcCfg;
+    int no_tcp_packages;
+    int no_regions;       // Multi-Block-Mode: no. of regions of the RAM-Buffer
+    int stream_mode;      // Continous-Mode: ADC_STREAM_RAW or ADC_STREAM_COMPRESSED
+    int no_steps;         // Sweep-Averaging: no. of LUT-steps per sweep (no_tcp_packages = no. of sweeps)
+                          // LUT-Calibration: no. of steps of the LUT
+    int ram_writer_mode;  // for RAM-Tests (RAM_WRITER_BLOCK_MODE/RAM_WRITER_CONTI_MODE)
+    int spi_fd;
+    int adc20_stop_ch;    // ADC20-Stream: sequence runs from channel 0 to adc20_stop_ch
+    bool* adc20_streaming;  // cleared by adc20_stream_done() when the job was collected
+    LutCalibConfig lutCalibCfg;
+    LutCalibPoint* lut_calib_points;  // allocated by START_LUT_CALIB, freed by the job
+    TriggerIrq* trigger_irq;
+    int trigger_cmd;      // polling-mode: command waiting for the trigger (trigger_wait_job)
+    int trigger_ret;
+    LiaStreamConfig liaStreamCfg;  // ADC_LIA_MODE: software-LIA
+    LiaMixerConfig liaMixerCfg;
+    LiaIIRConfig liaIIRCfg;
+    const uint32_t* lia_ref;       // reference-table of the LIA-Mixer
+    uint32_t lia_ref_len;
+    RecConfig recCfg;              // START_RECORD
+    RecRangeRequest recRange;      // GET_RECORD_RANGE
+    bool verbose;
+} AdcJob;
+
+// state of the server which is shared between all connected clients
+// (each FPGA-module exists only once, so the active configs are not stored per client)
+typedef struct {
+    AxiDevs axi_devs;
+    bool verbose;
+    Reactor reactor;
+    RegCache regcache;  // shadow-registers of the devices configured with NEW_CONFIG
+    ActiveConfig active;  // configs applied to the FPGA (NEW_CONFIG only applies the changes)
 
-    bool initial_start = true;  // flag to show the inital start
-
-    // set to false at some point....
-
-    // init buffer for TCP-Command (struct)
-    TcpCmd command;
-    char TcpCmdBuffer[sizeof(TcpCmd)];
+    RamConfig ramCfg;
 
     // Initalize a config-struct for each module where we want to receive configs for:
     DacConfig dacCfg;
-    char DacConfigBuffer[sizeof(DacConfig)];
     AdcConfig adcCfg;
-    char AdcConfigBuffer[sizeof(AdcConfig)];
     BramDacConfig bramDacConfig;
     BramDacConfig bramDacConfig_arr[NO_DAC_BRAM_INTERFACES_USED];
-    char BramDacConfigBuffer[sizeof(BramDacConfig)];
     TriggerConfig triggerConfig;
-    char TriggerConfigBuffer[sizeof(TriggerConfig)];
     DummyDataGenConfig dummyCfg;
-    char dummyCfgBuffer[sizeof(DummyDataGenConfig)];
     LiaMixerConfig liaMixerCfg;
-    char liaMixerCfgBuffer[sizeof(LiaMixerConfig)];
     ClockDividerConfig clockDividerConfig;
-    char ClockDividerConfigBuffer[sizeof(ClockDividerConfig)];
     RamInitConfig ramInitCfg;
-    char ramInitCfgBuffer[sizeof(RamInitConfig)];
-    BramConfig bramCfg;
-    char BramCfgBuffer[sizeof(BramConfig)];
+    BramUploadHeader bramUploadHeader;
     LiaIIRConfig liaIIRCfg;
-    char liaIIRCfgBuffer[sizeof(LiaIIRConfig)];
+    LiaStreamConfig liaStreamCfg;
+    // copy of the LIA-Mixer-BRAM for the software-LIA (also without the LIA-Mixer in the bitstream)
+    uint32_t liaRef[LIA_REF_MAX_WORDS];
+    uint32_t lia_ref_len;
     SpiConfig spiCfg;
-    char spiCfgBuffer[sizeof(SpiConfig)];
 
     // store file descriptor of the SPI interface
     int spi_fd;
-
-    int size; int *ptr;
+    // background-scanner of ADC24 Click, owns the SPI-bus while running
+    Adc24Scanner adc24_scanner;
+    Adc24Sample adc24_window[ADC24_SCAN_MAX_WINDOW_SAMPLES];
+    bool adc20_streaming;  // ADC20-Stream job uses the SPI-bus (from submit till collect)
 
     // store no of tcp packages for ADC-TCP-Connection
     int no_tcp_packages;
-
-    // for storing read-out-voltage from get-functions...
-    int voltage_mV, adc_cnt;
-
-    // when setting voltage on DAC
-    float voltage_V;
+    int no_regions;
+    int stream_mode;
+    int no_steps;
+    // last channel of the ADC20-Stream sequence
+    int adc20_stop_ch;
 
     // for trigger-dac-sweep:
     int trigger_sweep_index;
     int no_total_trigger;
+    TriggerIrq trigger_irq;  // trigger-armed event (UIO-interrupt, simulator or polling)
     LutValue lutValue;
-    char LutValueBuffer[sizeof(LutValue)];
+    LutCalibConfig lutCalibCfg;
+    LutCalibPoint* lut_calib_points;  // handed to the next LUT-Calibration-job
 
-    // for DAC-BRAM Info
-    float sample_rate_kHz, signal_rate_kHz;
-    int sample_rate_cnt, signal_rate_cnt;
+    // local recordings of the ADC-stream
+    RecConfig recCfg;
+    RecRangeRequest recRange;
 
-    // intit Server
-    sock_server = init_server();
+    // entries of the GET_STATS-snapshot
+    StatsCmdEntry statsCmds[METRICS_CMD_SLOTS];
 
-    // init system...
-    disable_system(axi_devs);  // disable all FPGA-Modules on default, activated only after config-params got send?
+    // binary LUT: staging-buffer for uploads (NEW_CONFIG/LUT_CONFIG_ID) and GET_LUT_BIN/STORE_LUT
+    LutBinHeader lutBinHeader;
+    uint32_t lutBinCodes[LUT_BIN_MAX_STEPS] __attribute__((aligned(16)));
+    bool lut_bin_pending[NO_DAC_BRAM_INTERFACES_USED];  // next DAC_BRAM_CONFIG uses the uploaded LUT
+    struct timespec lut_bin_t_start;                    // ACK of the current upload
 
-    printf("App-Server started..\n");
+    // arguments for the job currently running on the worker-thread
+    AdcJob job;
+} ServerState;
 
-    listen(sock_server, 1024);
+void signal_handler(int sig) {
+    // handles user interrupt (ctrl+c), gets connected to
+    printf("interrupted!\n");
+    interrupted = 1;
+}
 
-    // bind user interrupt (^C => SIGINT) to "interrupt handler"
+static int ram_writer_mode_for(int adc_mode) {
+    // only Block-Mode stops the RAM-Writer at the end of the buffer, Multi-Block- and
+    // LIA-Mode run on the wrapping continous-mode
+    return (adc_mode == ADC_BLOCK_MODE) ? RAM_WRITER_BLOCK_MODE : RAM_WRITER_CONTI_MODE;
+}
+
+static void adc_sampling_job(void* arg) {
+    // runs on the worker-thread, owns the client-socket till all data is sent
+    AdcJob* job = (AdcJob*)arg;
+    StreamStats stats;
+
+    signal(SIGINT, SIG_DFL);  // so that we can go outside here if we need to interrupt...
+    switch (job->adcCfg.adc_mode) {
+        case ADC_CONTINOUS_MODE:
+            /* continous mode for ADC-Sampling till 15.626 MS/s*/
+            printf("##### Start ADC-RAM-TCP-Writer in Continous-Mode for %d TCP-Packages #####\n", job->no_tcp_packages);
+            if (job->stream_mode == ADC_STREAM_COMPRESSED) {
+                cont_adc_writer_compressed(job->axi_devs, job->sock_client, job->ramCfg, job->no_tcp_packages, job->adcCfg.sample_rate_divider, &stats);
+            } else {
+                cont_adc_writer_zc(job->axi_devs, job->sock_client, job->ramCfg, job->no_tcp_packages, job->adcCfg.sample_rate_divider, &stats);
+            }
+            print_stream_stats("Continous-Mode", &stats);
+            break;
+        case ADC_BLOCK_MODE:
+            /* single shot block-mode with upto 125MS/s */
+            printf("##### Start ADC-RAM-TCP-Writer in Block-Mode for %d TCP-Packages #####\n", job->no_tcp_packages);
+            block_adc_writer(job->axi_devs, job->sock_client, job->ramCfg, job->verbose);
+            // one block of the RAM-size, block_adc_writer() doesn't report the bytes it sent
+            metrics_stream_package(METRICS_STREAM_BLOCK, job->ramCfg.param.ram_size_bytes);
+            break;
+        case ADC_MULTI_BLOCK_MODE:
+            /* back-to-back blocks, RAM-Writer is re-armed on the next region while one is sent */
+            printf("##### Start ADC-RAM-TCP-Writer in Multi-Block-Mode for %d Blocks #####\n", job->no_tcp_packages);
+            multi_block_adc_writer_zc(job->axi_devs, job->sock_client, job->ramCfg, job->no_tcp_packages, job->no_regions,
+                                      job->adcCfg.sample_rate_divider, &stats);
+            print_stream_stats("Multi-Block-Mode", &stats);
+            printf("    dropped blocks: %u\n", stats.overruns);
+            break;
+        case ADC_LIA_MODE: {
+            /* apply LIA on sampled ADC data and send via tcp (software-LIA on the continous RAM-Writer-stream) */
+            LiaSw lia;
+            printf("#### Start LIA-ADC-RAM-TCP-Writer for %d Blocks\n", job->no_tcp_packages);
+            if ((job->liaStreamCfg.output != LIA_OUT_IQ && job->liaStreamCfg.output != LIA_OUT_MAG_PHASE) ||
+                lia_sw_init(&lia, &job->liaIIRCfg, job->liaMixerCfg.channel, job->lia_ref, job->lia_ref_len,
+                            job->liaStreamCfg.decimation) < 0) {
+                printf("LIA-Mode: invalid LIA-Stream-Config, upload reference-table and LIA_STREAM_CONFIG_ID first\n");
+                send_to_client(job->sock_client, SERVER_ERROR_ID);  // instead of the first LiaStreamHeader
+                break;
+            }
+            set_ram_writer_mode(job->axi_devs, RAM_WRITER_CONTI_MODE);
+            lia_adc_writer(job->axi_devs, job->sock_client, job->ramCfg, &lia, job->liaStreamCfg.output,
+                           job->no_tcp_packages, job->adcCfg.sample_rate_divider, &stats);
+            print_stream_stats("LIA-Mode", &stats);
+            printf("    %d SOS, decimation %u: LIA-cpu %.3f s = %.1f%% of the run\n", lia.num_sos, lia.decimation,
+                   stats.codec_cpu_s, (stats.duration_s > 0) ? 100.0 * stats.codec_cpu_s / stats.duration_s : 0.0);
+            break;
+        }
+        default:
+            printf("ADC-Mode not available...\n");
+            break;
+    }
+    printf("Done sampling ADC...\n");
+    disable_rp_adc(job->axi_devs);
+    disable_ram_writer(job->axi_devs);
     signal(SIGINT, signal_handler);
+}
 
-    // main while loop:
-    while (!interrupted) {
-        printf("Waiting for client to connect to Socket..\n");
-
-        sock_client = wait_for_client_connect(sock_server);
-
-        printf("Client connected to Socket...\n");
-
-        while (!interrupted) {
-            printf("... waiting for next command\n");
-            wait_for_new_command(sock_client,&command,TcpCmdBuffer,sizeof(TcpCmdBuffer));
-            if (verbose) printf(">> msg_received: ID: %d , channel: %d ,value: %f \n", command.id, command.ch, command.val);
-
-            switch (command.id) {
-                case NEW_CONFIG:
-                    switch ((int)command.val) {
-                        case DAC_CONFIG_ID:
-                            // Receive new DAC configuration
-                            receive_struct(sock_client, &dacCfg, DacConfigBuffer, sizeof(DacConfig));
-                            printf("\n### Received new DAC-Config ###\n");
-                            // Configure and initialize output to init-state
-                            init_dac_module(axi_devs, dacCfg, false);  // Do not reset DAC-Outputs afer conifg (false)
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            break;
+static void sweep_avg_job(void* arg) {
+    // accumulates the ADC-samples per LUT-step over all sweeps, sends only the sums of one sweep
+    AdcJob* job = (AdcJob*)arg;
+    SweepAvgHeader header;
+    struct iovec iov[3];
+    ZcSocket zc;
+    size_t sum_bytes = (job->no_steps > 0) ? (size_t)job->no_steps * sizeof(int32_t) : 0;
+    int32_t* sum_a = malloc(sum_bytes + 1);
+    int32_t* sum_b = malloc(sum_bytes + 1);
+
+    printf("##### Start Sweep-Averaging: %d steps, %d sweeps #####\n", job->no_steps, job->no_tcp_packages);
+    header.magic = SWEEP_AVG_MAGIC;
+    header.no_steps = (uint32_t)job->no_steps;
+    header.no_sweeps = (uint32_t)job->no_tcp_packages;
+    header.status = SERVER_ERROR_ID;
+    if (sum_a != NULL && sum_b != NULL &&
+        sweep_average(job->axi_devs, job->ramCfg, job->no_steps, job->no_tcp_packages, job->adcCfg.sample_rate_divider, sum_a, sum_b) == 0) {
+        header.status = 0;
+    }
+    // back to the RAM-Writer-mode of the current ADC-Config
+    set_ram_writer_mode(job->axi_devs, ram_writer_mode_for(job->adcCfg.adc_mode));
+
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = sum_a;
+    iov[1].iov_len = sum_bytes;
+    iov[2].iov_base = sum_b;
+    iov[2].iov_len = sum_bytes;
+    zc.sock = job->sock_client;
+    zc.enabled = false;
+    zc_send_iov(&zc, iov, (header.status == 0) ? 3 : 1);
+    printf("Done Sweep-Averaging (status %d)...\n", header.status);
+
+    free(sum_a);
+    free(sum_b);
+}
 
-                        case ADC_CONFIG_ID:
-                            // Receive new ADC configuration
-                            receive_struct(sock_client, &adcCfg, AdcConfigBuffer, sizeof(AdcConfig));
-                            printf("\n### Received new ADC-Config ###\n");
-                            // Configure ADC
-                            rpa_config(axi_devs, adcCfg, verbose);
-                            // Configure RAM to enable/disable Block-Mode
-                            set_ram_writer_mode(axi_devs, adcCfg.adc_mode);
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            break;
+static void lut_calib_job(void* arg) {
+    // trigger-sweep with on-board correction of the LUT, sends only the final voltages
+    AdcJob* job = (AdcJob*)arg;
+    LutCalibResultHeader header = {LUT_CALIB_MAGIC, SERVER_ERROR_ID, 0, 0};
+    size_t result_bytes = (size_t)job->lutCalibCfg.no_triggers * sizeof(LutCalibResult);
+    LutCalibResult* results = malloc(result_bytes);
+    struct timespec t_start, t_end;
+    int ret = 0;
+
+    printf("##### Start LUT-Calibration: %d triggers on port %d #####\n", job->lutCalibCfg.no_triggers, job->lutCalibCfg.port_id);
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    if (results != NULL) {
+        ret = lut_calib_run(job->axi_devs, job->sock_client, job->trigger_irq, &job->lutCalibCfg, job->lut_calib_points,
+                            job->no_steps, results, &header, job->verbose);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+
+    if (ret == 0) {
+        ZcSocket zc;
+        struct iovec iov[2] = {{&header, sizeof(header)}, {results, result_bytes}};
+        zc.sock = job->sock_client;
+        zc.enabled = false;
+        zc_send_iov(&zc, iov, (results != NULL) ? 2 : 1);
+    }
+
+    int no_converged = 0;
+    for (int t = 0; results != NULL && t < job->lutCalibCfg.no_triggers; t++) no_converged += results[t].converged;
+    printf("Done LUT-Calibration (status %d): %d/%d triggers converged, %u measurements in %.1f s\n", header.status,
+           no_converged, job->lutCalibCfg.no_triggers, header.no_measurements,
+           (t_end.tv_sec - t_start.tv_sec) + (t_end.tv_nsec - t_start.tv_nsec) * 1e-9);
+
+    free(job->lut_calib_points);
+    job->lut_calib_points = NULL;
+    free(results);
+}
 
-                        case DAC_BRAM_CONFIG_ID:
-                            // Receive new BRAM-DAC configuration
-                            receive_struct(sock_client, &bramDacConfig, BramDacConfigBuffer, sizeof(BramDacConfig));
-                            printf("\n### Received new BRAM-DAC-config ###\n");
-                            // store new bramDacConfig at index port_id in bramDacConfig-array:
-                            // so we have acces to each config for each port only by knowing the port-id
-                            bramDacConfig_arr[bramDacConfig.port_id] = bramDacConfig;
-                            // TODOO: Add check if selected dac_bram_controller is running and skip the config???
-                            // ... not really needed when we dont disable DAC-Outputs after Config
-                            // Configure DacBramController for given port in bramDacConfig
-                            configDacBramController(axi_devs, bramDacConfig, verbose);
-                            // Write DAC-LUT-Values for selected BRAM-DAC-Port X (from file in lut/lut_port0.csv)
-                            write_dac_lut_from_config(axi_devs, bramDacConfig, verbose);
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            break;
+static void ram_test_job(void* arg) {
+    AdcJob* job = (AdcJob*)arg;
+    test_ram(job->axi_devs, job->sock_client, job->ramCfg, job->ram_writer_mode, job->no_tcp_packages, job->verbose);
+}
 
-                        case LUT_CONFIG_ID:
-                            // Handle LUT configuration (if needed)
-                            break;
+static void lia_debug_job(void* arg) {
+    AdcJob* job = (AdcJob*)arg;
+    lia_debug(job->axi_devs, job->sock_client, job->ramCfg, job->verbose);
+}
 
-                        case TRIGGER_CONFIG_ID:
-                            // receive new trigger-config:
-                            receive_struct(sock_client, &triggerConfig, TriggerConfigBuffer, sizeof(TriggerConfig));
-                            printf("\n### Received new Trigger-config ###\n");
-                            // config trigger generator with calculated values from host:
-                            config_trigger_generator(axi_devs, triggerConfig);
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            break;
+static void adc20_stream_job(void* arg) {
+    // streams raw frames of ADC20 Click, each package: AdcStreamHeader, uint16 raw[], uint8 ch_id[].
+    // If the stream can't be started or a read fails, a header with no_samples = 0 ends the stream.
+    AdcJob* job = (AdcJob*)arg;
+    Adc20Stream* stream = malloc(sizeof(Adc20Stream));
+    uint16_t raw[ADC20_STREAM_FRAMES_PER_PKG];
+    uint8_t ch_id[ADC20_STREAM_FRAMES_PER_PKG];
+    AdcStreamHeader header;
+    struct iovec iov[3];
+    StreamStats stats;
+    ZcSocket zc;
+    struct timespec t_start, t_end;
+
+    memset(&stats, 0, sizeof(stats));
+    zc.sock = job->sock_client;
+    zc.enabled = false;  // raw/ch_id buffers are reused for the next package
+
+    // frames are replayed from a captured frame-file if ADC20_REPLAY_FILE is set
+    if (stream == NULL || adc20_stream_init(stream, job->spi_fd, job->adc20_stop_ch, AVERAGE,
+                                            getenv(ADC20_REPLAY_ENV), getenv(ADC20_CAPTURE_ENV)) < 0) {
+        printf("Starting ADC20-Stream failed...\n");
+        header = (AdcStreamHeader){ADC20_STREAM_MAGIC, 0, 0, 0};
+        send_all(job->sock_client, &header, sizeof(header));
+        free(stream);
+        return;
+    }
 
-                        case DUMMY_DATA_GEN_CONFIG_ID:
-                            receive_struct(sock_client, &dummyCfg, dummyCfgBuffer, sizeof(DummyDataGenConfig));
-                            printf("\n### Received new Dummy-Data-Generator-Config ###\n");
-                            // config Dummy Data Generator with values from host:
-                            config_dummy_data_gen(axi_devs, dummyCfg, verbose);
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            break;
+    signal(SIGINT, SIG_DFL);
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    for (int i = 0; i < job->no_tcp_packages; i++) {
+        int rc = adc20_stream_read(stream, raw, ch_id, ADC20_STREAM_FRAMES_PER_PKG);
+
+        header.magic = ADC20_STREAM_MAGIC;
+        header.seq = (uint32_t)i;
+        header.overruns = stream->ch_errors;
+        header.no_samples = ADC20_STREAM_FRAMES_PER_PKG;
+        if (rc < 0) {
+            printf("ADC20-Stream stopped after %d/%d TCP-Packages\n", i, job->no_tcp_packages);
+            header.no_samples = 0;
+            send_all(job->sock_client, &header, sizeof(header));
+            break;
+        }
+
+        iov[0].iov_base = &header;
+        iov[0].iov_len = sizeof(header);
+        iov[1].iov_base = raw;
+        iov[1].iov_len = sizeof(raw);
+        iov[2].iov_base = ch_id;
+        iov[2].iov_len = sizeof(ch_id);
+        if (zc_send_iov(&zc, iov, 3) < 0) break;
+
+        stats.bytes_sent += sizeof(header) + sizeof(raw) + sizeof(ch_id);
+        stats.no_packages++;
+        TRACE_DEBUG("ADC20-Stream: package %d sent, %u channel-id errors", i, stream->ch_errors);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t_end);
+
+    stats.duration_s = (t_end.tv_sec - t_start.tv_sec) + (t_end.tv_nsec - t_start.tv_nsec) * 1e-9;
+    stats.mbytes_per_s = (stats.duration_s > 0) ? (stats.bytes_sent / 1e6) / stats.duration_s : 0;
+    stats.overruns = stream->ch_errors;
+    print_stream_stats("ADC20-Stream", &stats);
+    printf("    %.0f frames/s, %u frames with unexpected channel-id\n",
+           stats.no_packages * ADC20_STREAM_FRAMES_PER_PKG / (stats.duration_s > 0 ? stats.duration_s : 1), stream->ch_errors);
+
+    adc20_stream_close(stream);
+    free(stream);
+    signal(SIGINT, signal_handler);
+}
 
-                        case DUMMY_DATA_GEN_BRAM_ID:
-                            // Receive new data for Dummy-Data-Generator
-                            receive_struct(sock_client, &bramCfg, BramCfgBuffer, sizeof(BramConfig));
-                            printf("\n### Received new BRAM data ###\n");
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            write_dummy_data_gen_bram(axi_devs, bramCfg, verbose);
-                            break;
+static void adc20_stream_done(void* arg) {
+    // the SPI-bus is released when the job was collected (reactor-thread)
+    AdcJob* job = (AdcJob*)arg;
+    *job->adc20_streaming = false;
+}
 
-                        case LIA_MIXER_CONFIG_ID:
-                            // Receive new LIA-Mixer-Config
-                            receive_struct(sock_client, &liaMixerCfg, liaMixerCfgBuffer, sizeof(LiaMixerConfig));
-                            printf("\n### Received new LIA-Mixer-Config ###\n");
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            config_lia_mixer(axi_devs, liaMixerCfg, verbose);
-                            break;
+static void record_job(void* arg) {
+    // continous-mode into a file on the board, replies the no. of chunks written or SERVER_ERROR_ID
+    AdcJob* job = (AdcJob*)arg;
+    StreamStats stats;
+    char path[64];
+    int no_chunks = -1;
 
-                        case LIA_MIXER_BRAM_ID:
-                            // Receive new data for LIA-Mixer
-                            receive_struct(sock_client, &bramCfg, BramCfgBuffer, sizeof(BramConfig));
-                            printf("\n### Received new BRAM data ###\n");
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            write_lia_mixer_bram(axi_devs, bramCfg, verbose);
-                            break;
+    printf("##### Start Recording %d: %d chunks (%d samples each) #####\n", job->recCfg.rec_id, job->recCfg.no_chunks,
+           REC_CHUNK_SAMPLES);
+    signal(SIGINT, SIG_DFL);
+    if (rec_path(path, sizeof(path), job->recCfg.rec_id, job->recCfg.storage) == 0) {
+        set_ram_writer_mode(job->axi_devs, RAM_WRITER_CONTI_MODE);
+        no_chunks = record_adc_writer(job->axi_devs, job->ramCfg, path, job->adcCfg, job->recCfg.no_chunks,
+                                      job->adcCfg.sample_rate_divider, &stats);
+        disable_rp_adc(job->axi_devs);
+        disable_ram_writer(job->axi_devs);
+        // back to the RAM-Writer-mode of the current ADC-Config
+        set_ram_writer_mode(job->axi_devs, ram_writer_mode_for(job->adcCfg.adc_mode));
+    }
+    if (no_chunks >= 0) {
+        print_stream_stats("Recording", &stats);
+        printf("    lost chunks: %u\n", stats.overruns);
+    }
+    send_to_client(job->sock_client, (no_chunks >= 0) ? no_chunks : SERVER_ERROR_ID);
+    signal(SIGINT, signal_handler);
+}
 
-                        case LIA_IIR_CONFIG_ID:
-                            // Receive new IIR-Filter-Config
-                            receive_struct(sock_client, &liaIIRCfg, liaIIRCfgBuffer, sizeof(LiaIIRConfig));
-                            printf("\n### Received new IIR-Filter-Coefficents ###\n");
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            load_lia_iir_coeffs(axi_devs, liaIIRCfg, verbose);
-                            break;
+static int send_record_info(ClientConn* client, int rec_id) {
+    // replies ACK + RecFileHeader + RecChunkInfo[no_chunks] or SERVER_ERROR_ID
+    // (a running recording can be read, its index is rebuilt from the chunk-headers)
+    RecFileHeader header;
+    RecChunkInfo* index = NULL;
+    char path[64];
+    int ret = 0;
+
+    int fd = (rec_find(path, sizeof(path), rec_id) == 0) ? open(path, O_RDONLY | O_CLOEXEC) : -1;
+    if (fd < 0 || rec_load_index(fd, &header, &index) != 0) {
+        if (fd >= 0) close(fd);
+        reactor_reply(client, SERVER_ERROR_ID);
+        return 0;
+    }
+    close(fd);
+    reactor_reply(client, ACK);
+    if (send_all(client->sock, &header, sizeof(header)) != 0 ||
+        send_all(client->sock, index, header.no_chunks * sizeof(RecChunkInfo)) != 0) {
+        ret = -1;
+    }
+    free(index);
+    return ret;
+}
 
-                        case RAM_INIT_CONFIG_ID:
-                            // Initialize RAM with config from host
-                            receive_struct(sock_client, &ramInitCfg, ramInitCfgBuffer, sizeof(RamInitConfig));
-                            printf("\n### Received new RAM-Init-Config ###\n");
-                            ramCfg = init_ram(axi_devs, ramInitCfg);
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            break;
+static int send_lia_check(ClientConn* client, int n) {
+    // replies ACK + LiaCheckHeader + capture, reference-table and scalar output or SERVER_ERROR_ID
+    LiaCheckHeader header;
+    int ret = 0;
+
+    uint32_t* payload = lia_sw_check(n, &header);
+    if (payload == NULL) {
+        reactor_reply(client, SERVER_ERROR_ID);
+        return 0;
+    }
+    reactor_reply(client, ACK);
+    size_t payload_words = (size_t)header.no_samples + header.ref_len + 2 * (size_t)header.no_points;
+    if (send_all(client->sock, &header, sizeof(header)) != 0 ||
+        send_all(client->sock, payload, payload_words * sizeof(uint32_t)) != 0) {
+        ret = -1;
+    }
+    free(payload);
+    return ret;
+}
 
-                        case CLK_DIVIDER_CONFIG_ID:
-                            receive_struct(sock_client, &clockDividerConfig, ClockDividerConfigBuffer, sizeof(ClockDividerConfig));
-                            printf("\n### Received new Clock_Divider-Config ###\n");
-                            // config Clock_Divider with values from host:
-                            config_clock_divider(axi_devs, clockDividerConfig);
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            break;
+static void record_range_job(void* arg) {
+    // RecRangeHeader + samples of a recording, read and sent chunk by chunk
+    AdcJob* job = (AdcJob*)arg;
+    RecRangeRequest* req = &job->recRange;
+    RecRangeHeader header = {REC_RANGE_MAGIC, SERVER_ERROR_ID, 0, 0, req->first_sample};
+    RecFileHeader file_header;
+    RecChunkInfo* index = NULL;
+    uint32_t* samples = NULL;
+    char path[64];
+
+    int fd = (rec_find(path, sizeof(path), req->rec_id) == 0) ? open(path, O_RDONLY | O_CLOEXEC) : -1;
+    if (fd >= 0 && rec_load_index(fd, &file_header, &index) == 0 && (samples = malloc(REC_CHUNK_BYTES)) != NULL) {
+        // range is clipped to the end of the recording (last sample of the last chunk)
+        uint64_t end = (file_header.no_chunks > 0) ? index[file_header.no_chunks - 1].first_sample +
+                                                         index[file_header.no_chunks - 1].no_samples : 0;
+        uint64_t n = (req->first_sample < end) ? end - req->first_sample : 0;
+        if (n > req->no_samples) n = req->no_samples;
+        if (n > REC_MAX_RANGE_SAMPLES) n = REC_MAX_RANGE_SAMPLES;
+        header.status = 0;
+        header.no_samples = (uint32_t)n;
+        header.no_missing = rec_range_missing(index, file_header.no_chunks, req->first_sample, header.no_samples);
+    }
+
+    if (send_all(job->sock_client, &header, sizeof(header)) == 0 && header.status == 0) {
+        uint64_t pos = req->first_sample;
+        uint64_t end = req->first_sample + header.no_samples;
+        uint32_t no_missing;
+        while (pos < end) {
+            uint32_t n = (end - pos > REC_CHUNK_SAMPLES) ? REC_CHUNK_SAMPLES : (uint32_t)(end - pos);
+            // the header is already sent, on a read-error the client gets a short answer
+            if (rec_read_range(fd, index, file_header.no_chunks, pos, n, samples, &no_missing) != 0 ||
+                send_all(job->sock_client, samples, n * sizeof(uint32_t)) != 0) {
+                break;
+            }
+            pos += n;
+        }
+        printf("Sent %u samples of recording %d from sample %llu (%u missing)\n", header.no_samples, req->rec_id,
+               (unsigned long long)req->first_sample, header.no_missing);
+    }
+    if (fd >= 0) close(fd);
+    free(index);
+    free(samples);
+}
 
-                        case SPI_CONFIG_ID:
-                            receive_struct(sock_client, &spiCfg, spiCfgBuffer, sizeof(SpiConfig));
-                            printf("\n### Received new SPI-Config ###\n");
-                            spi_fd = setup_spi(spiCfg);
-                            // Send ACK to show Host-PC that configuration is done
-                            send_to_client(sock_client, CONFIG_DONE);
-                            
-                            break;
+static bool start_job(ServerState* s, ClientConn* client, WorkerJobFn job_fn, WorkerDoneFn done_fn, int ram_writer_mode) {
+    // only one job at a time, s->job is still used by a running job
+    if (worker_is_busy(&s->reactor.worker)) {
+        printf("Worker is busy with another job, command is rejected...\n");
+        reactor_reply(client, SERVER_ERROR_ID);
+        return false;
+    }
+
+    // the job accesses the devices directly (and may change the RAM-Writer-mode)
+    regcache_invalidate_all(&s->regcache);
+    s->active.ram_mode_valid = false;
+
+    // copy current configs for the job, so new configs from other clients don't change a running job
+    s->job.axi_devs = s->axi_devs;
+    s->job.sock_client = client->sock;
+    s->job.ramCfg = s->ramCfg;
+    s->job.adcCfg = s->adcCfg;
+    s->job.no_tcp_packages = s->no_tcp_packages;
+    s->job.no_regions = s->no_regions;
+    s->job.stream_mode = s->stream_mode;
+    s->job.no_steps = s->no_steps;
+    s->job.ram_writer_mode = ram_writer_mode;
+    s->job.spi_fd = s->spi_fd;
+    s->job.adc20_stop_ch = s->adc20_stop_ch;
+    s->job.adc20_streaming = &s->adc20_streaming;
+    s->job.lutCalibCfg = s->lutCalibCfg;
+    s->job.lut_calib_points = s->lut_calib_points;
+    s->job.trigger_irq = &s->trigger_irq;
+    s->job.liaStreamCfg = s->liaStreamCfg;
+    s->job.liaMixerCfg = s->liaMixerCfg;
+    s->job.liaIIRCfg = s->liaIIRCfg;
+    s->job.lia_ref = s->liaRef;
+    s->job.lia_ref_len = (s->liaStreamCfg.ref_len > 0) ? s->liaStreamCfg.ref_len : s->lia_ref_len;
+    s->job.recCfg = s->recCfg;
+    s->job.recRange = s->recRange;
+    s->job.verbose = s->verbose;
+
+    if (!reactor_start_job(&s->reactor, client, job_fn, done_fn, &s->job)) {
+        printf("Starting job on worker-thread failed...\n");
+        reactor_reply(client, SERVER_ERROR_ID);
+        return false;
+    }
+    return true;
+}
 
-                        default:
-                            printf("Config-ID %d not implemented yet...\n", (int)command.val);
-                            break;
-                    }
-                    break;
+static bool receive_config(ClientConn* client, void* cfg, size_t size) {
+    // config-struct following the command (ACK is sent before), false while it is still on the
+    // way: the handler returns and is called again when it is received
+    const void* payload = reactor_payload(client, 0, size);
+    if (payload == NULL) return false;
+    memcpy(cfg, payload, size);
+    return true;
+}
 
-                case SET_RP_DAC_NO_CALIB:
-                    // Set raw voltage on RP-DAC (used when calibrating the DACs)
-                    set_voltage_on_DAC_no_calib(axi_devs, RP_DAC_ID, command.ch, command.val, verbose);
-                    break;
+static int receive_bram_upload(ServerState* s, ClientConn* client, void* bram, uint32_t bram_words) {
+    // BramUploadHeader + words, replies CONFIG_DONE or SERVER_ERROR_ID, BRAM_UPLOAD_PENDING while it
+    // is still on the way (on error the connection has to be closed, the rest of the upload is still in the socket)
+    const void* payload = reactor_payload(client, 0, sizeof(BramUploadHeader));
+    if (payload == NULL) return BRAM_UPLOAD_PENDING;
+    memcpy(&s->bramUploadHeader, payload, sizeof(BramUploadHeader));
+    if (bram_upload_check(&s->bramUploadHeader, bram_words) != BRAM_UPLOAD_OK) {
+        reactor_reply(client, SERVER_ERROR_ID);
+        return BRAM_UPLOAD_ERR_HEADER;
+    }
+    const uint32_t* words = reactor_payload(client, sizeof(BramUploadHeader), s->bramUploadHeader.no_words * sizeof(uint32_t));
+    if (words == NULL) return BRAM_UPLOAD_PENDING;
+    bram_upload_write(bram, &s->bramUploadHeader, words);
+
+    printf("\n### Received new BRAM data: %u words at offset %u ###\n", s->bramUploadHeader.no_words,
+           s->bramUploadHeader.offset);
+    // Send ACK to show Host-PC that configuration is done
+    reactor_reply(client, CONFIG_DONE);
+    return BRAM_UPLOAD_OK;
+}
 
-                case SET_RP_DAC:
-                    // Set voltage on RP-DAC
-                    set_voltage_on_DAC(axi_devs, RP_DAC_ID, command.ch, command.val, verbose);
-                    break;
+// command-sequence running on the worker-thread (allocated by run_sequence, freed by seq_done)
+typedef struct {
+    Reactor* reactor;
+    ClientConn* client;  // socket is owned by the job, replies are captured
+    SeqProgramHeader header;
+    SeqOp* ops;
+    SeqResult* results;
+    SeqResultHeader result_header;
+    CmdResult result;  // result of the last command (connection closed/shutdown stops the program)
+} SeqJob;
+
+static bool seq_exec_command(void* arg, TcpCmd command, int32_t* status, int32_t* value) {
+    SeqJob* job = (SeqJob*)arg;
+    BatchResp resp;
+
+    // the connection can't be closed from the worker-thread
+    if (command.id == EXIT_APP || command.id == TERMINATE_CLIENT || command.id == CLIENT_DISCONNECT) {
+        *status = BATCH_STATUS_NOT_ALLOWED;
+        *value = 0;
+        return true;
+    }
+    job->result = reactor_exec_captured(job->reactor, job->client, command, &resp);
+    *status = resp.status;
+    *value = resp.value;
+    return job->result == CMD_KEEP_CONNECTION;
+}
 
-                case SET_AD_DAC:
-                    // Set voltage on external AD-DAC
-                    set_voltage_on_DAC(axi_devs, AD_DAC_ID, command.ch, command.val, verbose);
-                    break;
+static void seq_job(void* arg) {
+    SeqJob* job = (SeqJob*)arg;
+    seq_run(&job->header, job->ops, seq_exec_command, job, job->results, &job->result_header);
+}
 
-                case GET_RF_ADC:
-                    // Read voltage on fast ADC and send to the client
-                    voltage_mV = (int)(rpa_get_voltage(axi_devs, command.ch, true, command.val) * 1000);
-                    if (verbose) printf("\t voltage measured on fast ADC on channel %d : %d mV \n", command.ch, voltage_mV);
-                    send_to_client(sock_client, voltage_mV);
-                    break;
+static void seq_done(void* arg) {
+    // sends SeqResultHeader + results, a failed command or send closes the connection
+    SeqJob* job = (SeqJob*)arg;
+    SeqResultHeader* result_header = &job->result_header;
+
+    printf("Sequence finished with status %d: %u results in %llu us, %u late deadlines\n", result_header->status,
+           result_header->no_results, (unsigned long long)(result_header->t_total_ns / 1000), result_header->no_late);
+    if (send_all(job->client->sock, result_header, sizeof(SeqResultHeader)) != 0 ||
+        send_all(job->client->sock, job->results, result_header->no_results * sizeof(SeqResult)) != 0) {
+        printf("Sequence: sending result to client failed\n");
+        job->result = CMD_CLOSE_CONNECTION;
+    }
+    // the reactor closes the client when the socket is readable again
+    if (job->result != CMD_KEEP_CONNECTION) shutdown(job->client->sock, SHUT_RDWR);
+    free(job->ops);
+    free(job->results);
+    free(job);
+}
 
-                case GET_RF_ADC_CNT:
-                    // Read ADC count on RF-ADC channel and send to the client
-                    adc_cnt = rpa_get_raw_value(axi_devs, command.ch);
-                    if (verbose) printf("\t adc cnt on RF-ADC ch: %d : %x \n", command.ch, adc_cnt);
-                    send_to_client(sock_client, adc_cnt);
-                    break;
+static CmdResult run_sequence(ServerState* s, ClientConn* client) {
+    // receives the program and executes it on the worker-thread (other clients are served
+    // meanwhile, their commands are serialized with the ones of the program), seq_done()
+    // sends SeqResultHeader + results, SERVER_ERROR_ID for invalid programs
+    SeqProgramHeader header;
+
+    const void* payload = reactor_payload(client, 0, sizeof(SeqProgramHeader));
+    if (payload == NULL) return CMD_KEEP_CONNECTION;
+    memcpy(&header, payload, sizeof(SeqProgramHeader));
+    if (header.magic != SEQ_PROGRAM_MAGIC || header.version != SEQ_PROTOCOL_VERSION || header.no_ops == 0 ||
+        header.no_ops > SEQ_MAX_OPS || header.max_results > SEQ_MAX_RESULTS) {
+        printf("Sequence: invalid program-header (magic: 0x%08X, version: %u, %u ops, %u results)\n", header.magic,
+               header.version, header.no_ops, header.max_results);
+        // the ops are still in the socket
+        reactor_reply(client, SERVER_ERROR_ID);
+        return CMD_CLOSE_CONNECTION;
+    }
+
+    payload = reactor_payload(client, sizeof(SeqProgramHeader), header.no_ops * sizeof(SeqOp));
+    if (payload == NULL) return CMD_KEEP_CONNECTION;
+
+    SeqJob* job = calloc(1, sizeof(SeqJob));
+    if (job != NULL) {
+        job->ops = malloc(header.no_ops * sizeof(SeqOp));
+        job->results = malloc((header.max_results > 0 ? header.max_results : 1) * sizeof(SeqResult));
+    }
+    if (job == NULL || job->ops == NULL || job->results == NULL) {
+        if (job != NULL) {
+            free(job->ops);
+            free(job->results);
+        }
+        free(job);
+        reactor_reply(client, SERVER_ERROR_ID);
+        return CMD_KEEP_CONNECTION;
+    }
+    memcpy(job->ops, payload, header.no_ops * sizeof(SeqOp));
+    if (seq_check_program(&header, job->ops) != 0) {
+        free(job->ops);
+        free(job->results);
+        free(job);
+        reactor_reply(client, SERVER_ERROR_ID);
+        return CMD_KEEP_CONNECTION;
+    }
+    job->reactor = &s->reactor;
+    job->client = client;
+    job->header = header;
+    job->result = CMD_KEEP_CONNECTION;
+
+    if (!reactor_start_job(&s->reactor, client, seq_job, seq_done, job)) {
+        printf("Worker is busy with another job, sequence is rejected...\n");
+        free(job->ops);
+        free(job->results);
+        free(job);
+        reactor_reply(client, SERVER_ERROR_ID);
+    }
+    return CMD_KEEP_CONNECTION;
+}
 
-                case SET_PDM:
-                    // Set voltage on PDM and enable PDM output
-                    set_voltage_pdm(axi_devs, command.ch, command.val);
-                    enable_pdm_output(axi_devs, command.ch);
-                    break;
+static void reply_trigger_armed(int sock_client, TriggerIrq* irq, int cmd_id, int ret) {
+    // wavelength-request to the Host-PC (SERVER_ERROR_ID if the trigger is not armed within
+    // the timeout), REARM_TRIGGER has no reply
+    if (cmd_id == REARM_TRIGGER) return;
+    if (ret != 0) {
+        send_to_client(sock_client, SERVER_ERROR_ID);
+        return;
+    }
+    send_to_client(sock_client, REQ_WLENGTH);
+    trigger_irq_notified(irq);
+}
 
-                case GET_XADC:
-                    // Read XADC ports and return voltage for the selected channel
-                    voltage_mV = (int)(xad_get_voltage(axi_devs, command.ch) * 1000);
-                    if (verbose) printf("\t voltage measured: %d \n", voltage_mV);
-                    send_to_client(sock_client, voltage_mV);
-                    break;
+static CmdResult trigger_armed(void* ctx, ClientConn* client, TcpCmd command, bool timeout) {
+    // trigger-armed event (or timeout) of the command waiting in request_wavelength()
+    ServerState* s = (ServerState*)ctx;
+    int ret = -1;
+
+    if (timeout) {
+        trigger_irq_timeout(&s->trigger_irq, TRIGGER_IRQ_TIMEOUT_MS);
+    } else {
+        ret = trigger_irq_event(&s->trigger_irq);
+    }
+    reply_trigger_armed(client->sock, &s->trigger_irq, command.id, ret);
+    return CMD_KEEP_CONNECTION;
+}
 
-                case START_DAC_SWEEP:
-                    // Start DAC sweep for an infinite amount of time
-                    // TODO: Use separated Resets so we can Config dac-bram-controllers independent from others while they are currently running
-                    // enable module for synchronizing bram-ctrl:
-                    enable_module(axi_devs, RESET_INDEX_BRAM_CTRL_SYNC);
-                    start_bram_dac_output(axi_devs, command.ch);  // start bram-dac-output for selected BramDac-Port
-                    printf("###### Started LUT-DAC-Output for port %d ######\n", command.ch);
-                    break;
+static void trigger_wait_job(void* arg) {
+    // polling-mode (no UIO-device): wait_for_wlength_request() spins without timeout
+    AdcJob* job = (AdcJob*)arg;
+    job->trigger_ret = trigger_irq_wait(job->trigger_irq, job->axi_devs, TRIGGER_IRQ_TIMEOUT_MS);
+}
 
-                case STOP_DAC_SWEEP:
-                    // Stop DAC sweep, reset module, and exit application
-                    printf("Laser-Tuning stopped...\n");
-                    stop_bram_dac_output(axi_devs, command.ch);
-                    break;
+static void trigger_wait_done(void* arg) {
+    AdcJob* job = (AdcJob*)arg;
+    reply_trigger_armed(job->sock_client, job->trigger_irq, job->trigger_cmd, job->trigger_ret);
+}
 
-                case START_TRIGGER_SWEEP:
-                    // entry point for DAC-Sweep with trigger-handshake for measuring wavelenght during a sweep
-                    // for usage with trigger_generator-IP
-                    // expects the bram-port-id as channel-value (command.ch)
-                    disable_module(axi_devs,RESET_INDEX_TRIGGER_GEN);// disable before starting the other modules
-                    trigger_sweep_index = 0; // reset sweep-index for a new sweep:
-                    no_total_trigger    = command.val;
-                    printf("Start Trigger-Sweep for bram-port: %d and %d trigger: ####\n",command.ch,no_total_trigger);
-                    // enable needed modules:
-                    enable_module(axi_devs, RESET_INDEX_DAC_BRAM_CTRL_PORT0);
-                    enable_module(axi_devs, RESET_INDEX_BRAM_CTRL_SYNC);
-                    enable_module(axi_devs, RESET_INDEX_TRIGGER_GEN);
-                    // start output:
-                    start_bram_dac_output(axi_devs, command.ch);
-                    // wait till first trigger gets armed on FPGA-Logic
-                    wait_for_wlength_request(axi_devs);
-                    // now send request to Host-PC to read out measured wavelength at trigger
-                    send_to_client(sock_client, REQ_WLENGTH);
-                    printf("## Armed first trigger %d  for trigger-sweep with %d trigger:\n", (trigger_sweep_index + 1), no_total_trigger);
-                    break;
+static void request_wavelength(ServerState* s, ClientConn* client, TcpCmd command) {
+    // waits till the trigger is armed by the FPGA-Logic and sends the wavelength-request:
+    // the trigger-event completes the command on the reactor (trigger_armed), in polling-mode
+    // the wait runs on the worker-thread, so other clients are served meanwhile
+    int fd = trigger_irq_fd(&s->trigger_irq);
+
+    if (fd >= 0) {
+        if (!reactor_wait_event(&s->reactor, client, command, fd, TRIGGER_IRQ_TIMEOUT_MS, trigger_armed)) {
+            printf("Another client waits for the trigger already...\n");
+            reply_trigger_armed(client->sock, &s->trigger_irq, command.id, -1);
+        }
+        return;
+    }
+    if (command.id == REARM_TRIGGER && worker_is_busy(&s->reactor.worker)) {
+        printf("Worker is busy, not waiting for the rearmed trigger...\n");
+        return;
+    }
+    s->job.trigger_cmd = command.id;
+    start_job(s, client, trigger_wait_job, trigger_wait_done, 0);
+}
 
-                case NEXT_TRIGGER:
-                    // make sure to release the trigger before selecting the next-trigger
-                    // increment trigger-ref to select next trigger-timestep, clears check-wavelength
-                    select_next_trigger(axi_devs);
-                    printf("## Wavelength measured for %d/%d\n", (trigger_sweep_index + 1), no_total_trigger);
-                    // wait for trigger beeing armed by FPGA-Logic
-                    wait_for_wlength_request(axi_devs);
-                    // now send request to Host-PC to read out measured wavelength at trigger
-                    send_to_client(sock_client, REQ_WLENGTH);
-                    printf("## Requested wavelength for next trigger %d/%d\n", (trigger_sweep_index + 2), no_total_trigger);
-                    trigger_sweep_index++;
-                    if ((trigger_sweep_index + 1) == no_total_trigger) {
-                        printf("## Wavelength measured for last Trigger %d/%d \n", (trigger_sweep_index + 1), no_total_trigger);
-                        printf("## Finished Trigger-Sweep! ############################ \n");
-                    }
-                    break;
+static int trigger_latency_stat(TriggerIrq* irq, int stat) {
+    TriggerIrqStats snapshot;
+    TriggerIrqStats* stats = &snapshot;
+
+    trigger_irq_get_stats(irq, stats);
+    switch (stat) {
+        case TRIGGER_STAT_LAST_US:
+            return (int)(stats->last_ns / 1000);
+        case TRIGGER_STAT_MEAN_US:
+            return stats->no_events > 0 ? (int)(stats->sum_ns / stats->no_events / 1000) : 0;
+        case TRIGGER_STAT_MAX_US:
+            return (int)(stats->max_ns / 1000);
+        case TRIGGER_STAT_EVENTS:
+            return (int)stats->no_events;
+        case TRIGGER_STAT_TIMEOUTS:
+            return (int)stats->no_timeouts;
+        case TRIGGER_STAT_RESET:
+            trigger_irq_reset_stats(irq);
+            return ACK;
+        default:
+            return SERVER_ERROR_ID;
+    }
+}
 
-                case REARM_TRIGGER:
-                    // if wavelength-measurement failed or timed-out
-                    // we want to measure the wavelength again for the same trigger, so we rearm it
-                    rearm_current_trigger(axi_devs);
-                    printf("### Rearmed current trigger %d/%d", (trigger_sweep_index + 1), no_total_trigger);
-                    wait_for_wlength_request(axi_devs);
-                    break;
+static bool allowed_in_batch(int cmd_id) {
+    // commands which read more data from the socket, send more than one value or
+    // wait for the trigger can't be used inside a batch-frame
+    switch (cmd_id) {
+        case NEW_CONFIG:
+        case ADJ_LUT_VALUE:
+        case START_TRIGGER_SWEEP:
+        case NEXT_TRIGGER:
+        case REARM_TRIGGER:
+        case START_ADC_SAMPLING:
+        case RAM_TEST_BLOCK_MODE:
+        case RAM_TEST_CONTI_MODE:
+        case LIA_DEBUG:
+        case START_SEQ_SAMPLING_ADC24:
+        case START_SEQ_SAMPLING_ADC20:
+        case START_STREAM_ADC20:
+        case GET_WINDOW_ADC24:
+        case START_SWEEP_AVG:
+        case GET_LUT_BIN:
+        case START_LUT_CALIB:
+        case START_SEQUENCE:
+        case START_RECORD:
+        case GET_RECORD_INFO:
+        case GET_RECORD_RANGE:
+        case GET_STATS:
+            return false;
+        default:
+            return true;
+    }
+}
 
-                case HOLD_TRIGGER:
-                    // holds output-trigger high at current-trigger point until we select-next trigger
-                    // ..setting rearm-trigger constantly to 1
-                    // so there is no need for rearming all the time
-                    printf("### Hold current trigger %d \n",(trigger_sweep_index+1));
-                    hold_current_trigger(axi_devs);
-                    break;
+static bool spi_bus_busy(ServerState* s, ClientConn* client, TcpCmd command) {
+    // while the ADC24-Scanner or the ADC20-Stream (worker-thread) is running it owns the SPI-bus,
+    // commands which would access the bus directly are rejected (with an error-reply if the client waits for one)
+    bool scanner = adc24_scanner_is_running(&s->adc24_scanner);
+    if (!scanner && !s->adc20_streaming) return false;
+
+    switch (command.id) {
+        case GET_VOLTAGE_ADC20:
+        case START_STREAM_ADC20:
+            reactor_reply(client, SERVER_ERROR_ID);
+            break;
+        case START_SEQ_SAMPLING_ADC20:
+            for (int i = 0; i <= command.ch; i++) reactor_reply(client, SERVER_ERROR_ID);
+            break;
+        case START_SEQ_SAMPLING_ADC24: {
+            // the scanner answers from its latest samples
+            if (scanner) return false;
+            int size = (command.ch >= 0 && command.ch < ADC24_SCAN_NO_CHANNELS) ? command.ch + 1 : 1;
+            for (int i = 0; i < size; i++) reactor_reply(client, SERVER_ERROR_ID);
+            break;
+        }
+        case INIT_ADC24:
+        case INIT_ADC20:
+        case READ_REG_ADC20:
+        case ADC20_DEBUG_CMD:
+        case SPI_TEST:
+            break;
+        default:
+            return false;
+    }
+    if (scanner) {
+        printf("SPI-Bus is used by the ADC24-Scanner, command %d is rejected (STOP_ADC24_SCAN first)...\n", command.id);
+    } else {
+        printf("SPI-Bus is used by the ADC20-Stream, command %d is rejected...\n", command.id);
+    }
+    return true;
+}
 
-                case RELEASE_TRIGGER:
-                    // make sure to wait some time inbetween releasing the trigger and
-                    // selecting the next trigger... the time you need to sleep
-                    // depends on the DAC-SIGNAL-PERIOD (dac-dwell-time * dac-no-steps)
-                    printf("Trigger %d got released",(trigger_sweep_index+1));
-                    release_current_trigger(axi_devs);
-                    send_to_client(sock_client,ACK);
-                    break;
+static AxiDevs stage_config(ServerState* s) {
+    // AxiDevs for a config-function: cached devices are written by regcache_flush() afterwards
+    // (a running job may access the devices directly)
+    if (worker_is_busy(&s->reactor.worker)) regcache_invalidate_all(&s->regcache);
+    return regcache_begin(&s->regcache);
+}
 
-                case ADJ_LUT_VALUE:
-                    //inputs: - which Bram-Port?... from that we have access to bramDacConfig through bramDacConfig_arr
-                    printf("Received command to adjust LUT-Value:\n");
-                    // receive new LUT-Value-Struct:
-                    receive_struct(sock_client, &lutValue, LutValueBuffer, sizeof(LutValue));
-                    // apply new LutValue:
-                    change_value_in_lut(axi_devs, lutValue, verbose);
-
-                    // for first value in LUT we also want to adjust the last value in LUT
-                    if (lutValue.index == 0) {
-                        change_value_in_lut_at_index(axi_devs, lutValue, bramDacConfig_arr[lutValue.port_id].no_steps - 1, verbose);
-                    }
-                    printf("Received adjusted tuning voltage: %fV for trigger %d \n", lutValue.voltage, (trigger_sweep_index + 1));
-                    // now repeat wlength measurement for same trigger:
-                    rearm_current_trigger(axi_devs);
-                    // wait till trigger is armed by FPGA
-                    wait_for_wlength_request(axi_devs);
-                    // send wlength request to HOST-PC to measure wavelength at trigger:
-                    send_to_client(sock_client, REQ_WLENGTH);
-                    break;
+static void regcache_direct_access(ServerState* s, TcpCmd command) {
+    // commands which access cached devices directly, the shadow is read back before the next config
+    bool port_valid = command.ch >= 0 && command.ch < NO_DAC_BRAM_INTERFACES_USED;
+
+    switch (command.id) {
+        case GET_RF_ADC:
+        case GET_RF_ADC_CNT:
+            regcache_invalidate(&s->regcache, s->axi_devs.adc);
+            break;
+        case START_TRIGGER_SWEEP:
+            regcache_invalidate(&s->regcache, s->axi_devs.trigger_gen);
+            // fall through
+        case START_DAC_SWEEP:
+        case STOP_DAC_SWEEP:
+            if (port_valid) regcache_invalidate(&s->regcache, s->axi_devs.dac_bram_ctrl[command.ch]);
+            break;
+        case NEXT_TRIGGER:
+        case REARM_TRIGGER:
+        case HOLD_TRIGGER:
+        case RELEASE_TRIGGER:
+        case ADJ_LUT_VALUE:
+            regcache_invalidate(&s->regcache, s->axi_devs.trigger_gen);
+            break;
+        case EXIT_APP:
+            regcache_invalidate_all(&s->regcache);
+            break;
+        default:
+            break;
+    }
+}
 
-                case STORE_LUT:
-                    // we expect a port_id for the LUT/DAC-BRAM-Controller-Port we want to store the LUT (via channel-id)
-                    store_adj_lut_to_file(axi_devs,bramDacConfig_arr[command.ch],verbose);
-                    printf("Stored LUT for DAC-BRAM-CONRTOLLER at Port %d\n",command.ch);
-                    break;
+static CmdResult handle_command(void* ctx, ClientConn* client, TcpCmd command) {
+    // handles one command received from client, all requests from the application connected via tcp
+    ServerState* s = (ServerState*)ctx;
+    AxiDevs axi_devs = s->axi_devs;
+    bool verbose = s->verbose;
+    int sock_client = client->sock;
 
-                case START_ADC_SAMPLING:
-                    signal(SIGINT, SIG_DFL);  // so that we can go outside here if we need to interrupt...
-                    printf("received start ADC-Sampling command...\n");
-                    no_tcp_packages = (int)command.val;  // send amount of tcp package we wan to sample when sending startADC sampling request!
-                    switch (adcCfg.adc_mode) {
-                        case ADC_CONTINOUS_MODE:
-                            /* continous mode for ADC-Sampling till 15.626 MS/s*/
-                            printf("##### Start ADC-RAM-TCP-Writer in Continous-Mode for %d TCP-Packages #####\n", no_tcp_packages);
-                            cont_adc_writer(axi_devs, sock_client, ramCfg, no_tcp_packages, adcCfg.sample_rate_divider, verbose);
-                            break;
-                        case ADC_BLOCK_MODE:
-                            /* single shot block-mode with upto 125MS/s */
-                            printf("##### Start ADC-RAM-TCP-Writer in Block-Mode for %d TCP-Packages #####\n", no_tcp_packages);
-                            block_adc_writer(axi_devs, sock_client, ramCfg, verbose);
-                            break;
-                        case ADC_LIA_MODE:
-                            /* apply LIA on sampled ADC data and send via tcp*/
-                            printf("#### Start LIA-ADC-RAM-TCP-Writer for %d Blocks\n",no_tcp_packages);
-                            //lia_adc_writer(axi_devs, sock_client, no_tcp_packages, ramCfg);
-                        default:
-                            printf("ADC-Mode not available...\n");
-                            break;
+    int size; int *ptr;
+
+    // for storing read-out-voltage from get-functions...
+    int voltage_mV, adc_cnt;
+
+    // for DAC-BRAM Info
+    int sample_rate_cnt, signal_rate_cnt;
+
+    TRACE_DEBUG(">> msg_received: ID: %d , channel: %d ,value: %f", command.id, command.ch, command.val);
+
+    if (client->in_batch && !allowed_in_batch(command.id)) {
+        printf("Command with ID %d is not allowed inside a batch...\n", command.id);
+        reactor_set_status(client, BATCH_STATUS_NOT_ALLOWED);
+        return CMD_KEEP_CONNECTION;
+    }
+
+    if (spi_bus_busy(s, client, command)) return CMD_KEEP_CONNECTION;
+    regcache_direct_access(s, command);
+
+    switch (command.id) {
+        case NEW_CONFIG:
+            switch ((int)command.val) {
+                case DAC_CONFIG_ID: {
+                    // Receive new DAC configuration
+                    if (!receive_config(client, &s->dacCfg, sizeof(DacConfig))) break;
+                    printf("\n### Received new DAC-Config ###\n");
+                    uint32_t changed = config_diff(s->active.dac_valid, &s->active.dac, &s->dacCfg, dac_config_fields, DAC_CONFIG_NO_FIELDS);
+                    if (verbose) config_diff_print("DAC-Config", changed, dac_config_fields, DAC_CONFIG_NO_FIELDS);
+                    uint32_t applied = CONFIG_APPLIED_NONE;
+                    if (changed != 0) {
+                        // Configure and initialize output to init-state
+                        init_dac_module(axi_devs, s->dacCfg, false);  // Do not reset DAC-Outputs afer conifg (false)
+                        s->active.dac = s->dacCfg;
+                        s->active.dac_valid = true;
+                        applied |= CONFIG_APPLIED_REGS;
                     }
-                    printf("Done sampling ADC...\n");
-                    disable_rp_adc(axi_devs);
-                    disable_ram_writer(axi_devs);
-                    signal(SIGINT, signal_handler);
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, config_done_reply(command.ch, applied, 0));
                     break;
-
-                case SET_LED:
-                    turn_on_leds(axi_devs, (int) command.val);
+                }
+
+                case ADC_CONFIG_ID: {
+                    // Receive new ADC configuration
+                    if (!receive_config(client, &s->adcCfg, sizeof(AdcConfig))) break;
+                    printf("\n### Received new ADC-Config ###\n");
+                    uint32_t changed = config_diff(s->active.adc_valid, &s->active.adc, &s->adcCfg, adc_config_fields, ADC_CONFIG_NO_FIELDS);
+                    if (verbose) config_diff_print("ADC-Config", changed, adc_config_fields, ADC_CONFIG_NO_FIELDS);
+                    uint32_t applied = CONFIG_APPLIED_NONE, writes = 0;
+                    if (changed != 0) {
+                        // Configure ADC (only changed registers are written)
+                        rpa_config(stage_config(s), s->adcCfg, verbose);
+                        writes = regcache_flush(&s->regcache, verbose);
+                        applied |= CONFIG_APPLIED_REGS;
+                    }
+                    hal_sim_set_sample_rate_divider(s->adcCfg.sample_rate_divider);  // no-op on the FPGA
+                    if ((changed & CONFIG_FIELD_BIT(ADC_FIELD_ADC_MODE)) || !s->active.ram_mode_valid) {
+                        // Configure RAM to enable/disable Block-Mode
+                        set_ram_writer_mode(axi_devs, ram_writer_mode_for(s->adcCfg.adc_mode));
+                        applied |= CONFIG_APPLIED_RAM_MODE;
+                        s->active.ram_mode_valid = true;
+                    }
+                    s->active.adc = s->adcCfg;
+                    s->active.adc_valid = true;
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, config_done_reply(command.ch, applied, writes));
                     break;
-
-                case EXIT_APP:
-                    printf("exit application...\n");
-                    reset_system(axi_devs, true);  // forced reset on all modules...
-                    close(sock_client);
-                    close(sock_server);
-                    // reset interrupt signal
-                    signal(SIGINT, SIG_DFL);
-                    goto server_shutdown;
-
-                case TERMINATE_CLIENT:
-                    // when receiving a terminate-client command from Python (executed before closing python-socket)
-                    goto exit_client_connection;
-
-                case CLIENT_DISCONNECT:
-                    // when receiving invalid data we close client-socket
-                    goto exit_client_connection;
-
-                case GET_DAC_BRAM_SAMPLE_CNT:
-                    // Read ADC count on RF-ADC channel and send to the client
-                    sample_rate_cnt = get_sample_rate_bram_no_clocks(axi_devs, command.ch);
-                    send_to_client(sock_client, sample_rate_cnt);
+                }
+
+                case DAC_BRAM_CONFIG_ID: {
+                    // Receive new BRAM-DAC configuration
+                    if (!receive_config(client, &s->bramDacConfig, sizeof(BramDacConfig))) break;
+                    printf("\n### Received new BRAM-DAC-config ###\n");
+                    int port = s->bramDacConfig.port_id;
+                    if (port < 0 || port >= NO_DAC_BRAM_INTERFACES_USED) {
+                        printf("Invalid DAC-BRAM-Port %d...\n", port);
+                        reactor_reply(client, SERVER_ERROR_ID);
+                        break;
+                    }
+                    // store new bramDacConfig at index port_id in bramDacConfig-array:
+                    // so we have acces to each config for each port only by knowing the port-id
+                    s->bramDacConfig_arr[port] = s->bramDacConfig;
+                    uint32_t changed = config_diff(s->active.bram_valid[port], &s->active.bram[port], &s->bramDacConfig,
+                                                   bram_dac_config_fields, BRAM_DAC_CONFIG_NO_FIELDS);
+                    if (verbose) config_diff_print("BRAM-DAC-Config", changed, bram_dac_config_fields, BRAM_DAC_CONFIG_NO_FIELDS);
+                    uint32_t applied = CONFIG_APPLIED_NONE, writes = 0;
+                    // TODOO: Add check if selected dac_bram_controller is running and skip the config???
+                    // ... not really needed when we dont disable DAC-Outputs after Config
+                    if (changed != 0) {
+                        // Configure DacBramController for given port in bramDacConfig
+                        configDacBramController(stage_config(s), s->bramDacConfig, verbose);
+                        writes = regcache_flush(&s->regcache, verbose);
+                        s->active.bram[port] = s->bramDacConfig;
+                        s->active.bram_valid[port] = true;
+                        applied |= CONFIG_APPLIED_REGS;
+                    }
+                    LutSource source;
+                    lut_source_get(&source, port, s->lut_bin_pending[port]);
+                    if (s->lut_bin_pending[port]) {
+                        // LUT was already written into the BRAM by a binary upload
+                        s->lut_bin_pending[port] = false;
+                        printf("Using binary LUT for port %d, no LUT from .csv-file\n", port);
+                    } else if (s->active.lut_valid[port] && !(changed & BRAM_LUT_FIELDS) &&
+                               lut_source_equal(&s->active.lut_source[port], &source)) {
+                        printf("LUT of port %d is unchanged, no reload\n", port);
+                    } else {
+                        // Write DAC-LUT-Values for selected BRAM-DAC-Port X (from file in lut/lut_port0.csv)
+                        write_dac_lut_from_config(axi_devs, s->bramDacConfig, verbose);
+                        applied |= CONFIG_APPLIED_LUT;
+                    }
+                    s->active.lut_source[port] = source;
+                    s->active.lut_valid[port] = true;
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, config_done_reply(command.ch, applied, writes));
                     break;
-
-                case GET_DAC_BRAM_SIGNAL_CNT:
-                    // Read ADC count on RF-ADC channel and send to the client
-                    signal_rate_cnt = get_signal_rate_bram_no_clocks(axi_devs, command.ch);
-                    send_to_client(sock_client, signal_rate_cnt);
+                }
+
+                case LUT_CONFIG_ID: {
+                    // Receive binary LUT (LutBinHeader + DAC-codes) and write it directly into the BRAM,
+                    // voltages (LUT_BIN_VERSION_VOLTAGE) are converted with the DAC of the last DAC-Config
+                    struct timespec t_end;
+                    const void* payload = reactor_payload(client, 0, sizeof(LutBinHeader));
+                    if (payload == NULL) {
+                        clock_gettime(CLOCK_MONOTONIC, &s->lut_bin_t_start);
+                        break;
+                    }
+                    memcpy(&s->lutBinHeader, payload, sizeof(LutBinHeader));
+                    if (lut_bin_check_header(&s->lutBinHeader) != LUT_BIN_OK) {
+                        // the rest of the LUT is still in the socket after an invalid header
+                        reactor_reply(client, SERVER_ERROR_ID);
+                        return CMD_CLOSE_CONNECTION;
+                    }
+                    size_t code_bytes = s->lutBinHeader.no_steps * sizeof(uint32_t);
+                    payload = reactor_payload(client, sizeof(LutBinHeader), code_bytes);
+                    if (payload == NULL) break;
+                    memcpy(s->lutBinCodes, payload, code_bytes);
+                    if (lut_bin_check_codes(&s->lutBinHeader, s->lutBinCodes) != LUT_BIN_OK) {
+                        reactor_reply(client, SERVER_ERROR_ID);
+                        break;
+                    }
+                    if (s->lutBinHeader.version == LUT_BIN_VERSION_VOLTAGE) {
+                        if (lut_bin_write_voltages(axi_devs, &s->lutBinHeader, s->lutBinCodes, s->dacCfg.dev_id) != LUT_BIN_OK) {
+                            reactor_reply(client, SERVER_ERROR_ID);
+                            break;
+                        }
+                    } else {
+                        lut_bin_write_bram(axi_devs, &s->lutBinHeader, s->lutBinCodes);
+                    }
+                    s->active.lut_valid[s->lutBinHeader.port_id] = false;
+                    clock_gettime(CLOCK_MONOTONIC, &t_end);
+
+                    // LUT-size and DAC-port are needed by ADJ_LUT_VALUE/STORE_LUT
+                    s->bramDacConfig_arr[s->lutBinHeader.port_id].no_steps = (int)s->lutBinHeader.no_steps;
+                    s->bramDacConfig_arr[s->lutBinHeader.port_id].dac_port_id = s->lutBinHeader.dac_port_id;
+                    s->lut_bin_pending[s->lutBinHeader.port_id] = true;
+                    printf("\n### Received binary LUT for port %d: %u %s in %.3f ms ###\n", s->lutBinHeader.port_id,
+                           s->lutBinHeader.no_steps, (s->lutBinHeader.version == LUT_BIN_VERSION_VOLTAGE) ? "voltages" : "codes",
+                           (t_end.tv_sec - s->lut_bin_t_start.tv_sec) * 1e3 + (t_end.tv_nsec - s->lut_bin_t_start.tv_nsec) * 1e-6);
+                    reactor_reply(client, CONFIG_DONE);
                     break;
-
-                /**************************************************************/
-                /* Test-Commands for Debugging and Testing                    */
-                /**************************************************************/
-
-                case DEBUG:
-                    // add some debug-content... (reading back axi-config values etc..)
-                    // or printing some additional information regarding current tests
-                    // print configs for bram-dac-controllers:
-                    for (int i = 0; i < NO_DAC_BRAM_INTERFACES_USED; i++) {
-                        printf("### BRAM-DAC-Config-%d: ###\n", i);
-                        printf("dwell-time-delay:%d\n", bramDacConfig_arr[i].dwell_time_delay);
-                        printf("no-steps:%d\n", bramDacConfig_arr[i].no_steps);
+                }
+
+                case TRIGGER_CONFIG_ID: {
+                    // receive new trigger-config:
+                    if (!receive_config(client, &s->triggerConfig, sizeof(TriggerConfig))) break;
+                    printf("\n### Received new Trigger-config ###\n");
+                    uint32_t changed = config_diff(s->active.trigger_valid, &s->active.trigger, &s->triggerConfig,
+                                                   trigger_config_fields, TRIGGER_CONFIG_NO_FIELDS);
+                    if (verbose) config_diff_print("Trigger-Config", changed, trigger_config_fields, TRIGGER_CONFIG_NO_FIELDS);
+                    uint32_t applied = CONFIG_APPLIED_NONE, writes = 0;
+                    if (changed != 0) {
+                        // config trigger generator with calculated values from host:
+                        config_trigger_generator(stage_config(s), s->triggerConfig);
+                        writes = regcache_flush(&s->regcache, verbose);
+                        s->active.trigger = s->triggerConfig;
+                        s->active.trigger_valid = true;
+                        applied |= CONFIG_APPLIED_REGS;
                     }
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, config_done_reply(command.ch, applied, writes));
                     break;
-
-                /**************************************************************/
-                /* Test-Commands for RAM Writer test project                  */
-                /**************************************************************/
-
-                case RAM_TEST_BLOCK_MODE:
-                    // Test RAM-Writer in Block-Mode
-                    test_ram(axi_devs, sock_client, ramCfg, RAM_WRITER_BLOCK_MODE, no_tcp_packages, verbose);
+                }
+
+                case DUMMY_DATA_GEN_CONFIG_ID:
+                    if (!receive_config(client, &s->dummyCfg, sizeof(DummyDataGenConfig))) break;
+                    printf("\n### Received new Dummy-Data-Generator-Config ###\n");
+                    // config Dummy Data Generator with values from host:
+                    config_dummy_data_gen(stage_config(s), s->dummyCfg, verbose);
+                    regcache_flush(&s->regcache, verbose);
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, CONFIG_DONE);
                     break;
 
-                case RAM_TEST_CONTI_MODE:
-                    // Test RAM-Writer in Continous-Mode, with a given amount of tcp-packages
-                    no_tcp_packages = (int)command.val;
-                    test_ram(axi_devs, sock_client, ramCfg, RAM_WRITER_CONTI_MODE, no_tcp_packages, verbose);
+                case DUMMY_DATA_GEN_BRAM_ID: {
+                    // Receive new data for Dummy-Data-Generator (written into the BRAM when it is complete)
+                    int ret = receive_bram_upload(s, client, axi_devs.dummy_data_gen_bram, BRAM_UPLOAD_WINDOW_WORDS);
+                    if (ret == BRAM_UPLOAD_ERR_HEADER) return CMD_CLOSE_CONNECTION;
                     break;
-
-                case START_CLK_DIV:
-                    reset_clock_divider(axi_devs);
-                    printf("Start Clock Divider\n");
-                break;
-
-                case STOP_CLK_DIV:
-                    disable_clock_divider(axi_devs);
-                    printf("Stop Clock Divider\n");
-                break;
-
-                /**************************************************************/
-                /* Test-Commands for LIA debug project                        */
-                /**************************************************************/
-
-                case SELECT_RAM_MUX_INPUT:
-                    // select input for AXIS-Multiplexer
-                    select_ram_mux_input(axi_devs, command.val, verbose);
+                }
+
+                case LIA_MIXER_CONFIG_ID:
+                    // Receive new LIA-Mixer-Config
+                    if (!receive_config(client, &s->liaMixerCfg, sizeof(LiaMixerConfig))) break;
+                    printf("\n### Received new LIA-Mixer-Config ###\n");
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, CONFIG_DONE);
+                    // the software-LIA (ADC_LIA_MODE) works without the LIA-Mixer in the bitstream
+                    if (axi_devs.lia_mixer != NULL) config_lia_mixer(axi_devs, s->liaMixerCfg, verbose);
                     break;
 
-                case SELECT_ADC_MUX_INPUT:
-                    // select input for ADC-Multiplexer
-                    select_adc_mux_input(axi_devs, command.val, verbose);
+                case LIA_MIXER_BRAM_ID: {
+                    // Receive new data for LIA-Mixer (a range of the table can be updated via offset)
+                    // ranges beyond the copy (LIA_REF_MAX_WORDS) are rejected before anything is written
+                    void* bram = (axi_devs.lia_mixer_bram != NULL) ? axi_devs.lia_mixer_bram : s->liaRef;
+                    int ret = receive_bram_upload(s, client, bram, LIA_REF_MAX_WORDS);
+                    if (ret == BRAM_UPLOAD_ERR_HEADER) return CMD_CLOSE_CONNECTION;
+                    if (ret == BRAM_UPLOAD_PENDING) break;
+                    // the software-LIA uses a copy of the table (length: LiaStreamConfig.ref_len or uploaded words)
+                    uint32_t end = s->bramUploadHeader.offset + s->bramUploadHeader.no_words;
+                    if (bram != s->liaRef) {
+                        for (uint32_t i = s->bramUploadHeader.offset; i < end; i++) s->liaRef[i] = ((volatile uint32_t*)bram)[i];
+                    }
+                    if (end > s->lia_ref_len) s->lia_ref_len = end;
                     break;
-
-                case LIA_DEBUG:
-                    // Test LIA-Mixer-Module
-                    lia_debug(axi_devs, sock_client, ramCfg, verbose);
+                }
+
+                case LIA_IIR_CONFIG_ID:
+                    // Receive new IIR-Filter-Config
+                    if (!receive_config(client, &s->liaIIRCfg, sizeof(LiaIIRConfig))) break;
+                    printf("\n### Received new IIR-Filter-Coefficents ###\n");
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, CONFIG_DONE);
+                    if (axi_devs.lia_iir != NULL) load_lia_iir_coeffs(axi_devs, s->liaIIRCfg, verbose);
                     break;
 
-                case CLOSE_SPI:
-                    release_spi(spi_fd);
+                case LIA_STREAM_CONFIG_ID:
+                    // Receive decimation and output of the software-LIA (ADC_LIA_MODE)
+                    if (!receive_config(client, &s->liaStreamCfg, sizeof(LiaStreamConfig))) break;
+                    printf("\n### Received new LIA-Stream-Config: decimation %u, output %u, reference %u words ###\n",
+                           s->liaStreamCfg.decimation, s->liaStreamCfg.output, s->liaStreamCfg.ref_len);
+                    reactor_reply(client, CONFIG_DONE);
                     break;
 
-                /**********************************************************************/
-                 /* Commands to read back voltage value from ADC Click Boards over SPI*/
-                 /********************************************************************/
-
-                 case SPI_TEST:
-                    printf("## Testing SPI strted.....##\n");
-                    spi_test();
+                case RAM_INIT_CONFIG_ID:
+                    // Initialize RAM with config from host
+                    if (!receive_config(client, &s->ramInitCfg, sizeof(RamInitConfig))) break;
+                    printf("\n### Received new RAM-Init-Config ###\n");
+                    s->ramCfg = hal_init_ram(axi_devs, s->ramInitCfg);  // CMA-region or simulated RAM-Writer
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, CONFIG_DONE);
                     break;
 
-                 case INIT_ADC24:
-                    // use this command at the very beginning before sending any other command to ADC24 Ctrl Register
-                    //this command ensures that the next configuration (command) sent will be properly set
-                    init_adc24(spi_fd);
-                    printf("## Initialising the ADC24 Click Board##\n");
+                case CLK_DIVIDER_CONFIG_ID:
+                    if (!receive_config(client, &s->clockDividerConfig, sizeof(ClockDividerConfig))) break;
+                    printf("\n### Received new Clock_Divider-Config ###\n");
+                    // config Clock_Divider with values from host:
+                    config_clock_divider(axi_devs, s->clockDividerConfig);
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, CONFIG_DONE);
                     break;
 
-                 case GET_VOLTAGE_ADC24:
-                    // read the voltage from the selected channel of ADC24Click over SPI
-                    voltage_mV = get_voltage_adc24(spi_fd, command.ch);
-                    if (verbose) printf("\t voltage measured on channel %d : %dV \n", command.ch, voltage_mV);
-                    send_to_client(sock_client, voltage_mV);
+                case SPI_CONFIG_ID:
+                    if (!receive_config(client, &s->spiCfg, sizeof(SpiConfig))) break;
+                    printf("\n### Received new SPI-Config ###\n");
+                    adc24_scanner_stop(&s->adc24_scanner);
+                    s->spi_fd = setup_spi(s->spiCfg);
+                    // Send ACK to show Host-PC that configuration is done
+                    reactor_reply(client, CONFIG_DONE);
+                    
                     break;
 
-                case START_SEQ_SAMPLING_ADC24:
-                    printf("## Started ADC24 in sequence mode from Channel 0 to %d##\n", command.ch);
-                    size = command.ch + 1;
-                    ptr = sequence_mode_adc24(spi_fd, command.ch, size, verbose);
-                    //send the array to client
-                    send(sock_client, ptr, size * sizeof(int), MSG_NOSIGNAL);
-                    free(ptr);
+                default:
+                    printf("Config-ID %d not implemented yet...\n", (int)command.val);
                     break;
-
-                case INIT_ADC20: // make this a CONFIG_ID ... CONFIG_ADC_CLICKBOARD_20/24...
-                    // this command sets sampling rate of ADC20 to 1MHz, configures the channels as analog inputs
-                    init_adc20(spi_fd);
-                    printf("## Initialising the ADC20 Click Board##\n");
-                    //send_to_client(sock_client, CONFIG_DONE);
+            }
+            break;
+
+        case SET_RP_DAC_NO_CALIB:
+            // Set raw voltage on RP-DAC (used when calibrating the DACs)
+            set_voltage_on_DAC_no_calib(axi_devs, RP_DAC_ID, command.ch, command.val, verbose);
+            break;
+
+        case SET_RP_DAC:
+            // Set voltage on RP-DAC
+            set_voltage_on_DAC(axi_devs, RP_DAC_ID, command.ch, command.val, verbose);
+            break;
+
+        case SET_AD_DAC:
+            // Set voltage on external AD-DAC
+            set_voltage_on_DAC(axi_devs, AD_DAC_ID, command.ch, command.val, verbose);
+            break;
+
+        case GET_RF_ADC:
+            // Read voltage on fast ADC and send to the client
+            voltage_mV = (int)(rpa_get_voltage(axi_devs, command.ch, true, command.val) * 1000);
+            TRACE_DEBUG("\t voltage measured on fast ADC on channel %d : %d mV", command.ch, voltage_mV);
+            reactor_reply(client, voltage_mV);
+            break;
+
+        case GET_RF_ADC_CNT:
+            // Read ADC count on RF-ADC channel and send to the client
+            adc_cnt = rpa_get_raw_value(axi_devs, command.ch);
+            TRACE_DEBUG("\t adc cnt on RF-ADC ch: %d : %x", command.ch, adc_cnt);
+            reactor_reply(client, adc_cnt);
+            break;
+
+        case SET_PDM:
+            // Set voltage on PDM and enable PDM output
+            set_voltage_pdm(axi_devs, command.ch, command.val);
+            enable_pdm_output(axi_devs, command.ch);
+            break;
+
+        case GET_XADC:
+            // Read XADC ports and return voltage for the selected channel
+            voltage_mV = (int)(xad_get_voltage(axi_devs, command.ch) * 1000);
+            TRACE_DEBUG("\t voltage measured: %d", voltage_mV);
+            reactor_reply(client, voltage_mV);
+            break;
+
+        case START_DAC_SWEEP:
+            // Start DAC sweep for an infinite amount of time
+            // TODO: Use separated Resets so we can Config dac-bram-controllers independent from others while they are currently running
+            // enable module for synchronizing bram-ctrl:
+            enable_module(axi_devs, RESET_INDEX_BRAM_CTRL_SYNC);
+            start_bram_dac_output(axi_devs, command.ch);  // start bram-dac-output for selected BramDac-Port
+            printf("###### Started LUT-DAC-Output for port %d ######\n", command.ch);
+            break;
+
+        case STOP_DAC_SWEEP:
+            // Stop DAC sweep, reset module, and exit application
+            printf("Laser-Tuning stopped...\n");
+            stop_bram_dac_output(axi_devs, command.ch);
+            break;
+
+        case START_TRIGGER_SWEEP:
+            // entry point for DAC-Sweep with trigger-handshake for measuring wavelenght during a sweep
+            // for usage with trigger_generator-IP
+            // expects the bram-port-id as channel-value (command.ch)
+            disable_module(axi_devs,RESET_INDEX_TRIGGER_GEN);// disable before starting the other modules
+            s->trigger_sweep_index = 0; // reset sweep-index for a new sweep:
+            s->no_total_trigger    = command.val;
+            printf("Start Trigger-Sweep for bram-port: %d and %d trigger: ####\n",command.ch,s->no_total_trigger);
+            trigger_irq_arm(&s->trigger_irq);
+            // enable needed modules:
+            enable_module(axi_devs, RESET_INDEX_DAC_BRAM_CTRL_PORT0);
+            enable_module(axi_devs, RESET_INDEX_BRAM_CTRL_SYNC);
+            enable_module(axi_devs, RESET_INDEX_TRIGGER_GEN);
+            // start output:
+            start_bram_dac_output(axi_devs, command.ch);
+            // wait till first trigger gets armed on FPGA-Logic,
+            // then send request to Host-PC to read out measured wavelength at trigger
+            request_wavelength(s, client, command);
+            printf("## Armed first trigger %d  for trigger-sweep with %d trigger:\n", (s->trigger_sweep_index + 1), s->no_total_trigger);
+            break;
+
+        case NEXT_TRIGGER:
+            // make sure to release the trigger before selecting the next-trigger
+            // increment trigger-ref to select next trigger-timestep, clears check-wavelength
+            trigger_irq_arm(&s->trigger_irq);
+            select_next_trigger(axi_devs);
+            printf("## Wavelength measured for %d/%d\n", (s->trigger_sweep_index + 1), s->no_total_trigger);
+            // wait for trigger beeing armed by FPGA-Logic,
+            // then send request to Host-PC to read out measured wavelength at trigger
+            request_wavelength(s, client, command);
+            printf("## Requested wavelength for next trigger %d/%d\n", (s->trigger_sweep_index + 2), s->no_total_trigger);
+            s->trigger_sweep_index++;
+            if ((s->trigger_sweep_index + 1) == s->no_total_trigger) {
+                printf("## Wavelength measured for last Trigger %d/%d \n", (s->trigger_sweep_index + 1), s->no_total_trigger);
+                printf("## Finished Trigger-Sweep! ############################ \n");
+            }
+            break;
+
+        case REARM_TRIGGER:
+            // if wavelength-measurement failed or timed-out
+            // we want to measure the wavelength again for the same trigger, so we rearm it
+            trigger_irq_arm(&s->trigger_irq);
+            rearm_current_trigger(axi_devs);
+            printf("### Rearmed current trigger %d/%d", (s->trigger_sweep_index + 1), s->no_total_trigger);
+            // the next command of this client is handled when the trigger is armed again
+            request_wavelength(s, client, command);
+            break;
+
+        case HOLD_TRIGGER:
+            // holds output-trigger high at current-trigger point until we select-next trigger
+            // ..setting rearm-trigger constantly to 1
+            // so there is no need for rearming all the time
+            printf("### Hold current trigger %d \n",(s->trigger_sweep_index+1));
+            hold_current_trigger(axi_devs);
+            break;
+
+        case START_SEQUENCE:
+            // uploaded command-sequence with loops and deadlines, executed without round-trips
+            return run_sequence(s, client);
+
+        case START_LUT_CALIB: {
+            // trigger-sweep with closed-loop correction on the worker-thread: the host answers
+            // every REQ_WLENGTH with one float, RedPitaya adjusts the LUT and sends the result
+            if (!receive_config(client, &s->lutCalibCfg, sizeof(LutCalibConfig))) break;
+            bool port_valid = s->lutCalibCfg.port_id >= 0 && s->lutCalibCfg.port_id < NO_DAC_BRAM_INTERFACES_USED;
+            s->no_steps = port_valid ? s->bramDacConfig_arr[s->lutCalibCfg.port_id].no_steps : 0;
+            if (lut_calib_check_config(&s->lutCalibCfg, s->no_steps) != 0) {
+                // the trigger-points are still in the socket
+                reactor_reply(client, SERVER_ERROR_ID);
+                return CMD_CLOSE_CONNECTION;
+            }
+
+            size_t point_bytes = (size_t)s->lutCalibCfg.no_triggers * sizeof(LutCalibPoint);
+            const void* points = reactor_payload(client, sizeof(LutCalibConfig), point_bytes);
+            if (points == NULL) break;
+            s->lut_calib_points = malloc(point_bytes);
+            if (s->lut_calib_points == NULL) {
+                reactor_reply(client, SERVER_ERROR_ID);
+                break;
+            }
+            memcpy(s->lut_calib_points, points, point_bytes);
+            if (lut_calib_check_points(s->lut_calib_points, s->lutCalibCfg.no_triggers, s->no_steps) != 0) {
+                free(s->lut_calib_points);
+                s->lut_calib_points = NULL;
+                reactor_reply(client, SERVER_ERROR_ID);
+                break;
+            }
+            // the job owns the points from now on (and modifies the LUT)
+            s->active.lut_valid[s->lutCalibCfg.port_id] = false;
+            if (!start_job(s, client, lut_calib_job, NULL, 0)) free(s->lut_calib_points);
+            s->lut_calib_points = NULL;
+            break;
+        }
+
+        case GET_TRIGGER_LATENCY:
+            // statistics of the trigger-armed -> REQ_WLENGTH latency (ch: TRIGGER_STAT_*)
+            reactor_reply(client, trigger_latency_stat(&s->trigger_irq, command.ch));
+            break;
+
+        case RELEASE_TRIGGER:
+            // make sure to wait some time inbetween releasing the trigger and
+            // selecting the next trigger... the time you need to sleep
+            // depends on the DAC-SIGNAL-PERIOD (dac-dwell-time * dac-no-steps)
+            printf("Trigger %d got released",(s->trigger_sweep_index+1));
+            release_current_trigger(axi_devs);
+            reactor_reply(client, ACK);
+            break;
+
+        case ADJ_LUT_VALUE:
+            //inputs: - which Bram-Port?... from that we have access to bramDacConfig through bramDacConfig_arr
+            // receive new LUT-Value-Struct:
+            if (!receive_config(client, &s->lutValue, sizeof(LutValue))) break;
+            printf("Received command to adjust LUT-Value:\n");
+            // apply new LutValue (the LUT is reloaded by the next BRAM-DAC-Config):
+            change_value_in_lut(axi_devs, s->lutValue, verbose);
+            if (s->lutValue.port_id >= 0 && s->lutValue.port_id < NO_DAC_BRAM_INTERFACES_USED) s->active.lut_valid[s->lutValue.port_id] = false;
+
+            // for first value in LUT we also want to adjust the last value in LUT
+            if (s->lutValue.index == 0) {
+                change_value_in_lut_at_index(axi_devs, s->lutValue, s->bramDacConfig_arr[s->lutValue.port_id].no_steps - 1, verbose);
+            }
+            printf("Received adjusted tuning voltage: %fV for trigger %d \n", s->lutValue.voltage, (s->trigger_sweep_index + 1));
+            // now repeat wlength measurement for same trigger:
+            trigger_irq_arm(&s->trigger_irq);
+            rearm_current_trigger(axi_devs);
+            // wait till trigger is armed by FPGA,
+            // then send wlength request to HOST-PC to measure wavelength at trigger:
+            request_wavelength(s, client, command);
+            break;
+
+        case STORE_LUT:
+            // we expect a port_id for the LUT/DAC-BRAM-Controller-Port we want to store the LUT (via channel-id)
+            if ((int)command.val == LUT_STORE_BIN) {
+                char path[64];
+                snprintf(path, sizeof(path), LUT_BIN_ADJ_FILE, command.ch);
+                if (command.ch < 0 || command.ch >= NO_DAC_BRAM_INTERFACES_USED ||
+                    lut_bin_read_bram(axi_devs, s->bramDacConfig_arr[command.ch], &s->lutBinHeader, s->lutBinCodes) != LUT_BIN_OK ||
+                    lut_bin_store_file(path, &s->lutBinHeader, s->lutBinCodes) != LUT_BIN_OK) {
+                    printf("Storing binary LUT for port %d failed\n", command.ch);
                     break;
+                }
+            } else {
+                store_adj_lut_to_file(axi_devs,s->bramDacConfig_arr[command.ch],verbose);
+            }
+            printf("Stored LUT for DAC-BRAM-CONRTOLLER at Port %d\n",command.ch);
+            break;
+
+        case GET_LUT_BIN:
+            // replies ACK followed by LutBinHeader + DAC-codes from the BRAM of port ch,
+            // or SERVER_ERROR_ID if there is no valid BRAM-DAC-config for the port
+            if (command.ch < 0 || command.ch >= NO_DAC_BRAM_INTERFACES_USED ||
+                lut_bin_read_bram(axi_devs, s->bramDacConfig_arr[command.ch], &s->lutBinHeader, s->lutBinCodes) != LUT_BIN_OK) {
+                reactor_reply(client, SERVER_ERROR_ID);
+                break;
+            }
+            reactor_reply(client, ACK);
+            if (lut_bin_send(sock_client, &s->lutBinHeader, s->lutBinCodes) != LUT_BIN_OK) return CMD_CLOSE_CONNECTION;
+            break;
+
+        case START_SWEEP_AVG:
+            // averaging runs on the worker-thread, the DAC-BRAM-sweep has to be started by the host
+            s->no_steps = command.ch;
+            s->no_tcp_packages = (int)command.val;
+            start_job(s, client, sweep_avg_job, NULL, RAM_WRITER_CONTI_MODE);
+            break;
+
+        case START_ADC_SAMPLING:
+            printf("received start ADC-Sampling command...\n");
+            s->no_tcp_packages = (int)command.val;  // send amount of tcp package we wan to sample when sending startADC sampling request!
+            s->no_regions = command.ch;             // Multi-Block-Mode: no. of regions (0 = ping-pong)
+            s->stream_mode = command.ch;            // Continous-Mode: ADC_STREAM_RAW/ADC_STREAM_COMPRESSED
+            // sampling runs on the worker-thread, so other clients can still send commands
+            start_job(s, client, adc_sampling_job, NULL, s->adcCfg.adc_mode);
+            break;
+
+        case START_RECORD:
+            // continous-mode into a local file (worker-thread), replies the no. of chunks when done
+            if (!receive_config(client, &s->recCfg, sizeof(RecConfig))) break;
+            if (s->recCfg.no_chunks <= 0 ||
+                (s->recCfg.storage != REC_STORAGE_SD && s->recCfg.storage != REC_STORAGE_TMPFS)) {
+                printf("Invalid recording-config (storage %d, %d chunks)\n", s->recCfg.storage, s->recCfg.no_chunks);
+                reactor_reply(client, SERVER_ERROR_ID);
+                break;
+            }
+            start_job(s, client, record_job, NULL, RAM_WRITER_CONTI_MODE);
+            break;
+
+        case GET_RECORD_INFO:
+            // header and chunk-index of recording ch
+            if (send_record_info(client, command.ch) != 0) return CMD_CLOSE_CONNECTION;
+            break;
+
+        case GET_RECORD_RANGE:
+            // ACK, then RecRangeRequest, samples are read and sent by the worker-thread
+            if (!receive_config(client, &s->recRange, sizeof(RecRangeRequest))) break;
+            start_job(s, client, record_range_job, NULL, 0);
+            break;
+
+        case GET_STATS: {
+            // ACK + StatsSnapshotHeader + StatsCmdEntry[no_cmds], ch = STATS_RESET clears the metrics afterwards
+            StatsSnapshotHeader stats;
+            uint32_t no_cmds = metrics_snapshot(&stats, s->statsCmds);
+            if (command.ch == STATS_RESET) metrics_reset();
+            reactor_reply(client, ACK);
+            if (send_all(sock_client, &stats, sizeof(stats)) != 0 ||
+                send_all(sock_client, s->statsCmds, no_cmds * sizeof(StatsCmdEntry)) != 0) {
+                return CMD_CLOSE_CONNECTION;
+            }
+            break;
+        }
+
+        case SET_LED:
+            turn_on_leds(axi_devs, (int) command.val);
+            break;
+
+        case EXIT_APP:
+            printf("exit application...\n");
+            reset_system(axi_devs, true);  // forced reset on all modules...
+            // sockets get closed by the reactor
+            return CMD_SHUTDOWN_SERVER;
+
+        case TERMINATE_CLIENT:
+            // when receiving a terminate-client command from Python (executed before closing python-socket)
+            return CMD_CLOSE_CONNECTION;
+
+        case CLIENT_DISCONNECT:
+            // when receiving invalid data we close client-socket
+            return CMD_CLOSE_CONNECTION;
+
+        case GET_DAC_BRAM_SAMPLE_CNT:
+            // Read ADC count on RF-ADC channel and send to the client
+            sample_rate_cnt = get_sample_rate_bram_no_clocks(axi_devs, command.ch);
+            reactor_reply(client, sample_rate_cnt);
+            break;
+
+        case GET_DAC_BRAM_SIGNAL_CNT:
+            // Read ADC count on RF-ADC channel and send to the client
+            signal_rate_cnt = get_signal_rate_bram_no_clocks(axi_devs, command.ch);
+            reactor_reply(client, signal_rate_cnt);
+            break;
+
+        /**************************************************************/
+        /* Test-Commands for Debugging and Testing                    */
+        /**************************************************************/
+
+        case SET_VERBOSE:
+            // switch trace-level at runtime (val != 0: debug-traces on)
+            s->verbose = (command.val != 0);
+            trace_set_verbose(s->verbose);
+            reactor_reply(client, ACK);
+            break;
+
+        case CONVERT_BENCH:
+            // compare throughput of the conversion-kernels with the per-sample functions (output on console)
+            convert_benchmark((command.val > 0) ? (int)command.val : CONVERT_BENCH_DEFAULT_SAMPLES, CONVERT_BENCH_RUNS);
+            reactor_reply(client, ACK);
+            break;
+
+        case LIA_SW_CHECK:
+            // NEON- against scalar-version of the software-LIA, the client compares with lia_sw_reference()
+            if (send_lia_check(client, (command.val > 0) ? (int)command.val : LIA_SW_CHECK_DEFAULT_SAMPLES) != 0) {
+                return CMD_CLOSE_CONNECTION;
+            }
+            break;
+
+        case DEBUG:
+            // add some debug-content... (reading back axi-config values etc..)
+            // or printing some additional information regarding current tests
+            // print configs for bram-dac-controllers:
+            for (int i = 0; i < NO_DAC_BRAM_INTERFACES_USED; i++) {
+                printf("### BRAM-DAC-Config-%d: ###\n", i);
+                printf("dwell-time-delay:%d\n", s->bramDacConfig_arr[i].dwell_time_delay);
+                printf("no-steps:%d\n", s->bramDacConfig_arr[i].no_steps);
+            }
+            break;
+
+        /**************************************************************/
+        /* Test-Commands for RAM Writer test project                  */
+        /**************************************************************/
+
+        case RAM_TEST_BLOCK_MODE:
+            // Test RAM-Writer in Block-Mode
+            start_job(s, client, ram_test_job, NULL, RAM_WRITER_BLOCK_MODE);
+            break;
+
+        case RAM_TEST_CONTI_MODE:
+            // Test RAM-Writer in Continous-Mode, with a given amount of tcp-packages
+            s->no_tcp_packages = (int)command.val;
+            start_job(s, client, ram_test_job, NULL, RAM_WRITER_CONTI_MODE);
+            break;
+
+        case START_CLK_DIV:
+            reset_clock_divider(axi_devs);
+            printf("Start Clock Divider\n");
+        break;
+
+        case STOP_CLK_DIV:
+            disable_clock_divider(axi_devs);
+            printf("Stop Clock Divider\n");
+        break;
+
+        /**************************************************************/
+        /* Test-Commands for LIA debug project                        */
+        /**************************************************************/
+
+        case SELECT_RAM_MUX_INPUT:
+            // select input for AXIS-Multiplexer
+            select_ram_mux_input(axi_devs, command.val, verbose);
+            break;
+
+        case SELECT_ADC_MUX_INPUT:
+            // select input for ADC-Multiplexer
+            select_adc_mux_input(axi_devs, command.val, verbose);
+            break;
+
+        case LIA_DEBUG:
+            // Test LIA-Mixer-Module
+            start_job(s, client, lia_debug_job, NULL, 0);
+            break;
+
+        case CLOSE_SPI:
+            adc24_scanner_stop(&s->adc24_scanner);
+            release_spi(s->spi_fd);
+            break;
+
+        /**********************************************************************/
+         /* Commands to read back voltage value from ADC Click Boards over SPI*/
+         /********************************************************************/
+
+         case SPI_TEST:
+            printf("## Testing SPI strted.....##\n");
+            spi_test();
+            break;
+
+         case INIT_ADC24:
+            // use this command at the very beginning before sending any other command to ADC24 Ctrl Register
+            //this command ensures that the next configuration (command) sent will be properly set
+            init_adc24(s->spi_fd);
+            printf("## Initialising the ADC24 Click Board##\n");
+            break;
+
+         case GET_VOLTAGE_ADC24:
+            // read the voltage from the selected channel of ADC24Click over SPI
+            // (latest sample of the scanner if it is running)
+            if (adc24_scanner_is_running(&s->adc24_scanner)) {
+                Adc24Sample sample;
+                voltage_mV = (adc24_scanner_latest(&s->adc24_scanner, command.ch, &sample) == 0) ? adc24_raw_to_mV(sample.raw) : SERVER_ERROR_ID;
+            } else {
+                voltage_mV = get_voltage_adc24(s->spi_fd, command.ch);
+            }
+            TRACE_DEBUG("\t voltage measured on channel %d : %dV", command.ch, voltage_mV);
+            reactor_reply(client, voltage_mV);
+            break;
+
+        case START_SEQ_SAMPLING_ADC24:
+            printf("## Started ADC24 in sequence mode from Channel 0 to %d##\n", command.ch);
+            // the scanner has the latest sample of every channel, sequence_mode_adc24() needs stop_ch >= 1
+            if (command.ch < (adc24_scanner_is_running(&s->adc24_scanner) ? 0 : 1) || command.ch >= ADC24_SCAN_NO_CHANNELS) {
+                printf("**Invalid stop channel: %d**\n", command.ch);
+                reactor_reply(client, SERVER_ERROR_ID);
+                break;
+            }
+            size = command.ch + 1;
+            if (adc24_scanner_is_running(&s->adc24_scanner)) {
+                // latest sample of each channel from the scanner
+                Adc24Sample sample;
+                ptr = malloc(size * sizeof(int));
+                for (int i = 0; ptr != NULL && i < size; i++) {
+                    ptr[i] = (adc24_scanner_latest(&s->adc24_scanner, i, &sample) == 0) ? adc24_raw_to_mV(sample.raw) : SERVER_ERROR_ID;
+                }
+            } else {
+                ptr = sequence_mode_adc24(s->spi_fd, command.ch, size, verbose);
+            }
+            if (ptr == NULL) {
+                reactor_reply(client, SERVER_ERROR_ID);
+                break;
+            }
+            //send the array to client
+            if (send_all(sock_client, ptr, size * sizeof(int)) != 0) {
+                free(ptr);
+                return CMD_CLOSE_CONNECTION;
+            }
+            free(ptr);
+            break;
+
+        case INIT_ADC20: // make this a CONFIG_ID ... CONFIG_ADC_CLICKBOARD_20/24...
+            // this command sets sampling rate of ADC20 to 1MHz, configures the channels as analog inputs
+            init_adc20(s->spi_fd);
+            printf("## Initialising the ADC20 Click Board##\n");
+            //reactor_reply(client, CONFIG_DONE);
+            break;
+
+        case GET_VOLTAGE_ADC20:
+            // reads the voltage from the selected ADC20Click channel over SPI
+            voltage_mV = get_voltage_adc20(s->spi_fd, command.ch, command.val);
+            TRACE_DEBUG("voltage measured on channel %d of ADC20: %dmV", command.ch, voltage_mV);
+            reactor_reply(client, voltage_mV);
+            break;
+
+        case START_SEQ_SAMPLING_ADC20:
+            printf("## Started ADC20 in sequence mode starting from Channel 0 to %d##\n", command.ch);
+            size = command.ch + 1;
+            ptr = sample_sequence_mode_adc20(s->spi_fd, command.ch, command.val,  size,  verbose);
+            //send array to client
+            send(sock_client, ptr, size * sizeof(int), MSG_NOSIGNAL);
+            free(ptr);
+            break;
+
+        case START_STREAM_ADC20:
+            // stream no. of packages (val) with frames of channel 0..ch on the worker-thread
+            printf("## Started ADC20-Stream from Channel 0 to %d for %d TCP-Packages##\n", command.ch, (int)command.val);
+            s->adc20_stop_ch = command.ch;
+            s->no_tcp_packages = (int)command.val;
+            if (start_job(s, client, adc20_stream_job, adc20_stream_done, 0)) s->adc20_streaming = true;
+            break;
+
+        /**********************************************************************/
+        /* Background-Scanner of ADC24 Click                                  */
+        /**********************************************************************/
+
+        case START_ADC24_SCAN:
+            // sweep channel 0..ch with val sweeps/s in the background
+            if (s->adc20_streaming) {
+                printf("SPI-Bus is used by the ADC20-Stream, ADC24-Scanner not started...\n");
+                reactor_reply(client, SERVER_ERROR_ID);
+                break;
+            }
+            reactor_reply(client, (adc24_scanner_start(&s->adc24_scanner, s->spi_fd, command.ch, (int)command.val) == 0) ? ACK : SERVER_ERROR_ID);
+            break;
+
+        case STOP_ADC24_SCAN:
+            adc24_scanner_stop(&s->adc24_scanner);
+            break;
+
+        case GET_LATEST_ADC24: {
+            // latest voltage of channel ch, without waiting on the SPI-bus
+            Adc24Sample sample;
+            voltage_mV = (adc24_scanner_latest(&s->adc24_scanner, command.ch, &sample) == 0) ? adc24_raw_to_mV(sample.raw) : SERVER_ERROR_ID;
+            reactor_reply(client, voltage_mV);
+            break;
+        }
+
+        case GET_WINDOW_ADC24: {
+            // all samples of the last val ms: Adc24WindowHeader followed by Adc24Sample-array
+            Adc24WindowHeader header;
+            uint64_t window_ns = (command.val > 0) ? (uint64_t)(command.val * 1e6) : 0;
+            adc24_scanner_window(&s->adc24_scanner, window_ns, s->adc24_window, ADC24_SCAN_MAX_WINDOW_SAMPLES, &header);
+            if (send_all(sock_client, &header, sizeof(header)) != 0 ||
+                send_all(sock_client, s->adc24_window, header.no_samples * sizeof(Adc24Sample)) != 0) {
+                return CMD_CLOSE_CONNECTION;
+            }
+            break;
+        }
+
+        case READ_REG_ADC20:
+            printf("## Read register value from %d ##\n", command.ch);
+            read_register(s->spi_fd,  command.ch);
+            break;
+        
+        case ADC20_DEBUG_CMD:
+            adc20_debug_communication(s->spi_fd);
+            break;
+
+        /**************************************************************/
+        /* Default-Case for not implemented commands                  */
+        /**************************************************************/
+        default:
+            printf("Command with ID %d is not implemented...\n", command.id);
+            break;
+
+    }  // switch-case
+
+    return CMD_KEEP_CONNECTION;
+}
 
-                case GET_VOLTAGE_ADC20:
-                    // reads the voltage from the selected ADC20Click channel over SPI
-                    voltage_mV = get_voltage_adc20(spi_fd, command.ch, command.val);
-                    printf("voltage measured on channel %d of ADC20: %dmV \n", command.ch, voltage_mV);
-                    send_to_client(sock_client, voltage_mV);
-                    break;
+static int init_server_on_port(int port) {
+    // like init_server() with another port than TCP_PORT (listen() is called by app_server)
+    struct sockaddr_in addr;
+    int one = 1;
+
+    int sock_server = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock_server < 0) {
+        printf("Creating server-socket failed...\n");
+        return -1;
+    }
+    setsockopt(sock_server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(sock_server, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        printf("Binding server-socket to port %d failed...\n", port);
+        close(sock_server);
+        return -1;
+    }
+    printf("Server listens on port %d (%s)\n", port, SERVER_PORT_ENV);
+    return sock_server;
+}
 
-                case START_SEQ_SAMPLING_ADC20:
-                    printf("## Started ADC20 in sequence mode starting from Channel 0 to %d##\n", command.ch);
-                    size = command.ch + 1;
-                    ptr = sample_sequence_mode_adc20(spi_fd, command.ch, command.val,  size,  verbose);
-                    //send array to client
-                    send(sock_client, ptr, size * sizeof(int), MSG_NOSIGNAL);
-                    free(ptr);
-                    break;
+int app_server(AxiDevs axi_devs, bool verbose) {
+    // after all devices are initialized this should be the main application loop,
+    // where all requests from the applications connected via tcp are handled
+    int sock_server;
+    int ret;
+
+    // server-state is to big for the stack (binary-LUT-staging-buffer...), aligned for copy_words()
+    ServerState* s = aligned_alloc(_Alignof(ServerState), sizeof(ServerState));
+    if (s == NULL) {
+        printf("Allocating server-state failed...\n");
+        return -1;
+    }
+    memset(s, 0, sizeof(ServerState));
+    s->axi_devs = axi_devs;
+    s->verbose = verbose;
+    s->spi_fd = -1;
+    if (regcache_init(&s->regcache, axi_devs) < 0) {
+        free(s);
+        return -1;
+    }
 
-                case READ_REG_ADC20:
-                    printf("## Read register value from %d ##\n", command.ch);
-                    read_register(spi_fd,  command.ch);
-                    break;
-                
-                case ADC20_DEBUG_CMD:
-                    adc20_debug_communication(spi_fd);
-                    break;
+    // intit Server
+    const char* port = getenv(SERVER_PORT_ENV);
+    sock_server = (port != NULL) ? init_server_on_port(atoi(port)) : init_server();
+    if (sock_server < 0) {
+        regcache_release(&s->regcache);
+        free(s);
+        return -1;
+    }
 
-                /**************************************************************/
-                /* Default-Case for not implemented commands                  */
-                /**************************************************************/
-                default:
-                    printf("Command with ID %d is not implemented...\n", command.id);
-                    break;
+    // init system...
+    disable_system(axi_devs);  // disable all FPGA-Modules on default, activated only after config-params got send?
 
-            }  // switch-case
+    if (reactor_init(&s->reactor, sock_server, handle_command, s) < 0) {
+        close(sock_server);
+        regcache_release(&s->regcache);
+        free(s);
+        return -1;
+    }
+
+    trace_init(verbose);
+    metrics_init();
+    metrics_export_start();
+    trigger_irq_open(&s->trigger_irq);
+    printf("App-Server started..\n");
+
+    listen(sock_server, 1024);
 
-        }      // wait-for-commands-loop
+    // bind user interrupt (^C => SIGINT) to "interrupt handler"
+    signal(SIGINT, signal_handler);
 
-        exit_client_connection:
-        close(sock_client);
+    // main loop: wait for new clients and commands from all connected clients
+    ret = reactor_run(&s->reactor, &interrupted);
 
-    }  // wait-for-client-conncect-loop
-    server_shutdown:
+    reactor_close(&s->reactor);
+    adc24_scanner_stop(&s->adc24_scanner);
+    trigger_irq_close(&s->trigger_irq);
+    regcache_release(&s->regcache);
+    metrics_export_stop();
+    trace_shutdown();
     close(sock_server);
     signal(SIGINT, SIG_DFL);
+    free(s);
     printf("shutdown server...\n");
-    return 0;
+    return (ret < 0) ? -1 : 0;
 }
@@ -0,0 +1,41 @@
+/*
+ * rp_sim_server.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    App-Server on a host without FPGA: the AXI-windows are simulated by rp_hal,
+ *    so the command-loop and the streaming-paths can be tested and load-tested
+ *    with the normal python-client (RP_SIM_SAMPLE_RATE_HZ selects the ADC-rate before the
+ *    sample_rate_divider of the AdcConfig).
+ *
+ *    usage: ./sim_server [-v]
+ *           RP_SERVER_PORT=1003 RP_METRICS_PORT=9103 ./sim_server   (several simulated boards on one host)
+ *           RP_METRICS_BIND=0.0.0.0 ./sim_server                    (exporter reachable from other hosts)
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rp_hal.h"
+#include "rp_server_app.h"
+
+int main(int argc, char** argv) {
+    AxiDevs axi_devs;
+    bool verbose = (argc > 1 && strcmp(argv[1], "-v") == 0);
+    HalSimStats stats;
+
+    if (hal_init(HAL_BACKEND_SIM, &axi_devs) < 0) {
+        printf("Initializing simulated FPGA failed\n");
+        return EXIT_FAILURE;
+    }
+
+    int ret = app_server(axi_devs, verbose);
+
+    hal_sim_get_stats(&stats);
+    printf("Simulator: %llu samples written, %llu triggers\n", (unsigned long long)stats.samples_written,
+           (unsigned long long)stats.triggers);
+    hal_release(&axi_devs);
+    return (ret < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,67 @@
+/*
+ * rp_spsc_ring.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Lock-free single-producer/single-consumer ring.
+ *    head/tail are free running counters, the slot is selected with (counter & mask).
+ */
+
+#include "rp_spsc_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int spsc_ring_init(SpscRing* ring, uint32_t capacity, uint32_t elem_size) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        printf("SPSC-Ring capacity %u is not a power of two\n", capacity);
+        return -1;
+    }
+
+    ring->slots = aligned_alloc(RP_CACHE_LINE_SIZE, ((size_t)capacity * elem_size + RP_CACHE_LINE_SIZE - 1) & ~(size_t)(RP_CACHE_LINE_SIZE - 1));
+    if (ring->slots == NULL) {
+        printf("Allocating SPSC-Ring with %u elements failed\n", capacity);
+        return -1;
+    }
+    ring->mask = capacity - 1;
+    ring->elem_size = elem_size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return 0;
+}
+
+void spsc_ring_free(SpscRing* ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+bool spsc_ring_push(SpscRing* ring, const void* elem) {
+    // producer only: returns false if ring is full
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail > ring->mask) return false;
+
+    memcpy(ring->slots + (size_t)(head & ring->mask) * ring->elem_size, elem, ring->elem_size);
+    // publish element after it is written completely
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+bool spsc_ring_pop(SpscRing* ring, void* elem) {
+    // consumer only: returns false if ring is empty
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) return false;
+
+    memcpy(elem, ring->slots + (size_t)(tail & ring->mask) * ring->elem_size, ring->elem_size);
+    // release slot after it is copied
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+uint32_t spsc_ring_count(SpscRing* ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) - atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
@@ -0,0 +1,38 @@
+/*
+ * rp_spsc_ring.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Lock-free single-producer/single-consumer ring for fixed-size elements.
+ *
+ *     -- head is only written by the producer, tail only by the consumer
+ *     -- head and tail live on separate cache-lines, so producer and consumer
+ *        thread don't invalidate each others cache-line on every push/pop
+ *     -- capacity has to be a power of two
+ */
+
+#ifndef SRC_RP_SPSC_RING_H
+#define SRC_RP_SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cortex-A9 uses 32 byte cache-lines, 64 byte also separates head/tail on x86 (simulation)
+#define RP_CACHE_LINE_SIZE 64
+
+typedef struct {
+    _Alignas(RP_CACHE_LINE_SIZE) atomic_uint head;  // next slot to write (producer)
+    _Alignas(RP_CACHE_LINE_SIZE) atomic_uint tail;  // next slot to read (consumer)
+    _Alignas(RP_CACHE_LINE_SIZE) uint32_t mask;     // capacity - 1
+    uint32_t elem_size;
+    uint8_t* slots;
+} SpscRing;
+
+int spsc_ring_init(SpscRing* ring, uint32_t capacity, uint32_t elem_size);
+void spsc_ring_free(SpscRing* ring);
+bool spsc_ring_push(SpscRing* ring, const void* elem);
+bool spsc_ring_pop(SpscRing* ring, void* elem);
+uint32_t spsc_ring_count(SpscRing* ring);
+
+#endif
@@ -63,6 +63,78 @@ typedef struct {
     RamInitConfig param;
 } RamConfig;
 
+// header in front of every TCP-Package in ADC-Continous-Mode (followed by no_samples samples
+// and a uint32 status ADC_BLOCK_OK/ADC_BLOCK_TORN of the package ADC_STREAM_STATUS_LAG before)
+typedef struct {
+    uint32_t magic;       // ADC_STREAM_MAGIC
+    uint32_t seq;         // sequence-number of package
+    uint32_t overruns;    // total no. of packages lost since start of sampling
+    uint32_t no_samples;  // no. of 32bit-samples following the header, 0 for a lost package
+} AdcStreamHeader;
+
+// header in front of every TCP-Package in compressed Continous-Mode (ADC_STREAM_COMPRESSED)
+typedef struct {
+    uint32_t magic;       // ADC_STREAM_Z_MAGIC
+    uint32_t seq;         // sequence-number of package
+    uint32_t overruns;    // total no. of packages lost since start of sampling
+    uint32_t no_samples;  // no. of 32bit-samples encoded in the payload, 0 for a lost package
+    uint32_t no_bytes;    // size of the payload following the header
+    uint16_t codec;       // ADC_CODEC_*
+    uint16_t reserved;
+} AdcStreamZHeader;
+
+// header in front of each TCP-Package in ADC_LIA_MODE (followed by no_points I/Q- or magnitude/phase-pairs)
+typedef struct {
+    uint32_t magic;         // LIA_STREAM_MAGIC
+    uint32_t seq;           // sequence-number of the ADC-package
+    uint32_t overruns;      // total no. of packages lost since start
+    uint32_t no_points;     // 0 for a lost package
+    uint16_t output;        // LIA_OUT_*
+    uint16_t reserved;
+    uint32_t decimation;
+    uint64_t first_sample;  // absolute ADC-sample-index of the first point
+} LiaStreamHeader;
+
+// header in front of every block in ADC-Multi-Block-Mode (followed by no_samples samples
+// and a uint32 status ADC_BLOCK_OK/ADC_BLOCK_TORN of the block ADC_STREAM_STATUS_LAG before)
+typedef struct {
+    uint32_t magic;         // ADC_BLOCK_MAGIC
+    uint32_t seq;           // block-number since start (gaps => dropped blocks)
+    uint32_t dropped;       // total no. of blocks dropped since start
+    uint32_t no_samples;    // no. of 32bit-samples following the header
+    uint64_t first_sample;  // absolute index of the first sample since the RAM-Writer was started
+    uint64_t t_ns;          // CLOCK_MONOTONIC-time of the first sample on RedPitaya
+} AdcBlockHeader;
+
+// header of the result of the sweep-averaging (followed by int32 sum_a[no_steps], sum_b[no_steps]
+// if status is 0, mean = sum / no_sweeps in raw ADC-counts)
+typedef struct {
+    uint32_t magic;      // SWEEP_AVG_MAGIC
+    uint32_t no_steps;
+    uint32_t no_sweeps;
+    int32_t status;      // 0 = ok, SERVER_ERROR_ID = overrun/timeout/invalid parameters
+} SweepAvgHeader;
+
+// header of a binary LUT (followed by no_steps uint32 DAC-codes, the words as they are stored
+// in the BRAM of the DAC-BRAM-Controller, no conversion on RedPitaya; uploads with
+// LUT_BIN_VERSION_VOLTAGE are followed by no_steps float32 voltages instead)
+typedef struct {
+    uint32_t magic;        // LUT_BIN_MAGIC
+    uint32_t version;      // LUT_BIN_VERSION or LUT_BIN_VERSION_VOLTAGE (upload)
+    int32_t port_id;       // DAC-BRAM-Controller-Port
+    int32_t dac_port_id;   // DAC-Port connected to the DAC-BRAM-Controller-Port
+    uint32_t no_steps;     // no. of DAC-codes/voltages following the header
+    uint32_t checksum;     // CRC-32 (zlib) of the DAC-codes/voltages
+} LutBinHeader;
+
+// header of a variable-length BRAM-upload (DUMMY_DATA_GEN_BRAM_ID/LIA_MIXER_BRAM_ID),
+// followed by no_words uint32-words which are written to BRAM[offset ... offset + no_words - 1]
+typedef struct {
+    uint32_t magic;     // BRAM_UPLOAD_MAGIC
+    uint32_t offset;    // index of the first word in the BRAM
+    uint32_t no_words;  // no. of words following the header
+} BramUploadHeader;
+
 // struct for TCP-Command
 typedef struct {
     int id;
@@ -70,6 +142,83 @@ typedef struct {
     int ch;
 } TcpCmd;
 
+// Batched command protocol (frame = BatchFrameHeader followed by no_cmds x BatchCmd)
+// fixed-width fields, so the layout is the same on host and RedPitaya
+typedef struct {
+    uint32_t magic;     // BATCH_FRAME_MAGIC (never a valid TcpCmd-id)
+    uint16_t version;   // BATCH_PROTOCOL_VERSION
+    uint16_t no_cmds;   // no. of commands (requests) or responses following the header
+} BatchFrameHeader;
+
+typedef struct {
+    uint32_t seq;       // sequence-number from host, returned in the response
+    int32_t id;         // command-id (same IDs as TcpCmd)
+    int32_t ch;
+    int32_t reserved;
+    double val;
+} BatchCmd;
+
+typedef struct {
+    uint32_t seq;       // sequence-number of the command
+    int32_t status;     // BATCH_STATUS_*
+    int32_t value;      // value the command would send with send_to_client() (0 if none)
+    int32_t reserved;
+} BatchResp;
+
+// Command-sequence program (START_SEQUENCE): SeqProgramHeader followed by no_ops x SeqOp
+typedef struct {
+    uint32_t magic;        // SEQ_PROGRAM_MAGIC
+    uint16_t version;      // SEQ_PROTOCOL_VERSION
+    uint16_t no_ops;
+    uint32_t max_results;  // size of the result-buffer (captures)
+    uint32_t reserved;
+} SeqProgramHeader;
+
+typedef struct {
+    uint16_t op;      // SEQ_OP_*
+    uint16_t flags;   // SEQ_FLAG_*
+    int32_t id;       // SEQ_OP_CMD: command-id (same IDs as TcpCmd)
+    int32_t ch;       // SEQ_OP_CMD: channel
+    uint32_t count;   // SEQ_OP_LOOP: no. of iterations
+    double val;       // SEQ_OP_CMD: value, SEQ_OP_WAIT_UNTIL/SEQ_OP_DELAY: time in us
+} SeqOp;
+
+// result of a sequence: SeqResultHeader followed by no_results x SeqResult
+typedef struct {
+    uint32_t magic;        // SEQ_RESULT_MAGIC
+    int32_t status;        // SEQ_STATUS_*
+    uint32_t no_results;
+    uint32_t no_late;      // deadlines which were already over when the wait started
+    uint64_t t_total_ns;   // runtime of the program
+    uint64_t max_late_ns;  // max. delay behind a deadline
+} SeqResultHeader;
+
+typedef struct {
+    uint32_t op_index;  // index of the SEQ_OP_CMD in the program
+    int32_t status;     // BATCH_STATUS_*
+    int32_t value;      // value the command would send with send_to_client() (0 if none)
+    uint32_t loop_iter; // iteration of the innermost loop
+    uint64_t t_ns;      // end of the command, relative to the start of the program
+} SeqResult;
+
+// timestamped sample of the ADC24-Scanner
+typedef struct {
+    uint64_t t_ns;     // CLOCK_MONOTONIC on RedPitaya
+    uint32_t sweep;    // no. of the sweep this sample belongs to
+    uint16_t raw;      // 12-bit conversion result
+    uint8_t ch;
+    uint8_t reserved;
+} Adc24Sample;
+
+// header in front of the samples of a GET_WINDOW_ADC24-request
+typedef struct {
+    uint32_t no_samples;
+    uint32_t no_late;    // sweeps which missed their period
+    uint32_t truncated;  // 1 if the window held more samples than returned
+    uint32_t reserved;
+    uint64_t now_ns;     // CLOCK_MONOTONIC on RedPitaya when the window was taken
+} Adc24WindowHeader;
+
 // ADC-Config:
 typedef struct {
     int sample_rate_divider;  // relation between sys-clock and adc-sample-rate
@@ -87,6 +236,52 @@ typedef struct {
     int gain_offset_calib_en; // enable gain and offset calibration
 } AdcConfig;
 
+// config of a local recording (START_RECORD)
+typedef struct {
+    int rec_id;     // file rec_<rec_id>.rprc
+    int storage;    // REC_STORAGE_SD or REC_STORAGE_TMPFS
+    int no_chunks;  // no. of chunks (REC_CHUNK_SAMPLES each) to record
+} RecConfig;
+
+// file-header of a recording, the chunks start at REC_ALIGN
+typedef struct {
+    uint32_t magic;          // REC_FILE_MAGIC
+    uint32_t version;        // REC_FILE_VERSION
+    uint32_t chunk_samples;  // max. no. of samples per chunk
+    uint32_t no_chunks;      // 0 while recording (index is rebuilt from the chunk-headers)
+    uint64_t no_samples;     // no. of recorded samples (without lost chunks)
+    uint64_t index_offset;   // file-offset of RecChunkInfo[no_chunks], 0 while recording
+    uint64_t t_start_ns;     // CLOCK_MONOTONIC on RedPitaya
+    double sample_rate_hz;
+    AdcConfig adcCfg;        // ADC-Config used for the recording
+} RecFileHeader;
+
+// header in front of each chunk and entry of the index at the end of the file
+typedef struct {
+    uint32_t magic;         // REC_CHUNK_MAGIC
+    uint32_t seq;           // sequence-number of the package (gaps => lost packages)
+    uint32_t no_samples;
+    uint32_t overruns;      // total no. of packages lost before this chunk
+    uint64_t first_sample;  // absolute index of the first sample since start of sampling
+    uint64_t t_ns;          // CLOCK_MONOTONIC-time of the first sample
+    uint64_t offset;        // file-offset of the samples
+} RecChunkInfo;
+
+// request for samples [first_sample, first_sample + no_samples) of a recording
+typedef struct {
+    int32_t rec_id;
+    uint32_t no_samples;
+    uint64_t first_sample;
+} RecRangeRequest;
+
+typedef struct {
+    uint32_t magic;         // REC_RANGE_MAGIC
+    int32_t status;         // 0 or SERVER_ERROR_ID (no samples follow)
+    uint32_t no_samples;    // no. of samples following (clipped to the end of the recording)
+    uint32_t no_missing;    // samples of lost chunks inside the range (sent as 0)
+    uint64_t first_sample;
+} RecRangeHeader;
+
 // Trigger-Config:
 typedef struct {
     int trigger_inc;
@@ -137,6 +332,26 @@ typedef struct {
     uint32_t coeffs[30];  // coefficients for the IIR filter, max 6 SOS
 } LiaIIRConfig;
 
+// output of the software-LIA in ADC_LIA_MODE
+typedef struct {
+    uint32_t decimation;  // one point every decimation ADC-samples
+    uint32_t output;      // LIA_OUT_IQ or LIA_OUT_MAG_PHASE
+    uint32_t ref_len;     // words of the reference-table (one period), 0: all words uploaded so far
+} LiaStreamConfig;
+
+// reply of LIA_SW_CHECK: LiaCheckHeader followed by the capture (no_samples words), the
+// reference-table (ref_len words) and the output of the scalar version (no_points I/Q-pairs, int32)
+typedef struct {
+    uint32_t magic;       // LIA_CHECK_MAGIC
+    int32_t status;       // 0: NEON- and scalar-output identical, else index of the first different int32 + 1
+    uint32_t no_samples;
+    uint32_t ref_len;
+    uint32_t channel;
+    uint32_t decimation;
+    uint32_t no_points;
+    LiaIIRConfig iir;
+} LiaCheckHeader;
+
 
 // Struct to define a LUT-Value, for adjustment of single values inside LUT
 typedef struct {
@@ -147,6 +362,45 @@ typedef struct {
     int index;          // index for voltage value in LUT
 } LutValue;
 
+// config of the on-board LUT-calibration (START_LUT_CALIB), followed by no_triggers LutCalibPoint
+typedef struct {
+    int port_id;          // which DAC-BRAM-Ctrl-Port
+    int dac_dev_id;       // which dac-device
+    int dac_port_id;      // which DAC-Port is used
+    int no_triggers;      // no. of trigger-points of the sweep
+    int input_mode;       // host sends LUT_CALIB_INPUT_ERROR or LUT_CALIB_INPUT_READING
+    int max_iterations;   // max. measurements per trigger
+    float gain;           // voltage-step [V] per unit of error
+    float max_step;       // max. |voltage-step| per iteration [V]
+    float tolerance;      // trigger is converged for |error| <= tolerance
+    float min_voltage;    // LUT-voltages are clamped to [min_voltage, max_voltage]
+    float max_voltage;
+} LutCalibConfig;
+
+// trigger-point of the LUT-calibration
+typedef struct {
+    int index;      // LUT-index of the trigger
+    float voltage;  // current voltage of the LUT at index
+    float target;   // LUT_CALIB_INPUT_READING: error = target - reading
+} LutCalibPoint;
+
+// header of the result of the LUT-calibration (followed by no_triggers LutCalibResult)
+typedef struct {
+    uint32_t magic;            // LUT_CALIB_MAGIC
+    int32_t status;            // LUT_CALIB_OK/LUT_CALIB_TIMEOUT/LUT_CALIB_ABORTED
+    uint32_t no_triggers;
+    uint32_t no_measurements;  // total over all triggers
+} LutCalibResultHeader;
+
+// final state of one trigger-point
+typedef struct {
+    int index;
+    float voltage;   // final voltage in the LUT
+    float error;     // last error (NaN if the trigger was not reached)
+    int iterations;  // no. of measurements
+    int converged;   // |error| <= tolerance
+} LutCalibResult;
+
 // BRAM data struct which holds a maximum of 16KB of 32 bit samples
 typedef struct {
     uint32_t size;
@@ -0,0 +1,101 @@
+/*
+ * rp_sweep_avg.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Coherent averaging of DAC-BRAM-sweeps, see rp_sweep_avg.h
+ *
+ *    The consumer follows the pos-register of the RAM-Writer and accumulates every new
+ *    segment with accumulate_rf_adc_words(). A segment is split at the wrap-around of the
+ *    RAM-Buffer and at the end of a sweep (the step-index restarts at 0).
+ */
+
+#include "rp_sweep_avg.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rp_adc.h"
+#include "rp_constants.h"
+#include "rp_convert.h"
+#include "rp_ram.h"
+#include "rp_ram_stream.h"
+#include "rp_reset.h"
+#include "rp_trace.h"
+
+int sweep_average(AxiDevs axi_devs, RamConfig ramCfg, int no_steps, int no_sweeps, int sample_rate_divider,
+                  int32_t* sum_a, int32_t* sum_b) {
+    // returns 0 when all sweeps are accumulated, -1 on overrun/timeout/invalid parameters
+    uint32_t wrap = ram_stream_wrap_samples(ramCfg);
+    uint64_t total = (uint64_t)no_steps * (uint64_t)no_sweeps;
+    uint64_t done = 0;     // samples accumulated
+    uint64_t written = 0;  // samples written by the RAM-Writer
+    uint32_t rd_idx;
+    uint32_t step = 0;
+    int ret = 0;
+
+    if (no_steps <= 0 || no_sweeps <= 0 || no_sweeps > SWEEP_AVG_MAX_SWEEPS) {
+        printf("Invalid sweep-averaging parameters: %d steps, %d sweeps\n", no_steps, no_sweeps);
+        return -1;
+    }
+    memset(sum_a, 0, (size_t)no_steps * sizeof(int32_t));
+    memset(sum_b, 0, (size_t)no_steps * sizeof(int32_t));
+
+    // sleep a quarter of a sweep when waiting for new data
+    useconds_t poll_us = (useconds_t)((uint64_t)no_steps * (sample_rate_divider > 0 ? sample_rate_divider : 1) / (ADC_SYS_CLK_HZ / 1000000) / 4);
+    if (poll_us == 0) poll_us = 1;
+
+    // wrapping RAM-Writer, the ADC waits for first_sample of the DAC-BRAM-Controller
+    set_ram_writer_mode(axi_devs, RAM_WRITER_CONTI_MODE);
+    enable_module(axi_devs, RESET_INDEX_RAM_WRITER);
+    enable_module(axi_devs, RESET_INDEX_RP_ADC);
+
+    uint32_t last_pos = ram_stream_get_pos(ramCfg);
+    rd_idx = last_pos;
+    time_t t_progress = time(NULL);
+    while (done < total) {
+        uint32_t pos = ram_stream_get_pos(ramCfg);
+        uint32_t delta = (pos >= last_pos) ? (pos - last_pos) : (wrap - last_pos + pos);
+        last_pos = pos;
+        written += delta;
+
+        if (written == done) {
+            if (time(NULL) - t_progress > SWEEP_AVG_TIMEOUT_S) {
+                printf("Sweep-Averaging: no ADC-data for %d s (first-sample-trigger missing?)\n", SWEEP_AVG_TIMEOUT_S);
+                ret = -1;
+                break;
+            }
+            usleep(poll_us);
+            continue;
+        }
+        t_progress = time(NULL);
+
+        if (written - done > wrap) {
+            printf("Sweep-Averaging: RAM-Writer overwrote unprocessed data after %llu/%llu samples\n",
+                   (unsigned long long)done, (unsigned long long)total);
+            ret = -1;
+            break;
+        }
+
+        // accumulate all new samples (only up to the last sweep)
+        uint64_t avail = (written < total ? written : total) - done;
+        while (avail > 0) {
+            uint32_t n = (uint32_t)avail;
+            if (n > wrap - rd_idx) n = wrap - rd_idx;
+            if (n > (uint32_t)no_steps - step) n = (uint32_t)no_steps - step;
+
+            accumulate_rf_adc_words((const uint32_t*)ramCfg.ram + rd_idx, (int)n, sum_a + step, sum_b + step);
+            rd_idx = (rd_idx + n) % wrap;
+            step = (step + n) % (uint32_t)no_steps;
+            done += n;
+            avail -= n;
+        }
+        TRACE_DEBUG("Sweep-Averaging: %llu/%llu samples", (unsigned long long)done, (unsigned long long)total);
+    }
+
+    disable_rp_adc(axi_devs);
+    disable_ram_writer(axi_devs);
+    return ret;
+}
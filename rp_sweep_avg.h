@@ -0,0 +1,34 @@
+/*
+ * rp_sweep_avg.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Coherent averaging of DAC-BRAM-sweeps on RedPitaya:
+ *
+ *     -- the RF-ADC is started by first_sample_out of axis_dac_bram_controller_port0
+ *        (AdcConfig.trigger_mode = external) and samples once per LUT-step, so sample i of
+ *        the stream belongs to LUT-step (i % no_steps)
+ *
+ *     -- the RAM-Writer runs in continous-mode, the samples are accumulated per step
+ *        into int32-sums while the next sweeps are written (no. of sweeps is not limited
+ *        by the RAM-size)
+ *
+ *     -- only the sums of one sweep are sent to the host:
+ *        SweepAvgHeader + int32 sum_a[no_steps] + int32 sum_b[no_steps]
+ */
+
+#ifndef SRC_RP_SWEEP_AVG_H
+#define SRC_RP_SWEEP_AVG_H
+
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+// |raw| <= 2^13, so the int32-sums can't overflow up to 2^18 sweeps
+#define SWEEP_AVG_MAX_SWEEPS 65536
+#define SWEEP_AVG_TIMEOUT_S 5  // abort if the RAM-Writer does not advance (no first-sample-trigger)
+
+int sweep_average(AxiDevs axi_devs, RamConfig ramCfg, int no_steps, int no_sweeps, int sample_rate_divider,
+                  int32_t* sum_a, int32_t* sum_b);
+
+#endif
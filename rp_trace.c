@@ -0,0 +1,277 @@
+/*
+ * rp_trace.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Leveled binary tracing, see rp_trace.h
+ *
+ *    Each thread gets its own SpscRing on its first trace (the thread is the producer,
+ *    the dumper the consumer). Rings are registered in a list, registering is the only
+ *    locked operation. When a thread exits its ring is marked as orphaned and freed by
+ *    the dumper after it is drained.
+ */
+
+#include "rp_trace.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rp_spsc_ring.h"
+
+#define TRACE_DUMP_BATCH 4096
+
+typedef struct {
+    uint64_t t_ns;
+    const char* fmt;
+    uint32_t thread_no;
+    uint8_t level;
+    uint8_t no_args;
+    uint8_t arg_types[TRACE_MAX_ARGS];
+    union {
+        int64_t i;
+        double f;
+        const void* p;
+    } args[TRACE_MAX_ARGS];
+} TraceRecord;
+
+typedef struct TraceThreadRing {
+    SpscRing ring;
+    uint32_t thread_no;
+    atomic_uint dropped;
+    atomic_bool orphaned;  // thread exited, free after draining
+    struct TraceThreadRing* next;
+} TraceThreadRing;
+
+atomic_int trace_level = TRACE_LEVEL_INFO;
+
+static struct {
+    pthread_mutex_t lock;  // protects rings-list and batch (one consumer at a time)
+    pthread_key_t key;
+    pthread_once_t key_once;
+    pthread_t dumper;
+    atomic_bool running;
+    uint32_t no_threads;
+    TraceThreadRing* rings;
+    TraceRecord batch[TRACE_DUMP_BATCH];
+} trace = {.lock = PTHREAD_MUTEX_INITIALIZER, .key_once = PTHREAD_ONCE_INIT};
+
+static __thread TraceThreadRing* thread_ring = NULL;
+
+static const char* level_names[] = {"ERROR", "WARN", "INFO", "DEBUG", "HOT"};
+
+static uint64_t trace_now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static void thread_exit(void* arg) {
+    atomic_store(&((TraceThreadRing*)arg)->orphaned, true);
+}
+
+static void create_key(void) {
+    pthread_key_create(&trace.key, thread_exit);
+}
+
+static TraceThreadRing* register_thread(void) {
+    TraceThreadRing* r = calloc(1, sizeof(TraceThreadRing));
+    if (r == NULL) return NULL;
+    if (spsc_ring_init(&r->ring, TRACE_RING_SIZE, sizeof(TraceRecord)) != 0) {
+        free(r);
+        return NULL;
+    }
+    pthread_once(&trace.key_once, create_key);
+    pthread_setspecific(trace.key, r);
+
+    pthread_mutex_lock(&trace.lock);
+    r->thread_no = trace.no_threads++;
+    r->next = trace.rings;
+    trace.rings = r;
+    pthread_mutex_unlock(&trace.lock);
+    return r;
+}
+
+/**************************************************************/
+/* formatting (dumper only)                                   */
+/**************************************************************/
+
+static void print_record(const TraceRecord* rec) {
+    // formats the record like printf, each conversion uses the next stored argument
+    char out[512];
+    char spec[32];
+    size_t len = 0;
+    int arg = 0;
+    const char* p = rec->fmt;
+
+    while (*p != '\0' && len < sizeof(out) - 1) {
+        if (*p != '%') {
+            out[len++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[len++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // copy flags/width/precision, drop length-modifiers (arguments are stored 64-bit)
+        size_t s = 0;
+        spec[s++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL && s < sizeof(spec) - 4) spec[s++] = *p++;
+        while (*p != '\0' && strchr("hlzjtL", *p) != NULL) p++;
+        char conv = *p;
+        if (conv == '\0') break;
+        p++;
+
+        int n;
+        if (arg >= rec->no_args) {
+            n = snprintf(out + len, sizeof(out) - len, "<?>");
+        } else if (strchr("diouxXc", conv) != NULL) {
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = conv;
+            spec[s] = '\0';
+            int64_t v = rec->arg_types[arg] == TRACE_ARG_DOUBLE ? (int64_t)rec->args[arg].f : rec->args[arg].i;
+            n = (conv == 'd' || conv == 'i') ? snprintf(out + len, sizeof(out) - len, spec, (long long)v)
+                                              : snprintf(out + len, sizeof(out) - len, spec, (unsigned long long)v);
+        } else if (strchr("fFeEgGaA", conv) != NULL) {
+            spec[s++] = conv;
+            spec[s] = '\0';
+            double v = rec->arg_types[arg] == TRACE_ARG_DOUBLE ? rec->args[arg].f : (double)rec->args[arg].i;
+            n = snprintf(out + len, sizeof(out) - len, spec, v);
+        } else if (conv == 's') {
+            spec[s++] = 's';
+            spec[s] = '\0';
+            const char* str = rec->arg_types[arg] == TRACE_ARG_PTR ? rec->args[arg].p : NULL;
+            n = snprintf(out + len, sizeof(out) - len, spec, str != NULL ? str : "(null)");
+        } else if (conv == 'p') {
+            n = snprintf(out + len, sizeof(out) - len, "%p", rec->args[arg].p);
+        } else {
+            n = snprintf(out + len, sizeof(out) - len, "<%%%c?>", conv);
+        }
+        arg++;
+        if (n > 0) len += (size_t)n < sizeof(out) - len ? (size_t)n : sizeof(out) - 1 - len;
+    }
+    out[len] = '\0';
+
+    printf("[%llu.%06llu %s T%u] %s", (unsigned long long)(rec->t_ns / 1000000000ULL),
+           (unsigned long long)(rec->t_ns % 1000000000ULL / 1000), level_names[rec->level], rec->thread_no, out);
+    if (len == 0 || out[len - 1] != '\n') printf("\n");
+}
+
+static int compare_records(const void* a, const void* b) {
+    uint64_t t_a = ((const TraceRecord*)a)->t_ns;
+    uint64_t t_b = ((const TraceRecord*)b)->t_ns;
+    return (t_a > t_b) - (t_a < t_b);
+}
+
+static void drain_rings(void) {
+    // collects the records of all rings, prints them ordered by timestamp
+    int no_records = 0;
+
+    pthread_mutex_lock(&trace.lock);
+    TraceThreadRing** link = &trace.rings;
+    while (*link != NULL) {
+        TraceThreadRing* r = *link;
+        bool orphaned = atomic_load(&r->orphaned);
+
+        while (no_records < TRACE_DUMP_BATCH && spsc_ring_pop(&r->ring, &trace.batch[no_records])) no_records++;
+
+        unsigned int dropped = atomic_exchange(&r->dropped, 0);
+        if (dropped > 0) printf("[trace] T%u: %u records dropped (ring full)\n", r->thread_no, dropped);
+
+        if (orphaned && spsc_ring_count(&r->ring) == 0) {
+            *link = r->next;
+            spsc_ring_free(&r->ring);
+            free(r);
+        } else {
+            link = &r->next;
+        }
+    }
+
+    qsort(trace.batch, no_records, sizeof(TraceRecord), compare_records);
+    for (int i = 0; i < no_records; i++) print_record(&trace.batch[i]);
+    if (no_records > 0) fflush(stdout);
+    pthread_mutex_unlock(&trace.lock);
+}
+
+static void* dumper_thread(void* arg) {
+    (void)arg;
+    while (atomic_load(&trace.running)) {
+        drain_rings();
+        usleep(TRACE_DUMP_INTERVAL_US);
+    }
+    drain_rings();
+    return NULL;
+}
+
+/**************************************************************/
+/* API                                                        */
+/**************************************************************/
+
+void trace_write(int level, const char* fmt, const TraceArg* args, int no_args) {
+    TraceRecord rec;
+
+    rec.t_ns = trace_now_ns();
+    rec.fmt = fmt;
+    rec.level = (uint8_t)level;
+    rec.no_args = (uint8_t)(no_args < TRACE_MAX_ARGS ? no_args : TRACE_MAX_ARGS);
+    for (int i = 0; i < rec.no_args; i++) {
+        rec.arg_types[i] = args[i].type;
+        rec.args[i].i = args[i].i;  // copies the whole 64-bit value
+    }
+
+    if (!atomic_load_explicit(&trace.running, memory_order_relaxed)) {
+        // no dumper: format directly
+        rec.thread_no = 0;
+        print_record(&rec);
+        return;
+    }
+
+    if (thread_ring == NULL) {
+        thread_ring = register_thread();
+        if (thread_ring == NULL) return;
+    }
+    rec.thread_no = thread_ring->thread_no;
+    if (!spsc_ring_push(&thread_ring->ring, &rec)) atomic_fetch_add_explicit(&thread_ring->dropped, 1, memory_order_relaxed);
+}
+
+int trace_init(bool verbose) {
+    trace_set_verbose(verbose);
+    if (atomic_load(&trace.running)) return 0;
+
+    atomic_store(&trace.running, true);
+    if (pthread_create(&trace.dumper, NULL, dumper_thread, NULL) != 0) {
+        atomic_store(&trace.running, false);
+        printf("Starting trace-dumper failed, traces are printed directly\n");
+        return -1;
+    }
+    return 0;
+}
+
+void trace_set_verbose(bool verbose) {
+    trace_set_level(verbose ? TRACE_LEVEL_DEBUG : TRACE_LEVEL_INFO);
+}
+
+void trace_set_level(int level) {
+    if (level > RP_TRACE_LEVEL) {
+        printf("Trace-level %d is compiled out (RP_TRACE_LEVEL %d)\n", level, RP_TRACE_LEVEL);
+    }
+    atomic_store_explicit(&trace_level, level, memory_order_relaxed);
+}
+
+void trace_flush(void) {
+    // prints all pending records, callable from any thread
+    if (atomic_load(&trace.running)) drain_rings();
+}
+
+void trace_shutdown(void) {
+    if (!atomic_load(&trace.running)) return;
+    atomic_store(&trace.running, false);
+    pthread_join(trace.dumper, NULL);
+}
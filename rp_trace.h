@@ -0,0 +1,104 @@
+/*
+ * rp_trace.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Leveled binary tracing for the hot paths (SPI-reads, streaming, command-loop):
+ *
+ *     -- TRACE_*(fmt, args...) stores timestamp, pointer to the format-string and up to
+ *        TRACE_MAX_ARGS raw arguments as binary record in a lock-free ring of the calling
+ *        thread, no formatting and no console-output on the hot path
+ *
+ *     -- a dumper-thread formats the records of all threads (ordered by timestamp)
+ *        and prints them, records are dropped (and counted) if a ring is full
+ *
+ *     -- levels above RP_TRACE_LEVEL are compiled out (e.g. -DRP_TRACE_LEVEL=TRACE_LEVEL_HOT
+ *        to get the per-sample traces), the runtime-level is switched with trace_set_verbose()
+ *
+ *    The format-string has to be a string-literal and %s-arguments must point to static
+ *    strings, because both are formatted later by the dumper.
+ *    Without trace_init() (tools, tests) records are formatted and printed directly.
+ */
+
+#ifndef SRC_RP_TRACE_H
+#define SRC_RP_TRACE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRACE_LEVEL_ERROR 0
+#define TRACE_LEVEL_WARN 1
+#define TRACE_LEVEL_INFO 2
+#define TRACE_LEVEL_DEBUG 3  // verbose-mode
+#define TRACE_LEVEL_HOT 4    // per-sample/per-frame traces
+
+// highest level which is compiled in
+#ifndef RP_TRACE_LEVEL
+#define RP_TRACE_LEVEL TRACE_LEVEL_DEBUG
+#endif
+
+#define TRACE_MAX_ARGS 4
+#define TRACE_RING_SIZE 1024  // records per thread, power of two
+#define TRACE_DUMP_INTERVAL_US 10000
+
+typedef enum {
+    TRACE_ARG_INT,
+    TRACE_ARG_DOUBLE,
+    TRACE_ARG_PTR
+} TraceArgType;
+
+typedef struct {
+    uint8_t type;  // TraceArgType
+    union {
+        int64_t i;
+        double f;
+        const void* p;
+    };
+} TraceArg;
+
+extern atomic_int trace_level;  // runtime-level (set by the reactor, read by all threads)
+
+static inline TraceArg trace_arg_int(int64_t i) { return (TraceArg){.type = TRACE_ARG_INT, .i = i}; }
+static inline TraceArg trace_arg_double(double f) { return (TraceArg){.type = TRACE_ARG_DOUBLE, .f = f}; }
+static inline TraceArg trace_arg_ptr(const void* p) { return (TraceArg){.type = TRACE_ARG_PTR, .p = p}; }
+
+#define TRACE_ARG(x)                                                                                        \
+    _Generic((x), float: trace_arg_double, double: trace_arg_double, char*: trace_arg_ptr,                   \
+             const char*: trace_arg_ptr, void*: trace_arg_ptr, const void*: trace_arg_ptr, default: trace_arg_int)(x)
+
+// map up to TRACE_MAX_ARGS arguments to TraceArgs
+#define TRACE_NARGS(...) TRACE_NARGS_(_, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define TRACE_NARGS_(_0, _1, _2, _3, _4, N, ...) N
+#define TRACE_CAT(a, b) TRACE_CAT_(a, b)
+#define TRACE_CAT_(a, b) a##b
+#define TRACE_MAP_0()
+#define TRACE_MAP_1(a) TRACE_ARG(a)
+#define TRACE_MAP_2(a, b) TRACE_ARG(a), TRACE_ARG(b)
+#define TRACE_MAP_3(a, b, c) TRACE_ARG(a), TRACE_ARG(b), TRACE_ARG(c)
+#define TRACE_MAP_4(a, b, c, d) TRACE_ARG(a), TRACE_ARG(b), TRACE_ARG(c), TRACE_ARG(d)
+#define TRACE_MAP(...) TRACE_CAT(TRACE_MAP_, TRACE_NARGS(__VA_ARGS__))(__VA_ARGS__)
+
+// levels above RP_TRACE_LEVEL are removed by the compiler (arguments are still type-checked)
+#define TRACE(level, fmt, ...)                                                                                  \
+    do {                                                                                                        \
+        if ((level) <= RP_TRACE_LEVEL && (level) <= atomic_load_explicit(&trace_level, memory_order_relaxed)) { \
+            TraceArg trace_args_[] = {TRACE_MAP(__VA_ARGS__)};                                                  \
+            trace_write((level), fmt, trace_args_, sizeof(trace_args_) / sizeof(TraceArg));                     \
+        }                                                                                                       \
+    } while (0)
+
+#define TRACE_ERROR(fmt, ...) TRACE(TRACE_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define TRACE_WARN(fmt, ...) TRACE(TRACE_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define TRACE_INFO(fmt, ...) TRACE(TRACE_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define TRACE_DEBUG(fmt, ...) TRACE(TRACE_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define TRACE_HOT(fmt, ...) TRACE(TRACE_LEVEL_HOT, fmt, ##__VA_ARGS__)
+
+void trace_write(int level, const char* fmt, const TraceArg* args, int no_args);
+int trace_init(bool verbose);
+void trace_set_verbose(bool verbose);
+void trace_set_level(int level);
+void trace_flush(void);
+void trace_shutdown(void);
+
+#endif
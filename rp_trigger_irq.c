@@ -0,0 +1,197 @@
+/*
+ * rp_trigger_irq.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Trigger-armed event via UIO-interrupt or simulator-eventfd, see rp_trigger_irq.h
+ *
+ *    UIO: read() returns the interrupt-count and the interrupt stays masked till 1 is
+ *    written to the device (uio_pdrv_genirq), so it is unmasked in trigger_irq_arm().
+ */
+
+#include "rp_trigger_irq.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rp_hal.h"
+#include "rp_metrics.h"
+#include "rp_trigger_gen.h"
+#include "rp_trace.h"
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+static int open_uio_by_name(const char* name) {
+    // searches /sys/class/uio/uioX/name for the device of the Trigger-Generator
+    char path[64], dev_name[64];
+    struct dirent* entry;
+    int fd = -1;
+
+    DIR* dir = opendir("/sys/class/uio");
+    if (dir == NULL) return -1;
+
+    while (fd < 0 && (entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "uio", 3) != 0) continue;
+
+        snprintf(path, sizeof(path), "/sys/class/uio/%.16s/name", entry->d_name);
+        FILE* f = fopen(path, "r");
+        if (f == NULL) continue;
+        bool match = fgets(dev_name, sizeof(dev_name), f) != NULL && strncmp(dev_name, name, strlen(name)) == 0 &&
+                     (dev_name[strlen(name)] == '\n' || dev_name[strlen(name)] == '\0');
+        fclose(f);
+
+        if (match) {
+            snprintf(path, sizeof(path), "/dev/%.16s", entry->d_name);
+            fd = open(path, O_RDWR | O_CLOEXEC);
+            if (fd < 0) printf("Opening %s failed: %s\n", path, strerror(errno));
+        }
+    }
+    closedir(dir);
+    return fd;
+}
+
+static void drain_events(TriggerIrq* irq) {
+    // reads pending events without blocking
+    struct pollfd pfd = {.fd = irq->fd, .events = POLLIN};
+    uint64_t count;
+
+    while (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+        // UIO: 4 bytes interrupt-count, eventfd: 8 bytes counter
+        if (read(irq->fd, &count, irq->mode == TRIGGER_IRQ_UIO ? sizeof(uint32_t) : sizeof(uint64_t)) <= 0) break;
+    }
+}
+
+int trigger_irq_open(TriggerIrq* irq) {
+    memset(irq, 0, sizeof(TriggerIrq));
+    pthread_mutex_init(&irq->stats_lock, NULL);
+    irq->fd = -1;
+    irq->mode = TRIGGER_IRQ_POLLING;
+
+    if (hal_is_simulated()) {
+        irq->fd = hal_sim_trigger_fd();
+        irq->mode = TRIGGER_IRQ_SIM;
+        printf("Trigger-armed events from the simulator\n");
+        return 0;
+    }
+
+    irq->fd = open_uio_by_name(TRIGGER_IRQ_UIO_NAME);
+    if (irq->fd < 0) {
+        printf("No UIO-device '%s', waiting for triggers by polling the Trigger-Generator\n", TRIGGER_IRQ_UIO_NAME);
+        return -1;
+    }
+    irq->mode = TRIGGER_IRQ_UIO;
+    printf("Trigger-armed events via UIO-interrupt '%s'\n", TRIGGER_IRQ_UIO_NAME);
+    return 0;
+}
+
+void trigger_irq_close(TriggerIrq* irq) {
+    // the eventfd of the simulator is closed by the HAL
+    if (irq->mode == TRIGGER_IRQ_UIO) close(irq->fd);
+    irq->fd = -1;
+    irq->mode = TRIGGER_IRQ_POLLING;
+}
+
+void trigger_irq_arm(TriggerIrq* irq) {
+    // call before the trigger is (re-)armed: drops old events and unmasks the interrupt
+    irq->t_wait = now_ns();
+    if (irq->mode == TRIGGER_IRQ_POLLING) return;
+
+    drain_events(irq);
+    if (irq->mode == TRIGGER_IRQ_UIO) {
+        uint32_t unmask = 1;
+        if (write(irq->fd, &unmask, sizeof(unmask)) != sizeof(unmask)) {
+            printf("Unmasking trigger-interrupt failed: %s\n", strerror(errno));
+        }
+    }
+}
+
+int trigger_irq_wait(TriggerIrq* irq, AxiDevs axi_devs, int timeout_ms) {
+    // returns 0 when the trigger is armed, -1 on timeout/error (wait-time goes to the metrics)
+    uint64_t t_wait = now_ns();
+    if (irq->mode == TRIGGER_IRQ_POLLING) {
+        wait_for_wlength_request(axi_devs);
+        irq->t_armed = now_ns();
+        metrics_observe(&metrics.trigger_wait, irq->t_armed - t_wait);
+        return 0;
+    }
+
+    struct pollfd pfd = {.fd = irq->fd, .events = POLLIN};
+    uint64_t t_deadline = t_wait + (uint64_t)timeout_ms * 1000000ULL;
+    int ret;
+    do {
+        int64_t remaining_ms = ((int64_t)t_deadline - (int64_t)now_ns()) / 1000000;
+        ret = poll(&pfd, 1, remaining_ms > 0 ? (int)remaining_ms : 0);
+    } while (ret < 0 && errno == EINTR);
+
+    if (ret <= 0) {
+        if (ret < 0) printf("Waiting for trigger-event failed: %s\n", strerror(errno));
+        trigger_irq_timeout(irq, timeout_ms);
+        return -1;
+    }
+    irq->t_wait = t_wait;
+    return trigger_irq_event(irq);
+}
+
+int trigger_irq_fd(TriggerIrq* irq) {
+    // readable on trigger-armed (for epoll), -1 in polling-mode
+    return (irq->mode == TRIGGER_IRQ_POLLING) ? -1 : irq->fd;
+}
+
+int trigger_irq_event(TriggerIrq* irq) {
+    // call when trigger_irq_fd() got readable: consumes the event, 0 when the trigger is armed
+    irq->t_armed = now_ns();
+    metrics_observe(&metrics.trigger_wait, irq->t_armed - irq->t_wait);
+
+    uint64_t count = 0;
+    if (read(irq->fd, &count, irq->mode == TRIGGER_IRQ_UIO ? sizeof(uint32_t) : sizeof(uint64_t)) <= 0) {
+        printf("Reading trigger-event failed: %s\n", strerror(errno));
+        return -1;
+    }
+    if (irq->mode == TRIGGER_IRQ_SIM) irq->t_armed = hal_sim_last_trigger_ns();
+    return 0;
+}
+
+void trigger_irq_timeout(TriggerIrq* irq, int timeout_ms) {
+    // no trigger-armed event within timeout_ms
+    pthread_mutex_lock(&irq->stats_lock);
+    irq->stats.no_timeouts++;
+    pthread_mutex_unlock(&irq->stats_lock);
+    metrics_add(&metrics.trigger_timeouts, 1);
+    printf("No trigger-armed event within %d ms\n", timeout_ms);
+}
+
+void trigger_irq_notified(TriggerIrq* irq) {
+    // call after REQ_WLENGTH was sent
+    uint64_t latency = now_ns() - irq->t_armed;
+
+    pthread_mutex_lock(&irq->stats_lock);
+    irq->stats.no_events++;
+    irq->stats.last_ns = latency;
+    irq->stats.sum_ns += latency;
+    if (latency > irq->stats.max_ns) irq->stats.max_ns = latency;
+    pthread_mutex_unlock(&irq->stats_lock);
+    TRACE_DEBUG("Trigger-armed -> REQ_WLENGTH: %llu us", (unsigned long long)(latency / 1000));
+}
+
+void trigger_irq_get_stats(TriggerIrq* irq, TriggerIrqStats* stats) {
+    // consistent copy of the statistics
+    pthread_mutex_lock(&irq->stats_lock);
+    *stats = irq->stats;
+    pthread_mutex_unlock(&irq->stats_lock);
+}
+
+void trigger_irq_reset_stats(TriggerIrq* irq) {
+    pthread_mutex_lock(&irq->stats_lock);
+    memset(&irq->stats, 0, sizeof(TriggerIrqStats));
+    pthread_mutex_unlock(&irq->stats_lock);
+}
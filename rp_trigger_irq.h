@@ -0,0 +1,73 @@
+/*
+ * rp_trigger_irq.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Trigger-armed event of the Trigger-Generator (wavelength-request of the trigger-sweep):
+ *
+ *     -- FPGA: interrupt of the Trigger-Generator via UIO (/dev/uioX with the name
+ *        TRIGGER_IRQ_UIO_NAME in /sys/class/uio), the server sleeps in poll() with a
+ *        timeout instead of spinning on the register in wait_for_wlength_request()
+ *
+ *     -- simulator: eventfd which is written by the simulator-thread for every simulated
+ *        trigger (hal_sim_trigger_fd()), so the handshake runs on a PC
+ *
+ *     -- without UIO-device wait_for_wlength_request() is used (busy polling, no timeout)
+ *
+ *    Every wait is started with trigger_irq_arm() before the trigger is (re-)armed, so an
+ *    old event does not release the next wait. The app-server waits for trigger_irq_fd()
+ *    in its epoll-set and completes the wait with trigger_irq_event()/trigger_irq_timeout(),
+ *    trigger_irq_wait() blocks (worker-thread, polling-mode). The latency from trigger-armed to the sent
+ *    REQ_WLENGTH is measured with trigger_irq_notified() (FPGA: from the wake-up of
+ *    poll(), simulator: from the time the event was raised). The statistics are updated by
+ *    the reactor and the LUT-Calibration-job, they are read with trigger_irq_get_stats().
+ */
+
+#ifndef SRC_RP_TRIGGER_IRQ_H
+#define SRC_RP_TRIGGER_IRQ_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rp_structs.h"
+
+#define TRIGGER_IRQ_UIO_NAME "trigger_gen"  // name of the generic-uio node in the device-tree
+#define TRIGGER_IRQ_TIMEOUT_MS 10000
+
+typedef enum {
+    TRIGGER_IRQ_POLLING,  // no UIO-device: wait_for_wlength_request()
+    TRIGGER_IRQ_UIO,
+    TRIGGER_IRQ_SIM
+} TriggerIrqMode;
+
+typedef struct {
+    uint32_t no_events;    // REQ_WLENGTH sent
+    uint32_t no_timeouts;  // no trigger-armed event within TRIGGER_IRQ_TIMEOUT_MS
+    uint64_t last_ns;      // latency trigger-armed -> REQ_WLENGTH sent
+    uint64_t max_ns;
+    uint64_t sum_ns;
+} TriggerIrqStats;
+
+typedef struct {
+    TriggerIrqMode mode;
+    int fd;             // UIO-device or eventfd of the simulator
+    uint64_t t_wait;    // CLOCK_MONOTONIC-time [ns] of the last trigger_irq_arm() (start of the wait)
+    uint64_t t_armed;   // CLOCK_MONOTONIC-time [ns] of the last trigger-armed event
+    pthread_mutex_t stats_lock;  // reactor- and worker-thread update the stats
+    TriggerIrqStats stats;
+} TriggerIrq;
+
+int trigger_irq_open(TriggerIrq* irq);
+void trigger_irq_close(TriggerIrq* irq);
+
+void trigger_irq_arm(TriggerIrq* irq);
+int trigger_irq_wait(TriggerIrq* irq, AxiDevs axi_devs, int timeout_ms);
+int trigger_irq_fd(TriggerIrq* irq);
+int trigger_irq_event(TriggerIrq* irq);
+void trigger_irq_timeout(TriggerIrq* irq, int timeout_ms);
+void trigger_irq_notified(TriggerIrq* irq);
+void trigger_irq_get_stats(TriggerIrq* irq, TriggerIrqStats* stats);
+void trigger_irq_reset_stats(TriggerIrq* irq);
+
+#endif
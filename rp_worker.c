@@ -0,0 +1,130 @@
+/*
+ * rp_worker.c
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Single background-thread which executes one long running job at a time.
+ *    Jobs get submitted from the command-loop, after the job is done
+ *    the eventfd is signaled so the command-loop can hand back the client-socket
+ *    (the owner-socket is part of the job, it is returned by worker_collect()).
+ */
+
+#include "rp_worker.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+static void* worker_thread(void* arg) {
+    Worker* worker = (Worker*)arg;
+    uint64_t one = 1;
+
+    pthread_mutex_lock(&worker->lock);
+    while (!worker->shutdown) {
+        // wait for a new job
+        if (!worker->pending) {
+            pthread_cond_wait(&worker->cond, &worker->lock);
+            continue;
+        }
+        WorkerJob job = worker->job;
+        worker->pending = false;
+        pthread_mutex_unlock(&worker->lock);
+
+        job.fn(job.arg);
+
+        pthread_mutex_lock(&worker->lock);
+        worker->finished = true;
+        // notify command-loop that the job is finished
+        if (write(worker->event_fd, &one, sizeof(one)) < 0) {
+            printf("Worker: signaling finished job failed: %s\n", strerror(errno));
+        }
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return NULL;
+}
+
+int worker_init(Worker* worker) {
+    memset(worker, 0, sizeof(Worker));
+    worker->job.owner_fd = -1;
+
+    worker->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (worker->event_fd < 0) {
+        printf("Worker: creating eventfd failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    pthread_mutex_init(&worker->lock, NULL);
+    pthread_cond_init(&worker->cond, NULL);
+
+    if (pthread_create(&worker->thread, NULL, worker_thread, worker) != 0) {
+        printf("Worker: creating worker-thread failed\n");
+        close(worker->event_fd);
+        return -1;
+    }
+    return 0;
+}
+
+bool worker_submit(Worker* worker, WorkerJob job) {
+    // returns false if the worker is still busy with another job (or it was not collected yet)
+    bool accepted = false;
+
+    pthread_mutex_lock(&worker->lock);
+    if (!worker->busy && !worker->shutdown) {
+        worker->job = job;
+        worker->pending = true;
+        worker->busy = true;
+        accepted = true;
+        pthread_cond_signal(&worker->cond);
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return accepted;
+}
+
+bool worker_collect(Worker* worker, WorkerJob* job) {
+    // call after event_fd got readable: returns false if no job is finished, else the finished
+    // job (owner-socket, done-callback) and the worker accepts the next one
+    uint64_t cnt;
+    bool finished;
+
+    if (read(worker->event_fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) {
+        printf("Worker: reading eventfd failed: %s\n", strerror(errno));
+    }
+    pthread_mutex_lock(&worker->lock);
+    finished = worker->finished;
+    if (finished) {
+        *job = worker->job;
+        worker->job.owner_fd = -1;
+        worker->finished = false;
+        worker->busy = false;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return finished;
+}
+
+bool worker_is_busy(Worker* worker) {
+    bool busy;
+    pthread_mutex_lock(&worker->lock);
+    busy = worker->busy;
+    pthread_mutex_unlock(&worker->lock);
+    return busy;
+}
+
+int worker_event_fd(Worker* worker) {
+    return worker->event_fd;
+}
+
+void worker_shutdown(Worker* worker) {
+    // waits for a running job to finish before the thread gets joined
+    pthread_mutex_lock(&worker->lock);
+    worker->shutdown = true;
+    pthread_cond_signal(&worker->cond);
+    pthread_mutex_unlock(&worker->lock);
+
+    pthread_join(worker->thread, NULL);
+    close(worker->event_fd);
+    pthread_mutex_destroy(&worker->lock);
+    pthread_cond_destroy(&worker->cond);
+}
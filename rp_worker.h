@@ -0,0 +1,53 @@
+/*
+ * rp_worker.h
+ *
+ *  Created on: 17.10.2026
+ *
+ *    Background worker-thread for long running jobs (ADC-RAM-TCP-Writers, RAM-Tests...)
+ *
+ *    The command-loop hands a job to the worker and keeps serving the other clients.
+ *    When a job is finished the worker signals the eventfd returned by worker_event_fd(),
+ *    which can be added to the epoll-set of the server.
+ *
+ *    The worker stays busy till the finished job was collected by worker_collect(), so
+ *    the owner-socket and the done-callback of a job can't be overwritten by the next one.
+ */
+
+#ifndef SRC_RP_WORKER_H
+#define SRC_RP_WORKER_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+// function executed by the worker-thread, arg is handed over by worker_submit()
+typedef void (*WorkerJobFn)(void* arg);
+// called by the command-loop after the finished job was collected (may be NULL)
+typedef void (*WorkerDoneFn)(void* arg);
+
+typedef struct {
+    WorkerJobFn fn;
+    WorkerDoneFn done;
+    void* arg;
+    int owner_fd;  // client-socket which is owned by the job (-1: none)
+} WorkerJob;
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int event_fd;        // gets signaled after a job is finished
+    WorkerJob job;       // submitted, running or finished job
+    bool pending;        // job is submitted and not started yet
+    bool finished;       // job is finished and not collected yet
+    bool busy;           // from worker_submit() till worker_collect()
+    bool shutdown;
+} Worker;
+
+int worker_init(Worker* worker);
+bool worker_submit(Worker* worker, WorkerJob job);
+bool worker_collect(Worker* worker, WorkerJob* job);
+bool worker_is_busy(Worker* worker);
+int worker_event_fd(Worker* worker);
+void worker_shutdown(Worker* worker);
+
+#endif
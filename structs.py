@@ -2,7 +2,19 @@
 definiton of c-structs used to communicate with C-Application on RedPitaya
 """
 
-from ctypes import c_char_p, c_int, c_uint32, c_float, Structure, c_double, c_bool
+from ctypes import (
+    c_char_p,
+    c_int,
+    c_int32,
+    c_uint8,
+    c_uint16,
+    c_uint32,
+    c_uint64,
+    c_float,
+    Structure,
+    c_double,
+    c_bool,
+)
 
 
 # c-struct for tcp-command
@@ -10,6 +22,219 @@ class TcpCommand(Structure):
     _fields_ = [("id", c_int), ("val", c_double), ("ch", c_int)]
 
 
+# header in front of each tcp-package in ADC-Continous-Mode (followed by no_samples samples
+# and a uint32 status of the package ADC_STREAM_STATUS_LAG before, no_samples = 0 for a lost package)
+class AdcStreamHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("seq", c_uint32),
+        ("overruns", c_uint32),
+        ("no_samples", c_uint32),
+    ]
+
+
+# header in front of each tcp-package in compressed ADC-Continous-Mode (followed by no_bytes payload)
+class AdcStreamZHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("seq", c_uint32),
+        ("overruns", c_uint32),
+        ("no_samples", c_uint32),
+        ("no_bytes", c_uint32),
+        ("codec", c_uint16),
+        ("reserved", c_uint16),
+    ]
+
+
+# header in front of each block in ADC-Multi-Block-Mode
+class AdcBlockHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("seq", c_uint32),
+        ("dropped", c_uint32),
+        ("no_samples", c_uint32),
+        ("first_sample", c_uint64),
+        ("t_ns", c_uint64),
+    ]
+
+
+# header of the result of the on-board sweep-averaging (followed by int32-sums of channel A and B)
+class SweepAvgHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("no_steps", c_uint32),
+        ("no_sweeps", c_uint32),
+        ("status", c_int32),
+    ]
+
+
+# header of a binary LUT (followed by no_steps uint32 DAC-codes, as stored in the BRAM,
+# or no_steps float32 voltages for uploads with LUT_BIN_VERSION_VOLTAGE)
+class LutBinHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("version", c_uint32),
+        ("port_id", c_int32),
+        ("dac_port_id", c_int32),
+        ("no_steps", c_uint32),
+        ("checksum", c_uint32),  # zlib.crc32() of the DAC-codes/voltages
+    ]
+
+
+# header of a BRAM-upload (followed by no_words uint32-words, written to BRAM[offset:offset + no_words])
+class BramUploadHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("offset", c_uint32),
+        ("no_words", c_uint32),
+    ]
+
+
+# config of the on-board LUT-calibration (followed by no_triggers LutCalibPoint)
+class LutCalibConfig(Structure):
+    _fields_ = [
+        ("port_id", c_int),
+        ("dac_dev_id", c_int),
+        ("dac_port_id", c_int),
+        ("no_triggers", c_int),
+        ("input_mode", c_int),  # LUT_CALIB_INPUT_ERROR or LUT_CALIB_INPUT_READING
+        ("max_iterations", c_int),
+        ("gain", c_float),  # voltage-step [V] per unit of error
+        ("max_step", c_float),
+        ("tolerance", c_float),
+        ("min_voltage", c_float),
+        ("max_voltage", c_float),
+    ]
+
+
+# trigger-point of the LUT-calibration
+class LutCalibPoint(Structure):
+    _fields_ = [
+        ("index", c_int),
+        ("voltage", c_float),  # current voltage of the LUT at index
+        ("target", c_float),  # only used with LUT_CALIB_INPUT_READING
+    ]
+
+
+# header of the result of the LUT-calibration (followed by no_triggers LutCalibResult)
+class LutCalibResultHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("status", c_int32),
+        ("no_triggers", c_uint32),
+        ("no_measurements", c_uint32),
+    ]
+
+
+# final state of one trigger-point of the LUT-calibration
+class LutCalibResult(Structure):
+    _fields_ = [
+        ("index", c_int),
+        ("voltage", c_float),
+        ("error", c_float),
+        ("iterations", c_int),
+        ("converged", c_int),
+    ]
+
+
+# header of a batch-frame (request and response)
+class BatchFrameHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("version", c_uint16),
+        ("no_cmds", c_uint16),
+    ]
+
+
+# one command inside a batch-frame
+class BatchCmd(Structure):
+    _fields_ = [
+        ("seq", c_uint32),
+        ("id", c_int32),
+        ("ch", c_int32),
+        ("reserved", c_int32),
+        ("val", c_double),
+    ]
+
+
+# response of one command inside the response-frame
+class BatchResp(Structure):
+    _fields_ = [
+        ("seq", c_uint32),
+        ("status", c_int32),
+        ("value", c_int32),
+        ("reserved", c_int32),
+    ]
+
+
+# header of a command-sequence program (followed by no_ops SeqOp)
+class SeqProgramHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("version", c_uint16),
+        ("no_ops", c_uint16),
+        ("max_results", c_uint32),
+        ("reserved", c_uint32),
+    ]
+
+
+# one operation of a command-sequence (SEQ_OP_*)
+class SeqOp(Structure):
+    _fields_ = [
+        ("op", c_uint16),
+        ("flags", c_uint16),
+        ("id", c_int32),
+        ("ch", c_int32),
+        ("count", c_uint32),  # SEQ_OP_LOOP
+        ("val", c_double),  # command-value or time in us
+    ]
+
+
+# header of the result of a command-sequence (followed by no_results SeqResult)
+class SeqResultHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("status", c_int32),
+        ("no_results", c_uint32),
+        ("no_late", c_uint32),  # deadlines which were already over
+        ("t_total_ns", c_uint64),
+        ("max_late_ns", c_uint64),
+    ]
+
+
+# captured reply of one command of a command-sequence
+class SeqResult(Structure):
+    _fields_ = [
+        ("op_index", c_uint32),
+        ("status", c_int32),
+        ("value", c_int32),
+        ("loop_iter", c_uint32),
+        ("t_ns", c_uint64),  # relative to the start of the program
+    ]
+
+
+# timestamped sample of the ADC24-Scanner
+class Adc24Sample(Structure):
+    _fields_ = [
+        ("t_ns", c_uint64),  # CLOCK_MONOTONIC on RedPitaya
+        ("sweep", c_uint32),
+        ("raw", c_uint16),
+        ("ch", c_uint8),
+        ("reserved", c_uint8),
+    ]
+
+
+# header in front of the samples of GET_WINDOW_ADC24
+class Adc24WindowHeader(Structure):
+    _fields_ = [
+        ("no_samples", c_uint32),
+        ("no_late", c_uint32),
+        ("truncated", c_uint32),
+        ("reserved", c_uint32),
+        ("now_ns", c_uint64),
+    ]
+
+
 # c-structs for sending Config-Params via TCP to RedPitaya
 class TriggerConfig(Structure):
     _fields_ = [
@@ -61,6 +286,109 @@ class AdcConfig(Structure):
     ]
 
 
+# config of a local recording (START_RECORD)
+class RecConfig(Structure):
+    _fields_ = [
+        ("rec_id", c_int),  # file rec_<rec_id>.rprc
+        ("storage", c_int),  # REC_STORAGE_SD or REC_STORAGE_TMPFS
+        ("no_chunks", c_int),  # no. of chunks (REC_CHUNK_SAMPLES each) to record
+    ]
+
+
+# file-header of a recording
+class RecFileHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("version", c_uint32),
+        ("chunk_samples", c_uint32),
+        ("no_chunks", c_uint32),
+        ("no_samples", c_uint64),  # no. of recorded samples (without lost chunks)
+        ("index_offset", c_uint64),  # 0 while recording
+        ("t_start_ns", c_uint64),  # CLOCK_MONOTONIC on RedPitaya
+        ("sample_rate_hz", c_double),
+        ("adcCfg", AdcConfig),
+    ]
+
+
+# index-entry of one chunk (gaps in first_sample => lost packages)
+class RecChunkInfo(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("seq", c_uint32),
+        ("no_samples", c_uint32),
+        ("overruns", c_uint32),
+        ("first_sample", c_uint64),
+        ("t_ns", c_uint64),
+        ("offset", c_uint64),
+    ]
+
+
+# request for samples [first_sample, first_sample + no_samples) of a recording
+class RecRangeRequest(Structure):
+    _fields_ = [
+        ("rec_id", c_int32),
+        ("no_samples", c_uint32),
+        ("first_sample", c_uint64),
+    ]
+
+
+class RecRangeHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("status", c_int32),
+        ("no_samples", c_uint32),  # clipped to the end of the recording
+        ("no_missing", c_uint32),  # samples of lost chunks inside the range (0)
+        ("first_sample", c_uint64),
+    ]
+
+
+# histogram of durations (log2-buckets, see METRICS_HIST_SHIFT)
+class MetricsHist(Structure):
+    _fields_ = [
+        ("sum_ns", c_uint64),
+        ("buckets", c_uint64 * 24),  # METRICS_HIST_BUCKETS
+    ]
+
+
+class MetricsStream(Structure):
+    _fields_ = [
+        ("bytes", c_uint64),
+        ("packages", c_uint64),
+    ]
+
+
+class MetricsSpi(Structure):
+    _fields_ = [
+        ("transfers", c_uint64),
+        ("latency", MetricsHist),  # one entry per SPI-transaction
+    ]
+
+
+# reply of GET_STATS (followed by no_cmds StatsCmdEntry)
+class StatsSnapshotHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("version", c_uint32),
+        ("t_ns", c_uint64),
+        ("t_start_ns", c_uint64),  # start of the server or last STATS_RESET
+        ("no_cmds", c_uint32),
+        ("hist_buckets", c_uint32),
+        ("streams", MetricsStream * 5),  # METRICS_STREAMS
+        ("ram_overruns", c_uint64),
+        ("spi", MetricsSpi * 2),  # METRICS_SPI_BOARDS
+        ("trigger_wait", MetricsHist),
+        ("trigger_timeouts", c_uint64),
+    ]
+
+
+class StatsCmdEntry(Structure):
+    _fields_ = [
+        ("cmd_id", c_int32),  # METRICS_CMD_OTHER for IDs >= 256
+        ("reserved", c_uint32),
+        ("service", MetricsHist),
+    ]
+
+
 # Struct to define config for RAM-Writer module
 class RamInitConfig(Structure):
     _fields_ = [
@@ -98,6 +426,43 @@ class LiaIIRConfig(Structure):
     ]
 
 
+# output of the software-LIA in ADC_LIA_MODE
+class LiaStreamConfig(Structure):
+    _fields_ = [
+        ("decimation", c_uint32),  # one point every decimation ADC-samples
+        ("output", c_uint32),  # LIA_OUT_IQ or LIA_OUT_MAG_PHASE
+        ("ref_len", c_uint32),  # words of the reference-table (one period), 0: all words uploaded so far
+    ]
+
+
+# reply of LIA_SW_CHECK (capture, reference-table and scalar output follow)
+class LiaCheckHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("status", c_int32),  # 0: NEON- and scalar-output identical, else index of the first difference + 1
+        ("no_samples", c_uint32),
+        ("ref_len", c_uint32),
+        ("channel", c_uint32),
+        ("decimation", c_uint32),
+        ("no_points", c_uint32),
+        ("iir", LiaIIRConfig),
+    ]
+
+
+# header in front of each tcp-package in ADC_LIA_MODE (followed by no_points pairs)
+class LiaStreamHeader(Structure):
+    _fields_ = [
+        ("magic", c_uint32),
+        ("seq", c_uint32),
+        ("overruns", c_uint32),
+        ("no_points", c_uint32),
+        ("output", c_uint16),
+        ("reserved", c_uint16),
+        ("decimation", c_uint32),
+        ("first_sample", c_uint64),  # absolute ADC-sample-index of the first point
+    ]
+
+
 # Create Struct to define a LUT-Value
 # for adjustment/read/write of single values inside LUT/BRAM
 class LutValue(Structure):